@@ -13,6 +13,10 @@
 #include "ORFileWriter.hh"
 #include "ORLogger.hh"
 #include "ORSocketReader.hh"
+#include "ORIOConfig.hh"
+#include "ORTreeFillThread.hh"
+#include "ORTraceWriter.hh"
+#include "ORVTreeWriter.hh"
 
 #include "OROrcaRequestProcessor.hh"
 #include "ORServer.hh"
@@ -41,6 +45,27 @@ static const char Usage[] =
 "    A [num] value of 0 sets this to infinity (i.e. no timeout).\n"
 "  --daemon [port] : Runs as a server accepting connections on [port]. \n" 
 "  --connections [num] : Maximum [num] connections accepted by server. \n" 
+"  --recordmemory [MB] : Cap the memory used for record buffers at [MB] MB.\n"
+"  --compression [algo:level] : compression of the output file, e.g. zlib:1,\n"
+"    lzma:6, lz4:4 or zstd:5.\n"
+"  --ioconfig [file] : read ROOT output settings (compression, basket sizes,\n"
+"    AutoFlush, AutoSave per tree) from [file]. See ORIOConfig.hh.\n"
+"  --fillthread [MB] : fill trees and compress baskets on a separate thread,\n"
+"    queueing up to [MB] (default 64) MB of events.\n"
+"  --imt [num] : compress baskets with [num] threads using ROOT implicit\n"
+"    multi-threading. A [num] value of 0 uses one thread per core.\n"
+"  --waveformcodec [codec] : store waveforms encoded with ORWaveformCodec.\n"
+"    Choices are: off, delta, linear, and bitpack.\n"
+"  --runinfotree : store runNumber, subRunNumber and runningState once per\n"
+"    entry range in a friend tree <tree>_runInfo instead of in every entry.\n"
+"  --stats : time every processor and log its throughput and latency at\n"
+"    the end of every run, also storing them in the output file (see\n"
+"    ORProcessorStats.hh).\n"
+"  --trace [file[:N]] : write a timeline of the processing to [file] in the\n"
+"    Chrome trace-event format, tracing one record in [N] (default 1000).\n"
+"  --memory [MB] : log the memory held by each processor at the end of\n"
+"    every run. With [MB], warn and write out tree baskets whenever the\n"
+"    resident size of the process goes over [MB] MB.\n"
 "\n"
 "Example usage:\n"
 "orcaroot run194ecpu\n"
@@ -75,7 +100,18 @@ int main(int argc, char** argv)
     {"keepalive", optional_argument, 0, 'k'},
     {"maxreconnect", required_argument, 0, 'm'},
     {"daemon", required_argument, 0, 'd'},
-    {"connections", required_argument, 0, 'c'}
+    {"connections", required_argument, 0, 'c'},
+    {"recordmemory", required_argument, 0, 'r'},
+    {"compression", required_argument, 0, 'z'},
+    {"ioconfig", required_argument, 0, 'i'},
+    {"fillthread", optional_argument, 0, 'f'},
+    {"imt", required_argument, 0, 't'},
+    {"runinfotree", no_argument, 0, 'n'},
+    {"waveformcodec", required_argument, 0, 'w'},
+    {"stats", no_argument, 0, 's'},
+    {"trace", required_argument, 0, 'e'},
+    {"memory", optional_argument, 0, 'y'},
+    {0, 0, 0, 0}
   };
 
   string label = "OR";
@@ -87,6 +123,15 @@ int main(int argc, char** argv)
   unsigned int reconnectAttempts = 0; // default reconnect tries for sockets.
   unsigned int portToListenOn = 0;
   unsigned int maxConnections = 5; // default connections accepted by server
+  size_t recordMemoryMB = 0; // default no cap on record buffer memory
+  bool useFillThread = false;
+  size_t fillQueueMB = 0; // default queue size of ORTreeFillThread
+  int implicitMTThreads = -1; // default no implicit multi-threading
+  bool instrument = false; // default no processor statistics
+  string traceFile = ""; // default no timeline
+  UInt_t traceSampling = 1000;
+  bool accountMemory = false;
+  size_t memoryBudgetMB = 0; // default no memory budget
 
   while(1) {
     char optId = getopt_long(argc, argv, "", longOptions, NULL);
@@ -130,6 +175,55 @@ int main(int argc, char** argv)
       case('c'):
         maxConnections = abs(atoi(optarg));
         break;
+      case('r'):
+        recordMemoryMB = abs(atol(optarg));
+        break;
+      case('z'):
+        if(!ORIOConfig::SetFileCompression(optarg)) {
+          ORLog(kError) << Usage;
+          return 1;
+        }
+        break;
+      case('i'):
+        if(!ORIOConfig::LoadConfigFile(optarg)) return 1;
+        break;
+      case('f'):
+        useFillThread = true;
+        if(optarg) fillQueueMB = abs(atol(optarg));
+        break;
+      case('t'):
+        implicitMTThreads = abs(atoi(optarg));
+        break;
+      case('w'): {
+          Int_t codec;
+          if(!ORIOConfig::ParseWaveformCodec(optarg, codec)) {
+            ORLog(kError) << Usage;
+            return 1;
+          }
+          ORTreeIOSettings settings;
+          settings.SetWaveformCodec(codec);
+          ORIOConfig::AddTreeSettings("*", settings);
+        }
+        break;
+      case('n'):
+        ORVTreeWriter::SetDefaultRunBranchMode(ORVTreeWriter::kRunBranchesInRunInfoTree);
+        break;
+      case('s'):
+        instrument = true;
+        break;
+      case('e'): {
+          traceFile = optarg;
+          size_t iColon = traceFile.rfind(":");
+          if (iColon != string::npos) {
+            traceSampling = abs(atoi(traceFile.substr(iColon+1).c_str()));
+            traceFile = traceFile.substr(0, iColon);
+          }
+        }
+        break;
+      case('y'):
+        accountMemory = true;
+        if(optarg) memoryBudgetMB = abs(atol(optarg));
+        break;
       default: // unrecognized option
         ORLog(kError) << Usage;
         return 1;
@@ -252,6 +346,9 @@ int main(int argc, char** argv)
 
   ORLog(kRoutine) << "Setting up data processing manager..." << endl;
   ORDataProcManager dataProcManager(reader);
+  dataProcManager.SetRecordPoolMaxBytes(recordMemoryMB*1024*1024);
+  if (instrument) dataProcManager.EnableInstrumentation();
+  if (accountMemory) dataProcManager.SetMemoryBudget(memoryBudgetMB*1024*1024);
 
   /* Declare processors here. */
   // ORMyProcessor processor;
@@ -265,9 +362,16 @@ int main(int argc, char** argv)
     // dataProcManager.AddProcessor(&processor);
   }
 
+  /* Threads do not survive fork(), so start them only now. */
+  if (implicitMTThreads >= 0) ORTreeFillThread::EnableImplicitMT(implicitMTThreads);
+  if (useFillThread) ORTreeFillThread::Start(fillQueueMB*1024*1024);
+  if (traceFile != "") ORTraceWriter::Open(traceFile, traceSampling);
+
   ORLog(kRoutine) << "Start processing..." << endl;
   dataProcManager.ProcessDataStream();
   ORLog(kRoutine) << "Finished processing..." << endl;
+  ORTreeFillThread::Stop();
+  ORTraceWriter::Close();
 
   delete reader;
   delete handlerThread;
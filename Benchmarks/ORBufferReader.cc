@@ -0,0 +1,34 @@
+// ORBufferReader.cc
+
+#include "ORBufferReader.hh"
+
+#include <cstring>
+
+ORBufferReader::ORBufferReader(const char* buffer, size_t nBytes) :
+fBuffer(buffer), fNBytes(nBytes), fPosition(0), fIsOpen(false)
+{
+}
+
+void ORBufferReader::SetBuffer(const char* buffer, size_t nBytes)
+{
+  fBuffer = buffer;
+  fNBytes = nBytes;
+  fPosition = 0;
+}
+
+size_t ORBufferReader::Read(char* buffer, size_t nBytesMax)
+{
+  if (!fIsOpen || fPosition >= fNBytes) return 0;
+  size_t nBytes = fNBytes - fPosition;
+  if (nBytes > nBytesMax) nBytes = nBytesMax;
+  memcpy(buffer, fBuffer + fPosition, nBytes);
+  fPosition += nBytes;
+  return nBytes;
+}
+
+bool ORBufferReader::OpenDataStream()
+{
+  fPosition = 0;
+  fIsOpen = (fBuffer != NULL && fNBytes > 0);
+  return fIsOpen;
+}
@@ -0,0 +1,36 @@
+// ORBufferReader.hh
+
+#ifndef _ORBufferReader_hh_
+#define _ORBufferReader_hh_
+
+#ifndef _ORVReader_hh_
+#include "ORVReader.hh"
+#endif
+
+//! Reads an ORCA stream held in memory.
+/*!
+    Used by the benchmarks, so that what is timed is the decoding and not
+    the disk.  The buffer is not copied and must outlive the reader; each
+    OpenDataStream() starts reading it again from the beginning.
+ */
+class ORBufferReader : public ORVReader
+{
+  public:
+    ORBufferReader(const char* buffer = NULL, size_t nBytes = 0);
+    virtual ~ORBufferReader() {}
+
+    virtual void SetBuffer(const char* buffer, size_t nBytes);
+
+    virtual size_t Read(char* buffer, size_t nBytesMax);
+    virtual bool OKToRead() { return fIsOpen && fPosition < fNBytes; }
+    virtual bool OpenDataStream();
+    virtual void Close() { fIsOpen = false; }
+
+  protected:
+    const char* fBuffer;
+    size_t fNBytes;
+    size_t fPosition;
+    bool fIsOpen;
+};
+
+#endif
@@ -0,0 +1,329 @@
+// ORStreamReplayer.cc
+
+#include "ORStreamReplayer.hh"
+
+#include <cmath>
+#include <cstring>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include "TSocket.h"
+#include "TString.h"
+#include "ORHeader.hh"
+#include "ORHeaderDecoder.hh"
+#include "ORLogger.hh"
+#include "ORProcessorStats.hh"
+#include "ORUtils.hh"
+
+using namespace std;
+
+static const size_t kChunkBytes = 0x10000;
+// longest pause between two runs, in seconds of wall time
+static const Double_t kMaxPauseBetweenRuns = 3;
+// how long to wait for the last bytes to be acknowledged
+static const Double_t kAcknowledgeTimeout = 10;
+
+ORStreamReplayer::ORStreamReplayer() :
+fMustSwap(false), fRunDataId(ORVDataDecoder::GetIllegalDataId()), fSpeed(1), fBurstOn(0),
+fBurstOff(0), fReportInterval(5), fMaxSegmentBytes(256*1024*1024), fHaveDataTime(false),
+fDataStart(0), fScheduleStart(0), fLastDataTime(0), fHeartbeatPeriod(0),
+fDataSinceRunRecord(false), fLag(0), fReplayStart(0), fNBytesSent(0), fNRecordsSent(0),
+fLastReport(0), fBytesAtLastReport(0), fAcknowledgedAtLastReport(0)
+{
+}
+
+bool ORStreamReplayer::OpenFile(const string& fileName)
+{
+  if (fFile.is_open()) fFile.close();
+  fFile.clear();
+  fFile.open(fileName.c_str(), ios::in | ios::binary);
+  if (!fFile.good()) {
+    ORLog(kError) << "OpenFile(): couldn't open " << fileName << endl;
+    return false;
+  }
+  fFileName = fileName;
+
+  UInt_t firstWord = 0;
+  fFile.read((char*) &firstWord, sizeof(firstWord));
+  ORHeaderDecoder headerDecoder;
+  ORHeaderDecoder::EOrcaStreamVersion version = headerDecoder.GetStreamVersion(firstWord);
+  if (!fFile.good() || version == ORHeaderDecoder::kUnknownVersion) {
+    ORLog(kError) << "OpenFile(): " << fileName << " is not an ORCA file" << endl;
+    return false;
+  }
+  if (version == ORHeaderDecoder::kOld) {
+    ORLog(kError) << "OpenFile(): " << fileName << " has an old-style header, "
+                  << "which can't be replayed" << endl;
+    return false;
+  }
+  fMustSwap = (version == ORHeaderDecoder::kNewSwapped);
+
+  fFile.seekg(0);
+  fHeader.clear();
+  if (!ReadRecord(fHeader) || fHeader.size() <= 2*sizeof(UInt_t)) {
+    ORLog(kError) << "OpenFile(): couldn't read the header of " << fileName << endl;
+    return false;
+  }
+  ORHeader header;
+  if (!header.LoadHeaderString(&fHeader[2*sizeof(UInt_t)], fHeader.size() - 2*sizeof(UInt_t))) {
+    ORLog(kError) << "OpenFile(): couldn't parse the header of " << fileName << endl;
+    return false;
+  }
+  fRunDataId = header.GetDataId("ORRunModel:Run");
+  if (fRunDataId == ORVDataDecoder::GetIllegalDataId()) {
+    ORLog(kWarning) << "OpenFile(): no run records in " << fileName
+                    << "; sending as fast as possible" << endl;
+  }
+  return true;
+}
+
+bool ORStreamReplayer::ReadRecord(vector<char>& buffer)
+{
+  UInt_t firstWord = 0;
+  fFile.read((char*) &firstWord, sizeof(firstWord));
+  if (fFile.gcount() == 0) return false;
+  if (!fFile.good()) {
+    ORLog(kWarning) << "ReadRecord(): incomplete record at the end of " << fFileName << endl;
+    return false;
+  }
+  UInt_t hostFirstWord = firstWord;
+  if (fMustSwap) ORUtils::Swap(hostFirstWord);
+  size_t nBytes = fBasicDecoder.LengthOf(&hostFirstWord)*sizeof(UInt_t);
+  if (nBytes == 0) {
+    ORLog(kError) << "ReadRecord(): record of length 0 in " << fFileName << endl;
+    return false;
+  }
+  size_t start = buffer.size();
+  buffer.resize(start + nBytes);
+  memcpy(&buffer[start], &firstWord, sizeof(firstWord));
+  fFile.read(&buffer[start + sizeof(firstWord)], nBytes - sizeof(firstWord));
+  if (!fFile.good()) {
+    ORLog(kWarning) << "ReadRecord(): incomplete record at the end of " << fFileName << endl;
+    buffer.resize(start);
+    return false;
+  }
+  return true;
+}
+
+bool ORStreamReplayer::ReadSegment(vector<char>& segment, size_t& nRecords,
+                                   bool& endsWithRunRecord)
+{
+  segment.clear();
+  nRecords = 0;
+  endsWithRunRecord = false;
+  while (segment.size() < fMaxSegmentBytes) {
+    size_t start = segment.size();
+    if (!ReadRecord(segment)) break;
+    nRecords++;
+    UInt_t firstWord;
+    memcpy(&firstWord, &segment[start], sizeof(firstWord));
+    if (fMustSwap) ORUtils::Swap(firstWord);
+    if (fBasicDecoder.IsLong(&firstWord) && fBasicDecoder.DataIdOf(&firstWord) == fRunDataId &&
+        fBasicDecoder.LengthOf(&firstWord) >= 4) {
+      endsWithRunRecord = true;
+      break;
+    }
+  }
+  return nRecords > 0;
+}
+
+bool ORStreamReplayer::TimeOfRunRecord(const UInt_t* record, Double_t& time)
+{
+  // see ORRunDecoder
+  UInt_t flags = record[1];
+  if (flags & 0x8) {
+    // heartbeat: the previous one told when this one comes
+    UInt_t period = fHeartbeatPeriod;
+    fHeartbeatPeriod = record[3];
+    if (!fHaveDataTime) return false;
+    if (period == 0 && fDataSinceRunRecord) period = record[3];
+    time = fLastDataTime + period;
+    return true;
+  }
+
+  // run start or stop, with the time
+  Double_t utime = record[3];
+  fHeartbeatPeriod = 0;
+  if (!fHaveDataTime) {
+    fHaveDataTime = true;
+    fDataStart = utime;
+    fScheduleStart = ORProcessorStats::Now();
+    fLastDataTime = utime;
+    time = utime;
+    return true;
+  }
+  if (utime < fLastDataTime) utime = fLastDataTime;
+  if ((flags & 0x1) && utime - fLastDataTime > kMaxPauseBetweenRuns*fSpeed) {
+    // start of the next run: don't wait for the whole pause
+    fDataStart += utime - fLastDataTime - kMaxPauseBetweenRuns*fSpeed;
+  }
+  time = utime;
+  return true;
+}
+
+bool ORStreamReplayer::Replay(TSocket* socket)
+{
+  fHaveDataTime = false;
+  fHeartbeatPeriod = 0;
+  fLag = 0;
+  fNBytesSent = 0;
+  fNRecordsSent = 0;
+  fReplayStart = ORProcessorStats::Now();
+  fLastReport = fReplayStart;
+  fBytesAtLastReport = 0;
+  fAcknowledgedAtLastReport = 0;
+
+  ORLog(kRoutine) << "Replay(): sending " << fFileName << endl;
+  if (!SendAll(socket, &fHeader[0], fHeader.size())) return false;
+  fNRecordsSent++;
+
+  fFile.clear();
+  fFile.seekg(fHeader.size());
+  vector<char> segment;
+  size_t nRecords;
+  bool endsWithRunRecord;
+  while (ReadSegment(segment, nRecords, endsWithRunRecord)) {
+    bool hasEndTime = false;
+    Double_t endTime = 0;
+    if (endsWithRunRecord) {
+      UInt_t runRecord[4];
+      memcpy(runRecord, &segment[segment.size() - sizeof(runRecord)], sizeof(runRecord));
+      for (size_t i=0; fMustSwap && i<4; i++) ORUtils::Swap(runRecord[i]);
+      fDataSinceRunRecord = (nRecords > 1);
+      hasEndTime = TimeOfRunRecord(runRecord, endTime);
+    }
+    if (!SendSegment(socket, segment, hasEndTime, endTime)) {
+      Report(socket, true);
+      return false;
+    }
+    fNRecordsSent += nRecords;
+    if (hasEndTime) fLastDataTime = endTime;
+  }
+
+  Double_t start = ORProcessorStats::Now();
+  while (UnacknowledgedBytes(socket) > 0 && !TestCancel() &&
+         ORProcessorStats::Now() - start < kAcknowledgeTimeout) {
+    usleep(10000);
+  }
+  Report(socket, true);
+  return true;
+}
+
+bool ORStreamReplayer::SendSegment(TSocket* socket, const vector<char>& segment,
+                                   bool hasEndTime, Double_t endTime)
+{
+  bool paced = (fSpeed > 0 && fHaveDataTime && hasEndTime);
+  Double_t wallBegin = paced ? ScheduleOf(fLastDataTime) : 0;
+  Double_t wallEnd = paced ? ScheduleOf(endTime) : 0;
+  for (size_t offset=0; offset<segment.size(); offset+=kChunkBytes) {
+    size_t nBytes = segment.size() - offset;
+    if (nBytes > kChunkBytes) nBytes = kChunkBytes;
+    Double_t due = wallBegin + (wallEnd - wallBegin)*offset/segment.size();
+    if (!WaitUntil(socket, due)) return false;
+    if (paced) {
+      fLag = ORProcessorStats::Now() - due;
+      if (fLag < 0) fLag = 0;
+    }
+    if (!SendAll(socket, &segment[offset], nBytes)) return false;
+    if (fReportInterval > 0 && ORProcessorStats::Now() - fLastReport >= fReportInterval) {
+      Report(socket);
+    }
+  }
+  return true;
+}
+
+bool ORStreamReplayer::SendAll(TSocket* socket, const char* buffer, size_t nBytes)
+{
+  while (nBytes > 0) {
+    if (TestCancel()) return false;
+    Int_t nSent = socket->SendRaw(buffer, nBytes);
+    if (nSent == -4) {
+      // would block
+      socket->Select(TSocket::kWrite, 100);
+      continue;
+    }
+    if (nSent <= 0) {
+      ORLog(kError) << "SendAll(): the connection was closed after "
+                    << fNBytesSent << " bytes" << endl;
+      return false;
+    }
+    buffer += nSent;
+    nBytes -= nSent;
+    fNBytesSent += nSent;
+  }
+  return true;
+}
+
+bool ORStreamReplayer::WaitUntil(TSocket* socket, Double_t wallTime)
+{
+  while (!TestCancel()) {
+    Double_t now = ORProcessorStats::Now();
+    Double_t wait = wallTime - now;
+    if (fBurstOn > 0 && fBurstOff > 0) {
+      Double_t phase = fmod(now - fReplayStart, fBurstOn + fBurstOff);
+      if (phase >= fBurstOn && fBurstOn + fBurstOff - phase > wait) {
+        wait = fBurstOn + fBurstOff - phase;
+      }
+    }
+    if (wait <= 0) return true;
+    if (fReportInterval > 0 && now - fLastReport >= fReportInterval) Report(socket);
+    usleep((useconds_t) ((wait < 0.1 ? wait : 0.1)*1e6));
+  }
+  return false;
+}
+
+void ORStreamReplayer::Report(TSocket* socket, bool final)
+{
+  Double_t now = ORProcessorStats::Now();
+  Double_t elapsed = now - fReplayStart;
+  Double_t interval = now - fLastReport;
+  Long64_t unacknowledged = UnacknowledgedBytes(socket);
+  ULong64_t acknowledged = 0;
+  if (unacknowledged >= 0 && (ULong64_t) unacknowledged <= fNBytesSent) {
+    acknowledged = fNBytesSent - unacknowledged;
+  }
+  const Double_t MB = 1024.*1024.;
+
+  if (final) {
+    if (elapsed <= 0) elapsed = 1e-9;
+    ORLog(kRoutine) << ::Form("Replay(): sent %llu records, %.1f MB in %.1f s: %.2f MB/s",
+                              (unsigned long long) fNRecordsSent, fNBytesSent/MB, elapsed,
+                              fNBytesSent/MB/elapsed) << endl;
+    if (unacknowledged >= 0) {
+      ORLog(kRoutine) << ::Form("Replay(): %.1f MB acknowledged, %.1f MB not",
+                                acknowledged/MB, unacknowledged/MB) << endl;
+    }
+    if (fHaveDataTime && fLastDataTime > fDataStart) {
+      ORLog(kRoutine) << ::Form("Replay(): %.0f s of data, %.2f times real time",
+                                fLastDataTime - fDataStart,
+                                (fLastDataTime - fDataStart)/elapsed) << endl;
+    }
+  } else if (interval > 0) {
+    string line = ::Form("%7.1f s: sent %.1f MB (%.2f MB/s)", elapsed, fNBytesSent/MB,
+                          (fNBytesSent - fBytesAtLastReport)/MB/interval);
+    if (unacknowledged >= 0) {
+      line += ::Form(", acknowledged %.1f MB (%.2f MB/s)", acknowledged/MB,
+                     (acknowledged - (Double_t) fAcknowledgedAtLastReport)/MB/interval);
+    }
+    if (fSpeed > 0 && fHaveDataTime) line += ::Form(", %.1f s behind", fLag);
+    ORLog(kRoutine) << line << endl;
+  }
+  fLastReport = now;
+  fBytesAtLastReport = fNBytesSent;
+  fAcknowledgedAtLastReport = acknowledged;
+}
+
+Long64_t ORStreamReplayer::UnacknowledgedBytes(TSocket* socket)
+{
+  if (socket == NULL) return -1;
+  int descriptor = socket->GetDescriptor();
+  int nBytes = 0;
+#if defined(__linux__)
+  // sent but unacknowledged plus unsent, see tcp(7)
+  if (ioctl(descriptor, TIOCOUTQ, &nBytes) == 0) return nBytes;
+#elif defined(__APPLE__)
+  socklen_t length = sizeof(nBytes);
+  if (getsockopt(descriptor, SOL_SOCKET, SO_NWRITE, &nBytes, &length) == 0) return nBytes;
+#endif
+  return -1;
+}
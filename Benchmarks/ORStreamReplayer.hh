@@ -0,0 +1,124 @@
+// ORStreamReplayer.hh
+
+#ifndef _ORStreamReplayer_hh_
+#define _ORStreamReplayer_hh_
+
+#include <fstream>
+#include <string>
+#include <vector>
+#ifndef ROOT_Rtypes
+#include "Rtypes.h"
+#endif
+#ifndef _ORVSigHandler_hh_
+#include "ORVSigHandler.hh"
+#endif
+#ifndef _ORBasicDataDecoder_hh_
+#include "ORBasicDataDecoder.hh"
+#endif
+
+class TSocket;
+
+//! Sends a raw ORCA file over a socket the way ORCA sends a run.
+/*!
+    The file is sent unchanged, header first, in the byte order it was
+    written in, so that an ORSocketReader (orcaroot host:port) sees the
+    same stream it would see from ORCA.
+
+    The pace comes from the run records: the run start and stop carry the
+    time, and every heartbeat the time to the next heartbeat.  The records
+    between two of them are spread evenly over the time between them,
+    divided by SetSpeed(); a speed of 0 sends as fast as the socket takes
+    them.  Pauses between runs are shortened to a few seconds.  Up to
+    SetMaxSegmentBytes() are held to spread; when more data than that come
+    without a run record (e.g. files without heartbeats), they are sent as
+    fast as possible and the pace picks up again at the next run record.
+    With SetBurst(), data are only sent during the first onSeconds of every
+    onSeconds+offSeconds, so that the same average rate arrives in bursts
+    (with speed 0: at full speed, with pauses).
+
+    Every SetReportInterval() seconds, and at the end, the bytes sent are
+    logged together with the bytes acknowledged by the other side, as
+    reported by the kernel (unknown on systems other than Linux and Mac OS
+    X), and how far behind the schedule the sending is.  Bytes sent but not
+    acknowledged for long mean the reader does not keep up; compare with
+    the words ORSocketReader reports as thrown away.
+ */
+class ORStreamReplayer : public ORVSigHandler
+{
+  public:
+    ORStreamReplayer();
+    virtual ~ORStreamReplayer() {}
+
+    //! Opens a raw ORCA file and reads its header; returns false on error.
+    virtual bool OpenFile(const std::string& fileName);
+
+    //! Multiple of real time; 0 for as fast as possible.
+    virtual void SetSpeed(Double_t speed) { fSpeed = speed; }
+    virtual Double_t GetSpeed() const { return fSpeed; }
+    //! Sends in bursts of onSeconds every onSeconds+offSeconds; 0 for no bursts.
+    virtual void SetBurst(Double_t onSeconds, Double_t offSeconds)
+      { fBurstOn = onSeconds; fBurstOff = offSeconds; }
+    virtual void SetReportInterval(Double_t seconds) { fReportInterval = seconds; }
+    virtual void SetMaxSegmentBytes(size_t nBytes) { fMaxSegmentBytes = nBytes; }
+
+    //! Sends the whole file on socket; returns false if the socket failed or on cancel.
+    virtual bool Replay(TSocket* socket);
+
+    virtual ULong64_t GetNBytesSent() const { return fNBytesSent; }
+    virtual ULong64_t GetNRecordsSent() const { return fNRecordsSent; }
+
+    //! Bytes sent on a socket that the other side has not acknowledged, -1 if unknown.
+    static Long64_t UnacknowledgedBytes(TSocket* socket);
+
+  protected:
+    //! Reads the next record, appending it to buffer; false at the end of the file.
+    virtual bool ReadRecord(std::vector<char>& buffer);
+    //! Reads records up to and including a run record; false if there are none.
+    virtual bool ReadSegment(std::vector<char>& segment, size_t& nRecords,
+                             bool& endsWithRunRecord);
+    //! Data time of a run record, in seconds; false if it doesn't carry one.
+    virtual bool TimeOfRunRecord(const UInt_t* record, Double_t& time);
+    //! Sends segment, spread out until the data time endTime if hasEndTime.
+    virtual bool SendSegment(TSocket* socket, const std::vector<char>& segment,
+                             bool hasEndTime, Double_t endTime);
+    virtual bool SendAll(TSocket* socket, const char* buffer, size_t nBytes);
+    //! Sleeps until wallTime and the next burst, reporting meanwhile; false on cancel.
+    virtual bool WaitUntil(TSocket* socket, Double_t wallTime);
+    //! Wall time at which data of time dataTime are due.
+    virtual Double_t ScheduleOf(Double_t dataTime) const
+      { return fScheduleStart + (dataTime - fDataStart)/fSpeed; }
+    virtual void Report(TSocket* socket, bool final = false);
+
+  protected:
+    std::string fFileName;
+    std::ifstream fFile;
+    bool fMustSwap;
+    UInt_t fRunDataId;
+    ORBasicDataDecoder fBasicDecoder;
+    std::vector<char> fHeader;
+
+    Double_t fSpeed;
+    Double_t fBurstOn;
+    Double_t fBurstOff;
+    Double_t fReportInterval;
+    size_t fMaxSegmentBytes;
+
+    // pace
+    bool fHaveDataTime;
+    Double_t fDataStart;      // data time of the first run start
+    Double_t fScheduleStart;  // wall time it was sent at
+    Double_t fLastDataTime;   // data time of the last run record
+    UInt_t fHeartbeatPeriod;  // announced by the last heartbeat, 0 if none
+    bool fDataSinceRunRecord; // data records came before the current run record
+    Double_t fLag;            // seconds behind the schedule
+
+    // statistics
+    Double_t fReplayStart;
+    ULong64_t fNBytesSent;
+    ULong64_t fNRecordsSent;
+    Double_t fLastReport;
+    ULong64_t fBytesAtLastReport;
+    ULong64_t fAcknowledgedAtLastReport;
+};
+
+#endif
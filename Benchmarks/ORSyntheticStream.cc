@@ -0,0 +1,683 @@
+// ORSyntheticStream.cc
+
+#include "ORSyntheticStream.hh"
+
+#include <cctype>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include "ORDictionary.hh"
+#include "ORLogger.hh"
+#include "ORUtils.hh"
+#include "ORXmlPlistString.hh"
+
+using namespace std;
+
+// records per type, see the class description
+static const size_t kGretina4MSamples = 2018;
+static const size_t kSIS3302Samples = 1024;
+static const size_t kSIS3302EnergySamples = 510;
+static const size_t kKatrinV4FLTSamples = 2048;
+static const size_t kDGF4cEvents = 4;
+static const size_t kDGF4cSamples = 256;
+static const size_t kCaen5720Channels = 4;
+static const size_t kCaen5720Samples = 512;
+
+// mean gap between records of a type, in clock ticks
+static const Double_t kMeanTicksBetweenRecords = 50000;
+static const Double_t kClockFrequency = 1.e8;
+
+static const char* kCrateClassNames[] = { "ORVme64CrateModel", "ORVme64CrateModel",
+                                          "ORIpeV4CrateModel", "ORCamacCrateModel",
+                                          "ORVme64CrateModel" };
+
+ORSyntheticStream::ORSyntheticStream(UInt_t seed) :
+fSwapped(false), fRunNumber(1), fStartTime(1500000000), fHeartbeatInterval(10000),
+fWaveform(kKatrinV4FLTSamples)
+{
+  for (size_t i=0; i<kNRecordTypes; i++) fEnabled[i] = true;
+  SetSeed(seed);
+}
+
+void ORSyntheticStream::SetSeed(UInt_t seed)
+{
+  fRandomState = (seed == 0) ? 4357 : seed;
+  for (size_t i=0; i<8; i++) Random();
+  fHaveGaus = false;
+  fNextGaus = 0;
+  for (size_t i=0; i<kNRecordTypes; i++) {
+    fClock[i] = 0;
+    fEventCount[i] = 0;
+  }
+  fNextType = 0;
+}
+
+void ORSyntheticStream::EnableOnly(ERecordType type)
+{
+  for (size_t i=0; i<kNRecordTypes; i++) fEnabled[i] = (i == (size_t) type);
+}
+
+const char* ORSyntheticStream::GetTypeName(ERecordType type)
+{
+  switch (type) {
+    case kShaper: return "Shaper";
+    case kGretina4M: return "Gretina4M";
+    case kSIS3302: return "SIS3302";
+    case kKatrinV4FLTEnergy: return "KatrinV4FLTEnergy";
+    case kKatrinV4FLTWaveform: return "KatrinV4FLTWaveform";
+    case kDGF4c: return "DGF4c";
+    case kCaen5720: return "Caen5720";
+    default: return "";
+  }
+}
+
+bool ORSyntheticStream::ParseTypeName(const string& name, ERecordType& type)
+{
+  string lowerName = name;
+  for (size_t i=0; i<lowerName.size(); i++) lowerName[i] = tolower(lowerName[i]);
+  for (size_t i=0; i<kNRecordTypes; i++) {
+    string typeName = GetTypeName((ERecordType) i);
+    for (size_t j=0; j<typeName.size(); j++) typeName[j] = tolower(typeName[j]);
+    if (typeName == lowerName) {
+      type = (ERecordType) i;
+      return true;
+    }
+  }
+  return false;
+}
+
+const char* ORSyntheticStream::GetDataObjectPath(ERecordType type)
+{
+  switch (type) {
+    case kShaper: return "ORShaperModel:Shaper";
+    case kGretina4M: return "ORGretina4M:Gretina4M";
+    case kSIS3302: return "ORSIS3302:Energy";
+    case kKatrinV4FLTEnergy: return "ORKatrinV4FLTModel:KatrinV4FLTEnergy";
+    case kKatrinV4FLTWaveform: return "ORKatrinV4FLTModel:KatrinV4FLTWaveForm";
+    case kDGF4c: return "ORDGF4cModel:Event";
+    case kCaen5720: return "ORDT5720Model:waveform";
+    default: return "";
+  }
+}
+
+const ORSyntheticStream::ORCardPlacement& ORSyntheticStream::GetPlacement(ERecordType type)
+{
+  // the Caen 5720 decoder takes every record to be from card 0
+  static const ORCardPlacement placements[kNRecordTypes] = {
+    { "ORShaperModel", 0, 3, 2, 8 },
+    { "ORGretina4MModel", 1, 2, 2, 10 },
+    { "ORSIS3302Model", 1, 6, 2, 8 },
+    { "ORKatrinV4FLTModel", 2, 1, 2, 24 },
+    { "ORKatrinV4FLTModel", 2, 1, 2, 24 },
+    { "ORDGF4cModel", 3, 1, 2, 4 },
+    { "ORDT5720Model", 4, 0, 1, kCaen5720Channels }
+  };
+  return placements[type];
+}
+
+//------------------------------------------------------------------------------
+// header
+
+static ORDictValueA* ORSyntheticIntArray(size_t n, int value)
+{
+  ORDictValueA* array = new ORDictValueA;
+  for (size_t i=0; i<n; i++) array->LoadValue(new ORDictValueI(value));
+  return array;
+}
+
+static ORDictValueA* ORSyntheticRealArray(size_t n, double value)
+{
+  ORDictValueA* array = new ORDictValueA;
+  for (size_t i=0; i<n; i++) array->LoadValue(new ORDictValueR(value));
+  return array;
+}
+
+ORDictionary* ORSyntheticStream::BuildCardDictionary(ERecordType type, UInt_t card) const
+{
+  const ORCardPlacement& placement = GetPlacement(type);
+  size_t nChannels = placement.fNChannels;
+  ORDictionary* dict = new ORDictionary;
+  dict->LoadEntry("Class Name", new ORDictValueS(placement.fModelName));
+  dict->LoadEntry("Card", new ORDictValueI(card));
+  switch (type) {
+    case kShaper:
+      dict->LoadEntry("thresholds", ORSyntheticIntArray(nChannels, 100));
+      dict->LoadEntry("gains", ORSyntheticIntArray(nChannels, 128));
+      break;
+    case kGretina4M:
+      // presums as read by ORGretina4MDecoder::GetMultiRateInfo()
+      dict->LoadEntry("Integration Time", new ORDictValueI(350));
+      dict->LoadEntry("Enabled", ORSyntheticIntArray(nChannels, 1));
+      dict->LoadEntry("Chpsrt", ORSyntheticIntArray(nChannels, 0));
+      dict->LoadEntry("Mrpsrt", ORSyntheticIntArray(nChannels, 2));
+      dict->LoadEntry("Chpsdv", ORSyntheticIntArray(nChannels, 0));
+      dict->LoadEntry("Mrpsdv", ORSyntheticIntArray(nChannels, 2));
+      break;
+    case kSIS3302:
+      dict->LoadEntry("thresholds", ORSyntheticIntArray(nChannels, 500));
+      dict->LoadEntry("energyPeakingTimes", ORSyntheticIntArray(nChannels, 100));
+      dict->LoadEntry("energyGapTimes", ORSyntheticIntArray(nChannels, 200));
+      dict->LoadEntry("sampleLengths", ORSyntheticIntArray(nChannels, kSIS3302Samples));
+      break;
+    case kKatrinV4FLTEnergy:
+    case kKatrinV4FLTWaveform:
+      dict->LoadEntry("thresholds", ORSyntheticIntArray(nChannels, 2000));
+      dict->LoadEntry("gains", ORSyntheticIntArray(nChannels, 0));
+      dict->LoadEntry("filterLength", new ORDictValueI(6));
+      dict->LoadEntry("runMode", new ORDictValueI(1));
+      break;
+    case kDGF4c:
+      dict->LoadEntry("tau", ORSyntheticRealArray(nChannels, 50.));
+      dict->LoadEntry("traceLength", ORSyntheticRealArray(nChannels, 6.4));
+      dict->LoadEntry("energyRiseTime", ORSyntheticRealArray(nChannels, 4.));
+      dict->LoadEntry("energyFlatTop", ORSyntheticRealArray(nChannels, 1.2));
+      dict->LoadEntry("binFactor", ORSyntheticIntArray(nChannels, 1));
+      dict->LoadEntry("inSync", new ORDictValueB(false));
+      dict->LoadEntry("runBehavior", new ORDictValueI(0));
+      break;
+    case kCaen5720:
+      dict->LoadEntry("thresholds", ORSyntheticIntArray(nChannels, 100));
+      dict->LoadEntry("enabledMask", new ORDictValueI((1 << nChannels) - 1));
+      break;
+    default:
+      break;
+  }
+  return dict;
+}
+
+static ORDictionary* ORSyntheticSubDictionary(ORDictionary* parent, const string& key)
+{
+  ORDictionary::DictMap::iterator iter = parent->GetDictMap().find(key);
+  if (iter != parent->GetDictMap().end()) return dynamic_cast<ORDictionary*>(iter->second);
+  ORDictionary* dict = new ORDictionary(key);
+  parent->LoadEntry(key, dict);
+  return dict;
+}
+
+static void ORSyntheticDataDescription(ORDictionary* dataDescription, const string& path,
+                                       UInt_t dataId, int length, const char* decoder)
+{
+  size_t colon = path.find(':');
+  ORDictionary* object = ORSyntheticSubDictionary(dataDescription, path.substr(0, colon));
+  ORDictionary* record = ORSyntheticSubDictionary(object, path.substr(colon+1));
+  record->LoadEntry("dataId", new ORDictValueI(dataId));
+  record->LoadEntry("decoder", new ORDictValueS(decoder));
+  record->LoadEntry("length", new ORDictValueI(length));
+  record->LoadEntry("variable", new ORDictValueB(length < 0));
+}
+
+ORDictionary* ORSyntheticStream::BuildHeaderDictionary() const
+{
+  ORDictionary* header = new ORDictionary("rootDict");
+
+  ORDictionary* documentInfo = new ORDictionary("Document Info");
+  documentInfo->LoadEntry("OrcaVersion", new ORDictValueS("9.0"));
+  documentInfo->LoadEntry("dataVersion", new ORDictValueI(2));
+  documentInfo->LoadEntry("documentName", new ORDictValueS("ORSyntheticStream"));
+  header->LoadEntry("Document Info", documentInfo);
+
+  ORDictionary* dataDescription = new ORDictionary("dataDescription");
+  ORSyntheticDataDescription(dataDescription, "ORRunModel:Run", GetRunDataId(), 4,
+                             "ORRunDecoderForRun");
+  for (size_t i=0; i<kNRecordTypes; i++) {
+    ERecordType type = (ERecordType) i;
+    int length = (type == kDGF4c) ? -1 : (int) GetRecordLength(type);
+    ORSyntheticDataDescription(dataDescription, GetDataObjectPath(type), GetDataId(type),
+                               length, GetTypeName(type));
+  }
+  header->LoadEntry("dataDescription", dataDescription);
+
+  // one dictionary per crate, with the cards of all types in it
+  ORDictionary* objectInfo = new ORDictionary("ObjectInfo");
+  ORDictValueA* crates = new ORDictValueA("Crates");
+  size_t nCrates = sizeof(kCrateClassNames)/sizeof(kCrateClassNames[0]);
+  for (size_t crate=0; crate<nCrates; crate++) {
+    ORDictionary* crateDict = new ORDictionary;
+    crateDict->LoadEntry("CrateNumber", new ORDictValueI(crate));
+    crateDict->LoadEntry("ClassName", new ORDictValueS(kCrateClassNames[crate]));
+    crateDict->LoadEntry("FirstSlot", new ORDictValueI(0));
+    ORDictValueA* cards = new ORDictValueA("Cards");
+    for (size_t i=0; i<kNRecordTypes; i++) {
+      const ORCardPlacement& placement = GetPlacement((ERecordType) i);
+      if (placement.fCrate != crate) continue;
+      // types that share their cards with an earlier one
+      if (i > 0 && strcmp(placement.fModelName, GetPlacement((ERecordType) (i-1)).fModelName) == 0) {
+        continue;
+      }
+      for (UInt_t card=0; card<placement.fNCards; card++) {
+        cards->LoadValue(BuildCardDictionary((ERecordType) i, placement.fFirstCard + card));
+      }
+    }
+    crateDict->LoadEntry("Cards", cards);
+    crates->LoadValue(crateDict);
+  }
+  objectInfo->LoadEntry("Crates", crates);
+
+  ORDictionary* runControl = new ORDictionary("Run Control");
+  runControl->LoadEntry("Class Name", new ORDictValueS("ORRunModel"));
+  runControl->LoadEntry("RunNumber", new ORDictValueI(fRunNumber));
+  runControl->LoadEntry("quickStart", new ORDictValueB(false));
+  runControl->LoadEntry("remoteControl", new ORDictValueB(false));
+  runControl->LoadEntry("runType", new ORDictValueI(0));
+  runControl->LoadEntry("startTime", new ORDictValueI(fStartTime));
+  ORDictionary* chainLink = new ORDictionary;
+  chainLink->LoadEntry("Run Control", runControl);
+  ORDictValueA* dataChain = new ORDictValueA("DataChain");
+  dataChain->LoadValue(chainLink);
+  objectInfo->LoadEntry("DataChain", dataChain);
+  header->LoadEntry("ObjectInfo", objectInfo);
+
+  return header;
+}
+
+string ORSyntheticStream::GetHeaderXML() const
+{
+  ORDictionary* header = BuildHeaderDictionary();
+  ORXmlPlistString xml;
+  xml.LoadDictionary(header);
+  delete header;
+  return xml;
+}
+
+//------------------------------------------------------------------------------
+// records
+
+void ORSyntheticStream::AppendHeader(vector<UInt_t>& stream) const
+{
+  string xml = GetHeaderXML();
+  size_t nBytes = xml.size() + 1; // with the terminating 0
+  size_t length = 2 + (nBytes + 3)/4;
+  size_t offset = stream.size();
+  stream.resize(offset + length, 0);
+  UInt_t* record = &stream[offset];
+  record[0] = length; // data id 0
+  record[1] = nBytes;
+  memcpy(record + 2, xml.c_str(), nBytes);
+  if (fSwapped) SwapRecord(kShaper, record);
+}
+
+void ORSyntheticStream::AppendRunRecord(vector<UInt_t>& stream, ERunFlags flags)
+{
+  size_t offset = stream.size();
+  stream.resize(offset + 4, 0);
+  UInt_t* record = &stream[offset];
+  record[0] = GetRunDataId() | 4;
+  record[1] = flags;
+  record[2] = fRunNumber;
+  if (flags == kHeartbeat) record[3] = 30; // seconds to the next heartbeat
+  else if (flags == kRunStart) record[3] = fStartTime;
+  else {
+    ULong64_t lastTime = 0;
+    for (size_t i=0; i<kNRecordTypes; i++) if (fClock[i] > lastTime) lastTime = fClock[i];
+    record[3] = fStartTime + UInt_t(lastTime/kClockFrequency) + 1;
+  }
+  if (fSwapped) SwapRecord(kShaper, record);
+}
+
+size_t ORSyntheticStream::GetRecordLength(ERecordType type) const
+{
+  switch (type) {
+    case kShaper: return 2;
+    case kGretina4M: return 2 + 1024;
+    case kSIS3302: return 4 + 2 + kSIS3302Samples/2 + kSIS3302EnergySamples + 4;
+    case kKatrinV4FLTEnergy: return 7;
+    case kKatrinV4FLTWaveform: return 9 + kKatrinV4FLTSamples/2;
+    case kDGF4c: return 2 + (fDGF4cBuffer.size() + 1)/2;
+    case kCaen5720: return 2 + 4 + kCaen5720Channels*kCaen5720Samples/2;
+    default: return 0;
+  }
+}
+
+bool ORSyntheticStream::AppendRecord(ERecordType type, vector<UInt_t>& stream)
+{
+  if (type < 0 || type >= kNRecordTypes) return false;
+  if (type == kDGF4c) FillDGF4cBuffer();
+  size_t length = GetRecordLength(type);
+  size_t offset = stream.size();
+  stream.resize(offset + length, 0);
+  UInt_t* record = &stream[offset];
+  record[0] = GetDataId(type) | length;
+  switch (type) {
+    case kShaper: BuildShaper(record); break;
+    case kGretina4M: BuildGretina4M(record); break;
+    case kSIS3302: BuildSIS3302(record); break;
+    case kKatrinV4FLTEnergy: BuildKatrinV4FLT(record, false); break;
+    case kKatrinV4FLTWaveform: BuildKatrinV4FLT(record, true); break;
+    case kDGF4c: BuildDGF4c(record); break;
+    case kCaen5720: BuildCaen5720(record); break;
+    default: break;
+  }
+  fEventCount[type]++;
+  if (fSwapped) SwapRecord(type, record);
+  return true;
+}
+
+void ORSyntheticStream::AppendNextRecord(vector<UInt_t>& stream, size_t iRecord)
+{
+  for (size_t i=0; i<kNRecordTypes && !fEnabled[fNextType]; i++) {
+    fNextType = (fNextType + 1) % kNRecordTypes;
+  }
+  if (!fEnabled[fNextType]) return;
+  AppendRecord((ERecordType) fNextType, stream);
+  fNextType = (fNextType + 1) % kNRecordTypes;
+  if (fHeartbeatInterval > 0 && (iRecord + 1) % fHeartbeatInterval == 0) {
+    AppendRunRecord(stream, kHeartbeat);
+  }
+}
+
+void ORSyntheticStream::Generate(vector<UInt_t>& stream, size_t nRecords)
+{
+  AppendHeader(stream);
+  AppendRunRecord(stream, kRunStart);
+  for (size_t i=0; i<nRecords; i++) AppendNextRecord(stream, i);
+  AppendRunRecord(stream, kRunStop);
+}
+
+bool ORSyntheticStream::WriteFile(const string& fileName, size_t nRecords)
+{
+  ofstream file(fileName.c_str(), ios::out | ios::binary);
+  if (!file.good()) {
+    ORLog(kError) << "WriteFile(): could not open " << fileName << endl;
+    return false;
+  }
+  // written in chunks of about 4 MB
+  const size_t chunkWords = 1 << 20;
+  vector<UInt_t> chunk;
+  chunk.reserve(chunkWords + 8192);
+  AppendHeader(chunk);
+  AppendRunRecord(chunk, kRunStart);
+  for (size_t i=0; i<nRecords; i++) {
+    AppendNextRecord(chunk, i);
+    if (chunk.size() >= chunkWords) {
+      file.write((const char*) &chunk[0], chunk.size()*sizeof(UInt_t));
+      chunk.clear();
+    }
+  }
+  AppendRunRecord(chunk, kRunStop);
+  file.write((const char*) &chunk[0], chunk.size()*sizeof(UInt_t));
+  file.close();
+  if (file.fail()) {
+    ORLog(kError) << "WriteFile(): error writing " << fileName << endl;
+    return false;
+  }
+  return true;
+}
+
+void ORSyntheticStream::SwapRecord(ERecordType type, UInt_t* record)
+{
+  UInt_t dataId = record[0] & 0xfffc0000;
+  UInt_t length = record[0] & 0x3ffff;
+  ORUtils::Swap(record[0]);
+  if (dataId == 0) {
+    // the header string is not swapped
+    if (length > 1) ORUtils::Swap(record[1]);
+    return;
+  }
+  if (dataId == GetDataId(kDGF4c) && type == kDGF4c) {
+    // see ORDGF4cEventDecoder::Swap()
+    if (length > 1) ORUtils::Swap(record[1]);
+    UShort_t* shorts = (UShort_t*) (record + 2);
+    for (size_t i=0; length > 2 && i<2*(length-2); i++) ORUtils::Swap(shorts[i]);
+    return;
+  }
+  for (size_t i=1; i<length; i++) ORUtils::Swap(record[i]);
+}
+
+void ORSyntheticStream::RandomChannel(ERecordType type, UInt_t& card, UInt_t& channel)
+{
+  const ORCardPlacement& placement = GetPlacement(type);
+  card = placement.fFirstCard + RandomBelow(placement.fNCards);
+  channel = RandomBelow(placement.fNChannels);
+}
+
+static inline UInt_t ORSyntheticCrateCard(UInt_t crate, UInt_t card)
+{
+  return ((crate & 0xf) << 21) | ((card & 0x1f) << 16);
+}
+
+static inline UInt_t ORSyntheticSample(Double_t value, Double_t min, Double_t max)
+{
+  if (value < min) value = min;
+  if (value > max) value = max;
+  return (UInt_t) (Long64_t) floor(value + 0.5);
+}
+
+void ORSyntheticStream::BuildShaper(UInt_t* record)
+{
+  UInt_t card, channel;
+  RandomChannel(kShaper, card, channel);
+  UInt_t adc = ORSyntheticSample(RandomEnergy()*0xfff, 0, 0xfff);
+  NextTime(kShaper);
+  record[1] = ORSyntheticCrateCard(GetPlacement(kShaper).fCrate, card) | (channel << 12) | adc;
+}
+
+void ORSyntheticStream::BuildGretina4M(UInt_t* record)
+{
+  UInt_t card, channel;
+  RandomChannel(kGretina4M, card, channel);
+  record[1] = ORSyntheticCrateCard(GetPlacement(kGretina4M).fCrate, card);
+
+  // event header, see ORGretina4MDecoder
+  UInt_t* event = record + 2;
+  Double_t energy = RandomEnergy();
+  UInt_t rawEnergy = ORSyntheticSample(energy*0xffffff, 0, 0xffffff); // positive: no sign bit
+  ULong64_t time = NextTime(kGretina4M);
+  event[0] = 0xaaaaaaaa;
+  event[1] = (((0x100 + card) & 0xfff) << 4) | channel;
+  event[2] = (UInt_t) time;
+  event[3] = (UInt_t) ((time >> 32) & 0xffff) | ((rawEnergy & 0xffff) << 16);
+  event[4] = (rawEnergy >> 16) & 0x1ff;
+
+  // 14-bit signed samples around 0
+  FillPulse(&fWaveform[0], kGretina4MSamples, 0, energy*8000, 1000, 4, 5000, 3);
+  Short_t* samples = (Short_t*) (event + 15);
+  for (size_t i=0; i<kGretina4MSamples; i++) {
+    samples[i] = (Short_t) (Int_t) ORSyntheticSample(fWaveform[i], -8192, 8191);
+  }
+}
+
+void ORSyntheticStream::BuildSIS3302(UInt_t* record)
+{
+  UInt_t card, channel;
+  RandomChannel(kSIS3302, card, channel);
+  const size_t nWaveformWords = kSIS3302Samples/2;
+  record[1] = ORSyntheticCrateCard(GetPlacement(kSIS3302).fCrate, card) | (channel << 8);
+  record[2] = nWaveformWords;
+  record[3] = kSIS3302EnergySamples;
+
+  // buffer header, see ORSIS3302Decoder
+  ULong64_t time = NextTime(kSIS3302);
+  record[4] = (UInt_t) (((time >> 32) & 0xffff) << 16) | (card << 3) | channel;
+  record[5] = (UInt_t) time;
+
+  Double_t energy = RandomEnergy();
+  FillPulse(&fWaveform[0], kSIS3302Samples, 8000, energy*50000, 300, 5, 5000, 4);
+  UInt_t* waveform = record + 6;
+  for (size_t i=0; i<nWaveformWords; i++) {
+    waveform[i] = ORSyntheticSample(fWaveform[2*i], 0, 0xffff) |
+                  (ORSyntheticSample(fWaveform[2*i+1], 0, 0xffff) << 16);
+  }
+
+  // trapezoidal energy filter output
+  UInt_t energyMax = ORSyntheticSample(energy*0xfffff, 0, 0xfffff);
+  UInt_t* energyWaveform = waveform + nWaveformWords;
+  for (size_t i=0; i<kSIS3302EnergySamples; i++) {
+    Double_t shape = 0;
+    if (i >= 50 && i < 150) shape = (i - 50)/100.;
+    else if (i >= 150 && i < 350) shape = 1;
+    else if (i >= 350 && i < 450) shape = (450 - i)/100.;
+    energyWaveform[i] = ORSyntheticSample(energyMax*shape + 20*Gaus(), 0, 0xffffffffU);
+  }
+
+  UInt_t* trailer = energyWaveform + kSIS3302EnergySamples;
+  trailer[0] = energyMax;
+  trailer[1] = energyWaveform[0];
+  trailer[2] = 0x1 | ((fEventCount[kSIS3302] & 0xf) << 24); // trigger, fast trigger counter
+  trailer[3] = 0xdeadbeef;
+}
+
+void ORSyntheticStream::BuildKatrinV4FLT(UInt_t* record, bool withWaveform)
+{
+  ERecordType type = withWaveform ? kKatrinV4FLTWaveform : kKatrinV4FLTEnergy;
+  UInt_t card, channel;
+  RandomChannel(type, card, channel);
+  record[1] = ORSyntheticCrateCard(GetPlacement(type).fCrate, card) | (channel << 8);
+
+  // seconds and 20 MHz subseconds, see ORKatrinV4FLTEnergyDecoder
+  ULong64_t subSeconds = NextTime(type)/5;
+  record[2] = fStartTime + (UInt_t) (subSeconds/20000000);
+  record[3] = (UInt_t) (subSeconds % 20000000);
+  record[4] = 1 << channel;
+  record[5] = (fEventCount[type] & 0x3f) << 10; // page number
+  Double_t energy = RandomEnergy();
+  UInt_t rawEnergy = ORSyntheticSample(energy*0xfffff, 0, 0xfffff);
+  record[6] = ((fEventCount[type] & 0xfff) << 20) | rawEnergy;
+  if (!withWaveform) return;
+
+  record[7] = 0; // event flags
+  FillPulse(&fWaveform[0], kKatrinV4FLTSamples, 400, energy*3500, 1024, 10, 20000, 2);
+  UInt_t* waveform = record + 9;
+  for (size_t i=0; i<kKatrinV4FLTSamples/2; i++) {
+    waveform[i] = ORSyntheticSample(fWaveform[2*i], 0, 0xfff) |
+                  (ORSyntheticSample(fWaveform[2*i+1], 0, 0xfff) << 16);
+  }
+}
+
+void ORSyntheticStream::FillDGF4cBuffer()
+{
+  // buffer of 16-bit words in standard list mode, see ORDGF4cEventDecoder
+  UInt_t card, channel;
+  RandomChannel(kDGF4c, card, channel);
+  fDGF4cBuffer.clear();
+  ULong64_t bufferTime = fClock[kDGF4c];
+  fDGF4cBuffer.push_back(0); // length, filled in at the end
+  fDGF4cBuffer.push_back(card);
+  fDGF4cBuffer.push_back(0x100);
+  fDGF4cBuffer.push_back((bufferTime >> 32) & 0xffff);
+  fDGF4cBuffer.push_back((bufferTime >> 16) & 0xffff);
+  fDGF4cBuffer.push_back(bufferTime & 0xffff);
+
+  for (size_t iEvent=0; iEvent<kDGF4cEvents; iEvent++) {
+    ULong64_t time = NextTime(kDGF4c);
+    UShort_t hitPattern = 1 + RandomBelow(15);
+    fDGF4cBuffer.push_back(hitPattern);
+    fDGF4cBuffer.push_back((time >> 16) & 0xffff);
+    fDGF4cBuffer.push_back(time & 0xffff);
+    Double_t energy = RandomEnergy();
+    for (size_t iChannel=0; iChannel<4; iChannel++) {
+      if (!(hitPattern & (1 << iChannel))) continue;
+      Double_t share = 0.5 + 0.5*Uniform();
+      fDGF4cBuffer.push_back(9 + kDGF4cSamples);
+      fDGF4cBuffer.push_back((time + RandomBelow(8)) & 0xffff);
+      fDGF4cBuffer.push_back(ORSyntheticSample(energy*share*0x7fff, 0, 0xffff));
+      fDGF4cBuffer.push_back(RandomBelow(0x10000)); // XIA PSA
+      fDGF4cBuffer.push_back(0);                    // user PSA
+      fDGF4cBuffer.push_back(time & 0xffff);        // GSLT
+      fDGF4cBuffer.push_back((time >> 16) & 0xffff);
+      fDGF4cBuffer.push_back((time >> 32) & 0xffff);
+      fDGF4cBuffer.push_back((time >> 32) & 0xffff); // real time, high word
+      FillPulse(&fWaveform[0], kDGF4cSamples, 1000, energy*share*12000, 64, 4, 2000, 3);
+      for (size_t i=0; i<kDGF4cSamples; i++) {
+        fDGF4cBuffer.push_back(ORSyntheticSample(fWaveform[i], 0, 0x3fff));
+      }
+    }
+  }
+  fDGF4cBuffer[0] = fDGF4cBuffer.size();
+}
+
+void ORSyntheticStream::BuildDGF4c(UInt_t* record)
+{
+  const ORCardPlacement& placement = GetPlacement(kDGF4c);
+  record[1] = ORSyntheticCrateCard(placement.fCrate, fDGF4cBuffer[1]);
+  memcpy(record + 2, &fDGF4cBuffer[0], fDGF4cBuffer.size()*sizeof(UShort_t));
+}
+
+void ORSyntheticStream::BuildCaen5720(UInt_t* record)
+{
+  const size_t nWords = kCaen5720Samples/2;
+  const size_t eventSize = 4 + kCaen5720Channels*nWords;
+  record[1] = ORSyntheticCrateCard(GetPlacement(kCaen5720).fCrate, 0); // unit 0, not packed
+
+  // event header, see ORCaen5720Decoder
+  UInt_t* event = record + 2;
+  event[0] = 0xa0000000 | eventSize;
+  event[1] = (1 << kCaen5720Channels) - 1; // channel mask, pattern 0
+  event[2] = fEventCount[kCaen5720] & 0xffffff;
+  event[3] = (UInt_t) (NextTime(kCaen5720) & 0x7fffffff);
+
+  Double_t energy = RandomEnergy();
+  UInt_t* data = event + 4;
+  for (size_t iChannel=0; iChannel<kCaen5720Channels; iChannel++) {
+    Double_t share = 0.5 + 0.5*Uniform();
+    FillPulse(&fWaveform[0], kCaen5720Samples, 200, energy*share*3500, 100, 3, 1000, 2);
+    for (size_t i=0; i<nWords; i++) {
+      data[i] = ORSyntheticSample(fWaveform[2*i], 0, 0xfff) |
+                (ORSyntheticSample(fWaveform[2*i+1], 0, 0xfff) << 16);
+    }
+    data += nWords;
+  }
+}
+
+//------------------------------------------------------------------------------
+// random numbers and pulses
+
+UInt_t ORSyntheticStream::Random()
+{
+  fRandomState ^= fRandomState << 13;
+  fRandomState ^= fRandomState >> 17;
+  fRandomState ^= fRandomState << 5;
+  return fRandomState;
+}
+
+Double_t ORSyntheticStream::Gaus()
+{
+  if (fHaveGaus) {
+    fHaveGaus = false;
+    return fNextGaus;
+  }
+  Double_t u, v, s;
+  do {
+    u = 2*Uniform() - 1;
+    v = 2*Uniform() - 1;
+    s = u*u + v*v;
+  } while (s >= 1 || s == 0);
+  Double_t factor = sqrt(-2*log(s)/s);
+  fNextGaus = v*factor;
+  fHaveGaus = true;
+  return u*factor;
+}
+
+Double_t ORSyntheticStream::RandomEnergy()
+{
+  static const Double_t lines[] = { 0.12, 0.35, 0.6, 0.83 };
+  if (Uniform() < 0.3) {
+    Double_t energy = lines[RandomBelow(4)] + 0.004*Gaus();
+    return (energy < 0) ? 0 : (energy > 1) ? 1 : energy;
+  }
+  Double_t energy;
+  do energy = -0.25*log(Uniform());
+  while (energy >= 1);
+  return energy;
+}
+
+ULong64_t ORSyntheticStream::NextTime(ERecordType type)
+{
+  fClock[type] += 1 + (ULong64_t) (-kMeanTicksBetweenRecords*log(Uniform()));
+  return fClock[type];
+}
+
+void ORSyntheticStream::FillPulse(Double_t* waveform, size_t n, Double_t baseline,
+                                  Double_t amplitude, size_t start, Double_t riseTime,
+                                  Double_t decayTime, Double_t noise)
+{
+  const Double_t riseFactor = exp(-1./riseTime);
+  const Double_t decayFactor = exp(-1./decayTime);
+  Double_t rise = 1, decay = 1;
+  for (size_t i=0; i<n; i++) {
+    waveform[i] = baseline + noise*Gaus();
+    if (i < start) continue;
+    waveform[i] += amplitude*(1 - rise)*decay;
+    rise *= riseFactor;
+    decay *= decayFactor;
+  }
+}
@@ -0,0 +1,157 @@
+// ORSyntheticStream.hh
+
+#ifndef _ORSyntheticStream_hh_
+#define _ORSyntheticStream_hh_
+
+#include <string>
+#include <vector>
+#ifndef ROOT_Rtypes
+#include "Rtypes.h"
+#endif
+
+class ORDictionary;
+
+//! Generates ORCA data streams with synthetic records, for benchmarks.
+/*!
+    The stream starts with a header that holds what the decoders look up
+    (dataDescription with the data ids, ObjectInfo:Crates with a card
+    dictionary per card and ObjectInfo:DataChain with the Run Control), then
+    a run start record, the data records, a heartbeat every
+    SetHeartbeatInterval() data records and a run stop record.  The data
+    records take the enabled types in turn, so that each appears equally
+    often, with their layout as the decoders read it:
+
+    Shaper - ORShaperShaperDecoder, 2 words, 8 channels per card
+    Gretina4M - ORGretina4MDecoder, one event of 2018 signed samples
+    SIS3302 - ORSIS3302Decoder, 1024 samples, 510-word energy filter
+      waveform, no buffer wrap
+    KatrinV4FLTEnergy - ORKatrinV4FLTEnergyDecoder, 7 words
+    KatrinV4FLTWaveform - ORKatrinV4FLTWaveformDecoder, 2048 samples
+    DGF4c - ORDGF4cEventDecoder, standard list mode, 4 events per buffer
+      with 1 to 4 channels of 256 samples
+    Caen5720 - ORCaen5720Decoder, 4 channels of 512 unpacked samples
+
+    Energies are drawn from a falling continuum with a few lines on top,
+    waveforms are pulses with a rise and an exponential decay on a baseline
+    with gaussian noise, and timestamps increase with random gaps.  The
+    random numbers come from a generator of this class, so that a seed gives
+    the same stream with every version of ROOT and OrcaROOT.
+
+    With SetSwapped(), every record is written in the other byte order, as
+    ORCA running on a machine of the other endianness would have written
+    it: the first word of every record (and the second of the header) and
+    the words or 16-bit words that the decoder's Swap() swaps back.
+ */
+class ORSyntheticStream
+{
+  public:
+    enum ERecordType { kShaper, kGretina4M, kSIS3302, kKatrinV4FLTEnergy,
+                       kKatrinV4FLTWaveform, kDGF4c, kCaen5720, kNRecordTypes };
+    // flags of the run records, see ORRunDecoder
+    enum ERunFlags { kRunStop = 0x0, kRunStart = 0x1, kHeartbeat = 0x8 };
+
+    ORSyntheticStream(UInt_t seed = 4357);
+    virtual ~ORSyntheticStream() {}
+
+    //! Restarts the random numbers, the timestamps and the event counters.
+    virtual void SetSeed(UInt_t seed);
+    virtual void SetSwapped(bool swapped = true) { fSwapped = swapped; }
+    virtual bool IsSwapped() const { return fSwapped; }
+    virtual void SetRunNumber(UInt_t runNumber) { fRunNumber = runNumber; }
+    virtual UInt_t GetRunNumber() const { return fRunNumber; }
+    //! A heartbeat after every nRecords data records; 0 for none.
+    virtual void SetHeartbeatInterval(size_t nRecords) { fHeartbeatInterval = nRecords; }
+
+    //! Records of type are in the stream; all types are by default.
+    virtual void SetEnabled(ERecordType type, bool enabled = true) { fEnabled[type] = enabled; }
+    virtual bool IsEnabled(ERecordType type) const { return fEnabled[type]; }
+    virtual void EnableOnly(ERecordType type);
+
+    static const char* GetTypeName(ERecordType type);
+    //! Type of a name as returned by GetTypeName(), ignoring case.
+    static bool ParseTypeName(const std::string& name, ERecordType& type);
+    //! Object path in the dataDescription, as in the decoder.
+    static const char* GetDataObjectPath(ERecordType type);
+    static UInt_t GetDataId(ERecordType type) { return (UInt_t(type) + 2) << 18; }
+    static UInt_t GetRunDataId() { return 1 << 18; }
+
+    //! The header as an XML plist.
+    virtual std::string GetHeaderXML() const;
+
+    // The following append one record to stream, in the byte order of the
+    // stream.  AppendRecord() returns false if type is out of range.
+    virtual void AppendHeader(std::vector<UInt_t>& stream) const;
+    virtual void AppendRunRecord(std::vector<UInt_t>& stream, ERunFlags flags);
+    virtual bool AppendRecord(ERecordType type, std::vector<UInt_t>& stream);
+
+    //! Appends a whole run with nRecords data records.
+    virtual void Generate(std::vector<UInt_t>& stream, size_t nRecords);
+    //! Writes a whole run with nRecords data records to a file.
+    virtual bool WriteFile(const std::string& fileName, size_t nRecords);
+
+    //! Swaps record, in host byte order, to the other byte order.
+    /*!
+        The inverse of the swapping done by ORVReader and the decoder's
+        Swap().  type is ignored if the record is a header or run record
+        (recognized by its data id).
+     */
+    static void SwapRecord(ERecordType type, UInt_t* record);
+
+  protected:
+    // placement of the cards of a type in the crates
+    struct ORCardPlacement {
+      const char* fModelName;   // class name of the card in the header
+      UInt_t fCrate;
+      UInt_t fFirstCard;
+      UInt_t fNCards;
+      UInt_t fNChannels;
+    };
+    static const ORCardPlacement& GetPlacement(ERecordType type);
+
+    virtual ORDictionary* BuildCardDictionary(ERecordType type, UInt_t card) const;
+    virtual ORDictionary* BuildHeaderDictionary() const;
+    //! Appends data record iRecord of a run, and a heartbeat if one is due.
+    virtual void AppendNextRecord(std::vector<UInt_t>& stream, size_t iRecord);
+
+    virtual void BuildShaper(UInt_t* record);
+    virtual void BuildGretina4M(UInt_t* record);
+    virtual void BuildSIS3302(UInt_t* record);
+    virtual void BuildKatrinV4FLT(UInt_t* record, bool withWaveform);
+    virtual void FillDGF4cBuffer();
+    virtual void BuildDGF4c(UInt_t* record);
+    virtual void BuildCaen5720(UInt_t* record);
+    virtual size_t GetRecordLength(ERecordType type) const;
+    //! Picks a random card and channel of type.
+    virtual void RandomChannel(ERecordType type, UInt_t& card, UInt_t& channel);
+
+    // random numbers: xorshift, independent of ROOT
+    virtual UInt_t Random();
+    virtual Double_t Uniform() { return (Random() + 0.5)/4294967296.; }
+    virtual UInt_t RandomBelow(UInt_t n) { return UInt_t(Uniform()*n); }
+    virtual Double_t Gaus();
+    //! Energy as a fraction of full scale, from a continuum with lines.
+    virtual Double_t RandomEnergy();
+    //! Advances the clock of type by a random gap and returns it.
+    virtual ULong64_t NextTime(ERecordType type);
+    //! Pulse of height amplitude on baseline, starting at sample start.
+    virtual void FillPulse(Double_t* waveform, size_t n, Double_t baseline,
+                           Double_t amplitude, size_t start, Double_t riseTime,
+                           Double_t decayTime, Double_t noise);
+
+  protected:
+    bool fSwapped;
+    bool fEnabled[kNRecordTypes];
+    UInt_t fRunNumber;
+    UInt_t fStartTime;
+    size_t fHeartbeatInterval;
+    UInt_t fRandomState;
+    bool fHaveGaus;
+    Double_t fNextGaus;
+    ULong64_t fClock[kNRecordTypes];
+    UInt_t fEventCount[kNRecordTypes];
+    UInt_t fNextType;                   // type of the next data record
+    std::vector<UShort_t> fDGF4cBuffer; // the next DGF4c buffer
+    std::vector<Double_t> fWaveform;
+};
+
+#endif
@@ -0,0 +1,509 @@
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "TString.h"
+#include "TSystem.h"
+#include "ORBufferReader.hh"
+#include "ORCaen5720Decoder.hh"
+#include "ORCaen5720TreeWriter.hh"
+#include "ORDataProcManager.hh"
+#include "ORDGF4cEventDecoder.hh"
+#include "ORDGF4cWaveformTreeWriter.hh"
+#include "ORFileWriter.hh"
+#include "ORGretina4MDecoder.hh"
+#include "ORHardwareDictionary.hh"
+#include "ORHeader.hh"
+#include "ORKatrinV4FLTEnergyDecoder.hh"
+#include "ORKatrinV4FLTEnergyTreeWriter.hh"
+#include "ORKatrinV4FLTWaveformDecoder.hh"
+#include "ORKatrinV4FLTWaveformTreeWriter.hh"
+#include "ORLogger.hh"
+#include "ORProcessorStats.hh"
+#include "ORShaperShaperDecoder.hh"
+#include "ORShaperShaperTreeWriter.hh"
+#include "ORSIS3302Decoder.hh"
+#include "ORSyntheticStream.hh"
+#include "ORUtils.hh"
+#include "ORWaveformReductionTreeWriter.hh"
+
+using namespace std;
+
+static const char Usage[] =
+"\n"
+"\n"
+"Usage: orbenchmark [options]\n"
+"\n"
+"Measures the records/s and MB/s of OrcaROOT on synthetic ORCA streams (see\n"
+"ORSyntheticStream.hh), in both byte orders, in three stages:\n"
+"  decode : each decoder alone on records in memory, including the swapping\n"
+"    of the other byte order, the energies, times and channels of all\n"
+"    events and the conversion of their waveforms.\n"
+"  writer : ORDataProcManager reading the stream from memory into the tree\n"
+"    writer of each record type, with the ROOT file in the scratch directory.\n"
+"  chain : the same with all record types in one stream and all writers.\n"
+"Each measurement is the best of a number of repetitions.\n"
+"\n"
+"Available options:\n"
+"  --help : print this message and exit\n"
+"  --verbosity [verbosity] : set the severity/verbosity for the logger\n"
+"    (default error). Choices are: debug, trace, routine, warning, error,\n"
+"    and fatal.\n"
+"  --records [num] : number of data records per measurement (default 20000).\n"
+"  --types [type,type,...] : record types to measure (default all). Choices\n"
+"    are: Shaper, Gretina4M, SIS3302, KatrinV4FLTEnergy,\n"
+"    KatrinV4FLTWaveform, DGF4c, and Caen5720.\n"
+"  --stages [stage,stage,...] : stages to run (default decode,writer,chain).\n"
+"  --byte-order [order] : native, swapped, or both (default both).\n"
+"  --repeat [num] : repetitions of each measurement (default 3).\n"
+"  --seed [num] : seed of the random numbers (default 4357).\n"
+"  --scratch [dir] : directory for the ROOT files of the writer and chain\n"
+"    stages, which are removed afterwards (default the temporary directory).\n"
+"  --output [file] : also write the results to [file], tab separated.\n"
+"  --compare [file] : compare with results written by --output before, e.g.\n"
+"    by the previous version, and print the speedup.\n"
+"\n"
+"Example usage:\n"
+"orbenchmark --stages decode --output before.tsv\n"
+"  Measure the decoders and keep the results.\n"
+"orbenchmark --stages decode --compare before.tsv\n"
+"  Measure them again after a change and compare.\n"
+"\n"
+"\n";
+
+struct ORBenchmarkResult {
+  string fStage;
+  string fType;
+  string fByteOrder;
+  size_t fNRecords;
+  size_t fNBytes;
+  Double_t fSeconds;
+  string Key() const { return fStage + "\t" + fType + "\t" + fByteOrder; }
+};
+
+static vector<string> SplitList(const string& list)
+{
+  vector<string> items;
+  size_t start = 0;
+  while (start <= list.size()) {
+    size_t end = list.find(',', start);
+    if (end == string::npos) end = list.size();
+    if (end > start) items.push_back(list.substr(start, end-start));
+    start = end + 1;
+  }
+  return items;
+}
+
+static ORVDataDecoder* NewDecoder(ORSyntheticStream::ERecordType type)
+{
+  switch (type) {
+    case ORSyntheticStream::kShaper: return new ORShaperShaperDecoder;
+    case ORSyntheticStream::kGretina4M: return new ORGretina4MDecoder;
+    case ORSyntheticStream::kSIS3302: return new ORSIS3302Decoder;
+    case ORSyntheticStream::kKatrinV4FLTEnergy: return new ORKatrinV4FLTEnergyDecoder;
+    case ORSyntheticStream::kKatrinV4FLTWaveform: return new ORKatrinV4FLTWaveformDecoder;
+    case ORSyntheticStream::kDGF4c: return new ORDGF4cEventDecoder;
+    case ORSyntheticStream::kCaen5720: return new ORCaen5720Decoder;
+    default: return NULL;
+  }
+}
+
+static ORDataProcessor* NewTreeWriter(ORSyntheticStream::ERecordType type)
+{
+  ORWaveformReductionTreeWriter* reductionWriter = NULL;
+  switch (type) {
+    case ORSyntheticStream::kShaper: return new ORShaperShaperTreeWriter;
+    case ORSyntheticStream::kGretina4M:
+      reductionWriter = new ORWaveformReductionTreeWriter(new ORGretina4MDecoder);
+      break;
+    case ORSyntheticStream::kSIS3302:
+      reductionWriter = new ORWaveformReductionTreeWriter(new ORSIS3302Decoder);
+      break;
+    case ORSyntheticStream::kKatrinV4FLTEnergy: return new ORKatrinV4FLTEnergyTreeWriter;
+    case ORSyntheticStream::kKatrinV4FLTWaveform: return new ORKatrinV4FLTWaveformTreeWriter;
+    case ORSyntheticStream::kDGF4c: return new ORDGF4cWaveformTreeWriter;
+    case ORSyntheticStream::kCaen5720: return new ORCaen5720TreeWriter;
+    default: return NULL;
+  }
+  // store every waveform, as the other writers do
+  reductionWriter->SetPrescale(1);
+  return reductionWriter;
+}
+
+// Decodes everything of a record that a writer would; returns a sum of
+// the values so that none of the work can be optimized away.
+class ORDecodeBenchmark
+{
+  public:
+    ORDecodeBenchmark(ORSyntheticStream::ERecordType type) :
+      fType(type), fDecoder(NewDecoder(type)), fWaveform(0x10000),
+      fCaenTraces(ORCaen5720Decoder::kMaxChannels*kMaxCaenSamples)
+    {
+      fDigitizer = dynamic_cast<ORVDigitizerDecoder*>(fDecoder);
+      fTreeDecoder = dynamic_cast<ORVBasicTreeDecoder*>(fDecoder);
+      fCaen = dynamic_cast<ORCaen5720Decoder*>(fDecoder);
+      for (size_t i=0; i<ORCaen5720Decoder::kMaxChannels; i++) {
+        fCaenTracePointers[i] = &fCaenTraces[i*kMaxCaenSamples];
+      }
+    }
+    virtual ~ORDecodeBenchmark() { delete fDecoder; }
+
+    virtual void LoadHeader(const string& xml)
+    {
+      if (!fHeader.LoadHeaderString(xml.c_str(), xml.size()) ||
+          !fHardwareDict.LoadHardwareDictFromDict(fHeader.GetDictionary())) {
+        ORLog(kWarning) << "LoadHeader(): couldn't load the header" << endl;
+        return;
+      }
+      fDecoder->SetDecoderDictionary(
+        fHardwareDict.GetDecoderDictionary(fDecoder->GetDictionaryObjectPath()));
+    }
+
+    virtual ORVDataDecoder* GetDecoder() { return fDecoder; }
+
+    virtual Double_t Decode(UInt_t* record)
+    {
+      Double_t sum = 0;
+      if (fDigitizer != NULL) {
+        if (!fDigitizer->SetDataRecord(record)) return 0;
+        for (size_t i=0; i<fDigitizer->GetNumberOfEvents(); i++) {
+          sum += fDigitizer->GetEventEnergy(i) + fDigitizer->GetEventChannel(i);
+          sum += fDigitizer->GetEventTime(i);
+          size_t length = fDigitizer->GetWaveformView(i).CopyTo(&fWaveform[0], fWaveform.size());
+          if (length > 0) sum += fWaveform[length-1];
+        }
+      } else if (fTreeDecoder != NULL) {
+        for (size_t iRow=0; iRow<fTreeDecoder->GetNRows(record); iRow++) {
+          for (size_t iPar=0; iPar<fTreeDecoder->GetNPars(); iPar++) {
+            sum += fTreeDecoder->GetPar(record, iPar, iRow);
+          }
+        }
+      } else if (fCaen != NULL) {
+        sum += fCaen->EventCount(record) + fCaen->Clock(record);
+        UInt_t length = fCaen->CopyChannelTraces(record, fCaenTracePointers, kMaxCaenSamples);
+        if (length > 0) sum += fCaenTracePointers[0][length-1];
+      }
+      return sum;
+    }
+
+  protected:
+    enum { kMaxCaenSamples = 10000 };
+    ORSyntheticStream::ERecordType fType;
+    ORVDataDecoder* fDecoder;
+    ORVDigitizerDecoder* fDigitizer;
+    ORVBasicTreeDecoder* fTreeDecoder;
+    ORCaen5720Decoder* fCaen;
+    ORHeader fHeader;
+    ORHardwareDictionary fHardwareDict;
+    vector<Float_t> fWaveform;
+    vector<UInt_t> fCaenTraces;
+    UInt_t* fCaenTracePointers[ORCaen5720Decoder::kMaxChannels];
+};
+
+static Double_t gChecksum = 0;
+
+static ORBenchmarkResult BenchmarkDecode(ORSyntheticStream::ERecordType type, bool swapped,
+                                         size_t nRecords, size_t nRepeat, UInt_t seed)
+{
+  ORSyntheticStream generator(seed);
+  generator.EnableOnly(type);
+  generator.SetSwapped(swapped);
+  generator.SetHeartbeatInterval(0);
+  vector<UInt_t> stream;
+  generator.Generate(stream, nRecords);
+
+  // offsets of the data records, skipping the header and run records
+  ORDecodeBenchmark benchmark(type);
+  benchmark.LoadHeader(generator.GetHeaderXML());
+  vector<size_t> offsets;
+  ORBenchmarkResult result;
+  result.fStage = "decode";
+  result.fType = ORSyntheticStream::GetTypeName(type);
+  result.fByteOrder = swapped ? "swapped" : "native";
+  result.fNRecords = 0;
+  result.fNBytes = 0;
+  for (size_t offset=0; offset<stream.size(); ) {
+    UInt_t firstWord = stream[offset];
+    if (swapped) ORUtils::Swap(firstWord);
+    size_t length = firstWord & 0x3ffff;
+    if ((firstWord & 0xfffc0000) == ORSyntheticStream::GetDataId(type)) {
+      offsets.push_back(offset);
+      result.fNRecords++;
+      result.fNBytes += length*sizeof(UInt_t);
+    }
+    offset += (length > 0) ? length : 1;
+  }
+
+  // swapping is done in place, as the reader and ORDataProcessor do, so
+  // each repetition starts from a copy
+  ORVDataDecoder* decoder = benchmark.GetDecoder();
+  vector<UInt_t> records;
+  result.fSeconds = -1;
+  for (size_t iRepeat=0; iRepeat<nRepeat; iRepeat++) {
+    records = stream;
+    Double_t start = ORProcessorStats::Now();
+    for (size_t i=0; i<offsets.size(); i++) {
+      UInt_t* record = &records[offsets[i]];
+      if (swapped) {
+        ORUtils::Swap(record[0]);
+        decoder->Swap(record);
+      }
+      gChecksum += benchmark.Decode(record);
+    }
+    Double_t seconds = ORProcessorStats::Now() - start;
+    if (result.fSeconds < 0 || seconds < result.fSeconds) result.fSeconds = seconds;
+  }
+  return result;
+}
+
+static ORBenchmarkResult BenchmarkProcessing(const string& stage,
+                                             const vector<ORSyntheticStream::ERecordType>& types,
+                                             bool swapped, size_t nRecords, size_t nRepeat,
+                                             UInt_t seed, const string& scratchDir)
+{
+  ORSyntheticStream generator(seed);
+  for (size_t i=0; i<ORSyntheticStream::kNRecordTypes; i++) {
+    generator.SetEnabled((ORSyntheticStream::ERecordType) i, false);
+  }
+  for (size_t i=0; i<types.size(); i++) generator.SetEnabled(types[i]);
+  generator.SetSwapped(swapped);
+  vector<UInt_t> stream;
+  generator.Generate(stream, nRecords);
+
+  ORBenchmarkResult result;
+  result.fStage = stage;
+  result.fType = (types.size() == 1) ? ORSyntheticStream::GetTypeName(types[0]) : "all";
+  result.fByteOrder = swapped ? "swapped" : "native";
+  result.fNRecords = nRecords;
+  result.fNBytes = stream.size()*sizeof(UInt_t);
+  result.fSeconds = -1;
+
+  string label = scratchDir + "/orbenchmark_" + stage;
+  for (size_t iRepeat=0; iRepeat<nRepeat; iRepeat++) {
+    ORBufferReader reader((const char*) &stream[0], stream.size()*sizeof(UInt_t));
+    ORDataProcManager dataProcManager(&reader);
+    ORFileWriter fileWriter(label);
+    dataProcManager.AddProcessor(&fileWriter);
+    vector<ORDataProcessor*> writers;
+    for (size_t i=0; i<types.size(); i++) {
+      writers.push_back(NewTreeWriter(types[i]));
+      dataProcManager.AddProcessor(writers.back());
+    }
+
+    Double_t start = ORProcessorStats::Now();
+    dataProcManager.ProcessDataStream();
+    Double_t seconds = ORProcessorStats::Now() - start;
+    if (result.fSeconds < 0 || seconds < result.fSeconds) result.fSeconds = seconds;
+
+    for (size_t i=0; i<writers.size(); i++) delete writers[i];
+    gSystem->Unlink(::Form("%s_run%u.root", label.c_str(), generator.GetRunNumber()));
+  }
+  return result;
+}
+
+static void PrintResult(const ORBenchmarkResult& result, const map<string, Double_t>& before)
+{
+  Double_t seconds = (result.fSeconds > 0) ? result.fSeconds : 1e-9;
+  cout << ::Form("%-7s %-20s %-8s %10lu %12.0f %10.2f", result.fStage.c_str(),
+                 result.fType.c_str(), result.fByteOrder.c_str(), (unsigned long) result.fNRecords,
+                 result.fNRecords/seconds, result.fNBytes/seconds/1024/1024);
+  // seconds per record of the earlier results
+  map<string, Double_t>::const_iterator iter = before.find(result.Key());
+  if (iter != before.end() && result.fNRecords > 0) {
+    cout << ::Form(" %8.2fx", iter->second/(seconds/result.fNRecords));
+  }
+  cout << endl;
+}
+
+static bool ReadResults(const string& fileName, map<string, Double_t>& secondsPerRecord)
+{
+  ifstream file(fileName.c_str());
+  if (!file.good()) {
+    ORLog(kError) << "Couldn't open " << fileName << endl;
+    return false;
+  }
+  string line;
+  while (getline(file, line)) {
+    if (line.empty() || line[0] == '#') continue;
+    istringstream fields(line);
+    ORBenchmarkResult result;
+    if (!(fields >> result.fStage >> result.fType >> result.fByteOrder
+                 >> result.fNRecords >> result.fNBytes >> result.fSeconds)) continue;
+    if (result.fNRecords == 0) continue;
+    secondsPerRecord[result.Key()] = result.fSeconds/result.fNRecords;
+  }
+  return true;
+}
+
+int main(int argc, char** argv)
+{
+  static struct option longOptions[] = {
+    {"help", no_argument, 0, 'h'},
+    {"verbosity", required_argument, 0, 'v'},
+    {"records", required_argument, 0, 'n'},
+    {"types", required_argument, 0, 't'},
+    {"stages", required_argument, 0, 'g'},
+    {"byte-order", required_argument, 0, 'b'},
+    {"repeat", required_argument, 0, 'r'},
+    {"seed", required_argument, 0, 'e'},
+    {"scratch", required_argument, 0, 's'},
+    {"output", required_argument, 0, 'o'},
+    {"compare", required_argument, 0, 'c'},
+    {0, 0, 0, 0}
+  };
+
+  // the results are the output; keep the log for problems
+  ORLogger::SetSeverity(ORLogger::kError);
+
+  size_t nRecords = 20000;
+  string typeList = "";
+  string stageList = "decode,writer,chain";
+  string byteOrder = "both";
+  size_t nRepeat = 3;
+  UInt_t seed = 4357;
+  string scratchDir = "";
+  string outputFile = "";
+  string compareFile = "";
+
+  while(1) {
+    char optId = getopt_long(argc, argv, "", longOptions, NULL);
+    if(optId == -1) break;
+    switch(optId) {
+      case('h'): // help
+        cout << Usage;
+        return 0;
+      case('v'): // verbosity
+        if(strcmp(optarg, "debug") == 0) ORLogger::SetSeverity(ORLogger::kDebug);
+        else if(strcmp(optarg, "trace") == 0) ORLogger::SetSeverity(ORLogger::kTrace);
+        else if(strcmp(optarg, "routine") == 0) ORLogger::SetSeverity(ORLogger::kRoutine);
+        else if(strcmp(optarg, "warning") == 0) ORLogger::SetSeverity(ORLogger::kWarning);
+        else if(strcmp(optarg, "error") == 0) ORLogger::SetSeverity(ORLogger::kError);
+        else if(strcmp(optarg, "fatal") == 0) ORLogger::SetSeverity(ORLogger::kFatal);
+        else {
+          ORLog(kWarning) << "Unknown verbosity setting " << optarg
+                          << "; using kError" << endl;
+          ORLogger::SetSeverity(ORLogger::kError);
+        }
+        break;
+      case('n'):
+        nRecords = abs(atol(optarg));
+        break;
+      case('t'):
+        typeList = optarg;
+        break;
+      case('g'):
+        stageList = optarg;
+        break;
+      case('b'):
+        byteOrder = optarg;
+        break;
+      case('r'):
+        nRepeat = abs(atoi(optarg));
+        break;
+      case('e'):
+        seed = strtoul(optarg, NULL, 0);
+        break;
+      case('s'):
+        scratchDir = optarg;
+        break;
+      case('o'):
+        outputFile = optarg;
+        break;
+      case('c'):
+        compareFile = optarg;
+        break;
+      default: // unrecognized option
+        ORLog(kError) << Usage;
+        return 1;
+    }
+  }
+
+  vector<ORSyntheticStream::ERecordType> types;
+  if (typeList == "") {
+    for (size_t i=0; i<ORSyntheticStream::kNRecordTypes; i++) {
+      types.push_back((ORSyntheticStream::ERecordType) i);
+    }
+  } else {
+    vector<string> names = SplitList(typeList);
+    for (size_t i=0; i<names.size(); i++) {
+      ORSyntheticStream::ERecordType type;
+      if (!ORSyntheticStream::ParseTypeName(names[i], type)) {
+        ORLog(kError) << "Unknown record type " << names[i] << endl << Usage;
+        return 1;
+      }
+      types.push_back(type);
+    }
+  }
+
+  bool runDecode = false, runWriter = false, runChain = false;
+  vector<string> stages = SplitList(stageList);
+  for (size_t i=0; i<stages.size(); i++) {
+    if (stages[i] == "decode") runDecode = true;
+    else if (stages[i] == "writer") runWriter = true;
+    else if (stages[i] == "chain") runChain = true;
+    else {
+      ORLog(kError) << "Unknown stage " << stages[i] << endl << Usage;
+      return 1;
+    }
+  }
+
+  vector<bool> byteOrders;
+  if (byteOrder == "native" || byteOrder == "both") byteOrders.push_back(false);
+  if (byteOrder == "swapped" || byteOrder == "both") byteOrders.push_back(true);
+  if (byteOrders.empty()) {
+    ORLog(kError) << "Unknown byte order " << byteOrder << endl << Usage;
+    return 1;
+  }
+
+  if (nRepeat == 0) nRepeat = 1;
+  if (scratchDir == "") scratchDir = gSystem->TempDirectory();
+
+  map<string, Double_t> before;
+  if (compareFile != "" && !ReadResults(compareFile, before)) return 1;
+
+  cout << ::Form("%-7s %-20s %-8s %10s %12s %10s", "stage", "type", "order",
+                 "records", "records/s", "MB/s");
+  if (!before.empty()) cout << ::Form(" %9s", "speedup");
+  cout << endl;
+
+  vector<ORBenchmarkResult> results;
+  for (size_t iOrder=0; iOrder<byteOrders.size(); iOrder++) {
+    bool swapped = byteOrders[iOrder];
+    for (size_t i=0; runDecode && i<types.size(); i++) {
+      results.push_back(BenchmarkDecode(types[i], swapped, nRecords, nRepeat, seed));
+      PrintResult(results.back(), before);
+    }
+    for (size_t i=0; runWriter && i<types.size(); i++) {
+      vector<ORSyntheticStream::ERecordType> oneType(1, types[i]);
+      results.push_back(BenchmarkProcessing("writer", oneType, swapped, nRecords, nRepeat,
+                                            seed, scratchDir));
+      PrintResult(results.back(), before);
+    }
+    if (runChain) {
+      results.push_back(BenchmarkProcessing("chain", types, swapped, nRecords, nRepeat,
+                                            seed, scratchDir));
+      PrintResult(results.back(), before);
+    }
+  }
+  ORLog(kDebug) << "checksum " << gChecksum << endl;
+
+  if (outputFile != "") {
+    ofstream file(outputFile.c_str());
+    if (!file.good()) {
+      ORLog(kError) << "Couldn't open " << outputFile << endl;
+      return 1;
+    }
+    file << "# stage\ttype\tbyteOrder\trecords\tbytes\tseconds" << endl;
+    for (size_t i=0; i<results.size(); i++) {
+      file << results[i].Key() << "\t" << results[i].fNRecords << "\t"
+           << results[i].fNBytes << "\t" << results[i].fSeconds << endl;
+    }
+  }
+
+  return 0;
+}
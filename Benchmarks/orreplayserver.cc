@@ -0,0 +1,177 @@
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+#include <string>
+
+#include "TSocket.h"
+#include "ORHandlerThread.hh"
+#include "ORLogger.hh"
+#include "ORServer.hh"
+#include "ORStreamReplayer.hh"
+
+using namespace std;
+
+static const char Usage[] =
+"\n"
+"\n"
+"Usage: orreplayserver [options] [input file]\n"
+"\n"
+"Stands in for ORCA: listens on a port and sends a raw ORCA data file to\n"
+"the client that connects, header first, at the rate it was taken or a\n"
+"multiple of it (see ORStreamReplayer.hh). Connect to it with orcaroot\n"
+"host:port to load-test the online processing.\n"
+"\n"
+"Available options:\n"
+"  --help : print this message and exit\n"
+"  --verbosity [verbosity] : set the severity/verbosity for the logger.\n"
+"    Choices are: debug, trace, routine, warning, error, and fatal.\n"
+"  --port [num] : port to listen on (default 44666).\n"
+"  --speed [x] : send at x times the rate of the run (default 1).\n"
+"  --max : send as fast as the client takes the data.\n"
+"  --burst [on:off] : send only during the first [on] seconds of every\n"
+"    [on]+[off] seconds, e.g. 2:8 (default: no bursts).\n"
+"  --report [sec] : log sent and acknowledged bytes every [sec] seconds\n"
+"    (default 5, 0 for only at the end).\n"
+"  --segment [MB] : data held to spread between two run records, at\n"
+"    least 1 (default 256).\n"
+"  --loop : after sending the file, wait for the next client.\n"
+"\n"
+"Example usage:\n"
+"orreplayserver --speed 10 run194ecpu\n"
+"  Send run194ecpu at ten times the rate it was taken to the first client\n"
+"  on port 44666, e.g. orcaroot localhost:44666.\n"
+"orreplayserver --max --burst 1:4 --loop synth.dat\n"
+"  Send synth.dat at full speed for one second out of every five, to each\n"
+"  client in turn.\n"
+"\n"
+"\n";
+
+int main(int argc, char** argv)
+{
+  static struct option longOptions[] = {
+    {"help", no_argument, 0, 'h'},
+    {"verbosity", required_argument, 0, 'v'},
+    {"port", required_argument, 0, 'p'},
+    {"speed", required_argument, 0, 's'},
+    {"max", no_argument, 0, 'm'},
+    {"burst", required_argument, 0, 'b'},
+    {"report", required_argument, 0, 'r'},
+    {"segment", required_argument, 0, 'g'},
+    {"loop", no_argument, 0, 'l'},
+    {0, 0, 0, 0}
+  };
+
+  int port = 44666;
+  double speed = 1;
+  double burstOn = 0;
+  double burstOff = 0;
+  double reportInterval = 5;
+  size_t segmentMB = 256;
+  bool loop = false;
+
+  while(1) {
+    char optId = getopt_long(argc, argv, "", longOptions, NULL);
+    if(optId == -1) break;
+    switch(optId) {
+      case('h'): // help
+        cout << Usage;
+        return 0;
+      case('v'): // verbosity
+        if(strcmp(optarg, "debug") == 0) ORLogger::SetSeverity(ORLogger::kDebug);
+        else if(strcmp(optarg, "trace") == 0) ORLogger::SetSeverity(ORLogger::kTrace);
+        else if(strcmp(optarg, "routine") == 0) ORLogger::SetSeverity(ORLogger::kRoutine);
+        else if(strcmp(optarg, "warning") == 0) ORLogger::SetSeverity(ORLogger::kWarning);
+        else if(strcmp(optarg, "error") == 0) ORLogger::SetSeverity(ORLogger::kError);
+        else if(strcmp(optarg, "fatal") == 0) ORLogger::SetSeverity(ORLogger::kFatal);
+        else {
+          ORLog(kWarning) << "Unknown verbosity setting " << optarg
+                          << "; using kRoutine" << endl;
+          ORLogger::SetSeverity(ORLogger::kRoutine);
+        }
+        break;
+      case('p'):
+        port = abs(atoi(optarg));
+        break;
+      case('s'):
+        speed = atof(optarg);
+        if (speed <= 0) {
+          ORLog(kError) << "The speed must be positive; use --max for full speed" << endl;
+          return 1;
+        }
+        break;
+      case('m'):
+        speed = 0;
+        break;
+      case('b'): {
+        const char* colon = strchr(optarg, ':');
+        if (colon == NULL) {
+          ORLog(kError) << "--burst needs on:off, e.g. 2:8" << endl << Usage;
+          return 1;
+        }
+        burstOn = atof(optarg);
+        burstOff = atof(colon + 1);
+        break;
+      }
+      case('r'):
+        reportInterval = atof(optarg);
+        break;
+      case('g'):
+        if (atol(optarg) < 1) {
+          ORLog(kError) << "The segment must be at least 1 MB" << endl;
+          return 1;
+        }
+        segmentMB = atol(optarg);
+        break;
+      case('l'):
+        loop = true;
+        break;
+      default: // unrecognized option
+        ORLog(kError) << Usage;
+        return 1;
+    }
+  }
+
+  if (argc <= optind) {
+    ORLog(kError) << "You must supply an input file name" << endl << Usage << endl;
+    return 1;
+  }
+
+  ORStreamReplayer replayer;
+  if (!replayer.OpenFile(argv[optind])) return 1;
+  replayer.SetSpeed(speed);
+  replayer.SetBurst(burstOn, burstOff);
+  replayer.SetReportInterval(reportInterval);
+  replayer.SetMaxSegmentBytes(segmentMB*1024*1024);
+
+  ORHandlerThread* handlerThread = new ORHandlerThread();
+  handlerThread->StartThread();
+
+  ORServer* server = new ORServer(port);
+  if (!server->IsValid()) {
+    ORLog(kError) << "Error listening on port " << port
+      << endl << "Error code: " << server->GetErrorCode() << endl;
+    return 1;
+  }
+
+  int status = 0;
+  do {
+    ORLog(kRoutine) << "Waiting for connection on port " << port << "..." << endl;
+    TSocket* sock = server->Accept();
+    if (sock == (TSocket*) 0 || sock == (TSocket*) -1 ) {
+      // canceled, or the server got closed
+      break;
+    }
+    if (!sock->IsValid()) {
+      delete sock;
+      continue;
+    }
+    ORLog(kRoutine) << "Connection accepted, replaying " << argv[optind] << endl;
+    if (!replayer.Replay(sock)) status = 1;
+    sock->Close();
+    delete sock;
+  } while (loop && !replayer.TestCancel());
+
+  delete server;
+  delete handlerThread;
+  return status;
+}
@@ -0,0 +1,142 @@
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+#include <string>
+
+#include "ORLogger.hh"
+#include "ORSyntheticStream.hh"
+
+using namespace std;
+
+static const char Usage[] =
+"\n"
+"\n"
+"Usage: orsynthgen [options] [output file]\n"
+"\n"
+"Writes an ORCA data file with a run of synthetic records for the decoders\n"
+"listed below, with a header that describes them, for tests and benchmarks\n"
+"(see ORSyntheticStream.hh). The same options give the same file.\n"
+"\n"
+"Available options:\n"
+"  --help : print this message and exit\n"
+"  --verbosity [verbosity] : set the severity/verbosity for the logger.\n"
+"    Choices are: debug, trace, routine, warning, error, and fatal.\n"
+"  --records [num] : number of data records (default 100000).\n"
+"  --types [type,type,...] : record types to write (default all). Choices\n"
+"    are: Shaper, Gretina4M, SIS3302, KatrinV4FLTEnergy,\n"
+"    KatrinV4FLTWaveform, DGF4c, and Caen5720.\n"
+"  --swapped : write the records in the other byte order.\n"
+"  --seed [num] : seed of the random numbers (default 4357).\n"
+"  --run [num] : run number (default 1).\n"
+"  --heartbeat [num] : a heartbeat record every [num] data records\n"
+"    (default 10000, 0 for none).\n"
+"\n"
+"Example usage:\n"
+"orsynthgen --records 1000000 --types Gretina4M,SIS3302 --swapped synth.dat\n"
+"  Write a million Gretina4M and SIS3302 records, byte-swapped, to synth.dat.\n"
+"\n"
+"\n";
+
+static bool ParseTypes(const string& list, ORSyntheticStream& stream)
+{
+  for (size_t i=0; i<ORSyntheticStream::kNRecordTypes; i++) {
+    stream.SetEnabled((ORSyntheticStream::ERecordType) i, false);
+  }
+  size_t start = 0;
+  while (start <= list.size()) {
+    size_t end = list.find(',', start);
+    if (end == string::npos) end = list.size();
+    ORSyntheticStream::ERecordType type;
+    if (!ORSyntheticStream::ParseTypeName(list.substr(start, end-start), type)) {
+      ORLog(kError) << "Unknown record type " << list.substr(start, end-start) << endl;
+      return false;
+    }
+    stream.SetEnabled(type);
+    start = end + 1;
+  }
+  return true;
+}
+
+int main(int argc, char** argv)
+{
+  static struct option longOptions[] = {
+    {"help", no_argument, 0, 'h'},
+    {"verbosity", required_argument, 0, 'v'},
+    {"records", required_argument, 0, 'n'},
+    {"types", required_argument, 0, 't'},
+    {"swapped", no_argument, 0, 's'},
+    {"seed", required_argument, 0, 'e'},
+    {"run", required_argument, 0, 'r'},
+    {"heartbeat", required_argument, 0, 'b'},
+    {0, 0, 0, 0}
+  };
+
+  size_t nRecords = 100000;
+  string types = "";
+  bool swapped = false;
+  UInt_t seed = 4357;
+  UInt_t runNumber = 1;
+  size_t heartbeatInterval = 10000;
+
+  while(1) {
+    char optId = getopt_long(argc, argv, "", longOptions, NULL);
+    if(optId == -1) break;
+    switch(optId) {
+      case('h'): // help
+        cout << Usage;
+        return 0;
+      case('v'): // verbosity
+        if(strcmp(optarg, "debug") == 0) ORLogger::SetSeverity(ORLogger::kDebug);
+        else if(strcmp(optarg, "trace") == 0) ORLogger::SetSeverity(ORLogger::kTrace);
+        else if(strcmp(optarg, "routine") == 0) ORLogger::SetSeverity(ORLogger::kRoutine);
+        else if(strcmp(optarg, "warning") == 0) ORLogger::SetSeverity(ORLogger::kWarning);
+        else if(strcmp(optarg, "error") == 0) ORLogger::SetSeverity(ORLogger::kError);
+        else if(strcmp(optarg, "fatal") == 0) ORLogger::SetSeverity(ORLogger::kFatal);
+        else {
+          ORLog(kWarning) << "Unknown verbosity setting " << optarg 
+                          << "; using kRoutine" << endl;
+          ORLogger::SetSeverity(ORLogger::kRoutine);
+        }
+        break;
+      case('n'):
+        nRecords = abs(atol(optarg));
+        break;
+      case('t'):
+        types = optarg;
+        break;
+      case('s'):
+        swapped = true;
+        break;
+      case('e'):
+        seed = strtoul(optarg, NULL, 0);
+        break;
+      case('r'):
+        runNumber = abs(atoi(optarg));
+        break;
+      case('b'):
+        heartbeatInterval = abs(atol(optarg));
+        break;
+      default: // unrecognized option
+        ORLog(kError) << Usage;
+        return 1;
+    }
+  }
+
+  if (argc <= optind) {
+    ORLog(kError) << "You must supply an output file name" << endl << Usage << endl;
+    return 1;
+  }
+
+  ORSyntheticStream stream(seed);
+  stream.SetSwapped(swapped);
+  stream.SetRunNumber(runNumber);
+  stream.SetHeartbeatInterval(heartbeatInterval);
+  if (types != "" && !ParseTypes(types, stream)) {
+    ORLog(kError) << Usage;
+    return 1;
+  }
+
+  ORLog(kRoutine) << "Writing " << nRecords << " records to " << argv[optind] << endl;
+  if (!stream.WriteFile(argv[optind], nRecords)) return 1;
+  return 0;
+}
@@ -1,6 +1,7 @@
 #include "ORPyBindUtilities.hh"
 #include <string>
 #include <cctype>
+#include <cstring>
 
 #if PY_VERSION_HEX < 0x03000000
 template<class T>
@@ -61,30 +62,16 @@ PyObject* ORPyBindUtils::ObjectFromBuffer(void* buf,
 {
   // Helper function to generate a PyObject from a buffer
 #if PY_VERSION_HEX >= 0x03000000
-    std::string type;
+    const char* format;
     switch (stride_size) {
-        case 1: type = 'B'; break;    
-        case 2: type = 'H'; break;    
-        case 4: type = (is_int) ? 'I' : 'f'; break;
-        case 8: type = (is_int) ? 'L' : 'd'; break;
+        case 1: format = (is_signed) ? "b" : "B"; break;    
+        case 2: format = (is_signed) ? "h" : "H"; break;    
+        case 4: format = (is_int) ? ((is_signed) ? "i" : "I") : "f"; break;
+        case 8: format = (is_int) ? ((is_signed) ? "q" : "Q") : "d"; break;
         default: return NULL;
     }
-    if (is_signed) type[0] = tolower(type[0]);
-
-    // Fill the buffer with as much info as possible
-
-    Py_buffer tempBuffer;
-    int ret = PyBuffer_FillInfo(&tempBuffer, 0, buf, len, 1, PyBUF_SIMPLE);
-    if (ret != 0) return NULL;
-
-    // Now modify the information according to the type
-    tempBuffer.format = (char*)calloc(2, 1); 
-    tempBuffer.format[0] = type[0];
-    tempBuffer.itemsize = stride_size;
-    //tempBuffer.strides[0] = stride_size;
-    //tempBuffer.shape[0] = len/stride_size;
-
-    return PyMemoryView_FromBuffer(&tempBuffer);    
+    Py_ssize_t shape = len/stride_size;
+    return ArrayFromBuffer(buf, stride_size, format, 1, &shape);
 #else
 
     PyTypeObject* type;
@@ -96,7 +83,7 @@ PyObject* ORPyBindUtils::ObjectFromBuffer(void* buf,
         default: return NULL;
     }
 
-    PyObject* obj = PyBuffer_FromReadWriteMemory(buf, len*stride_size);
+    PyObject* obj = PyBuffer_FromReadWriteMemory(buf, len);
     if ( obj ) {
         Py_INCREF( (PyObject*)type);
         obj->ob_type = type; 
@@ -104,3 +91,33 @@ PyObject* ORPyBindUtils::ObjectFromBuffer(void* buf,
     return obj;
 #endif
 }
+
+PyObject* ORPyBindUtils::ArrayFromBuffer(const void* buf, size_t itemsize,
+        const char* format, int ndim, const Py_ssize_t* shape)
+{
+    Py_ssize_t len = itemsize;
+    for (int i=0; i<ndim; i++) len *= shape[i];
+    // empty vectors have no data, but python wants a pointer anyway
+    static const double empty = 0;
+    if (buf == NULL && len == 0) buf = &empty;
+#if PY_VERSION_HEX >= 0x03000000
+    // C-contiguous strides; the memoryview copies shape and strides
+    Py_ssize_t strides[PyBUF_MAX_NDIM];
+    if (ndim < 1 || ndim > PyBUF_MAX_NDIM) return NULL;
+    strides[ndim-1] = itemsize;
+    for (int i=ndim-1; i>0; i--) strides[i-1] = strides[i]*shape[i];
+
+    Py_buffer view;
+    if (PyBuffer_FillInfo(&view, 0, const_cast<void*>(buf), len, 1, PyBUF_FULL_RO) != 0) return NULL;
+    view.format = const_cast<char*>(format);
+    view.itemsize = itemsize;
+    view.ndim = ndim;
+    view.shape = const_cast<Py_ssize_t*>(shape);
+    view.strides = strides;
+    return PyMemoryView_FromBuffer(&view);
+#else
+    bool is_int = (strchr("fd", format[0]) == NULL);
+    bool is_signed = !is_int || islower(format[0]);
+    return ObjectFromBuffer(const_cast<void*>(buf), len, itemsize, is_signed, is_int);
+#endif
+}
@@ -16,6 +16,7 @@
     funcname, pyFunc, retIfError, retIfNoExist)       \
 retVal aclass::funcname()                             \
 {                                                     \
+    ORPyBindUtils::GILGuard gil;                      \
     PyObject* res = CallFunc(#funcname);              \
     if (res == 0) {                                   \
       CHECK_PY_ERROR                                  \
@@ -30,6 +31,7 @@ retVal aclass::funcname()                             \
 #define IMPLEMENT_PYBOUND_VOID_FUNCTION(aclass, funcname)  \
 void aclass::funcname()                               \
 {                                                     \
+    ORPyBindUtils::GILGuard gil;                      \
     PyObject* res = CallFunc(#funcname);              \
     if (res == 0) CHECK_PY_ERROR                      \
     Py_XDECREF( res );                                \
@@ -42,8 +44,57 @@ void aclass::funcname()                               \
 
 namespace ORPyBindUtils {
 
+    //! Holds the GIL for its lifetime.
+    /*!
+        Python is called from the processing loop, which may run with the
+        GIL released (see ORPyDataProcManager::ProcessDataStream()); every
+        call into python must hold one of these.  It may be nested, and is
+        harmless if the thread already holds the GIL.
+     */
+    class GILGuard {
+      public:
+        GILGuard() : fState(PyGILState_Ensure()) {}
+        ~GILGuard() { PyGILState_Release(fState); }
+      private:
+        PyGILState_STATE fState;
+    };
+
 	PyObject* ObjectFromBuffer(void* buf, size_t len, size_t stride_size, bool is_signed, bool is_int);
 
+    //! Read-only memoryview of a C-contiguous array of ndim dimensions.
+    /*!
+        format is a struct module character ('H', 'I', 'Q', 'f', ...) and
+        must outlive the view, e.g. a literal.  Nothing is copied: the view
+        is only valid as long as buf.  Python 2 gets a flat buffer instead,
+        to be reshaped.
+     */
+    PyObject* ArrayFromBuffer(const void* buf, size_t itemsize, const char* format,
+                              int ndim, const Py_ssize_t* shape);
+
+    //! Struct module character of P.
+    template<typename P>
+    const char* FormatOf()
+    {
+        static const char* unsignedFormats[] = { "", "B", "H", "", "I", "", "", "", "Q" };
+        static const char* signedFormats[] = { "", "b", "h", "", "i", "", "", "", "q" };
+        if (!std::numeric_limits<P>::is_integer) return (sizeof(P) == 4) ? "f" : "d";
+        return std::numeric_limits<P>::is_signed ? signedFormats[sizeof(P)] : unsignedFormats[sizeof(P)];
+    }
+
+    template<typename P>
+    PyObject* ArrayFromBuffer(const P* buf, size_t len)
+    {
+        Py_ssize_t shape = len;
+        return ArrayFromBuffer(buf, sizeof(P), FormatOf<P>(), 1, &shape);
+    }
+
+    template<typename P>
+    PyObject* ArrayFromBuffer(const P* buf, size_t nRows, size_t nColumns)
+    {
+        Py_ssize_t shape[2] = { (Py_ssize_t) nRows, (Py_ssize_t) nColumns };
+        return ArrayFromBuffer(buf, sizeof(P), FormatOf<P>(), 2, shape);
+    }
+
     template<typename P>
 	PyObject* ObjectFromBuffer(const P* buf, size_t len)
 	{
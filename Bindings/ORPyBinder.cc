@@ -27,7 +27,8 @@ void ORPyBinder::SetupSelf() const
 }
 
 //______________________________________________________________________________
-PyObject* ORPyBinder::CallFunc( const char* funcname, PyObject* args ) const 
+PyObject* ORPyBinder::CallFunc( const char* funcname, PyObject* args,
+                                PyObject* args2 ) const 
 {
    SetupSelf();
 
@@ -36,7 +37,7 @@ PyObject* ORPyBinder::CallFunc( const char* funcname, PyObject* args ) const
      PyObject_GetAttrString( fSelf, const_cast<char*>(funcname)); 
 
    if ( ! PyROOT::MethodProxy_CheckExact( pymethod ) ) {
-     result = PyObject_CallFunctionObjArgs( pymethod, args, 0 );
+     result = PyObject_CallFunctionObjArgs( pymethod, args, args2, 0 );
    } else {
       Py_INCREF( Py_None );
       result = Py_None;
@@ -46,4 +47,18 @@ PyObject* ORPyBinder::CallFunc( const char* funcname, PyObject* args ) const
    return result;
 }
 
+//______________________________________________________________________________
+bool ORPyBinder::HasPyFunc( const char* funcname ) const
+{
+   SetupSelf();
 
+   PyObject* pymethod = 
+     PyObject_GetAttrString( fSelf, const_cast<char*>(funcname)); 
+   if ( pymethod == 0 ) {
+      PyErr_Clear();
+      return false;
+   }
+   bool hasFunc = ! PyROOT::MethodProxy_CheckExact( pymethod );
+   Py_DECREF( pymethod );
+   return hasFunc;
+}
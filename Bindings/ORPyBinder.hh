@@ -14,7 +14,10 @@ class ORPyBinder : public TObject
 
   protected:
 
-    PyObject* CallFunc( const char* funcname, PyObject* args = 0 ) const;
+    PyObject* CallFunc( const char* funcname, PyObject* args = 0,
+                        PyObject* args2 = 0 ) const;
+    //! True if the python object defines funcname (not just the C++ base).
+    bool HasPyFunc( const char* funcname ) const;
 
   private:
     void SetupSelf() const;
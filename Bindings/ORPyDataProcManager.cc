@@ -1,3 +1,13 @@
 #include "ORPyDataProcManager.hh"
+#include "ORPyBindUtilities.hh"
 
 ClassImp(ORPyDataProcManager)
+
+ORPyDataProcManager::EReturnCode ORPyDataProcManager::ProcessDataStream()
+{
+  EReturnCode ret;
+  Py_BEGIN_ALLOW_THREADS
+  ret = ORDataProcManager::ProcessDataStream();
+  Py_END_ALLOW_THREADS
+  return ret;
+}
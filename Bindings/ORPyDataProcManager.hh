@@ -6,8 +6,20 @@
 #include "ORPyBinder.hh"
 #include "ORDataProcManager.hh"
 
+//! Data processing manager to be run from python.
+/*!
+    ProcessDataStream() releases the GIL while the C++ loop runs; the
+    python processors take it back when they are called.  With batches
+    (ORPyDataProcessor::SetBatchSize()), reading, decoding and C++
+    processors then run without the GIL between two batches.
+ */
 class ORPyDataProcManager : public ORDataProcManager, public ORPyBinder
 {
+  public:
+    ORPyDataProcManager(ORVReader* reader = NULL) : ORDataProcManager(reader) {}
+
+    //! Must be called from python, holding the GIL.
+    virtual EReturnCode ProcessDataStream();
 
     ClassDef(ORPyDataProcManager, 0)
 };
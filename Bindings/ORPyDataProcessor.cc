@@ -3,14 +3,38 @@
 
 ClassImp(ORPyDataProcessor)
 
-IMPLEMENT_PYBOUND_RETCODE_FUNCTION(ORPyDataProcessor, StartProcessing)
 IMPLEMENT_PYBOUND_RETCODE_FUNCTION(ORPyDataProcessor, StartRun)
-IMPLEMENT_PYBOUND_RETCODE_FUNCTION(ORPyDataProcessor, EndRun)
 IMPLEMENT_PYBOUND_RETCODE_FUNCTION(ORPyDataProcessor, EndProcessing)
 
+ORPyDataProcessor::EReturnCode ORPyDataProcessor::StartProcessing()
+{
+  ORPyBindUtils::GILGuard gil;
+  if (fBatchSize > 1 && !HasPyFunc("ProcessMyDataRecords")) {
+    ORLog(kWarning) << "StartProcessing(): batch size " << fBatchSize
+                    << " but no ProcessMyDataRecords(); handing records one by one" << std::endl;
+    fBatchSize = 0;
+  }
+  PyObject* res = CallFunc("StartProcessing");
+  if (res == 0) {
+    CHECK_PY_ERROR
+    return kAlarm;
+  }
+  EReturnCode ret = (res == Py_None) ? kSuccess : (EReturnCode) PyInt_AsLong(res);
+  Py_XDECREF( res );
+  return ret;
+}
+
 ORPyDataProcessor::EReturnCode ORPyDataProcessor::ProcessMyDataRecord(UInt_t* record)
 {
   assert(GetDecoder());
+  if (fBatchSize > 1) {
+    // no python here, so that the GIL can stay released
+    fBatch.Append(record, GetDecoder()->LengthOf(record));
+    if (fBatch.GetNRecords() < fBatchSize) return kSuccess;
+    return FlushBatch();
+  }
+
+  ORPyBindUtils::GILGuard gil;
   PyObject* send_obj = ORPyBindUtils::ObjectFromBuffer(record, GetDecoder()->LengthOf(record)); 
 
   PyObject* res = CallFunc("ProcessMyDataRecord", send_obj);
@@ -21,3 +45,46 @@ ORPyDataProcessor::EReturnCode ORPyDataProcessor::ProcessMyDataRecord(UInt_t* re
   return ret;
 
 }
+
+ORPyDataProcessor::EReturnCode ORPyDataProcessor::FlushBatch()
+{
+  if (fBatch.GetNRecords() == 0) return kSuccess;
+
+  ORPyBindUtils::GILGuard gil;
+  PyObject* offsets = ORPyBindUtils::ObjectFromBuffer(fBatch.GetOffsets(), fBatch.GetNRecords() + 1);
+  PyObject* data = ORPyBindUtils::ObjectFromBuffer(fBatch.GetData(), fBatch.GetNWords());
+
+  PyObject* res = CallFunc("ProcessMyDataRecords", offsets, data);
+  fBatch.Clear();
+  Py_XDECREF( offsets );
+  Py_XDECREF( data );
+  if (res == 0) {
+    CHECK_PY_ERROR
+    return kAlarm;
+  }
+  EReturnCode ret = (res == Py_None) ? kSuccess : (EReturnCode) PyInt_AsLong(res);
+  Py_XDECREF( res );
+  return ret;
+}
+
+ORPyDataProcessor::EReturnCode ORPyDataProcessor::EndRun()
+{
+  // the last records of the run
+  EReturnCode ret = FlushBatch();
+  if (ret >= kAlarm) return ret;
+
+  ORPyBindUtils::GILGuard gil;
+  PyObject* res = CallFunc("EndRun");
+  if (res == 0) {
+    CHECK_PY_ERROR
+    return kAlarm;
+  }
+  ret = (res == Py_None) ? kSuccess : (EReturnCode) PyInt_AsLong(res);
+  Py_XDECREF( res );
+  return ret;
+}
+
+size_t ORPyDataProcessor::GetMemoryUsage() const
+{
+  return ORDataProcessor::GetMemoryUsage() + fBatch.GetMemoryUsage();
+}
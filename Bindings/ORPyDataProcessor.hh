@@ -5,11 +5,30 @@
 
 #include "ORPyBinder.hh"
 #include "ORDataProcessor.hh"
+#include "ORPyRecordBatch.hh"
 
+//! Processor written in python.
+/*!
+    By default ProcessMyDataRecord(record) is called in python for every
+    record.  With SetBatchSize(n), the records are instead collected in C++
+    (without the GIL, see ORPyDataProcManager) and handed to python n at a
+    time, and at the end of the run:
+
+    \verbatim
+    def ProcessMyDataRecords(self, offsets, data):
+        for i in range(len(offsets) - 1):
+            record = data[offsets[i]:offsets[i+1]]
+    \endverbatim
+
+    The records are copied into the batch (see ORPyRecordBatch); offsets
+    and data are buffers of unsigned ints that view it, valid only during
+    the call because the batch is reused: copy what must be kept.
+    Return codes other than kSuccess apply to the whole batch.
+ */
 class ORPyDataProcessor : public ORDataProcessor, public ORPyBinder
 {
   public:
-    ORPyDataProcessor(ORVDataDecoder* dec = 0) : ORDataProcessor(dec) {}
+    ORPyDataProcessor(ORVDataDecoder* dec = 0) : ORDataProcessor(dec), fBatchSize(0) {}
    
     // these are the functions that are typically overloaded
     virtual EReturnCode StartProcessing();
@@ -18,6 +37,20 @@ class ORPyDataProcessor : public ORDataProcessor, public ORPyBinder
     virtual EReturnCode EndRun();
     virtual EReturnCode EndProcessing();
 
+    //! Hands the records to python nRecords at a time; 0 or 1 for one by one.
+    virtual void SetBatchSize(size_t nRecords) { fBatchSize = nRecords; }
+    virtual size_t GetBatchSize() const { return fBatchSize; }
+
+    virtual size_t GetMemoryUsage() const;
+    virtual void ReduceMemory() { FlushBatch(); }
+
+  protected:
+    //! Calls ProcessMyDataRecords in python with the records collected so far.
+    virtual EReturnCode FlushBatch();
+
+    size_t fBatchSize;
+    ORPyRecordBatch fBatch; //!
+
     ClassDef(ORPyDataProcessor, 0)
 
 };
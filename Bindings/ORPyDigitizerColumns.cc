@@ -0,0 +1,126 @@
+#include "ORPyDigitizerColumns.hh"
+#include "ORPyBindUtilities.hh"
+
+ClassImp(ORPyDigitizerColumns)
+
+using namespace ORPyBindUtils;
+
+// Words of a python buffer; view must be released with ReleaseWords().
+static const UInt_t* GetWords(PyObject* obj, Py_buffer& view, size_t& nWords)
+{
+#if PY_VERSION_HEX >= 0x03000000
+  if (PyObject_GetBuffer(obj, &view, PyBUF_C_CONTIGUOUS) != 0) return NULL;
+  nWords = view.len/sizeof(UInt_t);
+  return (const UInt_t*) view.buf;
+#else
+  const void* buf;
+  Py_ssize_t len;
+  view.obj = NULL;
+  if (PyObject_AsReadBuffer(obj, &buf, &len) != 0) return NULL;
+  nWords = len/sizeof(UInt_t);
+  return (const UInt_t*) buf;
+#endif
+}
+
+static void ReleaseWords(Py_buffer& view)
+{
+#if PY_VERSION_HEX >= 0x03000000
+  PyBuffer_Release(&view);
+#else
+  (void) view;
+#endif
+}
+
+size_t ORPyDigitizerColumns::AddBatch(PyObject* offsets, PyObject* data)
+{
+  Py_buffer offsetsView, dataView;
+  size_t nOffsets = 0, nWords = 0;
+  const UInt_t* offsetWords = GetWords(offsets, offsetsView, nOffsets);
+  if (offsetWords == NULL) {
+    CHECK_PY_ERROR
+    return 0;
+  }
+  const UInt_t* dataWords = GetWords(data, dataView, nWords);
+  if (dataWords == NULL) {
+    CHECK_PY_ERROR
+    ReleaseWords(offsetsView);
+    return 0;
+  }
+
+  size_t nRecords = (nOffsets > 0) ? nOffsets - 1 : 0;
+  if (nRecords > 0 && offsetWords[nRecords] > nWords) {
+    ORLog(kError) << "AddBatch(): offsets beyond the end of the data" << std::endl;
+    nRecords = 0;
+  }
+  size_t nAccepted = 0;
+  // the buffers stay exported, so python can't free them meanwhile
+  Py_BEGIN_ALLOW_THREADS
+  nAccepted = AddRecords(dataWords, offsetWords, nRecords);
+  Py_END_ALLOW_THREADS
+
+  ReleaseWords(dataView);
+  ReleaseWords(offsetsView);
+  return nAccepted;
+}
+
+PyObject* ORPyDigitizerColumns::Times()
+{
+  return ArrayFromBuffer(GetTimes(), GetNEvents());
+}
+
+PyObject* ORPyDigitizerColumns::Energies()
+{
+  return ArrayFromBuffer(GetEnergies(), GetNEvents());
+}
+
+PyObject* ORPyDigitizerColumns::Channels()
+{
+  return ArrayFromBuffer(GetChannels(), GetNEvents());
+}
+
+PyObject* ORPyDigitizerColumns::Flags()
+{
+  return ArrayFromBuffer(GetFlags(), GetNEvents());
+}
+
+PyObject* ORPyDigitizerColumns::Crates()
+{
+  return ArrayFromBuffer(GetCrates(), GetNEvents());
+}
+
+PyObject* ORPyDigitizerColumns::Cards()
+{
+  return ArrayFromBuffer(GetCards(), GetNEvents());
+}
+
+PyObject* ORPyDigitizerColumns::WaveformLengths()
+{
+  return ArrayFromBuffer(GetWaveformLengths(), GetNEvents());
+}
+
+PyObject* ORPyDigitizerColumns::Waveforms()
+{
+  // no rows at all if no event had a waveform
+  size_t nRows = (GetWaveformWidth() > 0 && GetWaveforms() != NULL) ? GetNEvents() : 0;
+  return ArrayFromBuffer(GetWaveforms(), nRows, GetWaveformWidth());
+}
+
+PyObject* ORPyDigitizerColumns::Columns()
+{
+  PyObject* columns = PyDict_New();
+  if (columns == NULL) return NULL;
+  const char* names[] = { "time", "energy", "channel", "flags", "crate", "card",
+                          "waveformLength", "waveform" };
+  PyObject* values[] = { Times(), Energies(), Channels(), Flags(), Crates(), Cards(),
+                         WaveformLengths(), Waveforms() };
+  bool ok = true;
+  for (size_t i=0; i<sizeof(names)/sizeof(names[0]); i++) {
+    if (values[i] == NULL || PyDict_SetItemString(columns, names[i], values[i]) != 0) ok = false;
+    Py_XDECREF(values[i]);
+  }
+  if (!ok) {
+    Py_DECREF(columns);
+    return NULL;
+  }
+  return columns;
+}
@@ -0,0 +1,53 @@
+// ORPyDigitizerColumns.hh
+
+#ifndef _ORPyDigitizerColumns_hh_
+#define _ORPyDigitizerColumns_hh_
+
+#include "TPyReturn.h"
+#include "ORDigitizerColumns.hh"
+
+//! ORDigitizerColumns with the columns as python memoryviews.
+/*!
+    The memoryviews point into the columns, so numpy.asarray() gives
+    arrays without copying.  Like the columns, they are only valid until
+    the next AddBatch(), AddRecord() or Clear(): use numpy.array() (a copy)
+    to keep them longer.  E.g. in an ORPyDataProcessor with batches:
+
+    \verbatim
+    def ProcessMyDataRecords(self, offsets, data):
+        self.columns.Clear()
+        self.columns.AddBatch(offsets, data)
+        c = dict((k, numpy.asarray(v)) for k, v in self.columns.Columns().items())
+        energy, waveform = c["energy"], c["waveform"]   # waveform is 2D
+    \endverbatim
+
+    Waveforms are 2D with Python 3; Python 2 only gets flat buffers, to be
+    reshaped to (GetNEvents(), GetWaveformWidth()).
+ */
+class ORPyDigitizerColumns : public ORDigitizerColumns
+{
+  public:
+    ORPyDigitizerColumns(ORVDigitizerDecoder* decoder = NULL) : ORDigitizerColumns(decoder) {}
+    virtual ~ORPyDigitizerColumns() {}
+
+    //! Adds the records of a batch as handed to ProcessMyDataRecords(offsets, data).
+    /*!
+        Decodes without the GIL.  Returns the number of records accepted.
+     */
+    virtual size_t AddBatch(PyObject* offsets, PyObject* data);
+
+    virtual PyObject* Times();
+    virtual PyObject* Energies();
+    virtual PyObject* Channels();
+    virtual PyObject* Flags();
+    virtual PyObject* Crates();
+    virtual PyObject* Cards();
+    virtual PyObject* WaveformLengths();
+    virtual PyObject* Waveforms();
+    //! All columns in a dict: time, energy, channel, flags, crate, card, waveformLength, waveform.
+    virtual PyObject* Columns();
+
+    ClassDef(ORPyDigitizerColumns, 0)
+};
+
+#endif
@@ -0,0 +1,24 @@
+// ORPyRecordBatch.cc
+
+#include "ORPyRecordBatch.hh"
+#include <cstring>
+
+void ORPyRecordBatch::Append(const UInt_t* record, size_t nWords)
+{
+  size_t start = fData.size();
+  fData.resize(start + nWords);
+  memcpy(&fData[start], record, nWords*sizeof(UInt_t));
+  fOffsets.push_back(fData.size());
+}
+
+void ORPyRecordBatch::Clear()
+{
+  fData.clear();
+  fOffsets.clear();
+  fOffsets.push_back(0);
+}
+
+size_t ORPyRecordBatch::GetMemoryUsage() const
+{
+  return fData.capacity()*sizeof(UInt_t) + fOffsets.capacity()*sizeof(UInt_t);
+}
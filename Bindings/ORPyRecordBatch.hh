@@ -0,0 +1,37 @@
+// ORPyRecordBatch.hh
+
+#ifndef _ORPyRecordBatch_hh_
+#define _ORPyRecordBatch_hh_
+
+#include <vector>
+#include "Rtypes.h"
+
+//! Records collected to be handed to python together.
+/*!
+    The records are copied one after the other into one array of words;
+    the offsets array has GetNRecords()+1 entries, record i being the words
+    from GetOffsets()[i] up to GetOffsets()[i+1].  The arrays are reused
+    from batch to batch, so that a batch costs no allocations once the
+    largest batch has been seen.
+ */
+class ORPyRecordBatch
+{
+  public:
+    ORPyRecordBatch() { Clear(); }
+    virtual ~ORPyRecordBatch() {}
+
+    virtual void Append(const UInt_t* record, size_t nWords);
+    virtual void Clear();
+
+    virtual size_t GetNRecords() const { return fOffsets.size() - 1; }
+    virtual size_t GetNWords() const { return fData.size(); }
+    virtual const UInt_t* GetData() const { return fData.empty() ? NULL : &fData[0]; }
+    virtual const UInt_t* GetOffsets() const { return &fOffsets[0]; }
+    virtual size_t GetMemoryUsage() const;
+
+  protected:
+    std::vector<UInt_t> fData;
+    std::vector<UInt_t> fOffsets;
+};
+
+#endif
@@ -3,14 +3,44 @@
 
 ClassImp(ORPyTreeWriter)
 
-IMPLEMENT_PYBOUND_RETCODE_FUNCTION(ORPyTreeWriter, StartProcessing)
 IMPLEMENT_PYBOUND_RETCODE_FUNCTION(ORPyTreeWriter, EndProcessing)
 IMPLEMENT_PYBOUND_RETCODE_FUNCTION(ORPyTreeWriter, InitializeBranches)
 IMPLEMENT_PYBOUND_VOID_FUNCTION(ORPyTreeWriter, Clear)
 
+ORPyTreeWriter::EReturnCode ORPyTreeWriter::StartProcessing()
+{
+  ORPyBindUtils::GILGuard gil;
+  if (fBatchSize > 1 && fThisProcessorAutoFillsTree) {
+    ORLog(kWarning) << "StartProcessing(): batches need DoNotAutoFillTree(); "
+                    << "handing records one by one" << std::endl;
+    fBatchSize = 0;
+  }
+  if (fBatchSize > 1 && !HasPyFunc("ProcessMyDataRecords")) {
+    ORLog(kWarning) << "StartProcessing(): batch size " << fBatchSize
+                    << " but no ProcessMyDataRecords(); handing records one by one" << std::endl;
+    fBatchSize = 0;
+  }
+  PyObject* res = CallFunc("StartProcessing");
+  if (res == 0) {
+    CHECK_PY_ERROR
+    return kAlarm;
+  }
+  EReturnCode ret = (res == Py_None) ? kSuccess : (EReturnCode) PyInt_AsLong(res);
+  Py_XDECREF( res );
+  return ret;
+}
+
 ORPyTreeWriter::EReturnCode ORPyTreeWriter::ProcessMyDataRecord(UInt_t* record)
 {
   assert(GetDecoder());
+  if (fBatchSize > 1) {
+    // no python here, so that the GIL can stay released
+    fBatch.Append(record, GetDecoder()->LengthOf(record));
+    if (fBatch.GetNRecords() < fBatchSize) return kSuccess;
+    return FlushBatch();
+  }
+
+  ORPyBindUtils::GILGuard gil;
   PyObject* send_obj = ORPyBindUtils::ObjectFromBuffer(record, GetDecoder()->LengthOf(record)); 
 
   PyObject* res = CallFunc("ProcessMyDataRecord", send_obj);
@@ -21,3 +51,43 @@ ORPyTreeWriter::EReturnCode ORPyTreeWriter::ProcessMyDataRecord(UInt_t* record)
   return ret;
 
 }
+
+ORPyTreeWriter::EReturnCode ORPyTreeWriter::FlushBatch()
+{
+  if (fBatch.GetNRecords() == 0) return kSuccess;
+
+  ORPyBindUtils::GILGuard gil;
+  PyObject* offsets = ORPyBindUtils::ObjectFromBuffer(fBatch.GetOffsets(), fBatch.GetNRecords() + 1);
+  PyObject* data = ORPyBindUtils::ObjectFromBuffer(fBatch.GetData(), fBatch.GetNWords());
+
+  PyObject* res = CallFunc("ProcessMyDataRecords", offsets, data);
+  fBatch.Clear();
+  Py_XDECREF( offsets );
+  Py_XDECREF( data );
+  if (res == 0) {
+    CHECK_PY_ERROR
+    return kAlarm;
+  }
+  EReturnCode ret = (res == Py_None) ? kSuccess : (EReturnCode) PyInt_AsLong(res);
+  Py_XDECREF( res );
+  return ret;
+}
+
+ORPyTreeWriter::EReturnCode ORPyTreeWriter::EndRun()
+{
+  // the last records of the run go in before the tree is written
+  EReturnCode ret = FlushBatch();
+  if (ret >= kAlarm) return ret;
+  return ORVTreeWriter::EndRun();
+}
+
+size_t ORPyTreeWriter::GetMemoryUsage() const
+{
+  return ORVTreeWriter::GetMemoryUsage() + fBatch.GetMemoryUsage();
+}
+
+void ORPyTreeWriter::ReduceMemory()
+{
+  FlushBatch();
+  ORVTreeWriter::ReduceMemory();
+}
@@ -5,16 +5,25 @@
 
 #include "ORPyBinder.hh"
 #include "ORVTreeWriter.hh"
-
+#include "ORPyRecordBatch.hh"
+
+//! Tree writer written in python.
+/*!
+    SetBatchSize() hands the records to ProcessMyDataRecords(offsets, data)
+    in python, as in ORPyDataProcessor.  Since the tree can then not be
+    filled once per record, this needs DoNotAutoFillTree(): python fills
+    the tree itself.
+ */
 class ORPyTreeWriter : public ORVTreeWriter, public ORPyBinder
 {
   public:
     ORPyTreeWriter(ORVDataDecoder* dec = 0, const std::string& treeName = "") : 
-      ORVTreeWriter(dec, treeName) {}
+      ORVTreeWriter(dec, treeName), fBatchSize(0) {}
    
     // these are the functions that are typically overloaded
     EReturnCode StartProcessing();
     EReturnCode ProcessMyDataRecord(UInt_t* record);
+    EReturnCode EndRun();
     EReturnCode EndProcessing();
 
     using ORVTreeWriter::Clear;
@@ -25,8 +34,20 @@ class ORPyTreeWriter : public ORVTreeWriter, public ORPyBinder
     
     TTree* GetTree() { return fTree; }
 
+    //! Hands the records to python nRecords at a time; 0 or 1 for one by one.
+    void SetBatchSize(size_t nRecords) { fBatchSize = nRecords; }
+    size_t GetBatchSize() const { return fBatchSize; }
+
+    size_t GetMemoryUsage() const;
+    void ReduceMemory();
+
   protected:
     EReturnCode InitializeBranches();
+    //! Calls ProcessMyDataRecords in python with the records collected so far.
+    EReturnCode FlushBatch();
+
+    size_t fBatchSize;
+    ORPyRecordBatch fBatch; //!
 
     ClassDef(ORPyTreeWriter, 0)
 
@@ -92,6 +92,10 @@ class ORAcqirisDC440Decoder: public ORVDigitizerDecoder
     virtual UInt_t GetEventWaveformPoint( size_t /*event*/, 
                                           size_t waveformPoint );
 
+  protected:
+    virtual bool FillWaveformView(size_t /*event*/, ORWaveformView& view)
+      { view = ORWaveformView(GetWaveformDataPointer(), GetWaveformLen(),
+                              ORWaveformView::kUInt16, 0xffff, true); return true; }
 };
 
 //inline functions: ************************************************************************
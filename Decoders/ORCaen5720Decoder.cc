@@ -1,8 +1,7 @@
 // ORCaen5720Decoder.cc
 // Basic information taken from ORCaen1720Decoder.cc provided by Jarek Kaspar.  
 // Updated by Laura Bodine
-// Zpack2.5 and zerolengthencoding are not currently handled here...
-// if your data is formatted that way then you must add that functionality to this decoder
+// Handles the normal, Pack2.5 and zero-length-encoded (ZLE) data formats.
 
 #include "TROOT.h"
 #include "ORCaen5720Decoder.hh"
@@ -11,152 +10,184 @@
 
 
 /**************************************************************************
-// Get number of samples in each trace (single channel)
+// Sample unpacking.  The event data are read as 32-bit words, so this does
+// not depend on the byte order of the host, in plain loops without
+// branches that the compiler can vectorize.
+//
+// Normal format: two samples per word, the earlier one in bits [11:0] and
+// the later one in bits [27:16].
+//
+// Pack2.5: five samples per two words,
+//   word 0: S2[7:0] S1[11:0] S0[11:0]
+//   word 1: 0000 S4[11:0] S3[11:0] S2[11:8]
 **************************************************************************/
-UInt_t ORCaen5720Decoder::TraceLength(UInt_t* record) {
+static inline UInt_t ORCaen5720SamplesInWords(UInt_t nWords, bool packed)
+{
+  return packed ? nWords*5/2 : nWords*2;
+}
+
+static void ORCaen5720Unpack(const UInt_t* words, UInt_t nSamples, UInt_t* waveform)
+{
+  UInt_t nWords = nSamples/2;
+  for (UInt_t i = 0; i < nWords; i++) {
+    waveform[2*i] = words[i] & ORCaen5720Decoder::kSampleMask;
+    waveform[2*i+1] = (words[i] >> 16) & ORCaen5720Decoder::kSampleMask;
+  }
+  if (nSamples % 2) waveform[nSamples-1] = words[nWords] & ORCaen5720Decoder::kSampleMask;
+}
+
+static inline void ORCaen5720UnpackPair(UInt_t word0, UInt_t word1, UInt_t* samples)
+{
+  samples[0] = word0 & ORCaen5720Decoder::kSampleMask;
+  samples[1] = (word0 >> 12) & ORCaen5720Decoder::kSampleMask;
+  samples[2] = (word0 >> 24) | ((word1 & 0xf) << 8);
+  samples[3] = (word1 >> 4) & ORCaen5720Decoder::kSampleMask;
+  samples[4] = (word1 >> 16) & ORCaen5720Decoder::kSampleMask;
+}
+
+static void ORCaen5720UnpackPacked(const UInt_t* words, UInt_t nSamples, UInt_t* waveform)
+{
+  UInt_t nPairs = nSamples/5;
+  for (UInt_t i = 0; i < nPairs; i++) {
+    ORCaen5720UnpackPair(words[2*i], words[2*i+1], waveform + 5*i);
+  }
+  UInt_t nLeft = nSamples % 5;
+  if (nLeft == 0) return;
+  UInt_t samples[5];
+  ORCaen5720UnpackPair(words[2*nPairs], (nLeft > 2) ? words[2*nPairs+1] : 0, samples);
+  for (UInt_t i = 0; i < nLeft; i++) waveform[5*nPairs+i] = samples[i];
+}
+
+/**************************************************************************
+// Get number of active channels in the record
+**************************************************************************/
+UInt_t ORCaen5720Decoder::NumberOfChannels(UInt_t* record) {
 	UInt_t numChan = 0;
 	UInt_t chanMask = ChannelMask(record);
 
 	for (; chanMask; numChan++) chanMask &= chanMask - 1; //check number of channels in record
 
-	return (EventSize(record) - 4) / numChan * 2; // 4 longs header, then 2 samples per long
+	return numChan;
 }
 
+/**************************************************************************
+// Get number of samples in each trace (single channel)
+**************************************************************************/
+UInt_t ORCaen5720Decoder::TraceLength(UInt_t* record) {
+	UInt_t numChan = NumberOfChannels(record);
+	if (numChan == 0 || EventSize(record) < kEventHeaderLen) return 0;
+
+	UInt_t* data = GetEventPointer(record) + kEventHeaderLen;
+	UInt_t* end = GetEventPointer(record) + EventSize(record);
+	if (fZeroLengthEncoded) return ExpandZLEChannel(data, end, NULL, 0, Packed(record));
+
+	// 4 longs header, then the channels' samples in equal blocks
+	return ORCaen5720SamplesInWords((EventSize(record) - kEventHeaderLen) / numChan, Packed(record));
+}
+
+/**************************************************************************
+// Expand one ZLE channel: a size word (the channel's length in words,
+// itself included) followed by control words.  A control word with bit 31
+// set is followed by that many words ([20:0]) of stored samples; one with
+// bit 31 clear stands for that many words of suppressed samples.
+// waveform may be NULL to just count the samples.
+**************************************************************************/
+UInt_t ORCaen5720Decoder::ExpandZLEChannel(const UInt_t* channel, const UInt_t* end, UInt_t* waveform,
+                                           UInt_t maxSamples, bool packed) {
+	if (channel >= end) return 0;
+	const UInt_t* channelEnd = channel + (channel[0] & 0x1fffff);
+	if (channelEnd > end) {
+	  ORLog(kWarning) << "ExpandZLEChannel(): channel size exceeds the event" << std::endl;
+	  channelEnd = end;
+	}
+	UInt_t numSamples = 0;
+	const UInt_t* word = channel + 1;
+	while (word < channelEnd) {
+	  UInt_t control = *word++;
+	  UInt_t nWords = control & 0x1fffff;
+	  UInt_t nSamples = ORCaen5720SamplesInWords(nWords, packed);
+	  UInt_t nToCopy = 0;
+	  if (waveform != NULL && numSamples < maxSamples) {
+	    nToCopy = (nSamples < maxSamples - numSamples) ? nSamples : maxSamples - numSamples;
+	  }
+	  if (control & 0x80000000) {
+	    if (word + nWords > channelEnd) {
+	      ORLog(kWarning) << "ExpandZLEChannel(): stored block exceeds the channel" << std::endl;
+	      break;
+	    }
+	    if (packed) ORCaen5720UnpackPacked(word, nToCopy, waveform + numSamples);
+	    else ORCaen5720Unpack(word, nToCopy, waveform + numSamples);
+	    word += nWords;
+	  }
+	  else {
+	    for (UInt_t i = 0; i < nToCopy; i++) waveform[numSamples+i] = fZLEFillValue;
+	  }
+	  numSamples += nSamples;
+	}
+	return numSamples;
+}
+
+/**************************************************************************
+// Get at the traces of any set of channels (channel blocks follow each
+// other in the order of the channel mask)
+**************************************************************************/
+UInt_t ORCaen5720Decoder::CopyChannelTraces(UInt_t* record, UInt_t** waveforms, UInt_t maxSamples) {
+	UInt_t numChan = NumberOfChannels(record);
+	if (numChan == 0 || EventSize(record) < kEventHeaderLen) return 0;
+
+	UInt_t chanMask = ChannelMask(record);
+	bool packed = Packed(record);
+	UInt_t* data = GetEventPointer(record) + kEventHeaderLen;
+	UInt_t* end = GetEventPointer(record) + EventSize(record);
+
+	if (fZeroLengthEncoded) {
+	  UInt_t numSamples = 0;
+	  for (UInt_t ch = 0; ch < kMaxChannels && data < end; ch++) {
+	    if (!(chanMask & (1 << ch))) continue;
+	    UInt_t n = ExpandZLEChannel(data, end, waveforms[ch], maxSamples, packed);
+	    if (numSamples == 0) numSamples = n;
+	    UInt_t size = data[0] & 0x1fffff;
+	    if (size == 0) break;
+	    data += size;
+	  }
+	  return (numSamples < maxSamples) ? numSamples : maxSamples;
+	}
+
+	UInt_t wordsPerChannel = (EventSize(record) - kEventHeaderLen) / numChan;
+	UInt_t numSamples = ORCaen5720SamplesInWords(wordsPerChannel, packed);
+	if (numSamples > maxSamples) numSamples = maxSamples;
+	for (UInt_t ch = 0; ch < kMaxChannels; ch++) {
+	  if (!(chanMask & (1 << ch))) continue;
+	  if (waveforms[ch] != NULL) {
+	    if (packed) ORCaen5720UnpackPacked(data, numSamples, waveforms[ch]);
+	    else ORCaen5720Unpack(data, numSamples, waveforms[ch]);
+	  }
+	  data += wordsPerChannel;
+	}
+	return numSamples;
+}
 
 /**************************************************************************
 //Copy the trace for the first ACTIVE channel.  Check ChannelMap to tell.  
 **************************************************************************/
 
 void ORCaen5720Decoder::CopyTrace(UInt_t* record, UInt_t* Waveform, UInt_t numSamples) {
-         UInt_t * evtpointer = GetEventPointer(record);
-         UShort_t* sample = (UShort_t*) evtpointer;
-	//iterative way, because of the coming packed2.5 mode
-	for (unsigned int i = 0; i < numSamples; i++) {
-	  Waveform[i] =  sample[i+8] & 0x0fff;
-	  //std::cout << "Waveform [" << i << "] = " << Waveform[i] << std::endl;       
+	UInt_t* waveforms[kMaxChannels] = { NULL };
+	UInt_t chanMask = ChannelMask(record);
+	for (UInt_t ch = 0; ch < kMaxChannels; ch++) {
+	  if (chanMask & (1 << ch)) {
+	    waveforms[ch] = Waveform;
+	    break;
+	  }
 	}
+	CopyChannelTraces(record, waveforms, numSamples);
 }
 
 /**************************************************************************
-// Get at all traces (array arithmetic based on ChannelMask active channels)  
+// Get at the traces of the first four channels
 **************************************************************************/
 
 void ORCaen5720Decoder::CopyTraces(UInt_t* record, UInt_t *Waveform0, UInt_t *Waveform1,UInt_t *Waveform2,UInt_t *Waveform3, UInt_t numSamples){
-         UInt_t * evtpointer = GetEventPointer(record);
-         UShort_t* sample = (UShort_t*) evtpointer;
-
-	 UInt_t chanMask = ChannelMask(record); //chanMask: int between 1 and 15
-
-	 switch(chanMask){
-	   case 1 :
-	     for(UInt_t i = 0 ; i<numSamples;i++){
-	       Waveform0[i] = sample[i+8] & 0x0fff;
-	     };
-	     break;
-	     
-	   case 2 :
-	     for(UInt_t i = 0 ; i<numSamples;i++){
-	       Waveform1[i] = sample[i+8] & 0x0fff;
-	     };
-	     break;
-
-	   case 3:
-	     for(UInt_t i = 0 ; i<numSamples;i++){
-	       Waveform0[i] = sample[i+8] & 0x0fff;
-	       Waveform1[i] = sample[i+8+numSamples] & 0x0fff;
-	     };
-	     break;
-
-	   case 4:
-	     for(UInt_t i = 0 ; i<numSamples;i++){
-	       Waveform2[i] = sample[i+8] & 0x0fff;
-	     };
-	     break;
-
-	   case 5:
-	     for(UInt_t i = 0 ; i<numSamples;i++){
-	       Waveform0[i] = sample[i+8] & 0x0fff;
-	       Waveform2[i] = sample[i+8+numSamples] & 0x0fff;
-	     };
-	     break;
-
-	   case 6:
-	     for(UInt_t i = 0 ; i<numSamples;i++){
-	       Waveform1[i] = sample[i+8] & 0x0fff;
-	       Waveform2[i] = sample[i+8+numSamples] & 0x0fff;
-	     };
-	     break;
-
-	   case 7:
-	     for(UInt_t i = 0 ; i<numSamples;i++){
-	       Waveform0[i] = sample[i+8] & 0x0fff;
-	       Waveform1[i] = sample[i+8+numSamples] & 0x0fff;
-	       Waveform2[i] = sample[i+8+2*numSamples] & 0x0fff;
-	     };
-	     break;
-
-	   case 8:
-	     for(UInt_t i = 0 ; i<numSamples;i++){
-	       Waveform3[i] = sample[i+8] & 0x0fff;
-	     };
-	     break;
-
-	   case 9:
-	     for(UInt_t i = 0 ; i<numSamples;i++){
-	       Waveform0[i] = sample[i+8] & 0x0fff;
-	       Waveform3[i] = sample[i+8+numSamples] & 0x0fff;
-	     };
-	     break;
-
-	   case 10:
-	     for(UInt_t i = 0 ; i<numSamples;i++){
-	       Waveform1[i] = sample[i+8] & 0x0fff;
-	       Waveform3[i] = sample[i+8+numSamples] & 0x0fff;
-	     };
-	     break;
-
-	   case 11:
-	     for(UInt_t i = 0 ; i<numSamples;i++){
-	       Waveform0[i] = sample[i+8] & 0x0fff;
-	       Waveform1[i] = sample[i+8+numSamples] & 0x0fff;
-	       Waveform3[i] = sample[i+8+2*numSamples] & 0x0fff;
-	     };
-	     break;
-
-	   case 12:
-	     for(UInt_t i = 0 ; i<numSamples;i++){
-	       Waveform2[i] = sample[i+8] & 0x0fff;
-	       Waveform3[i] = sample[i+8+numSamples] & 0x0fff;
-	     };
-	     break;
-
-	   case 13:
-	     for(UInt_t i = 0 ; i<numSamples;i++){
-	       Waveform0[i] = sample[i+8] & 0x0fff;
-	       Waveform2[i] = sample[i+8+numSamples] & 0x0fff;
-	       Waveform3[i] = sample[i+8+2*numSamples] & 0x0fff;
-	     };
-	     break;
-
-	   case 14:
-	     for(UInt_t i = 0 ; i<numSamples;i++){
-	       Waveform1[i] = sample[i+8] & 0x0fff;
-	       Waveform2[i] = sample[i+8+numSamples] & 0x0fff;
-	       Waveform3[i] = sample[i+8+2*numSamples] & 0x0fff;
-	     };
-	     break;
-
-	   case 15:
-	     for(UInt_t i = 0 ; i<numSamples;i++){
-	       Waveform0[i] = sample[i+8] & 0x0fff;
-	       Waveform1[i] = sample[i+8+numSamples] & 0x0fff;
-	       Waveform2[i] = sample[i+8+2*numSamples] & 0x0fff;
-	       Waveform3[i] = sample[i+8+3*numSamples] & 0x0fff;
-	     };
-	     break;
-
-
-	 }//end of switch(chanMask)
-
+	UInt_t* waveforms[kMaxChannels] = { Waveform0, Waveform1, Waveform2, Waveform3 };
+	CopyChannelTraces(record, waveforms, numSamples);
 }
-
@@ -1,8 +1,7 @@
 // ORCaen5720Decoder.hh
 // Basic information taken from ORCaen1720Decoder.hh provided by Jarek Kaspar.  
 // Updated by Laura Bodine
-// Zpack2.5 and zerolengthencoding are not currently handled here...
-// if your data is formatted that way then you must add functionality to this decoder
+// Handles the normal, Pack2.5 and zero-length-encoded (ZLE) data formats.
 
 #ifndef _ORCaen5720Decoder_hh_
 #define _ORCaen5720Decoder_hh_
@@ -12,11 +11,12 @@
 class ORCaen5720Decoder : public ORVDataDecoder
 {
   public:
-    ORCaen5720Decoder() {}
+    ORCaen5720Decoder() : fZeroLengthEncoded(false), fZLEFillValue(0) {}
 
     virtual ~ORCaen5720Decoder() {}
 
-  enum ECaen5720Consts { kEventDataLen = 1024, kEventHeaderLen = 4, kWFLen = 2018 };
+  enum ECaen5720Consts { kEventDataLen = 1024, kEventHeaderLen = 4, kWFLen = 2018,
+                         kMaxChannels = 8, kSampleMask = 0x0fff };
 
 
 	 virtual inline UInt_t CardOf(UInt_t* /*record*/)
@@ -49,11 +49,28 @@ class ORCaen5720Decoder : public ORVDataDecoder
          virtual inline bool Packed(UInt_t* record) 
                 { return (record[1]>>0  & 0x1);}
 
+         virtual UInt_t NumberOfChannels(UInt_t* record);
+
+         //! Number of samples in each trace, after expanding ZLE data.
        	 virtual UInt_t TraceLength(UInt_t* record);
 
   /**************************************************************************
-   // Copy waveforms iteratively because hte packed2.5 data requires it
+   // Zero length encoding is a board setting that is not flagged in the
+   // event, so it has to be set by the user.  Samples that the board
+   // suppressed are filled with the fill value.
+   *************************************************************************/
+         virtual void SetZeroLengthEncoded(bool zle) { fZeroLengthEncoded = zle; }
+         virtual bool IsZeroLengthEncoded() { return fZeroLengthEncoded; }
+         virtual void SetZLEFillValue(UInt_t fillValue) { fZLEFillValue = fillValue; }
+         virtual UInt_t GetZLEFillValue() { return fZLEFillValue; }
+
+  /**************************************************************************
+   // Copy waveforms of any set of channels: waveforms[ch] receives at most
+   // maxSamples samples of channel ch, and is skipped if NULL or if ch is
+   // not in the channel mask.  Returns the number of samples per trace.
    *************************************************************************/
+        virtual UInt_t CopyChannelTraces(UInt_t* record, UInt_t** waveforms, UInt_t maxSamples);
+
         virtual void CopyTrace(UInt_t* record, UInt_t *Waveform, UInt_t numSamples); //trace of first active channel
 
         virtual void CopyTraces(UInt_t* record, UInt_t *Waveform0, UInt_t *Waveform1,UInt_t *Waveform2,UInt_t *Waveform3, UInt_t numSamples); //trace of all channels (inactive read 0);
@@ -66,6 +83,13 @@ class ORCaen5720Decoder : public ORVDataDecoder
         virtual inline std::string GetDictionaryObjectPath() 
                 { return "ORDT5720Model"; } 
 
+  protected:
+        virtual UInt_t ExpandZLEChannel(const UInt_t* channel, const UInt_t* end, UInt_t* waveform,
+                                        UInt_t maxSamples, bool packed);
+
+  protected:
+        bool fZeroLengthEncoded;
+        UInt_t fZLEFillValue;
 
 };
 
@@ -117,6 +117,11 @@ class ORDGF4cEventDecoder: public ORVDigitizerDecoder
     void Dump(UInt_t* dataRecord);
     
   protected:
+    virtual bool FillWaveformView(size_t event, ORWaveformView& view)
+      { view = ORWaveformView(GetWaveformDataPointer(fEventVector[event].first,
+                              fEventVector[event].second), GetEventWaveformLength(event),
+                              ORWaveformView::kUInt16, 0xffff, false); return true; }
+
     virtual size_t FillChannelPtrs(size_t iEvent);
     virtual inline const UShort_t* GetChannelPointer(size_t iEvent, size_t iChannel); 
 
@@ -0,0 +1,92 @@
+// ORDigitizerColumns.cc
+
+#include "ORDigitizerColumns.hh"
+#include "ORVDigitizerDecoder.hh"
+#include "ORLogger.hh"
+
+using namespace std;
+
+ORDigitizerColumns::ORDigitizerColumns(ORVDigitizerDecoder* decoder) :
+fDecoder(decoder), fStoreWaveforms(true), fWidth(0)
+{
+}
+
+bool ORDigitizerColumns::AddRecord(UInt_t* record)
+{
+  if (fDecoder == NULL) {
+    ORLog(kError) << "AddRecord(): no decoder" << endl;
+    return false;
+  }
+  if (!fDecoder->SetDataRecord(record)) return false;
+  UShort_t crate = fDecoder->CrateOf();
+  UShort_t card = fDecoder->CardOf();
+  size_t nEvents = fDecoder->GetNumberOfEvents();
+  for (size_t i=0; i<nEvents; i++) {
+    fTimes.push_back(fDecoder->GetEventTime(i));
+    fEnergies.push_back(fDecoder->GetEventEnergy(i));
+    fChannels.push_back(fDecoder->GetEventChannel(i));
+    fFlags.push_back(fDecoder->GetEventFlags(i));
+    fCrates.push_back(crate);
+    fCards.push_back(card);
+    if (fStoreWaveforms) AddWaveform(i);
+    else fWaveformLengths.push_back(0);
+  }
+  return true;
+}
+
+void ORDigitizerColumns::SetStoreWaveforms(bool store)
+{
+  if (store != fStoreWaveforms && GetNEvents() > 0) {
+    ORLog(kWarning) << "SetStoreWaveforms(): " << GetNEvents()
+                    << " events are already stored; call Clear() first" << endl;
+    return;
+  }
+  fStoreWaveforms = store;
+}
+
+size_t ORDigitizerColumns::AddRecords(const UInt_t* data, const UInt_t* offsets, size_t nRecords)
+{
+  size_t nAccepted = 0;
+  for (size_t i=0; i<nRecords; i++) {
+    // the decoders take non-const records, but don't change them
+    if (AddRecord(const_cast<UInt_t*>(data) + offsets[i])) nAccepted++;
+  }
+  return nAccepted;
+}
+
+void ORDigitizerColumns::AddWaveform(size_t event)
+{
+  // the new event has already been added to the other columns
+  size_t row = fTimes.size() - 1;
+  ORWaveformView view = fDecoder->GetWaveformView(event);
+  size_t length = view.IsEmpty() ? 0 : view.GetLength();
+  fWaveformLengths.push_back(length);
+  if (fWidth == 0) {
+    fWidth = length;
+    if (fWidth == 0) return;
+    // rows for earlier events without waveforms
+    fWaveforms.assign(row*fWidth, 0);
+  }
+  fWaveforms.resize((row + 1)*fWidth, 0);
+  if (length > 0) view.CopyTo(&fWaveforms[row*fWidth], fWidth);
+}
+
+void ORDigitizerColumns::Clear()
+{
+  fTimes.clear();
+  fEnergies.clear();
+  fChannels.clear();
+  fFlags.clear();
+  fCrates.clear();
+  fCards.clear();
+  fWaveformLengths.clear();
+  fWaveforms.clear();
+}
+
+size_t ORDigitizerColumns::GetMemoryUsage() const
+{
+  return fTimes.capacity()*sizeof(ULong64_t) + fEnergies.capacity()*sizeof(UInt_t) +
+    fChannels.capacity()*sizeof(UShort_t) + fFlags.capacity()*sizeof(UInt_t) +
+    fCrates.capacity()*sizeof(UShort_t) + fCards.capacity()*sizeof(UShort_t) +
+    fWaveformLengths.capacity()*sizeof(UInt_t) + fWaveforms.capacity()*sizeof(Float_t);
+}
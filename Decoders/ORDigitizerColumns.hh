@@ -0,0 +1,99 @@
+// ORDigitizerColumns.hh
+
+#ifndef _ORDigitizerColumns_hh_
+#define _ORDigitizerColumns_hh_
+
+#include <vector>
+#ifndef ROOT_Rtypes
+#include "Rtypes.h"
+#endif
+
+class ORVDigitizerDecoder;
+
+//! Decodes digitizer records into one array per quantity.
+/*!
+    Every event of the records given to AddRecord() or AddRecords() adds
+    one entry to each column: time, energy, channel, flags, crate and card,
+    as given by the ORVDigitizerDecoder, and one row of
+    GetWaveformWidth() samples to the waveforms, a 2D array in row-major
+    order.  The rows all have the same width: set with SetWaveformWidth(),
+    or else the length of the first waveform, kept after Clear() so that
+    batches can be concatenated.  Longer waveforms are cut,
+    shorter ones padded with zeros; GetWaveformLengths() has the length of
+    each before that.  The samples are converted with
+    ORWaveformView::CopyTo(), masked and sign-extended.
+
+    The columns are plain arrays, e.g. for the python bindings to hand them
+    to numpy without copying (see ORPyDigitizerColumns).  They stay valid
+    until the next AddRecord(), AddRecords() or Clear(); Clear() keeps the
+    memory, so that filling the columns batch after batch does not
+    allocate once the largest batch has been seen.
+
+    The records must already be in the byte order of the machine, as they
+    are in processors.
+ */
+class ORDigitizerColumns
+{
+  public:
+    ORDigitizerColumns(ORVDigitizerDecoder* decoder = NULL);
+    virtual ~ORDigitizerColumns() {}
+
+    virtual void SetDecoder(ORVDigitizerDecoder* decoder) { fDecoder = decoder; }
+    virtual ORVDigitizerDecoder* GetDecoder() { return fDecoder; }
+
+    //! Samples per waveform row; 0 (default) for the length of the first waveform.
+    /*!
+        Call before adding records or after Clear().
+     */
+    virtual void SetWaveformWidth(size_t nSamples) { fWidth = nSamples; }
+    //! Set false to decode only the scalar columns.
+    /*!
+        Call before adding records or after Clear(); ignored otherwise, so
+        that the waveform rows stay those of the events.
+     */
+    virtual void SetStoreWaveforms(bool store = true);
+
+    //! Adds the events of a record; false if the decoder rejects it.
+    virtual bool AddRecord(UInt_t* record);
+    //! Adds nRecords records, record i being data[offsets[i]] to data[offsets[i+1]].
+    /*!
+        This is the layout of the batches of ORPyDataProcessor.  Returns
+        the number of records the decoder accepted.
+     */
+    virtual size_t AddRecords(const UInt_t* data, const UInt_t* offsets, size_t nRecords);
+    virtual void Clear();
+
+    virtual size_t GetNEvents() const { return fTimes.size(); }
+    virtual const ULong64_t* GetTimes() const { return Data(fTimes); }
+    virtual const UInt_t* GetEnergies() const { return Data(fEnergies); }
+    virtual const UShort_t* GetChannels() const { return Data(fChannels); }
+    virtual const UInt_t* GetFlags() const { return Data(fFlags); }
+    virtual const UShort_t* GetCrates() const { return Data(fCrates); }
+    virtual const UShort_t* GetCards() const { return Data(fCards); }
+    virtual const UInt_t* GetWaveformLengths() const { return Data(fWaveformLengths); }
+    //! GetNEvents() rows of GetWaveformWidth() samples.
+    virtual const Float_t* GetWaveforms() const { return Data(fWaveforms); }
+    virtual size_t GetWaveformWidth() const { return fWidth; }
+
+    virtual size_t GetMemoryUsage() const;
+
+  protected:
+    template<typename T> static const T* Data(const std::vector<T>& v)
+      { return v.empty() ? NULL : &v[0]; }
+    virtual void AddWaveform(size_t event);
+
+    ORVDigitizerDecoder* fDecoder;
+    bool fStoreWaveforms;
+    size_t fWidth;            // 0 until the first waveform
+
+    std::vector<ULong64_t> fTimes;
+    std::vector<UInt_t> fEnergies;
+    std::vector<UShort_t> fChannels;
+    std::vector<UInt_t> fFlags;
+    std::vector<UShort_t> fCrates;
+    std::vector<UShort_t> fCards;
+    std::vector<UInt_t> fWaveformLengths;
+    std::vector<Float_t> fWaveforms;
+};
+
+#endif
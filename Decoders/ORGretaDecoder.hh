@@ -103,6 +103,10 @@ class ORGretaDecoder: public ORVDigitizerDecoder
     void Dump(UInt_t* dataRecord);
     
   protected:
+    virtual bool FillWaveformView(size_t /*event*/, ORWaveformView& view)
+      { view = ORWaveformView(GetWaveformDataPointer(), GetWaveformLen(),
+                              ORWaveformView::kPacked16In32, fBitMask, false); return true; }
+
     /* GetRecordOffset() returns how many words the record is offset from the 
        beginning.  This is useful when additional headers are added. */
     virtual inline size_t GetRecordOffset() {return 2;}
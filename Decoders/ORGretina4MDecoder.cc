@@ -6,7 +6,8 @@
 
 using namespace std;
 
-ORGretina4MDecoder::ORGretina4MDecoder() 
+ORGretina4MDecoder::ORGretina4MDecoder() :
+fMRWindowStart(0), fMRWindowLength(kWFLen)
 {
 }
 
@@ -25,6 +26,7 @@ void ORGretina4MDecoder::SetDecoderDictionary(const ORDecoderDictionary* dict)
 {
   ORVDataDecoder::SetDecoderDictionary(dict);
   for(UInt_t iPar = 0; iPar < kNPars; iPar++) fCardPars[iPar].clear();
+  fMultiRateInfo.clear();
 }
 
 UInt_t ORGretina4MDecoder::GetCardParameter(ECardPars par, UInt_t crate, UInt_t card)
@@ -49,13 +51,15 @@ UInt_t ORGretina4MDecoder::GetParameter(UInt_t par, UInt_t ccc)
   // otherwise we have to look up the info from the header
   // first find a key
   const char* key = "";
-  if(par == kIntTime) key = "Integration Time";
-  //if(par == kChPreSum) key = "Chpsrt";
-  if(par == kChPreSum) key = "Enabled";
-  if(par == kChPreSum) key = "Mrpsrt";
-  else {
-    ORLog(kError) << "Unknown card parameter " << par << endl;
-    return (UInt_t) -1;
+  switch(par) {
+    case kIntTime: key = "Integration Time"; break;
+    case kChPreSum: key = "Chpsrt"; break;
+    case kMRPreSum: key = "Mrpsrt"; break;
+    case kChPreSumDiv: key = "Chpsdv"; break;
+    case kMRPreSumDiv: key = "Mrpsdv"; break;
+    default:
+      ORLog(kError) << "Unknown card parameter " << par << endl;
+      return (UInt_t) -1;
   }
 
   // now pull out the value for the key
@@ -64,7 +68,16 @@ UInt_t ORGretina4MDecoder::GetParameter(UInt_t par, UInt_t ccc)
   UInt_t ch = (ccc & 0xf);
   UInt_t value = 0;
   if(par < kNCardPars) value = GetIntValueFromKey(key, cr, ca);
-  else value = dynamic_cast<const ORDictValueI*>(GetArrayFromKey(key, cr, ca)->At(ch))->GetI();
+  else {
+    const ORDictValueA* array = GetArrayFromKey(key, cr, ca);
+    const ORDictValueI* element = (array == NULL || ch >= array->GetNValues()) ? NULL :
+      dynamic_cast<const ORDictValueI*>(array->At(ch));
+    if(element == NULL) {
+      ORLog(kWarning) << "No " << key << " for crate " << cr << ", card " << ca
+                      << ", channel " << ch << "; using 0" << endl;
+    }
+    else value = element->GetI();
+  }
 
   // cache locally and return
   fCardPars[par][ccc] = value;
@@ -88,3 +101,169 @@ UInt_t ORGretina4MDecoder::GetEnergy(UInt_t* header)
   return energy;
 }
 
+
+void ORGretina4MDecoder::SetMultiRateWindow(size_t firstSample, size_t nSamples)
+{
+  if(firstSample > kWFLen) firstSample = kWFLen;
+  if(nSamples > kWFLen - firstSample) nSamples = kWFLen - firstSample;
+  fMRWindowStart = firstSample;
+  fMRWindowLength = nSamples;
+}
+
+const ORGretina4MDecoder::MultiRateInfo& ORGretina4MDecoder::GetMultiRateInfo(size_t iEvent)
+{
+  UInt_t crate = CrateOf(), card = CardOf(), channel = GetEventChannel(iEvent);
+  UInt_t ccc = (crate << 12) + (card << 4) + channel;
+  map<UInt_t, MultiRateInfo>::iterator iter = fMultiRateInfo.find(ccc);
+  if(iter != fMultiRateInfo.end()) return iter->second;
+
+  // rates and dividers are powers of 2; anything above 2^16 is taken as bad
+  UInt_t chRate = GetChannelParameter(kChPreSum, crate, card, channel);
+  UInt_t mrRate = GetChannelParameter(kMRPreSum, crate, card, channel);
+  UInt_t chDiv = GetChannelParameter(kChPreSumDiv, crate, card, channel);
+  UInt_t mrDiv = GetChannelParameter(kMRPreSumDiv, crate, card, channel);
+  if(chRate > 16) chRate = 0;
+  if(mrRate > 16) mrRate = 0;
+  if(chDiv > 16) chDiv = 0;
+  if(mrDiv > 16) mrDiv = 0;
+
+  MultiRateInfo& info = fMultiRateInfo[ccc];
+  info.fChPreSum = 1 << chRate;
+  info.fMRPreSum = 1 << mrRate;
+  info.fChScale = double(1 << chDiv) / info.fChPreSum;
+  info.fMRScale = info.fChScale * double(1 << mrDiv) / info.fMRPreSum;
+  return info;
+}
+
+double ORGretina4MDecoder::GetEnergyWFSamplingFrequency(size_t iEvent)
+{
+  const MultiRateInfo& info = GetMultiRateInfo(iEvent);
+  return GetSamplingFrequency() / (info.fChPreSum * info.fMRPreSum);
+}
+
+double ORGretina4MDecoder::GetRisingEdgeWFSamplingFrequency(size_t iEvent)
+{
+  return GetSamplingFrequency() / GetMultiRateInfo(iEvent).fChPreSum;
+}
+
+size_t ORGretina4MDecoder::GetEnergyWFLength(size_t iEvent)
+{
+  UInt_t mrPreSum = GetMultiRateInfo(iEvent).fMRPreSum;
+  return kWFLen - fMRWindowLength + (fMRWindowLength + mrPreSum - 1) / mrPreSum;
+}
+
+size_t ORGretina4MDecoder::GetFullRateWFLength(size_t iEvent)
+{
+  return (kWFLen - fMRWindowLength) * GetMultiRateInfo(iEvent).fMRPreSum + fMRWindowLength;
+}
+
+// Kernels for the multi-rate waveforms: plain loops over the samples, with
+// the scale factors hoisted, that the compiler can vectorize.
+
+template<typename T>
+static void ORGretina4MScale(const Short_t* in, size_t n, double scale, T* out)
+{
+  const T s = scale;
+  for(size_t i = 0; i < n; i++) out[i] = s * in[i];
+}
+
+template<typename T>
+static void ORGretina4MUpsample(const Short_t* in, size_t n, UInt_t factor, double scale, T* out)
+{
+  const T s = scale;
+  for(size_t i = 0; i < n; i++) {
+    const T value = s * in[i];
+    for(UInt_t j = 0; j < factor; j++) out[i*factor + j] = value;
+  }
+}
+
+template<typename T>
+static size_t ORGretina4MDownsample(const Short_t* in, size_t n, UInt_t factor, double scale, T* out)
+{
+  const T s = scale / factor;
+  size_t nOut = n / factor;
+  for(size_t i = 0; i < nOut; i++) {
+    Int_t sum = 0;
+    for(UInt_t j = 0; j < factor; j++) sum += in[i*factor + j];
+    out[i] = s * sum;
+  }
+  size_t nLeft = n - nOut*factor;
+  if(nLeft > 0) {
+    // average of the last, incomplete group
+    Int_t sum = 0;
+    for(size_t j = 0; j < nLeft; j++) sum += in[nOut*factor + j];
+    out[nOut++] = T(scale) * sum / T(nLeft);
+  }
+  return nOut;
+}
+
+template<typename T>
+static size_t ORGretina4MCopyEnergyWF(const Short_t* wf, const ORGretina4MDecoder::MultiRateInfo& info,
+                                      size_t windowStart, size_t windowLength, T* out)
+{
+  size_t nAfter = ORGretina4MDecoder::kWFLen - windowStart - windowLength;
+  size_t n = 0;
+  ORGretina4MScale(wf, windowStart, info.fMRScale, out);
+  n += windowStart;
+  n += ORGretina4MDownsample(wf + windowStart, windowLength, info.fMRPreSum, info.fChScale, out + n);
+  ORGretina4MScale(wf + windowStart + windowLength, nAfter, info.fMRScale, out + n);
+  return n + nAfter;
+}
+
+template<typename T>
+static size_t ORGretina4MCopyFullRateWF(const Short_t* wf, const ORGretina4MDecoder::MultiRateInfo& info,
+                                        size_t windowStart, size_t windowLength, T* out)
+{
+  size_t nAfter = ORGretina4MDecoder::kWFLen - windowStart - windowLength;
+  size_t n = 0;
+  ORGretina4MUpsample(wf, windowStart, info.fMRPreSum, info.fMRScale, out);
+  n += windowStart * info.fMRPreSum;
+  ORGretina4MScale(wf + windowStart, windowLength, info.fChScale, out + n);
+  n += windowLength;
+  ORGretina4MUpsample(wf + windowStart + windowLength, nAfter, info.fMRPreSum, info.fMRScale, out + n);
+  return n + nAfter * info.fMRPreSum;
+}
+
+size_t ORGretina4MDecoder::CopyEnergyWF(size_t iEvent, Float_t* waveform, size_t maxLen)
+{
+  if(maxLen < GetEnergyWFLength(iEvent)) return 0;
+  return ORGretina4MCopyEnergyWF(WFPS(iEvent), GetMultiRateInfo(iEvent), fMRWindowStart,
+                                 fMRWindowLength, waveform);
+}
+
+size_t ORGretina4MDecoder::CopyEnergyWF(size_t iEvent, Double_t* waveform, size_t maxLen)
+{
+  if(maxLen < GetEnergyWFLength(iEvent)) return 0;
+  return ORGretina4MCopyEnergyWF(WFPS(iEvent), GetMultiRateInfo(iEvent), fMRWindowStart,
+                                 fMRWindowLength, waveform);
+}
+
+size_t ORGretina4MDecoder::CopyRisingEdgeWF(size_t iEvent, Float_t* waveform, size_t maxLen)
+{
+  if(maxLen < fMRWindowLength) return 0;
+  ORGretina4MScale(WFPS(iEvent) + fMRWindowStart, fMRWindowLength,
+                   GetMultiRateInfo(iEvent).fChScale, waveform);
+  return fMRWindowLength;
+}
+
+size_t ORGretina4MDecoder::CopyRisingEdgeWF(size_t iEvent, Double_t* waveform, size_t maxLen)
+{
+  if(maxLen < fMRWindowLength) return 0;
+  ORGretina4MScale(WFPS(iEvent) + fMRWindowStart, fMRWindowLength,
+                   GetMultiRateInfo(iEvent).fChScale, waveform);
+  return fMRWindowLength;
+}
+
+size_t ORGretina4MDecoder::CopyFullRateWF(size_t iEvent, Float_t* waveform, size_t maxLen)
+{
+  if(maxLen < GetFullRateWFLength(iEvent)) return 0;
+  return ORGretina4MCopyFullRateWF(WFPS(iEvent), GetMultiRateInfo(iEvent), fMRWindowStart,
+                                   fMRWindowLength, waveform);
+}
+
+size_t ORGretina4MDecoder::CopyFullRateWF(size_t iEvent, Double_t* waveform, size_t maxLen)
+{
+  if(maxLen < GetFullRateWFLength(iEvent)) return 0;
+  return ORGretina4MCopyFullRateWF(WFPS(iEvent), GetMultiRateInfo(iEvent), fMRWindowStart,
+                                   fMRWindowLength, waveform);
+}
@@ -25,9 +25,18 @@ class ORGretina4MDecoder : public ORVDigitizerDecoder
     enum EChanPars { 
       kChPreSum = kNCardPars, // channel presum (n samples)
       kMRPreSum, // additional presum for multi-rate mode (i.e. for baseline, flattop)
+      kChPreSumDiv, // right shift applied to the channel presum
+      kMRPreSumDiv, // right shift applied to the multi-rate presum
       kNPars, 
       kNChanPars = kNPars-kNCardPars
     };
+    // presum settings of a channel, in the form the kernels use them
+    struct MultiRateInfo {
+      UInt_t fChPreSum; // channel presum factor
+      UInt_t fMRPreSum; // multi-rate presum factor
+      double fChScale; // channel presum divider / factor
+      double fMRScale; // both dividers / both factors
+    };
 
     ORGretina4MDecoder();
     virtual ~ORGretina4MDecoder() {}
@@ -51,13 +60,41 @@ class ORGretina4MDecoder : public ORVDigitizerDecoder
     virtual inline UInt_t GetEventWaveformPoint(size_t iEvent, size_t iSample) { return WFPS(iEvent)[iSample]; }
     virtual inline Short_t GetSignedWaveformSample(size_t iEvent, size_t iSample) { return WFPS(iEvent)[iSample]; }
 
+    // Multi-rate waveforms. The hybrid waveform consists of samples presummed
+    // by the channel and the multi-rate presum before and after a window
+    // around the rising edge, and of samples presummed by the channel presum
+    // only inside the window. The presum factors (2^Chpsrt, 2^Mrpsrt) and
+    // dividers (right shifts Chpsdv, Mrpsdv) are read from the header and
+    // cached per channel. The window position is not in the header, so it
+    // has to be set with SetMultiRateWindow(); by default the whole waveform
+    // is taken to be in the window. All kernels write into caller-provided
+    // buffers, return the number of samples written (0 if maxLen is too
+    // small), and scale the samples to the mean ADC value per ADC clock
+    // tick, so that all parts of the waveform are on the same scale.
+    virtual void SetMultiRateWindow(size_t firstSample, size_t nSamples);
+    virtual size_t GetMultiRateWindowStart() { return fMRWindowStart; }
+    virtual size_t GetMultiRateWindowLength() { return fMRWindowLength; }
+    virtual const MultiRateInfo& GetMultiRateInfo(size_t iEvent);
+
     // energy waveform: pre-sum and shift every N samples of rising-edge portion
     // as necessary to get one waveform of constant sampling frequency
-    //virtual double GetEnergyWFSamplingFrequency(); // in GHz. 
+    virtual double GetEnergyWFSamplingFrequency(size_t iEvent); // in GHz. 
+    virtual size_t GetEnergyWFLength(size_t iEvent);
+    virtual size_t CopyEnergyWF(size_t iEvent, Float_t* waveform, size_t maxLen);
+    virtual size_t CopyEnergyWF(size_t iEvent, Double_t* waveform, size_t maxLen);
 
     // rising edge waveform: access to everything that is at the highest
     // sampling frequency
-    //virtual double GetRisingEdgeWFSamplingFrequency(); // in GHz. 
+    virtual double GetRisingEdgeWFSamplingFrequency(size_t iEvent); // in GHz. 
+    virtual size_t GetRisingEdgeWFLength(size_t /*iEvent*/) { return fMRWindowLength; }
+    virtual size_t CopyRisingEdgeWF(size_t iEvent, Float_t* waveform, size_t maxLen);
+    virtual size_t CopyRisingEdgeWF(size_t iEvent, Double_t* waveform, size_t maxLen);
+
+    // full-rate waveform: the whole hybrid waveform at the highest sampling
+    // frequency, repeating each presummed sample
+    virtual size_t GetFullRateWFLength(size_t iEvent);
+    virtual size_t CopyFullRateWF(size_t iEvent, Float_t* waveform, size_t maxLen);
+    virtual size_t CopyFullRateWF(size_t iEvent, Double_t* waveform, size_t maxLen);
 
     // Other available digitizer information
     virtual inline UShort_t GetBoardSerialNumber(size_t iEvent) 
@@ -72,6 +109,10 @@ class ORGretina4MDecoder : public ORVDigitizerDecoder
       { return GetCardParameter(kIntTime, CrateOf(), CardOf()); }
 
   protected:
+    virtual bool FillWaveformView(size_t event, ORWaveformView& view)
+      { view = ORWaveformView(WFPS(event), kWFLen,
+                              ORWaveformView::kUInt16, 0xffff, true); return true; }
+
     // fast pointer to event data
     virtual UInt_t* EP(size_t iEvent) { return fDataRecord + 2 + iEvent*kEventDataLen; } 
 
@@ -89,6 +130,9 @@ class ORGretina4MDecoder : public ORVDigitizerDecoder
 
   protected:
     std::map< UInt_t, std::map<UInt_t, UInt_t> > fCardPars;
+    std::map<UInt_t, MultiRateInfo> fMultiRateInfo;
+    size_t fMRWindowStart;
+    size_t fMRWindowLength;
 };
 
 #endif
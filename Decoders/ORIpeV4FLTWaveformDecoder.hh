@@ -69,6 +69,11 @@ class ORIpeV4FLTWaveformDecoder: public ORVDigitizerDecoder
     //debugging:
     void Dump(UInt_t* dataRecord);
     
+  protected:
+    // samples as CopyWaveformData() unpacks them
+    virtual bool FillWaveformView(size_t /*event*/, ORWaveformView& view)
+      { view = ORWaveformView(GetWaveformDataPointer(), GetWaveformLen(),
+                              ORWaveformView::kPacked16In32, 0xffff, false); return true; }
 };
 
 //inline functions: ************************************************************************
@@ -44,6 +44,10 @@ class ORJAMFADCDecoder : public ORVHistDecoder, public ORVBasicRDTreeDecoder
       { return double(IthADCValueOf(record, i)); }
     virtual inline double GetY(UInt_t* record, size_t i) 
       { return double(IthChannelOf(record, i)); }
+    virtual inline void DecodeEntries(UInt_t* record, size_t nEntries, double* x,
+                                      double* y, double* /*z*/, double* w)
+      { for (size_t i = 0; i < nEntries; i++) {
+          x[i] = record[3+i] & 0xffff; y[i] = (record[3+i] & 0xf0000) >> 16; w[i] = 1.0; } }
 
     // for basic trees
     virtual size_t GetNPars() { return 4; }
@@ -56,6 +56,10 @@ class ORMotionNodeDecoder: public ORVDigitizerDecoder
     virtual UInt_t GetEventWaveformPoint( size_t /*event*/, 
 										  size_t waveformPoint );
 
+  protected:
+    virtual bool FillWaveformView(size_t /*event*/, ORWaveformView& view)
+      { view = ORWaveformView(GetWaveformDataPointer(), GetWaveformLength(),
+                              ORWaveformView::kUInt32, 0xffffffff, WaveformDataIsSigned()); return true; }
 };
 
 //inline functions: ************************************************************************
@@ -33,33 +33,15 @@ bool ORSIS3302GenericDecoder::SetDataRecord(UInt_t* dataRecord)
     if (lenOfRecord - kOrcaHeaderLen == len) {
 	fWaveformDataPtr =  fDataRecord + GetRecordOffset();
         return true;
+    }
+    // Long waveforms come in several records
+    ORFragmentReassembler::EStatus status = fReassembler.AddFragment(crate, card, channel, len,
+      dataRecord + kOrcaHeaderLen, lenOfRecord - kOrcaHeaderLen);
+    if (status == ORFragmentReassembler::kComplete) {
+        fWaveformDataPtr = (UInt_t*) fReassembler.GetData(crate, card, channel);
     } else {
-      WFKey key = (( 0xFF & crate) << 24) + 
-                  (( 0xFF & card ) << 16) +
-                  (( 0xFF & channel) << 8); 
-      WFVec& vec = fWFCache[key].first;
-      bool&  isFullWF = fWFCache[key].second;
-      if (vec.size() + (lenOfRecord - kOrcaHeaderLen) == len) {
-        // Append
-	vec.insert(vec.end(), &dataRecord[4], &dataRecord[4] + (lenOfRecord -
-          kOrcaHeaderLen)); 
-        fWaveformDataPtr = &vec[0];
-        isFullWF = true;
-      } else {
-        if (vec.size() == 0) {
-          // Means this is the first cache entry, be sure we have set the WF flag
-          isFullWF = false;
-        }
-        if (isFullWF) {
-          // Means we are resetting a previously full waveform
-          isFullWF = false;
-          vec.resize(0);
-        }
-	vec.insert(vec.end(), &dataRecord[4], &dataRecord[4] + (lenOfRecord -
-          kOrcaHeaderLen)); 
         fWaveformDataPtr = NULL;
         fNumberOfEvents = 0;
-      } 
     }
     
     return true;
@@ -107,6 +89,16 @@ size_t ORSIS3302GenericDecoder::CopyWaveformDataDouble(double* waveform, size_t
 
 /* Card/Channel settings, parameters. */
 
+void ORSIS3302GenericDecoder::EndRun()
+{
+  // partial traces do not carry over into the next run
+  if (fReassembler.GetNCompleted() + fReassembler.GetNTimedOut() + fReassembler.GetNErrors() > 0) {
+    fReassembler.ReportStatistics();
+  }
+  fReassembler.ReleaseMemory();
+  fWaveformDataPtr = NULL;
+}
+
 //Error checking: **********************************************************************
 
 
@@ -4,6 +4,7 @@
 #define _ORSIS3302GenericDecoder_hh_
 
 #include "ORVDigitizerDecoder.hh"
+#include "ORFragmentReassembler.hh"
 
 class ORSIS3302GenericDecoder: public ORVDigitizerDecoder
 {
@@ -64,6 +65,13 @@ public:
     //debugging:
     void Dump(UInt_t* dataRecord);
 
+    //! Reassembly of waveforms longer than a record, e.g. to set its timeout.
+    virtual ORFragmentReassembler& GetReassembler() { return fReassembler; }
+    virtual size_t GetMemoryUsage() const
+      { return ORVDigitizerDecoder::GetMemoryUsage() + fReassembler.GetBytesAllocated(); }
+    virtual void ReduceMemory() { fReassembler.ReleaseIdleMemory(); }
+    virtual void EndRun();
+
     enum EClockType
     {
       k100MHzBad = 0,
@@ -79,13 +87,14 @@ public:
     UInt_t GetAveragingForChannel(size_t chan); 
     EClockType GetClockType(); 
 protected:
+    virtual bool FillWaveformView(size_t /*event*/, ORWaveformView& view)
+      { view = ORWaveformView(GetWaveformDataPointer(), GetWaveformLen(),
+                              ORWaveformView::kPacked16In32, 0xffff, false); return true; }
+
     /* GetRecordOffset() returns how many words the record is offset from the 
 	 beginning.  This is useful when additional headers are added. */
     virtual inline size_t GetRecordOffset() {return kOrcaHeaderLen;}
-    typedef UInt_t WFKey;
-    typedef std::vector<UInt_t> WFVec;
-    typedef std::map<WFKey, std::pair<WFVec, bool> > WFCache; 
-    WFCache fWFCache;  // For very long waveforms
+    ORFragmentReassembler fReassembler;  // For very long waveforms
     size_t  fNumberOfEvents;
     UInt_t* fWaveformDataPtr;
 
@@ -101,6 +101,13 @@ class ORVDataDecoder
     virtual void SetDecoderDictionary(const ORDecoderDictionary* aDict) 
       { fDecoderDictionary = aDict; }
 
+    //! Bytes held in caches and buffers of the decoder, see ORMemoryMonitor.
+    virtual size_t GetMemoryUsage() const { return 0; }
+    //! Frees buffers the decoder can do without, see ORMemoryMonitor.
+    virtual void ReduceMemory() {}
+    //! Called after the processor using the decoder ends a run.
+    virtual void EndRun() {}
+
   protected:
     //! Hardware dictionary access functions.
     /**
@@ -1,7 +1,9 @@
 #ifndef _ORVDigitizerDecoder_hh_
 #define _ORVDigitizerDecoder_hh_
 #include <string>
+#include <vector>
 #include "ORVDataDecoder.hh"
+#include "ORWaveformView.hh"
 
 //! Defines an interface for Digitizer decoders.
 class ORVDigitizerDecoder: public ORVDataDecoder
@@ -53,8 +55,40 @@ class ORVDigitizerDecoder: public ORVDataDecoder
      * is actually unsigned.    */
     virtual Bool_t WaveformDataIsSigned() { return true; }
 
+    //! Bulk access to the waveform of an event.
+    /*!
+        Returns a view of the samples in the current record (see
+        ORWaveformView), so that whole waveforms can be read and converted
+        without a virtual call per sample.  Decoders describe their storage
+        by overriding FillWaveformView(); for those that do not, the
+        waveform is copied once with GetEventWaveformPoint() into a buffer
+        owned by the decoder, which the view then points to.
+     */
+    inline ORWaveformView GetWaveformView(size_t event);
+
+    //! Looks up a numeric hardware setting of a channel in the header.
+    /*!
+        key may hold an array with one value per channel or a single value
+        for the card.  Returns false if there is no such number.
+     */
+    inline bool GetChannelSetting(const std::string& key, UInt_t crate, UInt_t card,
+                                  UInt_t channel, Double_t& value);
+
+    virtual size_t GetMemoryUsage() const
+      { return fWaveformViewBuffer.capacity()*sizeof(UInt_t); }
+
+  protected:
+    //! Override to describe the storage of the waveform of event.
+    /*!
+        Should set view and return true, or return false to fall back to
+        GetEventWaveformPoint().
+     */
+    virtual bool FillWaveformView(size_t /*event*/, ORWaveformView& /*view*/)
+      { return false; }
+
   protected:
     UInt_t* fDataRecord;
+    std::vector<UInt_t> fWaveformViewBuffer;
     
 
 };
@@ -69,5 +103,34 @@ inline UInt_t ORVDigitizerDecoder::CardOf()
   return (fDataRecord[1] & 0x001f0000) >> 16; 
 }
 
+inline ORWaveformView ORVDigitizerDecoder::GetWaveformView(size_t event)
+{
+  ORWaveformView view;
+  if (FillWaveformView(event, view)) return view;
+  size_t length = GetEventWaveformLength(event);
+  if (length == 0) return view;
+  fWaveformViewBuffer.resize(length);
+  for (size_t i=0; i<length; i++) {
+    fWaveformViewBuffer[i] = GetEventWaveformPoint(event, i);
+  }
+  return ORWaveformView(&fWaveformViewBuffer[0], length, ORWaveformView::kUInt32,
+                        0xffffffff, WaveformDataIsSigned());
+}
+inline bool ORVDigitizerDecoder::GetChannelSetting(const std::string& key, UInt_t crate,
+                                                   UInt_t card, UInt_t channel, Double_t& value)
+{
+  const ORVDictValue* setting = GetValueFromKey(key, crate, card);
+  const ORDictValueA* array = dynamic_cast<const ORDictValueA*>(setting);
+  if (array != NULL) {
+    setting = (channel < array->GetNValues()) ? array->At(channel) : NULL;
+  }
+  if (setting == NULL) return false;
+  switch (setting->GetValueType()) {
+    case ORVDictValue::kInt: value = ((const ORDictValueI*) setting)->GetI(); return true;
+    case ORVDictValue::kReal: value = ((const ORDictValueR*) setting)->GetR(); return true;
+    case ORVDictValue::kBool: value = ((const ORDictValueB*) setting)->GetB(); return true;
+    default: return false;
+  }
+}
 
 #endif
@@ -28,6 +28,13 @@ class ORVHistDecoder : virtual public ORVDataDecoder
     virtual double GetWeight(UInt_t* /*record*/, size_t /*i*/) // optional: weight the entry
       { return 1.0; } 
 
+    // Bulk filling: decodes the GetNEntries(record) entries into x, y, z
+    // (y and z only for 2 and 3 dimensions, NULL otherwise) and w, which
+    // hold at least that many values. Decoders can override this to decode
+    // whole records without a virtual call per entry.
+    virtual inline void DecodeEntries(UInt_t* record, size_t nEntries, double* x,
+                                      double* y, double* z, double* w);
+
     // Optional: multi-dimensional
     virtual inline size_t GetNDim() { return 1; }
     virtual std::string GetYTitle() { return "Y"; }
@@ -42,4 +49,15 @@ class ORVHistDecoder : virtual public ORVDataDecoder
     virtual inline double GetZHi() { return GetNbinsZ() - 0.5; }
 };
 
+inline void ORVHistDecoder::DecodeEntries(UInt_t* record, size_t nEntries, double* x,
+                                          double* y, double* z, double* w)
+{
+  for (size_t i = 0; i < nEntries; i++) {
+    x[i] = GetX(record, i);
+    if (y != NULL) y[i] = GetY(record, i);
+    if (z != NULL) z[i] = GetZ(record, i);
+    w[i] = GetWeight(record, i);
+  }
+}
+
 #endif
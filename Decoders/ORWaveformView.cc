@@ -0,0 +1,120 @@
+// ORWaveformView.cc
+
+#include "ORWaveformView.hh"
+
+// The conversion loops below are instantiated separately for each output
+// type, layout and signedness, so that the inner loops have no branches and
+// no function calls and can be vectorized by the compiler.  Signed samples
+// are sign-extended by shifting the sign bit of the mask up to bit 31 and
+// arithmetically back down.
+
+template<typename TOut, typename TCalc, bool kSigned>
+static inline TOut ORWaveformViewConvert(UInt_t raw, UInt_t mask, int shift, TCalc baseline)
+{
+  if (kSigned) return (TOut) ((TCalc) (((Int_t) (raw << shift)) >> shift) - baseline);
+  return (TOut) ((TCalc) (raw & mask) - baseline);
+}
+
+template<typename TIn, typename TOut, typename TCalc, bool kSigned>
+static void ORWaveformViewConvertStrided(const TIn* in, size_t n, size_t stride, UInt_t mask,
+                                         int shift, TCalc baseline, TOut* out)
+{
+  if (stride == 1) {
+    for (size_t i=0; i<n; i++) {
+      out[i] = ORWaveformViewConvert<TOut, TCalc, kSigned>(in[i], mask, shift, baseline);
+    }
+  }
+  else {
+    for (size_t i=0; i<n; i++) {
+      out[i] = ORWaveformViewConvert<TOut, TCalc, kSigned>(in[i*stride], mask, shift, baseline);
+    }
+  }
+}
+
+template<typename TOut, typename TCalc, bool kSigned>
+static void ORWaveformViewConvertPacked(const UInt_t* in, size_t n, UInt_t mask,
+                                        int shift, TCalc baseline, TOut* out)
+{
+  size_t nWords = n/2;
+  for (size_t i=0; i<nWords; i++) {
+    UInt_t word = in[i];
+    out[2*i] = ORWaveformViewConvert<TOut, TCalc, kSigned>(word & 0xffff, mask, shift, baseline);
+    out[2*i+1] = ORWaveformViewConvert<TOut, TCalc, kSigned>(word >> 16, mask, shift, baseline);
+  }
+  if (n % 2 == 1) {
+    out[n-1] = ORWaveformViewConvert<TOut, TCalc, kSigned>(in[nWords] & 0xffff, mask, shift, baseline);
+  }
+}
+
+template<typename TOut, typename TCalc, bool kSigned>
+static void ORWaveformViewConvertAll(const ORWaveformView& view, size_t n, TCalc baseline, TOut* out)
+{
+  UInt_t mask = view.GetMask();
+  int shift = 32 - view.GetSignificantBits();
+  switch (view.GetLayout()) {
+    case ORWaveformView::kUInt16:
+      ORWaveformViewConvertStrided<UShort_t, TOut, TCalc, kSigned>((const UShort_t*) view.GetData(),
+        n, view.GetStride(), mask, shift, baseline, out);
+      break;
+    case ORWaveformView::kUInt32:
+      ORWaveformViewConvertStrided<UInt_t, TOut, TCalc, kSigned>((const UInt_t*) view.GetData(),
+        n, view.GetStride(), mask, shift, baseline, out);
+      break;
+    case ORWaveformView::kPacked16In32:
+      ORWaveformViewConvertPacked<TOut, TCalc, kSigned>((const UInt_t*) view.GetData(),
+        n, mask, shift, baseline, out);
+      break;
+  }
+}
+
+template<typename TOut, typename TCalc>
+static size_t ORWaveformViewCopy(const ORWaveformView& view, TOut* out, size_t maxLen, TCalc baseline)
+{
+  if (view.IsEmpty() || out == NULL) return 0;
+  size_t n = (view.GetLength() < maxLen) ? view.GetLength() : maxLen;
+  if (view.IsSigned()) ORWaveformViewConvertAll<TOut, TCalc, true>(view, n, baseline, out);
+  else ORWaveformViewConvertAll<TOut, TCalc, false>(view, n, baseline, out);
+  return n;
+}
+
+ORWaveformView::ORWaveformView() :
+fData(NULL), fLength(0), fStride(1), fLayout(kUInt16), fMask(0xffff), fIsSigned(false),
+fSignificantBits(16)
+{
+}
+
+ORWaveformView::ORWaveformView(const void* data, size_t length, ELayout layout,
+                               UInt_t mask, bool isSigned, size_t stride) :
+fData(data), fLength(length), fStride(stride), fLayout(layout), fMask(mask), fIsSigned(isSigned)
+{
+  if (fLayout != kUInt32) fMask &= 0xffff;
+  if (fLayout == kPacked16In32 || fStride == 0) fStride = 1;
+  fSignificantBits = 0;
+  while (fSignificantBits < 32 && (fMask >> fSignificantBits) != 0) fSignificantBits++;
+  if (fSignificantBits == 0) fIsSigned = false;
+}
+
+size_t ORWaveformView::CopyTo(Short_t* out, size_t maxLen, Int_t baseline) const
+{
+  return ORWaveformViewCopy<Short_t, Int_t>(*this, out, maxLen, baseline);
+}
+
+size_t ORWaveformView::CopyTo(Float_t* out, size_t maxLen, Float_t baseline) const
+{
+  return ORWaveformViewCopy<Float_t, Float_t>(*this, out, maxLen, baseline);
+}
+
+size_t ORWaveformView::CopyTo(Double_t* out, size_t maxLen, Double_t baseline) const
+{
+  return ORWaveformViewCopy<Double_t, Double_t>(*this, out, maxLen, baseline);
+}
+
+Double_t ORWaveformView::GetMean(size_t first, size_t n) const
+{
+  if (first >= fLength) return 0;
+  if (n > fLength - first) n = fLength - first;
+  if (n == 0) return 0;
+  Double_t sum = 0;
+  for (size_t i=first; i<first+n; i++) sum += GetSample(i);
+  return sum/n;
+}
@@ -0,0 +1,99 @@
+// ORWaveformView.hh
+
+#ifndef _ORWaveformView_hh_
+#define _ORWaveformView_hh_
+
+#include <cstddef>
+#ifndef ROOT_Rtypes
+#include "Rtypes.h"
+#endif
+
+//! Describes where and how the samples of a digitizer waveform are stored.
+/*!
+    Returned by ORVDigitizerDecoder::GetWaveformView(), so that consumers can
+    read or convert a whole waveform without a virtual call per sample.
+    Sample i is
+
+    kUInt16 - ((const UShort_t*) GetData())[i*GetStride()]
+    kUInt32 - ((const UInt_t*) GetData())[i*GetStride()]
+    kPacked16In32 - the low (even i) or high (odd i) 16 bits of
+                    ((const UInt_t*) GetData())[i/2]; the stride is always 1
+
+    masked with GetMask() and, if IsSigned(), sign-extended from the highest
+    bit of the mask.  The mask must be a contiguous run of low bits.
+
+    The view points into the decoder's current record, so it is only valid
+    until the next call to SetDataRecord().
+
+    The CopyTo() functions convert the whole waveform, optionally
+    subtracting a baseline, in tight loops that the compiler can vectorize:
+    \verbatim
+    ORWaveformView view = decoder->GetWaveformView(iEvent);
+    std::vector<Float_t> wf(view.GetLength());
+    view.CopyTo(&wf[0], wf.size(), view.GetMean(0, 100));
+    \endverbatim
+ */
+class ORWaveformView
+{
+  public:
+    enum ELayout { kUInt16, kUInt32, kPacked16In32 };
+
+    ORWaveformView();
+    ORWaveformView(const void* data, size_t length, ELayout layout,
+                   UInt_t mask, bool isSigned, size_t stride = 1);
+
+    const void* GetData() const { return fData; }
+    size_t GetLength() const { return fLength; }
+    size_t GetStride() const { return fStride; }
+    ELayout GetLayout() const { return fLayout; }
+    UInt_t GetMask() const { return fMask; }
+    bool IsSigned() const { return fIsSigned; }
+    bool IsEmpty() const { return fData == NULL || fLength == 0; }
+
+    //! Returns sample i, masked and sign-extended.
+    /*!
+        Meant for occasional access; use CopyTo() for whole waveforms.
+     */
+    inline Long64_t GetSample(size_t i) const;
+
+    //! Converts at most maxLen samples to out, subtracting baseline.
+    /*!
+        Returns the number of samples written.  The Short_t version is
+        truncated to 16 bits after subtracting the baseline.
+     */
+    size_t CopyTo(Short_t* out, size_t maxLen, Int_t baseline = 0) const;
+    size_t CopyTo(Float_t* out, size_t maxLen, Float_t baseline = 0) const;
+    size_t CopyTo(Double_t* out, size_t maxLen, Double_t baseline = 0) const;
+
+    //! Mean of n samples starting at first, e.g. a pre-trigger baseline.
+    Double_t GetMean(size_t first, size_t n) const;
+
+    //! Number of bits the sign is extended from, i.e. the width of the mask.
+    int GetSignificantBits() const { return fSignificantBits; }
+
+  protected:
+    const void* fData;
+    size_t fLength;
+    size_t fStride;
+    ELayout fLayout;
+    UInt_t fMask;
+    bool fIsSigned;
+    int fSignificantBits;
+};
+
+inline Long64_t ORWaveformView::GetSample(size_t i) const
+{
+  UInt_t raw;
+  switch (fLayout) {
+    case kUInt16: raw = ((const UShort_t*) fData)[i*fStride]; break;
+    case kUInt32: raw = ((const UInt_t*) fData)[i*fStride]; break;
+    default: raw = ((const UInt_t*) fData)[i/2] >> (16*(i%2)); break;
+  }
+  raw &= fMask;
+  if (fIsSigned && fSignificantBits > 0 && (raw >> (fSignificantBits-1)) != 0) {
+    return ((Long64_t) raw) - (((Long64_t) 1) << fSignificantBits);
+  }
+  return raw;
+}
+
+#endif
@@ -23,6 +23,8 @@ class ORIgorFileReader : public ORFileReader
     virtual size_t Read(char* buffer, size_t nBytes);
     virtual size_t ReadPartialLineWithCR(char* , size_t ) { return 0;} 
     virtual bool ReadRecord(std::vector<UInt_t>& buffer);
+    virtual bool ReadRecord(ORRecordHandle& record, ORRecordPool& pool)
+      { return ReadRecordViaBuffer(record, pool); }
 
   protected:
     virtual std::string ReadHeader();
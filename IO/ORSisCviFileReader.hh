@@ -23,6 +23,8 @@ class ORSisCviFileReader : public ORFileReader
     virtual size_t Read(char* buffer, size_t nBytes);
     virtual size_t ReadPartialLineWithCR(char* , size_t ) { return 0;} 
     virtual bool ReadRecord(std::vector<UInt_t>& buffer);
+    virtual bool ReadRecord(ORRecordHandle& record, ORRecordPool& pool)
+      { return ReadRecordViaBuffer(record, pool); }
 
   protected:
     enum ESISFileDelimiters { kEOF =  0xE0F0E0F, kBucketHeader = 0xABBAABBA, kEventTrailer = 0xDEADBEEF };
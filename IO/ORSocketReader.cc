@@ -3,6 +3,7 @@
 #include "ORSocketReader.hh"
 #include "ORLogger.hh"
 #include "ORUtils.hh"
+#include "ORTraceWriter.hh"
 #include <sys/socket.h>
 #include <sys/select.h>
 #include <sys/errno.h>
@@ -32,6 +33,12 @@ ORSocketReader::ORSocketReader(TSocket* aSocket, bool writable)
 ORSocketReader::~ORSocketReader()
 {
   StopThread();
+  if (fCircularBuffer.totalLostLongCount != 0) {
+    ORLog(kWarning) << "Socket has thrown away " << fCircularBuffer.totalLostLongCount
+      << " of " << fCircularBuffer.totalLongCount << " long words received ("
+      << 100.*fCircularBuffer.totalLostLongCount/fCircularBuffer.totalLongCount
+      << "%)" << std::endl;
+  }
   if (fCircularBuffer.buffer) delete [] fCircularBuffer.buffer;
   pthread_attr_destroy(&fThreadAttr);
   pthread_rwlock_destroy(&fCircularBuffer.cbMutex);
@@ -63,6 +70,33 @@ bool ORSocketReader::ThreadIsStillRunning()
   return threadIsStillRunning;
 }
 
+double ORSocketReader::GetBufferOccupancy()
+{
+  double occupancy = 0;
+  pthread_rwlock_rdlock(&fCircularBuffer.cbMutex);
+  if (fCircularBuffer.bufferLength > 0) {
+    occupancy = double(fCircularBuffer.amountInBuffer)/fCircularBuffer.bufferLength;
+  }
+  pthread_rwlock_unlock(&fCircularBuffer.cbMutex);
+  return occupancy;
+}
+
+ULong64_t ORSocketReader::GetNWordsReceived()
+{
+  pthread_rwlock_rdlock(&fCircularBuffer.cbMutex);
+  ULong64_t nWords = fCircularBuffer.totalLongCount;
+  pthread_rwlock_unlock(&fCircularBuffer.cbMutex);
+  return nWords;
+}
+
+ULong64_t ORSocketReader::GetNWordsLost()
+{
+  pthread_rwlock_rdlock(&fCircularBuffer.cbMutex);
+  ULong64_t nWords = fCircularBuffer.totalLostLongCount;
+  pthread_rwlock_unlock(&fCircularBuffer.cbMutex);
+  return nWords;
+}
+
 bool ORSocketReader::StartThread()
 {
   if (ThreadIsStillRunning()) return true;
@@ -142,7 +176,10 @@ size_t ORSocketReader::ReadFromCircularBuffer(UInt_t* buffer, size_t numLongWord
          is in the circular buffer, it waits. */
       /* unlock before we wait to not deadlock. */
       pthread_rwlock_unlock(&fCircularBuffer.cbMutex);
-      if (fSleepTime != 0) sleep(fSleepTime);
+      if (fSleepTime != 0) {
+        ORTraceSpan span("wait for socket data", "reader");
+        sleep(fSleepTime);
+      }
       /* Relock and keep it if we break out of this loop. */
       pthread_rwlock_rdlock(&fCircularBuffer.cbMutex);
       /* There is a sufficient amount in the buffer, read it out. */
@@ -320,6 +357,7 @@ void* SocketReadoutThread(void* input)
   /* Readout Thread which sucks info out of socket as fast as it can. */
   /* Currently, it throws data away that it can't process. */
   
+  ORTraceWriter::SetThreadName("socket reader");
   bool firstWordRead = false;
   bool mustSwap = false;
   Int_t numBytesRead = 0, numLongsToRead = 0, amountAbleToRead = 0, firstRead = 0,
@@ -391,6 +429,8 @@ void* SocketReadoutThread(void* input)
       pthread_rwlock_unlock(&socketReader->fCircularBuffer.cbMutex);
       pthread_rwlock_wrlock(&socketReader->fCircularBuffer.cbMutex);
       socketReader->fCircularBuffer.lostLongCount += numLongsToRead;
+      socketReader->fCircularBuffer.totalLostLongCount += numLongsToRead;
+      socketReader->fCircularBuffer.totalLongCount += numLongsToRead;
       pthread_rwlock_unlock(&socketReader->fCircularBuffer.cbMutex);
 
       while (numLongsToRead > 0) {
@@ -444,6 +484,7 @@ void* SocketReadoutThread(void* input)
     } 
     socketReader->fCircularBuffer.writeIndex += numBytesRead/sizeof(UInt_t);
     socketReader->fCircularBuffer.amountInBuffer += numBytesRead/sizeof(UInt_t);
+    socketReader->fCircularBuffer.totalLongCount += numBytesRead/sizeof(UInt_t);
 
     if (socketReader->fCircularBuffer.writeIndex 
         == socketReader->fCircularBuffer.bufferLength) {
@@ -463,6 +504,7 @@ void* SocketReadoutThread(void* input)
       } 
       socketReader->fCircularBuffer.writeIndex += numBytesRead/sizeof(UInt_t);
       socketReader->fCircularBuffer.amountInBuffer += numBytesRead/sizeof(UInt_t);
+      socketReader->fCircularBuffer.totalLongCount += numBytesRead/sizeof(UInt_t);
       socketReader->fCircularBuffer.wrapArounds++;
     }
 
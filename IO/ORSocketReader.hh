@@ -35,6 +35,8 @@ typedef struct {
    size_t           readIndex;
    size_t           lostLongCount;
    size_t           wrapArounds;
+   ULong64_t        totalLongCount;
+   ULong64_t        totalLostLongCount;
    bool             isRunning;
 } CircularBufferStruct;
 
@@ -87,6 +89,12 @@ class ORSocketReader : public ORVReader, public ORVSigHandler, public ORVWriter
     virtual void Close() { if(TestCancel() || !fSocketIsOK) StopThread(); } 
     virtual void SetCircularBufferLength(Int_t length) 
       { fBufferLength = length; }
+    //! Fill level of the circular buffer.
+    virtual double GetBufferOccupancy();
+    //! Long words that came off the socket since it was opened.
+    virtual ULong64_t GetNWordsReceived();
+    //! Of those, the long words thrown away because the circular buffer was full.
+    virtual ULong64_t GetNWordsLost();
     enum ESocketReaderConsts {kDefaultBufferLength = 0xFFFFFF};
 
     //! Writes onto the socket.
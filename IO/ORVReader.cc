@@ -49,16 +49,87 @@ bool ORVReader::ReadRecord(std::vector<UInt_t>& buffer)
     if (!stillOpen) return false;
   }
 
+  LogRecordRead(&buffer[0]);
+
+  return true;
+}
+
+bool ORVReader::ReadRecord(ORRecordHandle& record, ORRecordPool& pool)
+{
+  // Release the last record first: if nobody retained it, its buffer is
+  // the one we get back from the pool.
+  record.Reset();
+
+  if (!ReadFirstWord(fStagingBuffer)) return false;
+
+  // Headers are rare and may come in the old line-based format; read them
+  // into the staging buffer and copy.
+  if (fHeaderDecoder.IsHeader(fStagingBuffer[0])) {
+    ORLog(kDebug) << "Reading rest of header..." << std::endl;
+    if (!ReadRestOfHeader(fStagingBuffer)) return false;
+    size_t nLongs = fBasicDecoder.LengthOf(&fStagingBuffer[0]);
+    if (nLongs > fStagingBuffer.size()) nLongs = fStagingBuffer.size();
+    record = pool.Copy(&fStagingBuffer[0], nLongs);
+    if (!record.IsValid()) {
+      ORLog(kError) << "ReadRecord(): record pool refused a buffer for the header" << std::endl;
+      return false;
+    }
+    LogRecordRead(record.GetData());
+    return true;
+  }
+
+  size_t nLongs = fBasicDecoder.LengthOf(&fStagingBuffer[0]);
+  if (nLongs < 1) { 
+    ORLog(kError) << "Record length is less than one!" << std::endl;
+    return false;
+  }
+  record = pool.Acquire(nLongs);
+  if (!record.IsValid()) {
+    ORLog(kError) << "ReadRecord(): record pool refused a buffer of " << nLongs
+                  << " words: memory limit reached" << std::endl;
+    return false;
+  }
+  record[0] = fStagingBuffer[0];
+  if (nLongs > 1) {
+    size_t nBytesToRead = (nLongs-1)*4;
+    size_t nBytesRead = Read(((char*) record.GetData())+4, nBytesToRead);
+    if (nBytesRead != nBytesToRead) {
+      ORLog(kWarning) << "ReadRecord(): attempt to read " << nBytesToRead
+                      << " B only returned " << nBytesRead << "B "
+        	      << "(id = " << fBasicDecoder.DataIdOf(record.GetData()) << ", "
+        	      << "len = " << nLongs << ")" << std::endl;
+      return false;
+    }
+  }
+  LogRecordRead(record.GetData());
+  return true;
+}
+
+bool ORVReader::ReadRecordViaBuffer(ORRecordHandle& record, ORRecordPool& pool)
+{
+  record.Reset();
+  if (!ReadRecord(fStagingBuffer)) return false;
+  size_t nLongs = fBasicDecoder.LengthOf(&fStagingBuffer[0]);
+  if (nLongs > fStagingBuffer.size()) nLongs = fStagingBuffer.size();
+  record = pool.Copy(&fStagingBuffer[0], nLongs);
+  if (!record.IsValid()) {
+    ORLog(kError) << "ReadRecord(): record pool refused a buffer of " << nLongs
+                  << " words: memory limit reached" << std::endl;
+    return false;
+  }
+  return true;
+}
+
+void ORVReader::LogRecordRead(UInt_t* record)
+{
   if (ORLogger::GetSeverity() <= ORLogger::kDebug) { // check severity; improves speed
     char type = 'l';
-    if (fHeaderDecoder.IsHeader(buffer[0])) type = 'h';
-    else if (fBasicDecoder.IsShort(&buffer[0])) type = 's';
+    if (fHeaderDecoder.IsHeader(record[0])) type = 'h';
+    else if (fBasicDecoder.IsShort(record)) type = 's';
     ORLog(kDebug) << "ReadRecord(): " << type << ": id = " 
-                  << std::setw(11) << fBasicDecoder.DataIdOf(&buffer[0]) 
-		  << "\tlen = " << fBasicDecoder.LengthOf(&buffer[0]) << std::endl;
+                  << std::setw(11) << fBasicDecoder.DataIdOf(record) 
+		  << "\tlen = " << fBasicDecoder.LengthOf(record) << std::endl;
   }
-
-  return true;
 }
 
 size_t ORVReader::DeleteAndResizeBuffer(std::vector<UInt_t>& buffer, size_t newNLongsMax)
@@ -9,6 +9,9 @@
 #ifndef _ORBasicDataDecoder_hh
 #include "ORBasicDataDecoder.hh"
 #endif
+#ifndef _ORRecordPool_hh_
+#include "ORRecordPool.hh"
+#endif
 //! Virtual Reader class defining the interface for OrcaROOT Readers.
 /*!
 
@@ -39,6 +42,15 @@ class ORVReader
      */
     virtual bool ReadRecord(std::vector<UInt_t>& buffer); 
 
+    /*! 
+       ReadRecord into a buffer taken from pool.  On success, record refers
+       to a pooled buffer holding the record just read; the buffer previously
+       held by record is released first so that it can be reused.
+       Returns false at the end of the stream, on a read error, or if the pool
+       refused the buffer because its memory limit was reached.
+     */
+    virtual bool ReadRecord(ORRecordHandle& record, ORRecordPool& pool);
+
     virtual bool Open() { fStreamVersion = ORHeaderDecoder::kUnknownVersion; 
                           return OpenDataStream(); }
 
@@ -58,18 +70,29 @@ class ORVReader
      */
     inline bool MustSwap() { return fMustSwap; }
 
+    //! Fraction (0 to 1) of the reader's internal buffer in use, or -1 if it has none.
+    virtual double GetBufferOccupancy() { return -1; }
+
   protected:
     virtual size_t DeleteAndResizeBuffer(std::vector<UInt_t>& buffer, size_t newNLongsMax); 
     virtual void DetermineFileTypeAndSetupSwap(char* buffer);
     virtual bool ReadFirstWord(std::vector<UInt_t>& buffer);
     virtual bool ReadRestOfHeader(std::vector<UInt_t>& buffer);
     virtual bool ReadRestOfLongRecord(std::vector<UInt_t>& buffer);
+    /*!
+       Pooled ReadRecord for readers which overload
+       ReadRecord(std::vector<UInt_t>&): the record is read into a staging
+       buffer and copied into the pool.
+     */
+    virtual bool ReadRecordViaBuffer(ORRecordHandle& record, ORRecordPool& pool);
+    virtual void LogRecordRead(UInt_t* record);
 
   protected:
     ORHeaderDecoder::EOrcaStreamVersion fStreamVersion;
     ORBasicDataDecoder fBasicDecoder;
     ORHeaderDecoder fHeaderDecoder;
     bool fMustSwap;
+    std::vector<UInt_t> fStagingBuffer; // headers and non-ORCA formats
 };
 
 #endif
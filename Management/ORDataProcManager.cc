@@ -5,6 +5,11 @@
 #include "ORLogger.hh"
 #include "ORSocketReader.hh"
 #include "ORVWriter.hh"
+#include "ORTreeFillThread.hh"
+#include "ORProcessorStats.hh"
+#include "ORMemoryMonitor.hh"
+#include "ORTraceWriter.hh"
+#include "TROOT.h"
 #include <vector>
 
 ORDataProcManager::ORDataProcManager(ORVReader* reader, ORRunDataProcessor* runDataProc, ORHeaderProcessor* headerProc)
@@ -39,6 +44,11 @@ ORDataProcManager::ORDataProcManager(ORVReader* reader, ORRunDataProcessor* runD
     fRunDataProcessor->IncreaseHeartbeatVerbosity();
   }
   fRunAsDaemon = false;
+  fProcessorStats = NULL;
+  fReaderStatsId = -1;
+  fNRecordsRead = 0;
+  fMemoryMonitor = NULL;
+  fNRecordsToMemoryCheck = 0;
 }
 
 ORDataProcManager::~ORDataProcManager()
@@ -47,6 +57,104 @@ ORDataProcManager::~ORDataProcManager()
   if(fIOwnHeaderProcessor) delete fHeaderProcessor;
   /* This class owns fRunContext. */
   delete fRunContext;
+  delete fProcessorStats;
+  delete fMemoryMonitor;
+}
+
+void ORDataProcManager::EnableInstrumentation(bool enable)
+{
+  if (enable == (fProcessorStats != NULL)) return;
+  if (enable) {
+    fProcessorStats = new ORProcessorStats;
+    fReaderStatsId = fProcessorStats->Register("reader");
+  }
+  SetProcessorStats(enable ? fProcessorStats : NULL);
+  fRunDataProcessor->SetProcessorStats(enable ? fProcessorStats : NULL);
+  if (!enable) {
+    delete fProcessorStats;
+    fProcessorStats = NULL;
+  }
+}
+
+void ORDataProcManager::EnableMemoryAccounting(bool enable)
+{
+  if (enable && fMemoryMonitor == NULL) fMemoryMonitor = new ORMemoryMonitor;
+  if (!enable) {
+    delete fMemoryMonitor;
+    fMemoryMonitor = NULL;
+  }
+}
+
+void ORDataProcManager::SetMemoryBudget(size_t nBytes)
+{
+  EnableMemoryAccounting();
+  fMemoryMonitor->SetBudget(nBytes);
+}
+
+void ORDataProcManager::ReduceMemory()
+{
+  // the trees may not be touched while fills are queued
+  ORTreeFillThread::Sync();
+  ORCompoundDataProcessor::ReduceMemory();
+  fRecordPool.Trim();
+}
+
+void ORDataProcManager::UpdateMemoryMonitor()
+{
+  ORMemoryMonitor& monitor = *fMemoryMonitor;
+  AccountMemory(monitor);
+  monitor.Set(monitor.Register("record pool"), fRecordPool.GetBytesAllocated());
+  monitor.Set(monitor.Register("ORTreeFillThread queue"), ORTreeFillThread::GetQueuedBytes());
+  monitor.Set(monitor.Register("header"), fHeaderProcessor->GetHeader()->GetMemoryUsage());
+  if (!fRunAsDaemon) {
+    monitor.Set(monitor.Register("run data processor"), fRunDataProcessor->GetMemoryUsage());
+  }
+  monitor.SampleResident();
+}
+
+void ORDataProcManager::CheckMemoryBudget()
+{
+  // reading the resident size costs a system call; don't do it for every record
+  if (fNRecordsToMemoryCheck-- > 0) return;
+  fNRecordsToMemoryCheck = 4096;
+  if (!fMemoryMonitor->CheckBudget()) return;
+
+  ORTraceSpan span("ReduceMemory", "io");
+  ORLog(kWarning) << "CheckMemoryBudget(): resident size "
+                  << ORMemoryMonitor::FormatBytes(fMemoryMonitor->GetResidentBytes())
+                  << " is over the budget of "
+                  << ORMemoryMonitor::FormatBytes(fMemoryMonitor->GetBudget())
+                  << "; writing out buffers. Largest components:" << std::endl;
+  ReduceMemory();
+  UpdateMemoryMonitor();
+  fMemoryMonitor->Print(10);
+}
+
+bool ORDataProcManager::ReadRecord(ORRecordHandle& record)
+{
+  ORTraceWriter::NextRecord();
+  ORTraceSpan span("ReadRecord", "reader", true);
+  if (fProcessorStats == NULL) return fReader->ReadRecord(record, fRecordPool);
+
+  Double_t start = ORProcessorStats::Now();
+  bool isRead = fReader->ReadRecord(record, fRecordPool);
+  size_t nBytes = isRead ? fStatsDecoder.LengthOf(record.GetData())*sizeof(UInt_t) : 0;
+  fProcessorStats->Add(fReaderStatsId, ORProcessorStats::kRead, 0,
+                       ORProcessorStats::Now() - start, nBytes);
+  // sampling the occupancy takes the reader's lock; don't do it for every record
+  if (fNRecordsRead++ % 256 == 0) {
+    fProcessorStats->AddBufferOccupancy(fReader->GetBufferOccupancy());
+  }
+  return isRead;
+}
+
+void ORDataProcManager::ReportProcessorStats()
+{
+  if (fProcessorStats == NULL) return;
+  fProcessorStats->Print();
+  // write to the output file if there is one (see ORFileWriter::EndRun())
+  if (gDirectory != NULL && gDirectory->GetFile() != NULL) fProcessorStats->Write();
+  fProcessorStats->Reset();
 }
 
 ORDataProcManager::EReturnCode ORDataProcManager::ProcessDataStream()
@@ -58,6 +166,7 @@ ORDataProcManager::EReturnCode ORDataProcManager::ProcessDataStream()
     return kAlarm;
   }
 
+  ORTraceWriter::SetThreadName("processing");
   EReturnCode retCode = StartProcessing();
   if (retCode >= kFailure) return kAlarm;
   
@@ -81,17 +190,22 @@ ORDataProcManager::EReturnCode ORDataProcManager::ProcessRun()
 
 
   EReturnCode retCode;
-  size_t nLongsMax = 1024;
-  std::vector<UInt_t> vecbuffer(nLongsMax);
+  // Records are read into buffers from the pool; a buffer goes back to the
+  // pool as soon as the next record is read, unless a processor retained it.
+  ORRecordHandle record;
 
   Bool_t headerIsReadIn = false;
 
+  fRunContext->SetRecordPool(&fRecordPool);
+  fRunContext->SetCurrentRecord(&record);
+
   ORLog(kDebug) << "ProcessRun(): start reading records..." << std::endl;
-  while (fReader->ReadRecord(vecbuffer)) {
+  while (ReadRecord(record)) {
 
-    UInt_t* buffer = &vecbuffer[0];
+    UInt_t* buffer = record.GetData();
     // Check if it is a header
 
+    Double_t headerStart = ORTraceWriter::IsOpen() ? ORTraceWriter::Now() : 0;
     if(fHeaderProcessor->ProcessDataRecord(buffer) == kSuccess) {
       // It is a header, perform the setup
       // Set the default flag, header is not read in yet
@@ -123,6 +237,7 @@ ORDataProcManager::EReturnCode ORDataProcManager::ProcessRun()
       SetDecoderDictionary();
 
       headerIsReadIn = true;
+      if (ORTraceWriter::IsOpen()) ORTraceWriter::AddSpan("header", "header", headerStart);
       
       // Read the next record
       continue; 
@@ -138,14 +253,25 @@ ORDataProcManager::EReturnCode ORDataProcManager::ProcessRun()
       // Starting a run
       retCode = StartRun();
       if (retCode >= kFailure) KillRun(); // but keep processing: skips to next run
-      if (retCode >= kAlarm) return kAlarm;
+      if (retCode >= kAlarm) {
+        fRunContext->SetCurrentRecord(NULL);
+        return kAlarm;
+      }
       if (!fRunAsDaemon) {
         fRunDataProcessor->OnStartRunComplete(); 
       }
+      if (fMemoryMonitor != NULL) {
+        UpdateMemoryMonitor();
+        fMemoryMonitor->StartRun();
+      }
     }      
+    if (fMemoryMonitor != NULL && fMemoryMonitor->GetBudget() > 0) CheckMemoryBudget();
     if (fDoProcessRun) {
       // let all processors process the data record
-      if (ProcessDataRecord(buffer) >= kAlarm) return kAlarm;
+      if (ProcessDataRecord(buffer) >= kAlarm) {
+        fRunContext->SetCurrentRecord(NULL);
+        return kAlarm;
+      }
     }
   
     if (fRunContext->GetState() == ORRunContext::kStopping) {
@@ -158,7 +284,24 @@ ORDataProcManager::EReturnCode ORDataProcManager::ProcessRun()
   }
   // Set up Run Context
   ORLog(kDebug) << "ProcessRun(): finished reading records..." << std::endl;
+  fRunContext->SetCurrentRecord(NULL);
+  record.Reset();
+  // processors write their trees and histograms in EndRun()
+  {
+    ORTraceSpan span("ORTreeFillThread::Sync", "io");
+    ORTreeFillThread::Sync();
+  }
   retCode = EndRun();
+  ORTreeFillThread::ReleaseAll();
+  ReportProcessorStats();
+  if (fMemoryMonitor != NULL) {
+    UpdateMemoryMonitor();
+    fMemoryMonitor->Print();
+  }
+
+  fRecordPool.ReportStatistics("ProcessRun(): record pool");
+  fRecordPool.Trim();
+  fRecordPool.ResetStatistics();
 
   if (retCode >= kAlarm) return kAlarm;
   if (!fRunAsDaemon) {
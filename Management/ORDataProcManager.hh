@@ -10,6 +10,11 @@
 #include "ORHeaderProcessor.hh"
 #include "ORRunDataProcessor.hh"
 #include "ORVSigHandler.hh"
+#include "ORRecordPool.hh"
+#include "ORBasicDataDecoder.hh"
+
+class ORMemoryMonitor;
+class ORProcessorStats;
 
 class ORDataProcManager : public ORCompoundDataProcessor, public ORVSigHandler
 {
@@ -26,14 +31,47 @@ class ORDataProcManager : public ORCompoundDataProcessor, public ORVSigHandler
 
     /*! Tells the manager to run as daemon and ignore warning messages related to Run Context, etc. */
     virtual void SetRunAsDaemon(bool runAsDaemon = true) { fRunAsDaemon = runAsDaemon; }
+
+    /*! Caps the memory held by the record pool (records in flight, records
+        retained by processors and cached buffers).  0 means no limit.  */
+    virtual void SetRecordPoolMaxBytes(size_t maxBytes) { fRecordPool.SetMaxBytes(maxBytes); }
+    virtual ORRecordPool& GetRecordPool() { return fRecordPool; }
+
+    //! Times the processors and the reader, see ORProcessorStats.
+    virtual void EnableInstrumentation(bool enable = true);
+    virtual ORProcessorStats* GetProcessorStats() { return fProcessorStats; }
+
+    //! Reports the memory held by each processor at the end of runs, see ORMemoryMonitor.
+    virtual void EnableMemoryAccounting(bool enable = true);
+    /*! Warns and writes out buffers when the resident size goes over
+        nBytes (0: no budget).  Enables the memory accounting.  */
+    virtual void SetMemoryBudget(size_t nBytes);
+    virtual ORMemoryMonitor* GetMemoryMonitor() { return fMemoryMonitor; }
+
+    //! Waits for queued tree fills, then has the processors write out buffers.
+    virtual void ReduceMemory();
+
   protected:
     virtual void SetRunContext(ORRunContext* aContext);
+    //! Reads the next record, timing the reader if instrumented.
+    virtual bool ReadRecord(ORRecordHandle& record);
+    virtual void ReportProcessorStats();
+    //! Records the memory held by the processors, the record pool, etc.
+    virtual void UpdateMemoryMonitor();
+    virtual void CheckMemoryBudget();
     ORVReader* fReader;
     ORHeaderProcessor* fHeaderProcessor;
     ORRunDataProcessor* fRunDataProcessor;
     bool fIOwnRunDataProcessor;
     bool fIOwnHeaderProcessor;
     bool fRunAsDaemon;
+    ORRecordPool fRecordPool;
+    ORProcessorStats* fProcessorStats; //!
+    int fReaderStatsId;
+    ORBasicDataDecoder fStatsDecoder;
+    ULong64_t fNRecordsRead;
+    ORMemoryMonitor* fMemoryMonitor; //!
+    UInt_t fNRecordsToMemoryCheck;
 };
 
 #endif
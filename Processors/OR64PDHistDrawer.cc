@@ -3,6 +3,7 @@
 #include "OR64PDHistDrawer.hh"
 
 #include "TRandom3.h"
+#include "ORHistViewer.hh"
 #include "ORLogger.hh"
 #include <iostream>
 #include <fstream>
@@ -15,11 +16,10 @@ OR64PDHistDrawer::OR64PDHistDrawer(ORShaperShaperDecoder* histDecoder) :
 ORDataProcessor(histDecoder)
 {
   fShaperDecoder = histDecoder;
-  
-  app = new TApplication("OR64PDHistDrawer", NULL, NULL, NULL, 0);
 
-  Tcanvas = new TCanvas("c1","ORCAroot Rate histogram");
-  Ecanvas = new TCanvas("c2","ORCAroot Energy histogram");
+  fViewer = new ORHistViewer;
+  fRatePanel = fViewer->AddPanel("ORCAroot Rate histogram");
+  fEnergyPanel = fViewer->AddPanel("ORCAroot Energy histogram");
   fEnergyHist = NULL;
   fRateHist = NULL;
   r3 = new TRandom3(0);
@@ -28,10 +28,8 @@ ORDataProcessor(histDecoder)
 }
 OR64PDHistDrawer::~OR64PDHistDrawer() 
 {
+  delete fViewer;
   if (r3 != NULL ) delete r3;
-  if (Ecanvas ) delete Ecanvas;
-  if (Tcanvas ) delete Tcanvas;
-  if ( app ) delete app;
 }
 
 ORDataProcessor::EReturnCode OR64PDHistDrawer::StartProcessing()
@@ -41,6 +39,7 @@ ORDataProcessor::EReturnCode OR64PDHistDrawer::StartProcessing()
     KillProcessor();
     return kFailure;
   }
+  fViewer->Start();
   return kSuccess;
 }
 
@@ -164,16 +163,11 @@ ORDataProcessor::EReturnCode OR64PDHistDrawer::ProcessMyDataRecord(UInt_t* recor
   card = fShaperDecoder->CardOf(record);
   channel = fShaperDecoder->ChannelOf(record);
 
-  //Draw histograms every fRefreshTime seconds
+  //Publish histograms to the viewer every fRefreshTime seconds
   if ( ( time - fLastDrawTime ) > fRefreshTime ) {
     fLastDrawTime = time;
-    Ecanvas->cd();
-    fEnergyHist->Draw();
-    Ecanvas->Update();
-    Tcanvas->cd();
-    fRateHist->Draw();
-    Tcanvas->Update();
-    // app->Run();
+    fViewer->Publish(fEnergyPanel, fEnergyHist);
+    fViewer->Publish(fRatePanel, fRateHist);
   }
   
   //don't draw events from low-gain pixels
@@ -238,6 +232,8 @@ ORDataProcessor::EReturnCode OR64PDHistDrawer::ProcessMyDataRecord(UInt_t* recor
 
 ORDataProcessor::EReturnCode OR64PDHistDrawer::EndRun()
 {
+  fViewer->Publish(fEnergyPanel, fEnergyHist);
+  fViewer->Publish(fRatePanel, fRateHist);
   if (fRateHist != NULL ) {
     fRateHist->Write();
   }
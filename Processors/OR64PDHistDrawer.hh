@@ -4,14 +4,19 @@
 #define _OR64PDHistDrawer_hh_
 
 #include "TROOT.h"
-#include "TApplication.h"
 #include "TH1.h"
-#include "TCanvas.h"
 #include "ORDataProcessor.hh"
 #include "ORShaperShaperDecoder.hh"
 
 class TRandom3;
+class ORHistViewer;
 
+//! Live energy and rate histograms of the 64-pixel detector.
+/*!
+    The histograms are published to an ORHistViewer every refresh time
+    (of record time, see Hist_Settings.txt) and drawn by its thread, so
+    that drawing does not slow down the processing.
+ */
 
 class OR64PDHistDrawer : public ORDataProcessor
 {
@@ -30,9 +35,9 @@ class OR64PDHistDrawer : public ORDataProcessor
     ORShaperShaperDecoder *fShaperDecoder;
     TH1* fEnergyHist;
     TH1* fRateHist;
-    TCanvas* Tcanvas;
-    TCanvas* Ecanvas;
-    TApplication *app;
+    ORHistViewer* fViewer;
+    int fRatePanel;
+    int fEnergyPanel;
     TRandom3 *r3;
     
     UInt_t card;
@@ -65,7 +65,7 @@ ORDataProcessor::EReturnCode ORAcqirisDC440TreeWriter::ProcessMyDataRecord(UInt_
     return kFailure;
   }
   fEventDecoder->CopyWaveformData(fWaveform, fWaveformLength);
-  fTree->Fill();
+  FillTree();
   return kSuccess;
 }
 
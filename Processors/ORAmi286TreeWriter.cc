@@ -43,7 +43,7 @@ ORDataProcessor::EReturnCode ORAmi286TreeWriter::ProcessMyDataRecord(UInt_t* rec
       << "     Time: " << fTime << std::endl
       << "     Status: " << fStatus << std::endl;
     }
-    fTree->Fill();
+    FillTree();
   }
 
   return kSuccess;
@@ -50,7 +50,7 @@ ORDataProcessor::EReturnCode ORBasicTreeWriter::ProcessMyDataRecord(UInt_t* reco
                       << *(fParameters[iPar]) << endl;
       }
     }
-    fTree->Fill();
+    FillTree();
   }
   return kSuccess;
 }
@@ -40,7 +40,7 @@ ORDataProcessor::EReturnCode ORBocTIC3TreeWriter::ProcessMyDataRecord(UInt_t* re
         << fChannel << ":" << fPressure << ":" 
         << ":" << fTime << endl;
     }
-    fTree->Fill();
+    FillTree();
   }
 
   return kSuccess;
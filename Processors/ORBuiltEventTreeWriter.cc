@@ -0,0 +1,47 @@
+// ORBuiltEventTreeWriter.cc
+
+#include "ORBuiltEventTreeWriter.hh"
+
+#include "ORLogger.hh"
+
+using namespace std;
+
+ORBuiltEventTreeWriter::ORBuiltEventTreeWriter(string treeName) :
+ORVTreeWriter(NULL, treeName)
+{
+  Clear();
+  SetDoNotAutoFillTree();
+}
+
+ORDataProcessor::EReturnCode ORBuiltEventTreeWriter::InitializeBranches()
+{
+  fTree->Branch("eventTime", &fEventTime, "eventTime/l");
+  fTree->Branch("nHits", &fNHits, "nHits/i");
+  fTree->Branch("hitCrate", fCrate, "hitCrate[nHits]/s");
+  fTree->Branch("hitCard", fCard, "hitCard[nHits]/s");
+  fTree->Branch("hitChannel", fChannel, "hitChannel[nHits]/s");
+  fTree->Branch("hitDt", fDt, "hitDt[nHits]/D");
+  fTree->Branch("hitEnergy", fEnergy, "hitEnergy[nHits]/i");
+  return kSuccess;
+}
+
+ORDataProcessor::EReturnCode ORBuiltEventTreeWriter::WriteEvent(const vector<ORBuilderHit>& hits)
+{
+  if (fTree == NULL || hits.empty()) return kFailure;
+  fEventTime = hits[0].fTime;
+  fNHits = hits.size();
+  if (fNHits > kMaxHits) {
+    ORLog(kWarning) << "WriteEvent(): storing " << kMaxHits << " of " << fNHits
+                    << " hits" << endl;
+    fNHits = kMaxHits;
+  }
+  for (size_t i = 0; i < fNHits; i++) {
+    fCrate[i] = hits[i].fCrate;
+    fCard[i] = hits[i].fCard;
+    fChannel[i] = hits[i].fChannel;
+    fDt[i] = (Double_t) (hits[i].fTime - fEventTime);
+    fEnergy[i] = hits[i].fEnergy;
+  }
+  FillTree();
+  return kSuccess;
+}
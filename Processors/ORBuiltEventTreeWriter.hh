@@ -0,0 +1,61 @@
+// ORBuiltEventTreeWriter.hh
+
+#ifndef _ORBuiltEventTreeWriter_hh_
+#define _ORBuiltEventTreeWriter_hh_
+
+#include <vector>
+#include "ORVTreeWriter.hh"
+
+//! One hit as seen by ORTimeOrderedEventBuilder.
+struct ORBuilderHit
+{
+  ULong64_t fTime;  // ns, unwrapped and offset-corrected
+  UShort_t fCrate;
+  UShort_t fCard;
+  UShort_t fChannel;
+  UInt_t fEnergy;
+};
+
+//! Writes the events of ORTimeOrderedEventBuilder.
+/*!
+    Branches, one entry per built event:
+
+    eventTime - ULong64_t, time of the first hit in ns
+    nHits - UInt_t, number of hits (at most kMaxHits are stored)
+    hitCrate[nHits], hitCard[nHits], hitChannel[nHits] - UShort_t
+    hitDt[nHits] - Double_t, time after the first hit in ns
+    hitEnergy[nHits] - UInt_t
+
+    The writer has no decoder of its own: it is driven by the builder,
+    which calls WriteEvent().
+ */
+class ORBuiltEventTreeWriter : public ORVTreeWriter
+{
+  public:
+    enum EBuiltEventTreeWriterConsts { kMaxHits = 1024 };
+
+    ORBuiltEventTreeWriter(std::string treeName = "builtEventTree");
+    virtual ~ORBuiltEventTreeWriter() {}
+
+    virtual void SetDataId() {}
+    virtual void SetDecoderDictionary() {}
+    virtual EReturnCode ProcessDataRecord(UInt_t*) { return kSuccess; }
+    virtual inline void Clear() { fEventTime = 0; fNHits = 0; }
+
+    //! Fills one entry from hits, which must be in time order.
+    virtual EReturnCode WriteEvent(const std::vector<ORBuilderHit>& hits);
+
+  protected:
+    virtual EReturnCode InitializeBranches();
+
+  protected:
+    ULong64_t fEventTime;
+    UInt_t fNHits;
+    UShort_t fCrate[kMaxHits];
+    UShort_t fCard[kMaxHits];
+    UShort_t fChannel[kMaxHits];
+    Double_t fDt[kMaxHits];
+    UInt_t fEnergy[kMaxHits];
+};
+
+#endif
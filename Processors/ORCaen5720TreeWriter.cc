@@ -43,10 +43,12 @@ ORDataProcessor::EReturnCode ORCaen5720TreeWriter::ProcessMyDataRecord(UInt_t* r
                   << "CAEN Digitizer  " << endl;
   }
 
-  bool dataispacked = fCaen5720Decoder->Packed(record);
-  if(dataispacked){cout << "ERROR: Cannot process pack2.5 data. \n You must add this functionality to the ORDT5720Decoder" << endl; }
-    
     fnumSamples =fCaen5720Decoder->TraceLength(record);
+    if (fnumSamples > fmaxnumSamples) {
+      ORLog(kWarning) << "ProcessMyDataRecord(): trace of " << fnumSamples
+                      << " samples truncated to " << fmaxnumSamples << endl;
+      fnumSamples = fmaxnumSamples;
+    }
     fEventCount = fCaen5720Decoder->EventCount(record);
     fChannelMask = fCaen5720Decoder->ChannelMask(record);
     fClock = fCaen5720Decoder->Clock(record);
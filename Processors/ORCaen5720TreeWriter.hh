@@ -19,6 +19,10 @@ class ORCaen5720TreeWriter : public ORVTreeWriter
 
   enum ECaen5720WFTreeWriter{ fmaxnumSamples = 10000};
 
+    //! Set if the boards run with zero length encoding (not flagged in the data).
+    virtual void SetZeroLengthEncoded(bool zle, UInt_t fillValue = 0)
+      { fCaen5720Decoder->SetZeroLengthEncoded(zle); fCaen5720Decoder->SetZLEFillValue(fillValue); }
+
   protected:
     virtual EReturnCode InitializeBranches();
 
@@ -61,7 +61,7 @@ ORDataProcessor::EReturnCode ORCaen792qdcMultiCardTreeWriter::ProcessMyDataRecor
       ORLog(kWarning) << "Bad fNValues at event count " << fEventCount 
                       << ": skipped card?" << endl;
     }
-    fTree->Fill();
+    FillTree();
     Clear();
   }
   if(fEventDecoder->EventCountOf(record) > fEventCount + 1) {
@@ -141,6 +141,6 @@ ORDataProcessor::EReturnCode ORCaen792qdcMultiCardTreeWriter::ProcessMyDataRecor
 
 ORDataProcessor::EReturnCode ORCaen792qdcMultiCardTreeWriter::EndRun()
 {
-  fTree->Fill();
+  FillTree();
   return kSuccess;
 }
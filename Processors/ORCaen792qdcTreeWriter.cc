@@ -71,7 +71,7 @@ ORDataProcessor::EReturnCode ORCaen792qdcTreeWriter::ProcessMyDataRecord(UInt_t*
     fIsUnderThreshold[iCh] = fEventDecoder->IthValueIsUnderThreshold(record, i);
     fIsOverflow[iCh]       = fEventDecoder->IthValueIsOverflow(record, i);
   }	
-  fTree->Fill();
+  FillTree();
   return kSuccess;
 }
 
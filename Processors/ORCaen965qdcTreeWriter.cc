@@ -69,7 +69,7 @@ ORDataProcessor::EReturnCode ORCaen965qdcTreeWriter::ProcessMyDataRecord(UInt_t*
 // 		  Dump(record, i);
 // 	} 
 	}	
-  fTree->Fill();
+  FillTree();
 return kSuccess;
 }
 
@@ -2,12 +2,18 @@
 
 #include "ORCompoundDataProcessor.hh"
 
+#include "ORBasicDataDecoder.hh"
 #include "ORLogger.hh"
+#include "ORMemoryMonitor.hh"
+#include "ORProcessorStats.hh"
+#include "ORTraceWriter.hh"
 #include <algorithm>
+#include <sstream>
 
 ORCompoundDataProcessor::ORCompoundDataProcessor()
 {
   SetComponentBreakReturnsFailure();
+  fProcessorStats = NULL;
 }
 
 void ORCompoundDataProcessor::SetDataId()
@@ -37,8 +43,11 @@ ORDataProcessor::EReturnCode ORCompoundDataProcessor::StartProcessing()
 
 ORDataProcessor::EReturnCode ORCompoundDataProcessor::StartRun()
 {
+  bool timed = (fProcessorStats != NULL || ORTraceWriter::IsOpen());
   for (size_t i=0; i<fDataProcessors.size(); i++) {
-     EReturnCode retCode = fDataProcessors[i]->StartRun();
+    Double_t start = timed ? ORTraceWriter::Now() : 0;
+    EReturnCode retCode = fDataProcessors[i]->StartRun();
+    if (timed) EndTimedCall(i, ORProcessorStats::kStartRun, start);
     if (retCode >= kFailure) fDataProcessors[i]->KillRun();
     if (retCode >= kBreak) return fBreakRetCode;
     if (retCode >= kAlarm) return retCode;
@@ -49,6 +58,9 @@ ORDataProcessor::EReturnCode ORCompoundDataProcessor::StartRun()
 ORDataProcessor::EReturnCode ORCompoundDataProcessor::ProcessDataRecord(UInt_t* record)
 {
   if (!fDoProcess || !fDoProcessRun) return kFailure;
+  if (fProcessorStats != NULL || ORTraceWriter::IsRecordSampled()) {
+    return ProcessDataRecordTimed(record);
+  }
   for (size_t i=0; i<fDataProcessors.size(); i++) {
     EReturnCode retCode = fDataProcessors[i]->ProcessDataRecord(record);
     if (retCode == kBreak) return fBreakRetCode;
@@ -57,16 +69,68 @@ ORDataProcessor::EReturnCode ORCompoundDataProcessor::ProcessDataRecord(UInt_t*
   return kSuccess;
 }
 
+ORDataProcessor::EReturnCode ORCompoundDataProcessor::ProcessDataRecordTimed(UInt_t* record)
+{
+  // the first word of the record is always in host order
+  static ORBasicDataDecoder decoder;
+  UInt_t dataId = decoder.DataIdOf(record);
+  size_t nBytes = decoder.LengthOf(record)*sizeof(UInt_t);
+  for (size_t i=0; i<fDataProcessors.size(); i++) {
+    Double_t start = ORTraceWriter::Now();
+    EReturnCode retCode = fDataProcessors[i]->ProcessDataRecord(record);
+    EndTimedCall(i, ORProcessorStats::kProcess, start, dataId, nBytes);
+    if (retCode == kBreak) return fBreakRetCode;
+    if (retCode >= kAlarm) return retCode;
+  }
+  return kSuccess;
+}
+
 ORDataProcessor::EReturnCode ORCompoundDataProcessor::EndRun()
 {
+  bool timed = (fProcessorStats != NULL || ORTraceWriter::IsOpen());
   for (size_t i=0; i<fDataProcessors.size(); i++) {
+    Double_t start = timed ? ORTraceWriter::Now() : 0;
     EReturnCode retCode = fDataProcessors[i]->EndRun();
+    if (fDataProcessors[i]->fDataDecoder != NULL) fDataProcessors[i]->fDataDecoder->EndRun();
+    if (timed) EndTimedCall(i, ORProcessorStats::kEndRun, start);
     if (retCode >= kBreak) return fBreakRetCode;
     if (retCode >= kAlarm) return retCode;
   }
   return kSuccess;
 }
 
+void ORCompoundDataProcessor::EndTimedCall(size_t i, int phase, Double_t start,
+                                           UInt_t dataId, size_t nBytes)
+{
+  if (fProcessorStats != NULL) {
+    fProcessorStats->Add(fStatsIds[i], (ORProcessorStats::EPhase) phase, dataId,
+                         (ORTraceWriter::Now() - start)*1e-6, nBytes);
+  }
+  if (phase == ORProcessorStats::kProcess) {
+    if (ORTraceWriter::IsRecordSampled()) {
+      ORTraceWriter::AddSpan(GetComponentName(i), "processor", start);
+    }
+  }
+  else if (ORTraceWriter::IsOpen()) {
+    ORTraceWriter::AddSpan(GetComponentName(i) + " " +
+                           ORProcessorStats::PhaseName((ORProcessorStats::EPhase) phase),
+                           "processor", start);
+  }
+}
+
+const std::string& ORCompoundDataProcessor::GetComponentName(size_t i)
+{
+  if (fComponentNames.size() != fDataProcessors.size()) {
+    fComponentNames.resize(fDataProcessors.size());
+    for (size_t j=0; j<fDataProcessors.size(); j++) {
+      std::ostringstream name;
+      name << ORProcessorStats::ClassNameOf(fDataProcessors[j]) << "[" << j << "]";
+      fComponentNames[j] = name.str();
+    }
+  }
+  return fComponentNames[i];
+}
+
 ORDataProcessor::EReturnCode ORCompoundDataProcessor::EndProcessing()
 {
   for (size_t i=0; i<fDataProcessors.size(); i++) {
@@ -107,6 +171,9 @@ void ORCompoundDataProcessor::AddProcessor(ORDataProcessor* processor)
   }
   processor->SetRunContext(fRunContext);
   fDataProcessors.push_back(processor); 
+  fStatsIds.push_back(-1);
+  fComponentNames.clear();
+  if (fProcessorStats != NULL) RegisterComponent(fDataProcessors.size()-1);
 }
 
 void ORCompoundDataProcessor::RemoveProcessor(ORDataProcessor* processor)
@@ -114,9 +181,55 @@ void ORCompoundDataProcessor::RemoveProcessor(ORDataProcessor* processor)
   std::vector<ORDataProcessor*>::iterator it = 
     std::find(fDataProcessors.begin(), fDataProcessors.end(), processor);
   if (it != fDataProcessors.end()) {
+    fStatsIds.erase(fStatsIds.begin() + (it - fDataProcessors.begin()));
+    fComponentNames.clear();
     fDataProcessors.erase(it);
   } else {
     ORLog(kWarning) << "Unable to remove processor, not found!" << std::endl;
   }
   
 }
+
+void ORCompoundDataProcessor::SetProcessorStats(ORProcessorStats* stats, const std::string& namePrefix)
+{
+  fProcessorStats = stats;
+  fStatsPrefix = namePrefix;
+  fStatsIds.assign(fDataProcessors.size(), -1);
+  for (size_t i=0; i<fDataProcessors.size(); i++) RegisterComponent(i);
+}
+
+void ORCompoundDataProcessor::RegisterComponent(size_t i)
+{
+  std::ostringstream name;
+  name << fStatsPrefix << ORProcessorStats::ClassNameOf(fDataProcessors[i]) << "[" << i << "]";
+  fStatsIds[i] = (fProcessorStats != NULL) ? fProcessorStats->Register(name.str()) : -1;
+  ORCompoundDataProcessor* compound = dynamic_cast<ORCompoundDataProcessor*>(fDataProcessors[i]);
+  if (compound != NULL) compound->SetProcessorStats(fProcessorStats, name.str() + "/");
+}
+
+size_t ORCompoundDataProcessor::GetMemoryUsage() const
+{
+  size_t nBytes = 0;
+  for (size_t i=0; i<fDataProcessors.size(); i++) {
+    nBytes += fDataProcessors[i]->GetMemoryUsage();
+  }
+  return nBytes;
+}
+
+void ORCompoundDataProcessor::ReduceMemory()
+{
+  for (size_t i=0; i<fDataProcessors.size(); i++) {
+    fDataProcessors[i]->ReduceMemory();
+    if (fDataProcessors[i]->fDataDecoder != NULL) fDataProcessors[i]->fDataDecoder->ReduceMemory();
+  }
+}
+
+void ORCompoundDataProcessor::AccountMemory(ORMemoryMonitor& monitor, const std::string& namePrefix)
+{
+  for (size_t i=0; i<fDataProcessors.size(); i++) {
+    std::string name = namePrefix + GetComponentName(i);
+    monitor.Set(monitor.Register(name), fDataProcessors[i]->GetMemoryUsage());
+    ORCompoundDataProcessor* compound = dynamic_cast<ORCompoundDataProcessor*>(fDataProcessors[i]);
+    if (compound != NULL) compound->AccountMemory(monitor, name + "/");
+  }
+}
@@ -5,8 +5,12 @@
 
 #include "ORUtilityProcessor.hh"
 
+#include <string>
 #include <vector>
 
+class ORMemoryMonitor;
+class ORProcessorStats;
+
 
 class ORCompoundDataProcessor : public ORUtilityProcessor
 {
@@ -39,13 +43,43 @@ class ORCompoundDataProcessor : public ORUtilityProcessor
     virtual void SetComponentBreakReturnsBreak() { fBreakRetCode = kBreak; }
 
     virtual void AddProcessor(ORDataProcessor* processor);
-    virtual void ClearProcessors() { fDataProcessors.clear(); }
+    virtual void ClearProcessors()
+      { fDataProcessors.clear(); fStatsIds.clear(); fComponentNames.clear(); }
     virtual void RemoveProcessor(ORDataProcessor* processor);
 
+    //! Times the calls to the components in stats; NULL stops timing.
+    /*!
+        Components are named namePrefix + class name + [index]; nested
+        compound processors time their components too.
+        See ORProcessorStats.
+     */
+    virtual void SetProcessorStats(ORProcessorStats* stats, const std::string& namePrefix = "");
+
+    //! Sum of the memory held by the components.
+    virtual size_t GetMemoryUsage() const;
+    virtual void ReduceMemory();
+    //! Records the memory held by each component in monitor.
+    /*!
+        Components are named as for SetProcessorStats(); those of nested
+        compound processors are recorded too, as compound/component.
+     */
+    virtual void AccountMemory(ORMemoryMonitor& monitor, const std::string& namePrefix = "");
+
   protected:
     virtual void SetRunContext(ORRunContext* aContext);
+    virtual void RegisterComponent(size_t i);
+    virtual EReturnCode ProcessDataRecordTimed(UInt_t* record);
+    //! Records a call to component i that began at start (ORTraceWriter::Now()).
+    virtual void EndTimedCall(size_t i, int phase, Double_t start, UInt_t dataId = 0,
+                              size_t nBytes = 0);
+    //! Class name and index of component i, for the timeline.
+    virtual const std::string& GetComponentName(size_t i);
     std::vector<ORDataProcessor*> fDataProcessors;
     EReturnCode fBreakRetCode;
+    ORProcessorStats* fProcessorStats; //!
+    std::string fStatsPrefix;
+    std::vector<int> fStatsIds; // by component
+    std::vector<std::string> fComponentNames; // built on first use
 };
 
 #endif
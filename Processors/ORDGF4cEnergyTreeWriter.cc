@@ -53,7 +53,7 @@ ORDataProcessor::EReturnCode ORDGF4cEnergyTreeWriter::ProcessMyDataRecord(UInt_t
       fCard = fEventDecoder->CardOf();
       fChannel = k;
       fEnergy = fEventDecoder->GetChanEnergy(i,k);
-      fTree->Fill();
+      FillTree();
     }
   }
   return kSuccess;
@@ -70,7 +70,7 @@ ORDataProcessor::EReturnCode ORDGF4cLiveTimeWriter::ProcessMyDataRecord(UInt_t*
       fLiveTime = fLiveTimeDecoder->GetChanLiveTime(i);
       fNumEvents = fLiveTimeDecoder->GetChanNumEvents(i);
     }
-    fTree->Fill();
+    FillTree();
     ORLog(kDebug) << fChannel << "-" << fLiveTime << "-" << fNumEvents << endl;
   }
   return kSuccess;
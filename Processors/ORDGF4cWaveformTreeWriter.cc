@@ -6,7 +6,8 @@
 using namespace std;
 
 ORDGF4cWaveformTreeWriter::ORDGF4cWaveformTreeWriter(string treeName) :
-ORVTreeWriter(new ORDGF4cEventDecoder, treeName)
+ORVTreeWriter(new ORDGF4cEventDecoder, treeName),
+fWaveformBranch(kMaxWFLength)
 {
   fEventDecoder = dynamic_cast<ORDGF4cEventDecoder*>(fDataDecoder);
   fEventTime = 0;
@@ -32,7 +33,8 @@ ORDataProcessor::EReturnCode ORDGF4cWaveformTreeWriter::InitializeBranches()
   fTree->Branch("card", &fCard, "card/s");
   fTree->Branch("channel", &fChannel, "channel/s");
   fTree->Branch("energy", &fEnergy, "energy/s");
-  fTree->Branch("waveform", fWaveform, "waveform[wfLength]/s");
+  fWaveformBranch.Branch(fTree, "waveform", fWaveform, "wfLength",
+                         fEventDecoder->GetBitResolution());
   return kSuccess;
 }
 
@@ -66,7 +68,8 @@ ORDataProcessor::EReturnCode ORDGF4cWaveformTreeWriter::ProcessMyDataRecord(UInt
     fChannel = fEventDecoder->GetChannelNumber(i,k);
     fEnergy = fEventDecoder->GetChanEnergy(i,k);
     fWaveformLength = (Int_t) fEventDecoder->CopyWaveformData(fWaveform, kMaxWFLength, i, k);
-    fTree->Fill();
+    fWaveformBranch.Encode(fWaveform, fWaveformLength);
+    FillTree();
     }
   }
   return kSuccess;
@@ -4,6 +4,7 @@
 #define _ORDGF4cWaveformTreeWriter_hh_
 
 #include "ORVTreeWriter.hh"
+#include "ORWaveformBranch.hh"
 #include "ORDGF4cEventDecoder.hh"
 
 class ORDGF4cWaveformTreeWriter : public ORVTreeWriter
@@ -15,6 +16,9 @@ class ORDGF4cWaveformTreeWriter : public ORVTreeWriter
     virtual inline void Clear() 
       { fEventTime = 0.0; fCrate = 0; fCard = 0; fChannel = 0; fEnergy = 0; fWaveformLength = 0;}
     enum EDGF4cWFTreeWriter{kMaxWFLength = 4000};
+    //! Selects plain or encoded (ORWaveformCodec) storage of the waveforms.
+    virtual ORWaveformBranch& GetWaveformBranch() { return fWaveformBranch; }
+
   protected:
     virtual EReturnCode InitializeBranches();
 
@@ -23,6 +27,7 @@ class ORDGF4cWaveformTreeWriter : public ORVTreeWriter
     Double_t fEventTime;
     UShort_t fCrate, fCard, fChannel;
     UShort_t fWaveform[kMaxWFLength];
+    ORWaveformBranch fWaveformBranch;
     UShort_t fEnergy;
     Int_t fWaveformLength;
 };
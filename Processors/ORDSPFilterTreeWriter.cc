@@ -0,0 +1,163 @@
+// ORDSPFilterTreeWriter.cc
+
+#include "ORDSPFilterTreeWriter.hh"
+
+#include <cctype>
+#include <fstream>
+#include <sstream>
+#include "ORLogger.hh"
+
+using namespace std;
+
+ORDSPFilterTreeWriter::ORDSPFilterTreeWriter(ORVDigitizerDecoder* decoder, string treeName) :
+ORVTreeWriter(decoder, treeName)
+{
+  fDigitizerDecoder = decoder;
+  if (treeName == "") fTreeName = "dsp" + decoder->GetDictionaryObjectPath();
+  Clear();
+  SetDoNotAutoFillTree();
+}
+
+ORDSPFilterTreeWriter::~ORDSPFilterTreeWriter()
+{
+  delete fDigitizerDecoder;
+}
+
+ORDataProcessor::EReturnCode ORDSPFilterTreeWriter::InitializeBranches()
+{
+  fTree->Branch("crate", &fCrate, "crate/s");
+  fTree->Branch("card", &fCard, "card/s");
+  fTree->Branch("channel", &fChannel, "channel/s");
+  fTree->Branch("eventTime", &fEventTime, "eventTime/l");
+  fTree->Branch("decoderEnergy", &fDecoderEnergy, "decoderEnergy/i");
+  fTree->Branch("energy", &fEnergy, "energy/F");
+  fTree->Branch("amplitude", &fAmplitude, "amplitude/F");
+  fTree->Branch("t0", &fT0, "t0/F");
+  fTree->Branch("baseline", &fBaseline, "baseline/F");
+  fTree->Branch("baselineRMS", &fBaselineRMS, "baselineRMS/F");
+  return kSuccess;
+}
+
+ORDataProcessor::EReturnCode ORDSPFilterTreeWriter::StartRun()
+{
+  // the hardware settings may have changed
+  fChannelFilters.clear();
+  return ORVTreeWriter::StartRun();
+}
+
+ORDataProcessor::EReturnCode ORDSPFilterTreeWriter::ProcessMyDataRecord(UInt_t* record)
+{
+  if (!fDigitizerDecoder->SetDataRecord(record)) return kFailure;
+  fCrate = fDigitizerDecoder->CrateOf();
+  fCard = fDigitizerDecoder->CardOf();
+  for (size_t iEvent = 0; iEvent < fDigitizerDecoder->GetNumberOfEvents(); iEvent++) {
+    fChannel = fDigitizerDecoder->GetEventChannel(iEvent);
+    fEventTime = fDigitizerDecoder->GetEventTime(iEvent);
+    fDecoderEnergy = fDigitizerDecoder->GetEventEnergy(iEvent);
+
+    ORWaveformView view = fDigitizerDecoder->GetWaveformView(iEvent);
+    fWaveform.resize(view.GetLength());
+    if (view.IsEmpty()) fResult.Clear();
+    else {
+      view.CopyTo(&fWaveform[0], fWaveform.size());
+      GetChannelFilter(fCrate, fCard, fChannel).Process(&fWaveform[0], fWaveform.size(), fResult);
+    }
+    fEnergy = fResult.fEnergy;
+    fAmplitude = fResult.fAmplitude;
+    fT0 = fResult.fT0;
+    fBaseline = fResult.fBaseline;
+    fBaselineRMS = fResult.fBaselineRMS;
+    FillTree();
+  }
+  return kSuccess;
+}
+
+ORDSPFilter& ORDSPFilterTreeWriter::GetChannelFilter(UInt_t crate, UInt_t card, UInt_t channel)
+{
+  UInt_t key = ChannelKey(crate, card, channel);
+  map<UInt_t, ORDSPFilter>::iterator iter = fChannelFilters.find(key);
+  if (iter != fChannelFilters.end()) return iter->second;
+
+  ORDSPFilter& filter = fChannelFilters[key];
+  filter = fDefaultFilter;
+  map<int, string>::iterator dictKey;
+  for (dictKey = fDictionaryKeys.begin(); dictKey != fDictionaryKeys.end(); dictKey++) {
+    Double_t value;
+    ORDSPFilter::EParameter parameter = (ORDSPFilter::EParameter) dictKey->first;
+    if (!fDigitizerDecoder->GetChannelSetting(dictKey->second, crate, card, channel, value)) {
+      ORLog(kWarning) << "GetChannelFilter(): no " << dictKey->second << " in the header for crate "
+                      << crate << ", card " << card << ", channel " << channel << endl;
+    }
+    else if (!ORDSPFilter::IsValidParameter(parameter, value)) {
+      ORLog(kWarning) << "GetChannelFilter(): ignoring " << dictKey->second << " = " << value
+                      << " in the header for crate " << crate << ", card " << card
+                      << ", channel " << channel << endl;
+    }
+    else filter.SetParameter(parameter, value);
+  }
+  map<UInt_t, ParameterList>::iterator settings = fChannelSettings.find(key);
+  if (settings != fChannelSettings.end()) {
+    for (size_t i = 0; i < settings->second.size(); i++) {
+      filter.SetParameter(settings->second[i].first, settings->second[i].second);
+    }
+  }
+  return filter;
+}
+
+bool ORDSPFilterTreeWriter::SetChannelParameter(UInt_t crate, UInt_t card, UInt_t channel,
+                                                const string& name, const string& value)
+{
+  // check the name and value before storing them
+  ORDSPFilter check;
+  if (!check.SetParameter(name, value)) return false;
+  fChannelSettings[ChannelKey(crate, card, channel)].push_back(make_pair(name, value));
+  fChannelFilters.clear();
+  return true;
+}
+
+bool ORDSPFilterTreeWriter::ParseSetting(const string& line)
+{
+  string setting = line.substr(0, line.find('#'));
+  istringstream words(setting);
+  string name, value;
+  if (!(words >> name)) return true; // empty line
+  if (name == "channel") {
+    UInt_t crate, card, channel;
+    if (!(words >> crate >> card >> channel >> name >> value)) return false;
+    return SetChannelParameter(crate, card, channel, name, value);
+  }
+  if (name == "key") {
+    ORDSPFilter::EParameter parameter;
+    if (!(words >> name) || !ORDSPFilter::ParseParameterName(name, parameter)) return false;
+    string key;
+    getline(words >> ws, key);
+    while (!key.empty() && isspace(key[key.size()-1])) key.erase(key.size()-1);
+    if (key.empty()) return false;
+    SetDictionaryKey(parameter, key);
+    return true;
+  }
+  if (!(words >> value)) return false;
+  fChannelFilters.clear();
+  return fDefaultFilter.SetParameter(name, value);
+}
+
+bool ORDSPFilterTreeWriter::LoadConfigFile(const string& fileName)
+{
+  ifstream configFile(fileName.c_str());
+  if (!configFile.good()) {
+    ORLog(kError) << "LoadConfigFile(): could not open " << fileName << endl;
+    return false;
+  }
+  string line;
+  int lineNumber = 0;
+  bool allGood = true;
+  while (getline(configFile, line)) {
+    lineNumber++;
+    if (!ParseSetting(line)) {
+      ORLog(kError) << "LoadConfigFile(): error on line " << lineNumber
+                    << " of " << fileName << endl;
+      allGood = false;
+    }
+  }
+  return allGood;
+}
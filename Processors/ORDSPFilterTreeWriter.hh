@@ -0,0 +1,91 @@
+// ORDSPFilterTreeWriter.hh
+
+#ifndef _ORDSPFilterTreeWriter_hh_
+#define _ORDSPFilterTreeWriter_hh_
+
+#include <map>
+#include <string>
+#include <vector>
+#include "ORVTreeWriter.hh"
+#include "ORVDigitizerDecoder.hh"
+#include "ORDSPFilter.hh"
+
+//! Computes energies online with a digital filter, for any digitizer.
+/*!
+    Runs an ORDSPFilter on the waveform of every event of an
+    ORVDigitizerDecoder and writes one entry per event with branches
+
+    crate, card, channel - UShort_t
+    eventTime - ULong64_t, from the decoder
+    decoderEnergy - UInt_t, the energy reported by the digitizer
+    energy, amplitude, t0, baseline, baselineRMS - Float_t, see ORDSPResult
+
+    so that the waveforms themselves need not be stored.  The writer takes
+    ownership of the decoder, e.g.
+    \verbatim
+    ORDSPFilterTreeWriter dsp(new ORGretina4MDecoder);
+    dsp.LoadConfigFile("dsp.cfg");
+    \endverbatim
+
+    The filter of each channel starts from GetDefaultFilter(), then takes
+    the parameters set with SetDictionaryKey() from the header (e.g. rise
+    times programmed into the hardware), then the channel's own settings.
+    Configuration files have one setting per line, '#' starting a comment:
+    \verbatim
+    type trapezoidal
+    rise 400
+    flattop 150
+    decay 5000
+    key rise Integration Time
+    channel 1 5 3 gain 0.42
+    \endverbatim
+    See ORDSPFilter for the parameter names.
+ */
+class ORDSPFilterTreeWriter : public ORVTreeWriter
+{
+  public:
+    ORDSPFilterTreeWriter(ORVDigitizerDecoder* decoder, std::string treeName = "");
+    virtual ~ORDSPFilterTreeWriter();
+
+    virtual EReturnCode StartRun();
+    virtual EReturnCode ProcessMyDataRecord(UInt_t* record);
+    virtual inline void Clear()
+      { fCrate = 0; fCard = 0; fChannel = 0; fEventTime = 0; fDecoderEnergy = 0;
+        fEnergy = 0; fAmplitude = 0; fT0 = -1; fBaseline = 0; fBaselineRMS = 0; }
+
+    //! Filter for all channels, before dictionary and channel settings.
+    virtual ORDSPFilter& GetDefaultFilter() { return fDefaultFilter; }
+    //! Sets a parameter (see ORDSPFilter::SetParameter()) for one channel.
+    virtual bool SetChannelParameter(UInt_t crate, UInt_t card, UInt_t channel,
+                                     const std::string& name, const std::string& value);
+    //! Takes parameter from the hardware setting key of each channel in the header.
+    virtual void SetDictionaryKey(ORDSPFilter::EParameter parameter, const std::string& key)
+      { fDictionaryKeys[parameter] = key; fChannelFilters.clear(); }
+
+    virtual bool ParseSetting(const std::string& line);
+    virtual bool LoadConfigFile(const std::string& fileName);
+
+  protected:
+    virtual EReturnCode InitializeBranches();
+    virtual ORDSPFilter& GetChannelFilter(UInt_t crate, UInt_t card, UInt_t channel);
+    static UInt_t ChannelKey(UInt_t crate, UInt_t card, UInt_t channel)
+      { return (crate << 16) + (card << 8) + channel; }
+
+  protected:
+    typedef std::vector< std::pair<std::string, std::string> > ParameterList;
+
+    ORVDigitizerDecoder* fDigitizerDecoder;
+    ORDSPFilter fDefaultFilter;
+    std::map<UInt_t, ORDSPFilter> fChannelFilters;   // built on first use
+    std::map<UInt_t, ParameterList> fChannelSettings;
+    std::map<int, std::string> fDictionaryKeys;
+    std::vector<Float_t> fWaveform;
+    ORDSPResult fResult;
+
+    UShort_t fCrate, fCard, fChannel;
+    ULong64_t fEventTime;
+    UInt_t fDecoderEnergy;
+    Float_t fEnergy, fAmplitude, fT0, fBaseline, fBaselineRMS;
+};
+
+#endif
@@ -66,7 +66,7 @@ ORDataGenBurstTreeWriter::EReturnCode ORDataGenBurstTreeWriter::ProcessMyDataRec
 	}
 	
 	
-	fTree->Fill();
+	FillTree();
   
 
   return kSuccess;
@@ -1,6 +1,7 @@
 // ORDataProcessor.cc
 
 #include "ORDataProcessor.hh"
+#include "ORBasicDataDecoder.hh"
 #include "ORLogger.hh"
 #include "ORRunContext.hh"
 
@@ -83,3 +84,28 @@ ORDataProcessor::EReturnCode ORDataProcessor::ProcessDataRecord(UInt_t* record)
   }
   else return kSuccess;
 }
+
+ORRecordHandle ORDataProcessor::RetainRecord(UInt_t* record)
+{
+  // pool for records retained outside of an ORDataProcManager
+  static ORRecordPool unmanagedPool;
+
+  if (record == NULL) return ORRecordHandle();
+  ORRecordPool* pool = &unmanagedPool;
+  if (fRunContext) {
+    const ORRecordHandle& current = fRunContext->GetCurrentRecord();
+    if (current.GetData() == record) return current;
+    if (fRunContext->GetRecordPool()) pool = fRunContext->GetRecordPool();
+  }
+  ORBasicDataDecoder decoder;
+  ORRecordHandle handle = pool->Copy(record, decoder.LengthOf(record));
+  if (!handle.IsValid()) {
+    ORLog(kWarning) << "RetainRecord(): record pool refused to retain a record" << endl;
+  }
+  return handle;
+}
+
+size_t ORDataProcessor::GetMemoryUsage() const
+{
+  return (fDataDecoder != NULL) ? fDataDecoder->GetMemoryUsage() : 0;
+}
@@ -6,6 +6,9 @@
 #ifndef _ORVDataDecoder_hh
 #include "ORVDataDecoder.hh"
 #endif
+#ifndef _ORRecordPool_hh_
+#include "ORRecordPool.hh"
+#endif
 
 class ORCompoundDataProcessor;
 class ORDataProcManager;
@@ -66,6 +69,35 @@ class ORDataProcessor
 
     virtual void SetDebugRecord(bool debug = true) { fDebugRecord = debug; }
 
+    //! Keeps record alive past ProcessDataRecord().
+    /*!
+       Returns a reference-counted handle to record.  If record is the one
+       currently being processed by the manager, the handle shares the
+       reader's buffer and nothing is copied; otherwise the record is copied
+       into the record pool.  The record stays valid as long as a copy of the
+       handle exists, e.g.:
+       \verbatim
+       fLastTrigger = RetainRecord(record);
+       ...
+       UInt_t* trigger = fLastTrigger.GetData();
+       \endverbatim
+       Note that a retained record is shared: it must not be modified.
+     */
+    virtual ORRecordHandle RetainRecord(UInt_t* record);
+
+    //! Bytes of memory held by the processor and its decoder.
+    /*!
+       Used by ORMemoryMonitor.  Processors that keep data (trees,
+       histograms, buffered events) override this to add what they hold.
+     */
+    virtual size_t GetMemoryUsage() const;
+    //! Called when the process is over its memory budget, see ORMemoryMonitor.
+    /*!
+       Processors should give back what they can without losing data, e.g.
+       write out buffers.  Queued tree fills have been done when it is called.
+     */
+    virtual void ReduceMemory() {}
+
     /** 
        This is to allow a ORCompoundDataProcessor to access the protected members
        of other ORDataProcessors, for example, SetRunContext, which we want to 
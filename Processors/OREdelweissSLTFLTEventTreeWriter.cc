@@ -7,7 +7,8 @@
 using namespace std;
 
 OREdelweissSLTFLTEventTreeWriter::OREdelweissSLTFLTEventTreeWriter(string treeName) :
-ORVTreeWriter(new OREdelweissSLTFLTEventDecoder, treeName)
+ORVTreeWriter(new OREdelweissSLTFLTEventDecoder, treeName),
+fWaveformBranch(kMaxWFLength)
 {
   fEventDecoder = dynamic_cast<OREdelweissSLTFLTEventDecoder*>(fDataDecoder);
   Clear();
@@ -38,7 +39,8 @@ ORDataProcessor::EReturnCode OREdelweissSLTFLTEventTreeWriter::InitializeBranche
   fTree->Branch("triggerAddr", &fTriggerAddr, "triggerAddr/S");
   fTree->Branch("eventFlags", &fEventFlags, "eventFlags/i");
   fTree->Branch("eventInfo", &fEventInfo, "eventInfo/i");
-  fTree->Branch("waveform", fWaveform, "waveform[wfLength]/s");
+  fWaveformBranch.Branch(fTree, "waveform", fWaveform, "wfLength",
+                         fEventDecoder->GetBitResolution());
   return kSuccess;
 }
 
@@ -88,6 +90,7 @@ ORDataProcessor::EReturnCode OREdelweissSLTFLTEventTreeWriter::ProcessMyDataReco
   }
   
   fEventDecoder->CopyWaveformData( fWaveform, kMaxWFLength );
+  fWaveformBranch.Encode(fWaveform, fWaveformLength);
 
   return kSuccess;
 }
@@ -4,6 +4,7 @@
 #define _OREdelweissSLTFLTEventTreeWriter_hh_
 
 #include "ORVTreeWriter.hh"
+#include "ORWaveformBranch.hh"
 #include "OREdelweissSLTFLTEventDecoder.hh"
 
 class OREdelweissSLTFLTEventTreeWriter : public ORVTreeWriter
@@ -22,6 +23,9 @@ class OREdelweissSLTFLTEventTreeWriter : public ORVTreeWriter
       //kMaxWFLength = OREdelweissSLTFLTEventDecoder::kWaveformLength -tb- this was too small
       kMaxWFLength = OREdelweissSLTFLTEventDecoder::kWaveformLength * 1 /*64*/ //TODO: test it -tb-
       };
+    //! Selects plain or encoded (ORWaveformCodec) storage of the waveforms.
+    virtual ORWaveformBranch& GetWaveformBranch() { return fWaveformBranch; }
+
   protected:
     virtual EReturnCode InitializeBranches();
 
@@ -32,6 +36,7 @@ class OREdelweissSLTFLTEventTreeWriter : public ORVTreeWriter
     UInt_t fChannelMap;
     UShort_t fCrate, fCard, fFiber, fChannel, fTrigChannel;
     UShort_t fWaveform[kMaxWFLength];
+    ORWaveformBranch fWaveformBranch;
     UInt_t fWaveformLength;
     Int_t fEnergy;
     Short_t fTriggerAddr;
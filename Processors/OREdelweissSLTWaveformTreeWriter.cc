@@ -7,7 +7,8 @@
 using namespace std;
 
 OREdelweissSLTWaveformTreeWriter::OREdelweissSLTWaveformTreeWriter(string treeName) :
-ORVTreeWriter(new OREdelweissSLTWaveformDecoder, treeName)
+ORVTreeWriter(new OREdelweissSLTWaveformDecoder, treeName),
+fWaveformBranch(kMaxWFLength)
 {
   fEventDecoder = dynamic_cast<OREdelweissSLTWaveformDecoder*>(fDataDecoder);
   Clear();
@@ -36,7 +37,8 @@ ORDataProcessor::EReturnCode OREdelweissSLTWaveformTreeWriter::InitializeBranche
   fTree->Branch("energy_adc", &fEnergy, "energy_adc/i");
   fTree->Branch("eventFlags", &fEventFlags, "eventFlags/i");
   fTree->Branch("eventInfo", &fEventInfo, "eventInfo/i");
-  fTree->Branch("waveform", fWaveform, "waveform[wfLength]/s");
+  fWaveformBranch.Branch(fTree, "waveform", fWaveform, "wfLength",
+                         fEventDecoder->GetBitResolution());
   return kSuccess;
 }
 
@@ -83,6 +85,7 @@ ORDataProcessor::EReturnCode OREdelweissSLTWaveformTreeWriter::ProcessMyDataReco
   }
   
   fEventDecoder->CopyWaveformData( fWaveform, kMaxWFLength );
+  fWaveformBranch.Encode(fWaveform, fWaveformLength);
 
   return kSuccess;
 }
@@ -4,6 +4,7 @@
 #define _OREdelweissSLTWaveformTreeWriter_hh_
 
 #include "ORVTreeWriter.hh"
+#include "ORWaveformBranch.hh"
 #include "OREdelweissSLTWaveformDecoder.hh"
 
 class OREdelweissSLTWaveformTreeWriter : public ORVTreeWriter
@@ -22,6 +23,9 @@ class OREdelweissSLTWaveformTreeWriter : public ORVTreeWriter
       //kMaxWFLength = OREdelweissSLTWaveformDecoder::kWaveformLength -tb- this was too small
       kMaxWFLength = OREdelweissSLTWaveformDecoder::kWaveformLength * 1 /*64*/ //TODO: test it -tb-
       };
+    //! Selects plain or encoded (ORWaveformCodec) storage of the waveforms.
+    virtual ORWaveformBranch& GetWaveformBranch() { return fWaveformBranch; }
+
   protected:
     virtual EReturnCode InitializeBranches();
 
@@ -31,6 +35,7 @@ class OREdelweissSLTWaveformTreeWriter : public ORVTreeWriter
     UInt_t fChannelMap;
     UShort_t fCrate, fCard, fFiber, fChannel, fTrigChannel;
     UShort_t fWaveform[kMaxWFLength];
+    ORWaveformBranch fWaveformBranch;
     UInt_t fWaveformLength;
     UInt_t fEnergy;
     UInt_t fEventID, fEventFlags, fEventInfo;
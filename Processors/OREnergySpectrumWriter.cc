@@ -0,0 +1,148 @@
+// OREnergySpectrumWriter.cc
+
+#include "OREnergySpectrumWriter.hh"
+
+#include <cstdio>
+#include <ctime>
+#include "TFile.h"
+#include "TH1.h"
+#include "TROOT.h"
+#include "ORLogger.hh"
+
+using namespace std;
+
+OREnergySpectrumWriter::OREnergySpectrumWriter(ORVDigitizerDecoder* decoder,
+                                               string histNamePrefix) :
+ORDataProcessor(decoder)
+{
+  fDigitizerDecoder = decoder;
+  fHistNamePrefix = histNamePrefix;
+  if (fHistNamePrefix == "" && decoder != NULL) {
+    fHistNamePrefix = "hE" + decoder->GetDictionaryObjectPath();
+  }
+  fSpectra = new ORChannelSpectra;
+  fOwnsSpectra = true;
+  fSnapshotInterval = 0;
+  fNextSnapshot = 0;
+}
+
+OREnergySpectrumWriter::~OREnergySpectrumWriter()
+{
+  if (fOwnsSpectra) delete fSpectra;
+}
+
+void OREnergySpectrumWriter::ShareSpectra(ORChannelSpectra* spectra)
+{
+  if (spectra == NULL || spectra == fSpectra) return;
+  if (fOwnsSpectra) delete fSpectra;
+  fSpectra = spectra;
+  fOwnsSpectra = false;
+  fSpectra->SetAtomic();
+}
+
+size_t OREnergySpectrumWriter::GetMemoryUsage() const
+{
+  // the decoder is not ours
+  return fOwnsSpectra ? fSpectra->GetBytesAllocated() : 0;
+}
+
+ORDataProcessor::EReturnCode OREnergySpectrumWriter::StartProcessing()
+{
+  if (fDigitizerDecoder == NULL) {
+    ORLog(kWarning) << "StartProcessing(): fDigitizerDecoder was NULL, can't proceed" << endl;
+    KillProcessor();
+    return kFailure;
+  }
+  return kSuccess;
+}
+
+ORDataProcessor::EReturnCode OREnergySpectrumWriter::StartRun()
+{
+  if (!fOwnsSpectra) return kSuccess;
+  fSpectra->Reset();
+  if (fSnapshotInterval > 0) fNextSnapshot = time(NULL) + fSnapshotInterval;
+  return kSuccess;
+}
+
+ORDataProcessor::EReturnCode OREnergySpectrumWriter::ProcessMyDataRecord(UInt_t* record)
+{
+  if (!fDigitizerDecoder->SetDataRecord(record)) return kFailure;
+  UInt_t crate = fDigitizerDecoder->CrateOf();
+  UInt_t card = fDigitizerDecoder->CardOf();
+  size_t nEvents = fDigitizerDecoder->GetNumberOfEvents();
+  for (size_t iEvent = 0; iEvent < nEvents; iEvent++) {
+    fSpectra->Add(crate, card, fDigitizerDecoder->GetEventChannel(iEvent),
+                  fDigitizerDecoder->GetEventEnergy(iEvent));
+  }
+
+  if (fOwnsSpectra && fSnapshotInterval > 0 && time(NULL) >= fNextSnapshot) {
+    WriteSnapshot();
+    fNextSnapshot = time(NULL) + fSnapshotInterval;
+  }
+  return kSuccess;
+}
+
+TH1* OREnergySpectrumWriter::MakeHist(size_t index)
+{
+  const UInt_t* spectrum = fSpectra->GetSpectrum(index);
+  if (spectrum == NULL) return NULL;
+  UInt_t crate = ORChannelSpectra::CrateOf(index);
+  UInt_t card = ORChannelSpectra::CardOf(index);
+  UInt_t channel = ORChannelSpectra::ChannelOf(index);
+  size_t nBins = fSpectra->GetNBins();
+  TH1* hist = new TH1D(Form("%s_%u_%u_%u", fHistNamePrefix.c_str(), crate, card, channel),
+                       Form("%s: Crate %u, Card %u, Channel %u", fHistNamePrefix.c_str(),
+                            crate, card, channel),
+                       nBins, 0, ((Double_t) nBins)*(1 << fSpectra->GetShift()));
+  hist->SetXTitle("Energy");
+  Double_t nEntries = 0;
+  for (size_t iBin = 0; iBin <= nBins; iBin++) {
+    hist->SetBinContent(iBin+1, spectrum[iBin]);
+    nEntries += spectrum[iBin];
+  }
+  hist->SetEntries(nEntries);
+  return hist;
+}
+
+void OREnergySpectrumWriter::WriteHists()
+{
+  for (size_t index = 0; index < ORChannelSpectra::GetMaxIndex(); index++) {
+    TH1* hist = MakeHist(index);
+    if (hist != NULL) hist->Write();
+  }
+}
+
+bool OREnergySpectrumWriter::WriteSnapshot()
+{
+  TDirectory* savedDirectory = gDirectory;
+  string tmpFileName = fSnapshotFileName + ".tmp";
+  TFile file(tmpFileName.c_str(), "RECREATE");
+  if (file.IsZombie()) {
+    ORLog(kWarning) << "WriteSnapshot(): couldn't open " << tmpFileName << endl;
+    savedDirectory->cd();
+    return false;
+  }
+  WriteHists();  // the histograms are deleted with the file
+  file.Close();
+  savedDirectory->cd();
+  if (rename(tmpFileName.c_str(), fSnapshotFileName.c_str()) != 0) {
+    ORLog(kWarning) << "WriteSnapshot(): couldn't rename " << tmpFileName
+                    << " to " << fSnapshotFileName << endl;
+    return false;
+  }
+  return true;
+}
+
+ORDataProcessor::EReturnCode OREnergySpectrumWriter::EndRun()
+{
+  if (!fOwnsSpectra) return kSuccess;
+  if (fSpectra->GetNOutOfRange() > 0) {
+    ORLog(kWarning) << "EndRun(): " << fSpectra->GetNOutOfRange() << " events with crate, card "
+                    << "or channel out of range were not counted" << endl;
+  }
+  // if a TFile is open, the histos will be deleted by the file; otherwise
+  // they remain in memory (see ORHistWriter)
+  WriteHists();
+  if (fSnapshotInterval > 0) WriteSnapshot();
+  return kSuccess;
+}
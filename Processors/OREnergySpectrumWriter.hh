@@ -0,0 +1,74 @@
+// OREnergySpectrumWriter.hh
+
+#ifndef _OREnergySpectrumWriter_hh_
+#define _OREnergySpectrumWriter_hh_
+
+#include <string>
+#include "ORDataProcessor.hh"
+#include "ORVDigitizerDecoder.hh"
+#include "ORChannelSpectra.hh"
+
+class TH1;
+
+//! Quick-look energy spectra of every channel of a digitizer.
+/*!
+    Counts GetEventEnergy() of every event of an ORVDigitizerDecoder in a
+    spectrum per crate/card/channel (see ORChannelSpectra) and writes them
+    as TH1D named <prefix>_<crate>_<card>_<channel> at EndRun().  The
+    prefix defaults to "hE" followed by the decoder's dictionary object path.
+    The decoder is not owned.
+
+    By default the spectra have 65536 bins of one energy unit; use
+    SetBinning() for digitizers with wider energies.
+
+    SetSnapshot() additionally writes all spectra to a file of their own
+    every so many seconds during the run; the file is written under a
+    temporary name and then renamed, so it can be opened at any time, e.g.
+    by a viewer.
+
+    Several writers, e.g. one per processing thread, each with its own
+    decoder, can fill the same spectra: pass the spectra of one writer to
+    the others with ShareSpectra().  The counters are then updated
+    atomically, and only the writer that owns the spectra writes them.
+ */
+class OREnergySpectrumWriter : public ORDataProcessor
+{
+  public:
+    OREnergySpectrumWriter(ORVDigitizerDecoder* decoder, std::string histNamePrefix = "");
+    virtual ~OREnergySpectrumWriter();
+
+    virtual EReturnCode StartProcessing();
+    virtual EReturnCode StartRun();
+    virtual EReturnCode ProcessMyDataRecord(UInt_t* record);
+    virtual EReturnCode EndRun();
+
+    //! nBins bins of 2^shift energy units each.
+    virtual void SetBinning(size_t nBins, UInt_t shift = 0) { fSpectra->SetBinning(nBins, shift); }
+    //! Writes the spectra to fileName every interval seconds; 0 disables.
+    virtual void SetSnapshot(UInt_t interval, const std::string& fileName)
+      { fSnapshotInterval = interval; fSnapshotFileName = fileName; }
+    virtual bool WriteSnapshot();
+
+    //! Fills spectra (owned by another writer) instead of own ones.
+    virtual void ShareSpectra(ORChannelSpectra* spectra);
+    virtual ORChannelSpectra* GetSpectra() { return fSpectra; }
+
+    //! The spectra, if owned.
+    virtual size_t GetMemoryUsage() const;
+
+  protected:
+    //! Histogram of the spectrum of index, in the current directory.
+    virtual TH1* MakeHist(size_t index);
+    virtual void WriteHists();
+
+  protected:
+    ORVDigitizerDecoder* fDigitizerDecoder;
+    std::string fHistNamePrefix;
+    ORChannelSpectra* fSpectra;
+    bool fOwnsSpectra;
+    UInt_t fSnapshotInterval;
+    std::string fSnapshotFileName;
+    Long64_t fNextSnapshot;
+};
+
+#endif
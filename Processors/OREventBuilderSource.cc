@@ -0,0 +1,83 @@
+// OREventBuilderSource.cc
+
+#include "OREventBuilderSource.hh"
+
+#include "ORTimeOrderedEventBuilder.hh"
+#include "ORVDigitizerDecoder.hh"
+#include "ORVBasicTreeDecoder.hh"
+#include "ORLogger.hh"
+
+using namespace std;
+
+ORDigitizerEventSource::ORDigitizerEventSource(ORVDigitizerDecoder* decoder,
+                                               ORTimeOrderedEventBuilder* builder,
+                                               Double_t clockFrequency, UInt_t clockBits) :
+ORVEventBuilderSource(decoder, builder), fDigitizerDecoder(decoder),
+fClockFrequency(clockFrequency), fClockBits(clockBits), fSubSecondsPerSecond(0)
+{
+}
+
+ORDataProcessor::EReturnCode ORDigitizerEventSource::ProcessMyDataRecord(UInt_t* record)
+{
+  if (!fDigitizerDecoder->SetDataRecord(record)) return kFailure;
+  Double_t frequency = fClockFrequency;
+  if (frequency <= 0) frequency = fDigitizerDecoder->GetSamplingFrequency()*1.0e9; // GHz
+  if (frequency <= 0) {
+    ORLog(kError) << "ProcessMyDataRecord(): no clock frequency for "
+                  << fDigitizerDecoder->GetDataObjectPath() << endl;
+    return kFailure;
+  }
+  UInt_t crate = fDigitizerDecoder->CrateOf();
+  UInt_t card = fDigitizerDecoder->CardOf();
+  for (size_t iEvent = 0; iEvent < fDigitizerDecoder->GetNumberOfEvents(); iEvent++) {
+    ULong64_t time = fDigitizerDecoder->GetEventTime(iEvent);
+    if (fSubSecondsPerSecond > 0) {
+      time = (time >> 32)*((ULong64_t) fSubSecondsPerSecond) + (time & 0xffffffff);
+    }
+    fBuilder->AddHit(crate, card, fDigitizerDecoder->GetEventChannel(iEvent), time,
+                     frequency, fClockBits, fDigitizerDecoder->GetEventEnergy(iEvent));
+  }
+  return kSuccess;
+}
+
+ORSecSubSecEventSource::ORSecSubSecEventSource(ORVBasicTreeDecoder* decoder,
+                                               ORTimeOrderedEventBuilder* builder,
+                                               Double_t subSecondsPerSecond) :
+ORVEventBuilderSource(decoder, builder), fBasicDecoder(decoder),
+fSubSecondsPerSecond(subSecondsPerSecond)
+{
+  fNPars = decoder->GetNPars();
+  fSecondsPar = fSubSecondsPar = fChannelPar = fChannelMapPar = fEnergyPar = fNPars;
+  for (size_t iPar = 0; iPar < fNPars; iPar++) {
+    string name = decoder->GetParName(iPar);
+    if (name == "seconds") fSecondsPar = iPar;
+    else if (name == "subseconds") fSubSecondsPar = iPar;
+    else if (name == "channel") fChannelPar = iPar;
+    else if (name == "channelMap") fChannelMapPar = iPar;
+    else if (name == "energy") fEnergyPar = iPar;
+  }
+  if (fSecondsPar == fNPars || fSubSecondsPar == fNPars) {
+    ORLog(kError) << decoder->GetDataObjectPath() << " has no seconds and subseconds" << endl;
+    KillProcessor();
+  }
+}
+
+ORDataProcessor::EReturnCode ORSecSubSecEventSource::ProcessMyDataRecord(UInt_t* record)
+{
+  UInt_t crate = fBasicDecoder->CrateOf(record);
+  UInt_t card = fBasicDecoder->CardOf(record);
+  for (size_t iRow = 0; iRow < fBasicDecoder->GetNRows(record); iRow++) {
+    ULong64_t time = ((ULong64_t) fBasicDecoder->GetPar(record, fSecondsPar, iRow))
+                     *((ULong64_t) fSubSecondsPerSecond)
+                     + fBasicDecoder->GetPar(record, fSubSecondsPar, iRow);
+    UShort_t channel = 0;
+    if (fChannelPar != fNPars) channel = fBasicDecoder->GetPar(record, fChannelPar, iRow);
+    else if (fChannelMapPar != fNPars) {
+      UInt_t channelMap = fBasicDecoder->GetPar(record, fChannelMapPar, iRow);
+      while (channelMap != 0 && (channelMap & 0x1) == 0) { channelMap >>= 1; channel++; }
+    }
+    UInt_t energy = (fEnergyPar != fNPars) ? fBasicDecoder->GetPar(record, fEnergyPar, iRow) : 0;
+    fBuilder->AddHit(crate, card, channel, time, fSubSecondsPerSecond, 64, energy);
+  }
+  return kSuccess;
+}
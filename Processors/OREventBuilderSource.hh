@@ -0,0 +1,76 @@
+// OREventBuilderSource.hh
+
+#ifndef _OREventBuilderSource_hh_
+#define _OREventBuilderSource_hh_
+
+#include "ORDataProcessor.hh"
+
+class ORTimeOrderedEventBuilder;
+class ORVDigitizerDecoder;
+class ORVBasicTreeDecoder;
+
+//! Hands the hits of one decoder's records to an ORTimeOrderedEventBuilder.
+/*!
+    Sources are made by ORTimeOrderedEventBuilder::AddDigitizer() and
+    AddSecSubSecSource() and own their decoder.
+ */
+class ORVEventBuilderSource : public ORDataProcessor
+{
+  public:
+    ORVEventBuilderSource(ORVDataDecoder* decoder, ORTimeOrderedEventBuilder* builder) :
+      ORDataProcessor(decoder), fBuilder(builder) {}
+    virtual ~ORVEventBuilderSource() { delete fDataDecoder; }
+
+  protected:
+    ORTimeOrderedEventBuilder* fBuilder;
+};
+
+//! Hits of any ORVDigitizerDecoder, timed by GetEventTime().
+/*!
+    The event time counts ticks of clockFrequency in Hz (0: the sampling
+    frequency of the decoder) and wraps after clockBits bits.  For decoders
+    that pack seconds and subseconds into the event time (seconds << 32 |
+    subseconds, e.g. ORKatrinV4FLTWaveformDecoder), call SetSecSubSecTime().
+ */
+class ORDigitizerEventSource : public ORVEventBuilderSource
+{
+  public:
+    ORDigitizerEventSource(ORVDigitizerDecoder* decoder, ORTimeOrderedEventBuilder* builder,
+                           Double_t clockFrequency = 0, UInt_t clockBits = 64);
+    virtual ~ORDigitizerEventSource() {}
+
+    virtual void SetSecSubSecTime(Double_t subSecondsPerSecond)
+      { fSubSecondsPerSecond = subSecondsPerSecond; fClockFrequency = subSecondsPerSecond; }
+
+    virtual EReturnCode ProcessMyDataRecord(UInt_t* record);
+
+  protected:
+    ORVDigitizerDecoder* fDigitizerDecoder;
+    Double_t fClockFrequency;
+    UInt_t fClockBits;
+    Double_t fSubSecondsPerSecond;
+};
+
+//! Hits of basic tree records with "seconds" and "subseconds" parameters.
+/*!
+    For the KATRIN and IPE FLT energy records.  The channel is taken from a
+    "channel" parameter or else from the lowest bit of "channelMap"; the
+    energy from "energy".
+ */
+class ORSecSubSecEventSource : public ORVEventBuilderSource
+{
+  public:
+    ORSecSubSecEventSource(ORVBasicTreeDecoder* decoder, ORTimeOrderedEventBuilder* builder,
+                           Double_t subSecondsPerSecond = 2.0e7);
+    virtual ~ORSecSubSecEventSource() {}
+
+    virtual EReturnCode ProcessMyDataRecord(UInt_t* record);
+
+  protected:
+    ORVBasicTreeDecoder* fBasicDecoder;
+    Double_t fSubSecondsPerSecond;
+    size_t fNPars; // index of parameters the decoder does not have
+    size_t fSecondsPar, fSubSecondsPar, fChannelPar, fChannelMapPar, fEnergyPar;
+};
+
+#endif
@@ -5,7 +5,11 @@
 #include "TROOT.h"
 #include "TObjString.h"
 #include "ORLogger.hh"
+#include "ORIOConfig.hh"
+#include "ORTreeFillThread.hh"
 #include "ORRunContext.hh"
+#include "ORTraceWriter.hh"
+#include "ORVTreeWriter.hh"
 
 using namespace std;
 
@@ -14,6 +18,7 @@ ORFileWriter::ORFileWriter(string label)
   fLabel = label;
   fSavedName = "";
   fFile = NULL;
+  fCompressionSettings = -1;
 }
 
 ORDataProcessor::EReturnCode ORFileWriter::StartRun()
@@ -23,6 +28,9 @@ ORDataProcessor::EReturnCode ORFileWriter::StartRun()
       ORLog(kError) << "Lost track of fFile!" << endl;
       return kFailure;
     }
+    ORTraceSpan span("TFile::Close", "io");
+    ORTreeFillThread::ReleaseAll();
+    ORVTreeWriter::DeleteRunInfoTrees();
     fFile->Close();
     delete fFile;
   }
@@ -32,6 +40,8 @@ ORDataProcessor::EReturnCode ORFileWriter::StartRun()
   }
   string filename = fLabel + ::Form("_run%d.root", fRunContext->GetRunNumber());
   fFile = new TFile(filename.c_str(), "RECREATE");
+  if (fCompressionSettings >= 0) fFile->SetCompressionSettings(fCompressionSettings);
+  else ORIOConfig::ApplyToFile(fFile);
   fSavedName = fFile->GetName();
   fSavedName.erase( fSavedName.size() - 5, 5 ); // Removing .root from the end
 
@@ -64,6 +74,8 @@ ORDataProcessor::EReturnCode ORFileWriter::ProcessDataRecord(UInt_t*)
 {
   if (fRunContext->GetSubRunNumber()!=fLastSubRunNumber)
   {
+    ORTraceSpan span("sub-run header", "io");
+    ORTreeFillThread::Sync();
     fFile->cd();
     TObjString headerXML(fRunContext->GetHeader()->GetRawXML().Data());
     headerXML.Write(::Form("headerXML_%d",fRunContext->GetSubRunNumber()));
@@ -82,6 +94,9 @@ ORDataProcessor::EReturnCode ORFileWriter::EndProcessing()
     ORLog(kError) << "Lost track of fFile!" << endl;
     return kFailure;
   }
+  ORTraceSpan span("TFile::Close", "io");
+  ORTreeFillThread::ReleaseAll();
+  ORVTreeWriter::DeleteRunInfoTrees();
   fFile->Close();
   delete fFile;
   return kSuccess;
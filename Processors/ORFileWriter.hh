@@ -27,6 +27,14 @@ class ORFileWriter : public ORUtilityProcessor
     virtual std::string GetLabel() { return fLabel; }
     virtual void SetLabel(std::string label) { fLabel = label; }
 
+    //! Compression of this writer's files; overrides ORIOConfig's file compression.
+    /*!
+        settings are ROOT compression settings (100*algorithm + level);
+        -1 (the default) uses ORIOConfig::GetFileCompressionSettings().
+     */
+    virtual void SetCompressionSettings(Int_t settings) { fCompressionSettings = settings; }
+    virtual Int_t GetCompressionSettings() { return fCompressionSettings; }
+
   protected:
     virtual TFile* UpdateFilePointer();
   
@@ -35,6 +43,7 @@ class ORFileWriter : public ORUtilityProcessor
     std::string fSavedName;
     TFile* fFile;
     Int_t fLastSubRunNumber;
+    Int_t fCompressionSettings;
 };
 
 #endif
@@ -6,7 +6,8 @@
 using namespace std;
 
 ORGretaWaveformTreeWriter::ORGretaWaveformTreeWriter(string treeName) :
-ORVTreeWriter(new ORGretaDecoder, treeName)
+ORVTreeWriter(new ORGretaDecoder, treeName),
+fWaveformBranch(kMaxWFLength)
 {
   fEventDecoder = dynamic_cast<ORGretaDecoder*>(fDataDecoder);
   fLEDEventTime = 0.;
@@ -36,7 +37,8 @@ ORDataProcessor::EReturnCode ORGretaWaveformTreeWriter::InitializeBranches()
   fTree->Branch("channel", &fChannel, "channel/s");
   fTree->Branch("board", &fBoard, "board/s");
   fTree->Branch("energy", &fEnergy, "energy/i");
-  fTree->Branch("waveform", fWaveform, "waveform[wfLength]/s");
+  fWaveformBranch.Branch(fTree, "waveform", fWaveform, "wfLength",
+                         fEventDecoder->GetBitResolution());
   return kSuccess;
 }
 
@@ -63,7 +65,8 @@ ORDataProcessor::EReturnCode ORGretaWaveformTreeWriter::ProcessMyDataRecord(UInt
   fChannel = fEventDecoder->GetChannelNum();
   fEnergy = fEventDecoder->GetEnergy();
   fWaveformLength = fEventDecoder->CopyWaveformData(fWaveform, kMaxWFLength);
-  fTree->Fill();
+  fWaveformBranch.Encode(fWaveform, fWaveformLength);
+  FillTree();
   return kSuccess;
 }
 
@@ -4,6 +4,7 @@
 #define _ORGretaWaveformTreeWriter_hh_
 
 #include "ORVTreeWriter.hh"
+#include "ORWaveformBranch.hh"
 #include "ORGretaDecoder.hh"
 
 class ORGretaWaveformTreeWriter : public ORVTreeWriter
@@ -15,6 +16,9 @@ class ORGretaWaveformTreeWriter : public ORVTreeWriter
     virtual inline void Clear() 
       { fLEDEventTime = 0.0; fCFDEventTime = 0.0; fCrate = 0; fCard = 0; fChannel = 0; fEnergy = 0; fWaveformLength = 0;}
     enum EDGF4cWFTreeWriter{kMaxWFLength = 5000};
+    //! Selects plain or encoded (ORWaveformCodec) storage of the waveforms.
+    virtual ORWaveformBranch& GetWaveformBranch() { return fWaveformBranch; }
+
   protected:
     virtual EReturnCode InitializeBranches();
 
@@ -24,6 +28,7 @@ class ORGretaWaveformTreeWriter : public ORVTreeWriter
     Double_t fCFDEventTime;
     UShort_t fCrate, fCard, fChannel,fBoard;
     UShort_t fWaveform[kMaxWFLength];
+    ORWaveformBranch fWaveformBranch;
     size_t fWaveformLength;
     UInt_t fEnergy;
 };
@@ -0,0 +1,202 @@
+// ORHistViewer.cc
+
+#include "ORHistViewer.hh"
+
+#include <pthread.h>
+#include <sys/time.h>
+#include <cerrno>
+#include "RVersion.h"
+#include "TApplication.h"
+#include "TCanvas.h"
+#include "TH1.h"
+#include "TROOT.h"
+#include "TSystem.h"
+#if ROOT_VERSION_CODE < ROOT_VERSION(6,5,0)
+#include "TThread.h"
+#endif
+#include "ORLogger.hh"
+
+using namespace std;
+
+// State shared by the publisher and the viewer thread.  fPending and
+// fHasNew are protected by fMutex; fFront and fCanvases belong to the
+// viewer thread.
+class ORHistViewerThread
+{
+  public:
+    ORHistViewerThread(const vector<string>& titles, Double_t refreshTime) :
+      fTitles(titles), fRefreshTime(refreshTime), fStop(false),
+      fPending(titles.size(), (TH1*) NULL), fHasNew(titles.size(), false),
+      fFront(titles.size(), (TH1*) NULL), fCanvases(titles.size(), (TCanvas*) NULL)
+    {
+      pthread_mutex_init(&fMutex, NULL);
+      pthread_cond_init(&fStopCond, NULL);
+    }
+    ~ORHistViewerThread()
+    {
+      for (size_t i=0; i<fPending.size(); i++) delete fPending[i];
+      for (size_t i=0; i<fFront.size(); i++) delete fFront[i];
+      pthread_cond_destroy(&fStopCond);
+      pthread_mutex_destroy(&fMutex);
+    }
+
+    void Run();
+    // Waits for the refresh time or Stop; returns false when stopping.
+    bool Wait();
+    void Draw();
+
+    vector<string> fTitles;
+    Double_t fRefreshTime;
+    pthread_t fThread;
+    pthread_mutex_t fMutex;
+    pthread_cond_t fStopCond;
+    bool fStop;
+    vector<TH1*> fPending;
+    vector<bool> fHasNew;
+    vector<TH1*> fFront;
+    vector<TCanvas*> fCanvases;
+};
+
+static void* ORHistViewerThreadLoop(void* arg)
+{
+  ((ORHistViewerThread*) arg)->Run();
+  return NULL;
+}
+
+bool ORHistViewerThread::Wait()
+{
+  struct timeval now;
+  gettimeofday(&now, NULL);
+  double until = now.tv_sec + 1e-6*now.tv_usec + fRefreshTime;
+  struct timespec deadline;
+  deadline.tv_sec = (time_t) until;
+  deadline.tv_nsec = (long) ((until - deadline.tv_sec)*1e9);
+  pthread_mutex_lock(&fMutex);
+  while (!fStop) {
+    if (pthread_cond_timedwait(&fStopCond, &fMutex, &deadline) == ETIMEDOUT) break;
+  }
+  bool stop = fStop;
+  pthread_mutex_unlock(&fMutex);
+  return !stop;
+}
+
+void ORHistViewerThread::Draw()
+{
+  vector<bool> hasNew(fFront.size(), false);
+  pthread_mutex_lock(&fMutex);
+  for (size_t i=0; i<fFront.size(); i++) {
+    if (!fHasNew[i]) continue;
+    TH1* swap = fFront[i];
+    fFront[i] = fPending[i];
+    fPending[i] = swap;
+    fHasNew[i] = false;
+    hasNew[i] = true;
+  }
+  pthread_mutex_unlock(&fMutex);
+
+  for (size_t i=0; i<fFront.size(); i++) {
+    if (!hasNew[i]) continue;
+    if (fCanvases[i] == NULL) {
+      fCanvases[i] = new TCanvas(Form("ORHistViewer%d", (int) i), fTitles[i].c_str());
+    }
+    // the pad gets a copy of its own, as fFront[i] goes back to the publisher
+    fCanvases[i]->cd();
+    fCanvases[i]->Clear();
+    fFront[i]->DrawCopy();
+    fCanvases[i]->Modified();
+    fCanvases[i]->Update();
+  }
+  gSystem->ProcessEvents();
+}
+
+void ORHistViewerThread::Run()
+{
+  if (gApplication == NULL) new TApplication("ORHistViewer", NULL, NULL, NULL, 0);
+  while (Wait()) Draw();
+  Draw();
+  for (size_t i=0; i<fCanvases.size(); i++) delete fCanvases[i];
+  fCanvases.assign(fCanvases.size(), (TCanvas*) NULL);
+}
+
+ORHistViewer::ORHistViewer(Double_t refreshTime) :
+fRefreshTime(refreshTime), fThread(NULL), fNSkipped(0)
+{
+}
+
+ORHistViewer::~ORHistViewer()
+{
+  Stop();
+  for (size_t i=0; i<fBack.size(); i++) delete fBack[i];
+}
+
+int ORHistViewer::AddPanel(const string& title)
+{
+  if (IsRunning()) {
+    ORLog(kWarning) << "AddPanel(): panels must be added before Start()" << endl;
+    return -1;
+  }
+  fTitles.push_back(title);
+  fBack.push_back(NULL);
+  return fTitles.size() - 1;
+}
+
+bool ORHistViewer::Start()
+{
+  if (IsRunning()) return true;
+#if ROOT_VERSION_CODE >= ROOT_VERSION(6,5,0)
+  ROOT::EnableThreadSafety();
+#else
+  TThread::Initialize();
+#endif
+  fThread = new ORHistViewerThread(fTitles, fRefreshTime);
+  if (pthread_create(&fThread->fThread, NULL, ORHistViewerThreadLoop, fThread) != 0) {
+    ORLog(kError) << "Start(): could not create the viewer thread" << endl;
+    delete fThread;
+    fThread = NULL;
+    return false;
+  }
+  return true;
+}
+
+void ORHistViewer::Stop()
+{
+  if (!IsRunning()) return;
+  pthread_mutex_lock(&fThread->fMutex);
+  fThread->fStop = true;
+  pthread_cond_signal(&fThread->fStopCond);
+  pthread_mutex_unlock(&fThread->fMutex);
+  pthread_join(fThread->fThread, NULL);
+  delete fThread;
+  fThread = NULL;
+}
+
+bool ORHistViewer::Publish(int panel, const TH1* hist)
+{
+  if (!IsRunning() || hist == NULL || panel < 0 || (size_t) panel >= fBack.size()) return false;
+
+  TH1*& back = fBack[panel];
+  if (back == NULL || back->GetNbinsX() != hist->GetNbinsX()) {
+    delete back;
+    Bool_t addDirectory = TH1::AddDirectoryStatus();
+    TH1::AddDirectory(kFALSE);
+    back = (TH1*) hist->Clone();
+    TH1::AddDirectory(addDirectory);
+  }
+  else {
+    for (Int_t iBin = 0; iBin <= hist->GetNbinsX()+1; iBin++) {
+      back->SetBinContent(iBin, hist->GetBinContent(iBin));
+    }
+    back->SetEntries(hist->GetEntries());
+  }
+
+  if (pthread_mutex_trylock(&fThread->fMutex) != 0) {
+    fNSkipped++;
+    return false;
+  }
+  TH1* swap = fThread->fPending[panel];
+  fThread->fPending[panel] = back;
+  back = swap;
+  fThread->fHasNew[panel] = true;
+  pthread_mutex_unlock(&fThread->fMutex);
+  return true;
+}
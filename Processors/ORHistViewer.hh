@@ -0,0 +1,64 @@
+// ORHistViewer.hh
+
+#ifndef _ORHistViewer_hh_
+#define _ORHistViewer_hh_
+
+#include <string>
+#include <vector>
+#ifndef ROOT_Rtypes
+#include "Rtypes.h"
+#endif
+
+class TH1;
+class ORHistViewerThread;
+
+//! Displays snapshots of histograms on a thread of its own.
+/*!
+    Processors that show live histograms Publish() them from the processing
+    thread; a viewer thread draws the latest snapshot of each panel (one
+    canvas per panel) every GetRefreshTime() seconds of wall time.  The
+    processing thread never waits for graphics:
+
+    - Publish() copies the bin contents into a back buffer owned by the
+      publisher, then hands it to the viewer by swapping pointers under a
+      lock that is only held for the swap.  If the viewer holds the lock at
+      that moment, Publish() returns false and the snapshot is skipped; the
+      next one supersedes it anyway.
+    - The viewer swaps the latest snapshot into its front buffer, again
+      only for the time of a pointer swap, and draws from there.
+
+    Only 1-dimensional histograms are supported.  The canvases (and the
+    TApplication, if none exists) are created by the viewer thread.
+ */
+class ORHistViewer
+{
+  public:
+    ORHistViewer(Double_t refreshTime = 1.0);
+    virtual ~ORHistViewer();
+
+    //! Adds a canvas with title; returns the panel number for Publish().
+    virtual int AddPanel(const std::string& title);
+    virtual void SetRefreshTime(Double_t seconds) { fRefreshTime = seconds; }
+    virtual Double_t GetRefreshTime() const { return fRefreshTime; }
+
+    //! Starts the viewer thread.
+    virtual bool Start();
+    //! Stops and joins the viewer thread; the canvases are deleted.
+    virtual void Stop();
+    virtual bool IsRunning() const { return fThread != NULL; }
+
+    //! Hands a copy of hist to panel; false if skipped.
+    virtual bool Publish(int panel, const TH1* hist);
+
+    //! Snapshots skipped because the viewer was busy swapping.
+    virtual size_t GetNSkipped() const { return fNSkipped; }
+
+  protected:
+    Double_t fRefreshTime;
+    std::vector<std::string> fTitles;
+    std::vector<TH1*> fBack;   // filled by Publish(), by panel
+    ORHistViewerThread* fThread; //!
+    size_t fNSkipped;
+};
+
+#endif
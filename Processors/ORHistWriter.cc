@@ -2,17 +2,104 @@
 
 #include "ORHistWriter.hh"
 
+#include <pthread.h>
 #include "TH2.h"
 #include "TH3.h"
 #include "ORLogger.hh"
+#include "ORMemoryMonitor.hh"
+#include "ORReadWriteLock.hh"
 #include "TROOT.h"
 
 using namespace std;
 
+// Entries of one histogram waiting for FillN().
+struct ORHistBatch
+{
+  TH1* fHist;
+  size_t fN;
+  vector<double> fX, fY, fZ, fW;
+};
+
+// Batches (and, for threads other than the main one, shadow histograms)
+// of one thread.
+class ORHistFillContext
+{
+  public:
+    ORHistFillContext(bool isShadow) : fIsShadow(isShadow) {}
+    ~ORHistFillContext() { Clear(); }
+    void Clear()
+    {
+      for (size_t i = 0; i < fBatches.size(); i++) delete fBatches[i];
+      for (size_t i = 0; i < fShadows.size(); i++) delete fShadows[i];
+      fBatches.clear();
+      fShadows.clear();
+    }
+
+    bool fIsShadow;
+    vector<ORHistBatch*> fBatches; // by histogram index
+    vector<TH1*> fShadows;         // by histogram index
+};
+
+static size_t ORHistFillContextBytes(const ORHistFillContext* context)
+{
+  size_t nBytes = 0;
+  for (size_t i = 0; i < context->fBatches.size(); i++) {
+    const ORHistBatch* batch = context->fBatches[i];
+    if (batch == NULL) continue;
+    nBytes += (batch->fX.capacity() + batch->fY.capacity() + batch->fZ.capacity() +
+               batch->fW.capacity())*sizeof(double);
+  }
+  for (size_t i = 0; i < context->fShadows.size(); i++) {
+    nBytes += ORMemoryMonitor::SizeOf(context->fShadows[i]);
+  }
+  return nBytes;
+}
+
+class ORHistWriterThreads
+{
+  public:
+    pthread_key_t fKey;
+    ORReadWriteLock fLock; // for booking, and the list of contexts
+    vector<ORHistFillContext*> fContexts;
+};
+
+static void FillBatch(ORHistBatch* batch, size_t nDim)
+{
+  if (batch->fN == 0) return;
+  Int_t n = batch->fN;
+  switch (nDim) {
+    case 2:
+      ((TH2*) batch->fHist)->FillN(n, &batch->fX[0], &batch->fY[0], &batch->fW[0]);
+      break;
+    case 3:
+      for (Int_t i = 0; i < n; i++) {
+        ((TH3*) batch->fHist)->Fill(batch->fX[i], batch->fY[i], batch->fZ[i], batch->fW[i]);
+      }
+      break;
+    default:
+      batch->fHist->FillN(n, &batch->fX[0], &batch->fW[0]);
+      break;
+  }
+  batch->fN = 0;
+}
+
 ORHistWriter::ORHistWriter(ORVHistDecoder* histDecoder) :
 ORDataProcessor(histDecoder)
 {
   fHistDecoder = histDecoder;
+  fBatchSize = 256;
+  fThreadLocalFilling = false;
+  fMainContext = new ORHistFillContext(false);
+  fThreads = new ORHistWriterThreads;
+  pthread_key_create(&fThreads->fKey, NULL);
+}
+
+ORHistWriter::~ORHistWriter()
+{
+  pthread_key_delete(fThreads->fKey);
+  for (size_t i = 0; i < fThreads->fContexts.size(); i++) delete fThreads->fContexts[i];
+  delete fThreads;
+  delete fMainContext;
 }
 
 ORDataProcessor::EReturnCode ORHistWriter::StartProcessing()
@@ -27,97 +114,190 @@ ORDataProcessor::EReturnCode ORHistWriter::StartProcessing()
 
 ORDataProcessor::EReturnCode ORHistWriter::StartRun()
 {
-  map<int, TH1*>::iterator iHist;
-  for (iHist = fHists.begin(); iHist != fHists.end(); iHist++) {
-    if (iHist->second != NULL) iHist->second->Reset();
+  for (size_t iHist = 0; iHist < fHists.size(); iHist++) {
+    if (fHists[iHist] != NULL) fHists[iHist]->Reset();
   }
  
   return kSuccess;
 }
 
+TH1* ORHistWriter::BookHist(int iHist)
+{
+  // fHists are owned by parent root file (or gROOT); 
+  // they will be deleted upon fFile->Close() (or end of program)
+  TH1* hist = NULL;
+  switch(fHistDecoder->GetNDim()) {
+    case 1:
+      hist = new TH1D(
+        fHistDecoder->GetHistName(iHist).c_str(), fHistDecoder->GetHistTitle(iHist).c_str(),
+        fHistDecoder->GetNbinsX(), fHistDecoder->GetXLo(), fHistDecoder->GetXHi()
+      );
+      hist->SetXTitle(fHistDecoder->GetXTitle().c_str());
+      break;
+    case 2:
+      hist = new TH2D(
+        fHistDecoder->GetHistName(iHist).c_str(), fHistDecoder->GetHistTitle(iHist).c_str(),
+        fHistDecoder->GetNbinsX(), fHistDecoder->GetXLo(), fHistDecoder->GetXHi(),
+        fHistDecoder->GetNbinsY(), fHistDecoder->GetYLo(), fHistDecoder->GetYHi()
+      );
+      hist->SetXTitle(fHistDecoder->GetXTitle().c_str());
+      hist->SetYTitle(fHistDecoder->GetYTitle().c_str());
+      break;
+    case 3:
+      hist = new TH3D(
+        fHistDecoder->GetHistName(iHist).c_str(), fHistDecoder->GetHistTitle(iHist).c_str(),
+        fHistDecoder->GetNbinsX(), fHistDecoder->GetXLo(), fHistDecoder->GetXHi(),
+        fHistDecoder->GetNbinsY(), fHistDecoder->GetYLo(), fHistDecoder->GetYHi(),
+        fHistDecoder->GetNbinsZ(), fHistDecoder->GetZLo(), fHistDecoder->GetZHi()
+      );
+      hist->SetXTitle(fHistDecoder->GetXTitle().c_str());
+      hist->SetYTitle(fHistDecoder->GetYTitle().c_str());
+      hist->SetZTitle(fHistDecoder->GetZTitle().c_str());
+      break;
+    default:
+      ORLog(kWarning) << "BookHist(): Can't handle more than "
+                      << "3 dimensions; using 1..." << endl;
+      hist = new TH1D(
+        fHistDecoder->GetHistName(iHist).c_str(), fHistDecoder->GetHistTitle(iHist).c_str(),
+        fHistDecoder->GetNbinsX(), fHistDecoder->GetXLo(), fHistDecoder->GetXHi()
+      );
+  }
+  return hist;
+}
+
+TH1* ORHistWriter::GetHist(int iHist)
+{
+  if (fThreadLocalFilling) fThreads->fLock.writeLock();
+  if ((size_t) iHist >= fHists.size()) fHists.resize(iHist+1, (TH1*) NULL);
+  if (fHists[iHist] == NULL) fHists[iHist] = BookHist(iHist);
+  TH1* hist = fHists[iHist];
+  if (fThreadLocalFilling) fThreads->fLock.unlock();
+  return hist;
+}
+
+ORHistFillContext* ORHistWriter::GetFillContext()
+{
+  if (!fThreadLocalFilling) return fMainContext;
+  ORHistFillContext* context = (ORHistFillContext*) pthread_getspecific(fThreads->fKey);
+  if (context == NULL) {
+    context = new ORHistFillContext(true);
+    fThreads->fLock.writeLock();
+    fThreads->fContexts.push_back(context);
+    fThreads->fLock.unlock();
+    pthread_setspecific(fThreads->fKey, context);
+  }
+  return context;
+}
+
 ORDataProcessor::EReturnCode ORHistWriter::ProcessMyDataRecord(UInt_t* record)
 {
   int iHist = fHistDecoder->GetHistIndex(record);
+  if (iHist < 0 || iHist >= kMaxHistIndex) {
+    ORLog(kWarning) << "ProcessMyDataRecord(): histogram index " << iHist
+                    << " out of range" << endl;
+    return kFailure;
+  }
 
-  // look up in map only once for a typical record
-  TH1* hist = fHists[iHist]; 
-
-  if(hist == NULL) {
-    switch(fHistDecoder->GetNDim()) {
-      // fHists are owned by parent root file (or gROOT); 
-      // they will be deleted upon fFile->Close() (or end of program)
-      case 1:
-        fHists[iHist] = new TH1D(
-	  fHistDecoder->GetHistName(iHist).c_str(), fHistDecoder->GetHistTitle(iHist).c_str(),
-	  fHistDecoder->GetNbinsX(), fHistDecoder->GetXLo(), fHistDecoder->GetXHi()
-	);
-	fHists[iHist]->SetXTitle(fHistDecoder->GetXTitle().c_str());
-        break;
-      case 2:
-        fHists[iHist] = new TH2D(
-	  fHistDecoder->GetHistName(iHist).c_str(), fHistDecoder->GetHistTitle(iHist).c_str(),
-	  fHistDecoder->GetNbinsX(), fHistDecoder->GetXLo(), fHistDecoder->GetXHi(),
-	  fHistDecoder->GetNbinsY(), fHistDecoder->GetYLo(), fHistDecoder->GetYHi()
-	);
-	fHists[iHist]->SetXTitle(fHistDecoder->GetXTitle().c_str());
-	fHists[iHist]->SetYTitle(fHistDecoder->GetYTitle().c_str());
-        break;
-      case 3:
-        fHists[iHist] = new TH3D(
-	  fHistDecoder->GetHistName(iHist).c_str(), fHistDecoder->GetHistTitle(iHist).c_str(),
-	  fHistDecoder->GetNbinsX(), fHistDecoder->GetXLo(), fHistDecoder->GetXHi(),
-	  fHistDecoder->GetNbinsY(), fHistDecoder->GetYLo(), fHistDecoder->GetYHi(),
-	  fHistDecoder->GetNbinsZ(), fHistDecoder->GetZLo(), fHistDecoder->GetZHi()
-	);
-	fHists[iHist]->SetXTitle(fHistDecoder->GetXTitle().c_str());
-	fHists[iHist]->SetYTitle(fHistDecoder->GetYTitle().c_str());
-	fHists[iHist]->SetZTitle(fHistDecoder->GetZTitle().c_str());
-        break;
-      default:
-        ORLog(kWarning) << "ProcessMyDataRecord(): Can't handle more than "
-	                << "3 dimensions; using 1..." << endl;
-        fHists[iHist] = new TH1D(
-	  fHistDecoder->GetHistName(iHist).c_str(), fHistDecoder->GetHistTitle(iHist).c_str(),
-	  fHistDecoder->GetNbinsX(), fHistDecoder->GetXLo(), fHistDecoder->GetXHi()
-	);
+  ORHistFillContext* context = GetFillContext();
+  if ((size_t) iHist >= context->fBatches.size()) {
+    context->fBatches.resize(iHist+1, (ORHistBatch*) NULL);
+  }
+  ORHistBatch* batch = context->fBatches[iHist];
+  size_t nDim = fHistDecoder->GetNDim();
+  if (batch == NULL) {
+    batch = new ORHistBatch;
+    batch->fN = 0;
+    batch->fHist = GetHist(iHist);
+    if (context->fIsShadow) {
+      // private copy for this thread; Clone() under the lock, as it uses gDirectory
+      fThreads->fLock.writeLock();
+      Bool_t addDirectory = TH1::AddDirectoryStatus();
+      TH1::AddDirectory(kFALSE);
+      TH1* shadow = (TH1*) batch->fHist->Clone();
+      TH1::AddDirectory(addDirectory);
+      fThreads->fLock.unlock();
+      shadow->SetDirectory(NULL);
+      shadow->Reset();
+      if ((size_t) iHist >= context->fShadows.size()) {
+        context->fShadows.resize(iHist+1, (TH1*) NULL);
+      }
+      context->fShadows[iHist] = shadow;
+      batch->fHist = shadow;
     }
-    hist = fHists[iHist];
-  }
-
-  for(size_t iEntry=0; iEntry < fHistDecoder->GetNEntries(record); iEntry++) {
-    switch(fHistDecoder->GetNDim()) {
-      case 1: 
-        hist->Fill(fHistDecoder->GetX(record, iEntry), 
-                   fHistDecoder->GetWeight(record, iEntry));
-        break;
-      case 2: 
-        ((TH2D*) hist)->Fill(fHistDecoder->GetX(record, iEntry), 
-                             fHistDecoder->GetY(record, iEntry), 
-                             fHistDecoder->GetWeight(record, iEntry));
-        break;
-      case 3: 
-        ((TH3D*) hist)->Fill(fHistDecoder->GetX(record, iEntry), 
-                             fHistDecoder->GetY(record, iEntry), 
-                             fHistDecoder->GetZ(record, iEntry),
-                             fHistDecoder->GetWeight(record, iEntry));
-        break;
-      default:
-        hist->Fill(fHistDecoder->GetX(record, iEntry), 
-                   fHistDecoder->GetWeight(record, iEntry));
-        break;
+    context->fBatches[iHist] = batch;
+  }
+
+  size_t nEntries = fHistDecoder->GetNEntries(record);
+  if (nEntries == 0) return kSuccess;
+  if (batch->fN + nEntries > batch->fX.size()) {
+    FillBatch(batch, nDim);
+    size_t capacity = (nEntries > fBatchSize) ? nEntries : fBatchSize;
+    if (capacity > batch->fX.size()) {
+      batch->fX.resize(capacity);
+      batch->fW.resize(capacity);
+      if (nDim == 2 || nDim == 3) batch->fY.resize(capacity);
+      if (nDim == 3) batch->fZ.resize(capacity);
     }
   }
+  size_t n = batch->fN;
+  fHistDecoder->DecodeEntries(record, nEntries, &batch->fX[n],
+                              (nDim == 2 || nDim == 3) ? &batch->fY[n] : NULL,
+                              (nDim == 3) ? &batch->fZ[n] : NULL, &batch->fW[n]);
+  batch->fN += nEntries;
+  if (batch->fN >= fBatchSize) FillBatch(batch, nDim);
 
   return kSuccess;
 }
 
+size_t ORHistWriter::GetMemoryUsage() const
+{
+  size_t nBytes = ORDataProcessor::GetMemoryUsage();
+  for (size_t iHist = 0; iHist < fHists.size(); iHist++) {
+    nBytes += ORMemoryMonitor::SizeOf(fHists[iHist]);
+  }
+  nBytes += ORHistFillContextBytes(fMainContext);
+  if (fThreadLocalFilling) fThreads->fLock.readLock();
+  for (size_t i = 0; i < fThreads->fContexts.size(); i++) {
+    nBytes += ORHistFillContextBytes(fThreads->fContexts[i]);
+  }
+  if (fThreadLocalFilling) fThreads->fLock.unlock();
+  return nBytes;
+}
+
+void ORHistWriter::FlushBatches(ORHistFillContext* context)
+{
+  size_t nDim = fHistDecoder->GetNDim();
+  for (size_t i = 0; i < context->fBatches.size(); i++) {
+    if (context->fBatches[i] != NULL) FillBatch(context->fBatches[i], nDim);
+  }
+}
+
+void ORHistWriter::MergeShadows()
+{
+  for (size_t iContext = 0; iContext < fThreads->fContexts.size(); iContext++) {
+    ORHistFillContext* context = fThreads->fContexts[iContext];
+    FlushBatches(context);
+    for (size_t iHist = 0; iHist < context->fShadows.size(); iHist++) {
+      TH1* shadow = context->fShadows[iHist];
+      if (shadow != NULL && iHist < fHists.size() && fHists[iHist] != NULL) {
+        fHists[iHist]->Add(shadow);
+      }
+    }
+    // the histograms may not survive the run (see EndRun())
+    context->Clear();
+  }
+}
+
 ORDataProcessor::EReturnCode ORHistWriter::EndRun()
 {
-  map<int, TH1*>::iterator iHist;
-  for (iHist = fHists.begin(); iHist != fHists.end(); iHist++) {
-    if (iHist->second != NULL) {
-      iHist->second->Write();
-      iHist->second->Reset();
+  FlushBatches(fMainContext);
+  fMainContext->Clear();
+  MergeShadows();
+
+  for (size_t iHist = 0; iHist < fHists.size(); iHist++) {
+    if (fHists[iHist] != NULL) {
+      fHists[iHist]->Write();
+      fHists[iHist]->Reset();
     }
   }
 
@@ -133,9 +313,9 @@ ORDataProcessor::EReturnCode ORHistWriter::EndProcessing()
 {
   if(string(gDirectory->GetName()) != "Rint") return kSuccess;
 
-  map<int, TH1*>::iterator iHist;
-  for (iHist = fHists.begin(); iHist != fHists.end(); iHist++) {
-    delete iHist->second;
+  for (size_t iHist = 0; iHist < fHists.size(); iHist++) {
+    delete fHists[iHist];
   }
+  fHists.clear();
   return kSuccess;
 }
@@ -3,17 +3,35 @@
 #ifndef _ORHistWriter_hh_
 #define _ORHistWriter_hh_
 
-#include <map>
+#include <vector>
 #include "TH1.h"
 #include "ORDataProcessor.hh"
 #include "ORVHistDecoder.hh"
 
+class ORHistFillContext;
+class ORHistWriterThreads;
 
+//! Fills and writes the histograms of an ORVHistDecoder.
+/*!
+    Histograms are kept in a table indexed directly by
+    ORVHistDecoder::GetHistIndex(), which must be in [0, kMaxHistIndex).
+    Entries are decoded in bulk (ORVHistDecoder::DecodeEntries()) into
+    per-histogram batches of SetBatchSize() entries, which are filled with
+    TH1::FillN() (TH2::FillN() for 2 dimensions) when full and at the end
+    of the run.
+
+    With SetThreadLocalFilling(), each thread calling ProcessDataRecord()
+    fills shadow histograms of its own, without locking; the shadows are
+    added to the histograms at EndRun(), which must be called after all
+    threads have finished processing the run.
+ */
 class ORHistWriter : public ORDataProcessor
 {
   public:
+    enum EHistWriterConsts { kMaxHistIndex = 0x100000 };
+
     ORHistWriter(ORVHistDecoder* histDecoder);
-    virtual ~ORHistWriter() {}
+    virtual ~ORHistWriter();
 
     virtual EReturnCode StartProcessing();
     virtual EReturnCode StartRun();
@@ -21,9 +39,28 @@ class ORHistWriter : public ORDataProcessor
     virtual EReturnCode EndRun();
     virtual EReturnCode EndProcessing();
 
+    //! Entries buffered per histogram before FillN(); 1 fills every record directly.
+    virtual void SetBatchSize(size_t nEntries) { fBatchSize = (nEntries > 0) ? nEntries : 1; }
+    virtual void SetThreadLocalFilling(bool threadLocal = true) { fThreadLocalFilling = threadLocal; }
+
+    //! Histogram contents, including batches and shadows.
+    virtual size_t GetMemoryUsage() const;
+
+  protected:
+    //! Histogram iHist, booked on first use.
+    virtual TH1* GetHist(int iHist);
+    virtual TH1* BookHist(int iHist);
+    virtual ORHistFillContext* GetFillContext();
+    virtual void FlushBatches(ORHistFillContext* context);
+    virtual void MergeShadows();
+
   protected:
-    std::map<int, TH1*> fHists;
+    std::vector<TH1*> fHists; // by histogram index; NULL if not booked
     ORVHistDecoder* fHistDecoder;
+    size_t fBatchSize;
+    bool fThreadLocalFilling;
+    ORHistFillContext* fMainContext; //!
+    ORHistWriterThreads* fThreads; //!
 };
 
 #endif
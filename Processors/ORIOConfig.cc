@@ -0,0 +1,266 @@
+// ORIOConfig.cc
+
+#include "ORIOConfig.hh"
+
+#include <fnmatch.h>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include "RVersion.h"
+#include "TFile.h"
+#include "TTree.h"
+#include "TBranch.h"
+#include "TObjArray.h"
+#include "ORLogger.hh"
+#include "ORWaveformCodec.hh"
+
+using namespace std;
+
+Int_t ORIOConfig::fgFileCompressionSettings = -1;
+vector<pair<string, ORTreeIOSettings> > ORIOConfig::fgTreeSettings;
+
+ORTreeIOSettings::ORTreeIOSettings()
+{
+  fCompressionAlgorithm = -1;
+  fCompressionLevel = -1;
+  fBasketSize = 0;
+  fHasAutoFlush = false;
+  fAutoFlush = 0;
+  fHasAutoSave = false;
+  fAutoSave = 0;
+  fWaveformCodec = -1;
+}
+
+void ORTreeIOSettings::Merge(const ORTreeIOSettings& other)
+{
+  if (other.fCompressionAlgorithm >= 0) fCompressionAlgorithm = other.fCompressionAlgorithm;
+  if (other.fCompressionLevel >= 0) fCompressionLevel = other.fCompressionLevel;
+  if (other.fBasketSize > 0) fBasketSize = other.fBasketSize;
+  if (other.fHasAutoFlush) SetAutoFlush(other.fAutoFlush);
+  if (other.fHasAutoSave) SetAutoSave(other.fAutoSave);
+  if (other.fWaveformCodec >= 0) fWaveformCodec = other.fWaveformCodec;
+  map<string, Int_t>::const_iterator iter;
+  for (iter = other.fBranchBasketSizes.begin(); iter != other.fBranchBasketSizes.end(); iter++) {
+    fBranchBasketSizes[iter->first] = iter->second;
+  }
+}
+
+bool ORTreeIOSettings::IsEmpty() const
+{
+  return fCompressionAlgorithm < 0 && fCompressionLevel < 0 && fBasketSize <= 0 &&
+         !fHasAutoFlush && !fHasAutoSave && fBranchBasketSizes.empty() &&
+         fWaveformCodec < 0;
+}
+
+Int_t ORTreeIOSettings::GetCompressionSettings() const
+{
+  if (fCompressionAlgorithm < 0 && fCompressionLevel < 0) return -1;
+  Int_t algorithm = (fCompressionAlgorithm < 0) ? ORIOConfig::kUseGlobal : fCompressionAlgorithm;
+  Int_t level = (fCompressionLevel < 0) ? 1 : fCompressionLevel;
+  return 100*algorithm + level;
+}
+
+void ORTreeIOSettings::Apply(TTree* aTree) const
+{
+  if (aTree == NULL || IsEmpty()) return;
+
+  // Basket sizes first: the global size, then the per-branch exceptions.
+  if (fBasketSize > 0) aTree->SetBasketSize("*", fBasketSize);
+  map<string, Int_t>::const_iterator iter;
+  for (iter = fBranchBasketSizes.begin(); iter != fBranchBasketSizes.end(); iter++) {
+    if (aTree->GetBranch(iter->first.c_str()) == NULL) {
+      ORLog(kWarning) << "Apply(): tree " << aTree->GetName() << " has no branch "
+                      << iter->first << "; basket size not set" << endl;
+      continue;
+    }
+    aTree->SetBasketSize(iter->first.c_str(), iter->second);
+  }
+
+  Int_t settings = GetCompressionSettings();
+  if (settings >= 0) {
+    TObjArray* branches = aTree->GetListOfBranches();
+    for (int i=0; i<branches->GetEntriesFast(); i++) {
+      ApplyCompression((TBranch*) branches->At(i), settings);
+    }
+  }
+
+  if (fHasAutoFlush) aTree->SetAutoFlush(fAutoFlush);
+  if (fHasAutoSave) aTree->SetAutoSave(fAutoSave);
+}
+
+void ORTreeIOSettings::ApplyCompression(TBranch* aBranch, Int_t settings) const
+{
+  if (aBranch == NULL) return;
+  aBranch->SetCompressionSettings(settings);
+  TObjArray* subBranches = aBranch->GetListOfBranches();
+  for (int i=0; i<subBranches->GetEntriesFast(); i++) {
+    ApplyCompression((TBranch*) subBranches->At(i), settings);
+  }
+}
+
+bool ORIOConfig::ParseCompression(const string& spec, Int_t& algorithm, Int_t& level)
+{
+  string algoName = spec;
+  string levelString;
+  size_t colon = spec.find(':');
+  if (colon != string::npos) {
+    algoName = spec.substr(0, colon);
+    levelString = spec.substr(colon+1);
+  }
+  else if (spec.find_first_not_of("0123456789") == string::npos) {
+    algoName = "";
+    levelString = spec;
+  }
+
+  if (algoName == "") algorithm = kUseGlobal;
+  else if (algoName == "zlib") algorithm = kZLIB;
+  else if (algoName == "lzma") algorithm = kLZMA;
+  else if (algoName == "lz4") algorithm = kLZ4;
+  else if (algoName == "zstd") algorithm = kZSTD;
+  else {
+    ORLog(kError) << "ParseCompression(): unknown compression algorithm "
+                  << algoName << " in " << spec << endl;
+    return false;
+  }
+
+  if (levelString == "") level = (algorithm == kLZ4) ? 4 : 1;
+  else {
+    if (levelString.find_first_not_of("0123456789") != string::npos) {
+      ORLog(kError) << "ParseCompression(): bad compression level in " << spec << endl;
+      return false;
+    }
+    level = atoi(levelString.c_str());
+    if (level > 9) {
+      ORLog(kWarning) << "ParseCompression(): compression level " << level
+                      << " out of range, using 9" << endl;
+      level = 9;
+    }
+  }
+
+#if ROOT_VERSION_CODE < ROOT_VERSION(6,12,0)
+  if (algorithm == kLZ4) {
+    ORLog(kWarning) << "ParseCompression(): lz4 requires ROOT >= 6.12; "
+                    << "using the global default" << endl;
+    algorithm = kUseGlobal;
+  }
+#endif
+#if ROOT_VERSION_CODE < ROOT_VERSION(6,20,0)
+  if (algorithm == kZSTD) {
+    ORLog(kWarning) << "ParseCompression(): zstd requires ROOT >= 6.20; "
+                    << "using the global default" << endl;
+    algorithm = kUseGlobal;
+  }
+#endif
+  return true;
+}
+
+void ORIOConfig::SetFileCompression(Int_t algorithm, Int_t level)
+{
+  fgFileCompressionSettings = 100*algorithm + level;
+}
+
+bool ORIOConfig::SetFileCompression(const string& spec)
+{
+  Int_t algorithm, level;
+  if (!ParseCompression(spec, algorithm, level)) return false;
+  SetFileCompression(algorithm, level);
+  return true;
+}
+
+bool ORIOConfig::ParseWaveformCodec(const string& spec, Int_t& codec)
+{
+  if (spec == "off") codec = 0;
+  else if (spec == "delta") codec = ORWaveformCodec::kDelta;
+  else if (spec == "linear") codec = ORWaveformCodec::kLinear;
+  else if (spec == "bitpack") codec = ORWaveformCodec::kNoPrediction;
+  else {
+    ORLog(kError) << "ParseWaveformCodec(): unknown waveform codec " << spec << endl;
+    return false;
+  }
+  return true;
+}
+
+void ORIOConfig::AddTreeSettings(const string& namePattern, const ORTreeIOSettings& settings)
+{
+  fgTreeSettings.push_back(pair<string, ORTreeIOSettings>(namePattern, settings));
+}
+
+ORTreeIOSettings ORIOConfig::GetTreeSettings(const string& treeName)
+{
+  ORTreeIOSettings settings;
+  for (size_t i=0; i<fgTreeSettings.size(); i++) {
+    if (fnmatch(fgTreeSettings[i].first.c_str(), treeName.c_str(), 0) == 0) {
+      settings.Merge(fgTreeSettings[i].second);
+    }
+  }
+  return settings;
+}
+
+bool ORIOConfig::ParseSetting(const string& line)
+{
+  string setting = line.substr(0, line.find('#'));
+  istringstream tokens(setting);
+  vector<string> words;
+  string word;
+  while (tokens >> word) words.push_back(word);
+  if (words.size() == 0) return true;
+
+  if (words[0] == "file") {
+    if (words.size() == 3 && words[1] == "compression") return SetFileCompression(words[2]);
+  }
+  else if (words[0] == "tree" && words.size() >= 4) {
+    ORTreeIOSettings settings;
+    const string& key = words[2];
+    if (words.size() == 4 && key == "compression") {
+      Int_t algorithm, level;
+      if (!ParseCompression(words[3], algorithm, level)) return false;
+      settings.SetCompression(algorithm, level);
+    }
+    else if (words.size() == 4 && key == "basketsize") settings.SetBasketSize(atoi(words[3].c_str()));
+    else if (words.size() == 4 && key == "autoflush") settings.SetAutoFlush(atoll(words[3].c_str()));
+    else if (words.size() == 4 && key == "autosave") settings.SetAutoSave(atoll(words[3].c_str()));
+    else if (words.size() == 4 && key == "waveformcodec") {
+      Int_t codec;
+      if (!ParseWaveformCodec(words[3], codec)) return false;
+      settings.SetWaveformCodec(codec);
+    }
+    else if (words.size() == 6 && key == "branch" && words[4] == "basketsize") {
+      settings.SetBranchBasketSize(words[3], atoi(words[5].c_str()));
+    }
+    else {
+      ORLog(kError) << "ParseSetting(): unknown tree setting: " << line << endl;
+      return false;
+    }
+    AddTreeSettings(words[1], settings);
+    return true;
+  }
+  ORLog(kError) << "ParseSetting(): could not parse setting: " << line << endl;
+  return false;
+}
+
+bool ORIOConfig::LoadConfigFile(const string& fileName)
+{
+  ifstream configFile(fileName.c_str());
+  if (!configFile.good()) {
+    ORLog(kError) << "LoadConfigFile(): could not open " << fileName << endl;
+    return false;
+  }
+  string line;
+  int lineNumber = 0;
+  bool allGood = true;
+  while (getline(configFile, line)) {
+    lineNumber++;
+    if (!ParseSetting(line)) {
+      ORLog(kError) << "LoadConfigFile(): error on line " << lineNumber
+                    << " of " << fileName << endl;
+      allGood = false;
+    }
+  }
+  return allGood;
+}
+
+void ORIOConfig::ApplyToFile(TFile* aFile)
+{
+  if (aFile == NULL || fgFileCompressionSettings < 0) return;
+  aFile->SetCompressionSettings(fgFileCompressionSettings);
+}
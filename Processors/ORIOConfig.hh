@@ -0,0 +1,127 @@
+// ORIOConfig.hh
+
+#ifndef _ORIOConfig_hh_
+#define _ORIOConfig_hh_
+
+#include <string>
+#include <map>
+#include <vector>
+#ifndef ROOT_Rtypes
+#include "Rtypes.h"
+#endif
+
+class TFile;
+class TTree;
+class TBranch;
+
+//! I/O settings for a single TTree.
+/*!
+    Every field is optional; unset fields leave the ROOT defaults (or the
+    value set by an earlier, less specific, setting) alone.
+ */
+class ORTreeIOSettings
+{
+  public:
+    ORTreeIOSettings();
+
+    //! Fills in the fields that are set in other.  Branch basket sizes are merged.
+    virtual void Merge(const ORTreeIOSettings& other);
+    //! Applies the settings to aTree.  Call after all branches have been made.
+    virtual void Apply(TTree* aTree) const;
+    virtual bool IsEmpty() const;
+
+    void SetCompression(Int_t algorithm, Int_t level)
+      { fCompressionAlgorithm = algorithm; fCompressionLevel = level; }
+    void SetBasketSize(Int_t nBytes) { fBasketSize = nBytes; }
+    void SetBranchBasketSize(const std::string& branchName, Int_t nBytes)
+      { fBranchBasketSizes[branchName] = nBytes; }
+    //! See TTree::SetAutoFlush(): > 0 entries, < 0 bytes, 0 disables.
+    void SetAutoFlush(Long64_t autoFlush) { fAutoFlush = autoFlush; fHasAutoFlush = true; }
+    //! See TTree::SetAutoSave(): > 0 entries, < 0 bytes, 0 disables.
+    void SetAutoSave(Long64_t autoSave) { fAutoSave = autoSave; fHasAutoSave = true; }
+    //! 0: store waveforms as plain arrays, else the ORWaveformCodec::EPredictor to encode them with.
+    void SetWaveformCodec(Int_t predictor) { fWaveformCodec = predictor; }
+    Int_t GetWaveformCodec() const { return fWaveformCodec; }
+
+    Int_t GetCompressionAlgorithm() const { return fCompressionAlgorithm; }
+    Int_t GetCompressionLevel() const { return fCompressionLevel; }
+    //! ROOT compression settings (100*algorithm + level), or -1 if unset.
+    Int_t GetCompressionSettings() const;
+
+  protected:
+    virtual void ApplyCompression(TBranch* aBranch, Int_t settings) const;
+
+  public:
+    Int_t fCompressionAlgorithm; // -1: unset
+    Int_t fCompressionLevel;     // -1: unset
+    Int_t fBasketSize;           // 0: unset
+    bool fHasAutoFlush;
+    Long64_t fAutoFlush;
+    bool fHasAutoSave;
+    Long64_t fAutoSave;
+    std::map<std::string, Int_t> fBranchBasketSizes;
+    Int_t fWaveformCodec;        // -1: unset; used by ORWaveformBranch
+};
+
+//! Global configuration of the ROOT output of OrcaROOT.
+/*!
+    ORFileWriter applies the file compression when it opens an output file
+    and ORVTreeWriter applies the settings of all tree patterns matching the
+    name of its tree after the tree's branches have been made, in the order
+    in which they were given (later settings win).  Settings made directly
+    on a writer (ORVTreeWriter::SetIOSettings(),
+    ORFileWriter::SetCompressionSettings()) take precedence.
+
+    Settings may be loaded from a configuration file, one setting per line,
+    with '#' starting a comment:
+    \verbatim
+    file compression zlib:1
+    tree * autoflush -30000000
+    tree *Waveform* compression lzma:6
+    tree *Waveform* basketsize 256000
+    tree *Waveform* branch waveform basketsize 1024000
+    tree *Ami286* compression lz4:4
+    tree *Ami286* autosave 1000
+    tree *Waveform* waveformcodec linear
+    \endverbatim
+    Tree names are matched as shell wildcards.  Compression is given as
+    algorithm[:level] or as a bare level; the algorithms are zlib, lzma,
+    lz4 and zstd (lz4 requires ROOT >= 6.12, zstd ROOT >= 6.20).  The
+    waveform codec (see ORWaveformBranch) is one of off, delta, linear or
+    bitpack.
+ */
+class ORIOConfig
+{
+  public:
+    enum ECompressionAlgorithm { kUseGlobal = 0, kZLIB = 1, kLZMA = 2,
+                                 kOldCompressionAlgo = 3, kLZ4 = 4, kZSTD = 5 };
+
+    //! Parses "algorithm[:level]" or "level".  Returns false if malformed.
+    static bool ParseCompression(const std::string& spec, Int_t& algorithm, Int_t& level);
+
+    static void SetFileCompression(Int_t algorithm, Int_t level);
+    static bool SetFileCompression(const std::string& spec);
+
+    //! Parses off, delta, linear or bitpack; returns false if unknown.
+    static bool ParseWaveformCodec(const std::string& spec, Int_t& codec);
+    //! ROOT compression settings for new files, -1 if unset.
+    static Int_t GetFileCompressionSettings() { return fgFileCompressionSettings; }
+
+    //! Adds settings for all trees matching namePattern.
+    static void AddTreeSettings(const std::string& namePattern, const ORTreeIOSettings& settings);
+    //! Merges all settings whose pattern matches treeName.
+    static ORTreeIOSettings GetTreeSettings(const std::string& treeName);
+    static void ClearTreeSettings() { fgTreeSettings.clear(); }
+
+    //! Parses one line of the configuration file format.
+    static bool ParseSetting(const std::string& line);
+    static bool LoadConfigFile(const std::string& fileName);
+
+    static void ApplyToFile(TFile* aFile);
+
+  protected:
+    static Int_t fgFileCompressionSettings;
+    static std::vector<std::pair<std::string, ORTreeIOSettings> > fgTreeSettings; //!
+};
+
+#endif
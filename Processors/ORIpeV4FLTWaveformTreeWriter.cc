@@ -7,7 +7,8 @@
 using namespace std;
 
 ORIpeV4FLTWaveformTreeWriter::ORIpeV4FLTWaveformTreeWriter(string treeName) :
-ORVTreeWriter(new ORIpeV4FLTWaveformDecoder, treeName)
+ORVTreeWriter(new ORIpeV4FLTWaveformDecoder, treeName),
+fWaveformBranch(kMaxWFLength)
 {
   fEventDecoder = dynamic_cast<ORIpeV4FLTWaveformDecoder*>(fDataDecoder);
   Clear();
@@ -35,7 +36,8 @@ ORDataProcessor::EReturnCode ORIpeV4FLTWaveformTreeWriter::InitializeBranches()
   fTree->Branch("energy_adc", &fEnergy, "energy_adc/i");
   fTree->Branch("eventFlags", &fEventFlags, "eventFlags/i");
   fTree->Branch("eventInfo", &fEventInfo, "eventInfo/i");
-  fTree->Branch("waveform", fWaveform, "waveform[wfLength]/s");
+  fWaveformBranch.Branch(fTree, "waveform", fWaveform, "wfLength",
+                         fEventDecoder->GetBitResolution());
   return kSuccess;
 }
 
@@ -80,6 +82,7 @@ ORDataProcessor::EReturnCode ORIpeV4FLTWaveformTreeWriter::ProcessMyDataRecord(U
   }
   
   fEventDecoder->CopyWaveformData( fWaveform, kMaxWFLength );
+  fWaveformBranch.Encode(fWaveform, fWaveformLength);
 
   return kSuccess;
 }
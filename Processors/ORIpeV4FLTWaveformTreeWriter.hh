@@ -4,6 +4,7 @@
 #define _ORIpeV4FLTWaveformTreeWriter_hh_
 
 #include "ORVTreeWriter.hh"
+#include "ORWaveformBranch.hh"
 #include "ORIpeV4FLTWaveformDecoder.hh"
 
 class ORIpeV4FLTWaveformTreeWriter : public ORVTreeWriter
@@ -23,6 +24,9 @@ class ORIpeV4FLTWaveformTreeWriter : public ORVTreeWriter
       //kMaxWFLength = ORIpeV4FLTWaveformDecoder::kWaveformLength -tb- this was too small
       kMaxWFLength = ORIpeV4FLTWaveformDecoder::kWaveformLength * 64
       };
+    //! Selects plain or encoded (ORWaveformCodec) storage of the waveforms.
+    virtual ORWaveformBranch& GetWaveformBranch() { return fWaveformBranch; }
+
   protected:
     virtual EReturnCode InitializeBranches();
 
@@ -32,6 +36,7 @@ class ORIpeV4FLTWaveformTreeWriter : public ORVTreeWriter
     UInt_t fChannelMap;
     UShort_t fCrate, fCard, fChannel;
     UShort_t fWaveform[kMaxWFLength];
+    ORWaveformBranch fWaveformBranch;
     UInt_t fWaveformLength;
     UInt_t fEnergy;
     UInt_t fEventID, fEventFlags, fEventInfo;
@@ -7,7 +7,8 @@
 using namespace std;
 
 ORKatrinFLTWaveformTreeWriter::ORKatrinFLTWaveformTreeWriter(string treeName) :
-ORVTreeWriter(new ORKatrinFLTWaveformDecoder, treeName)
+ORVTreeWriter(new ORKatrinFLTWaveformDecoder, treeName),
+fWaveformBranch(kMaxWFLength)
 {
   fEventDecoder = dynamic_cast<ORKatrinFLTWaveformDecoder*>(fDataDecoder);
   Clear();
@@ -36,7 +37,8 @@ ORDataProcessor::EReturnCode ORKatrinFLTWaveformTreeWriter::InitializeBranches()
   fTree->Branch("energy_adc", &fEnergy, "energy_adc/i");
   fTree->Branch("resetSec", &fResetSec, "resetSec/i");
   fTree->Branch("resetSubSec", &fResetSubSec, "resetSubSec/i");
-  fTree->Branch("waveform", fWaveform, "waveform[wfLength]/s");
+  fWaveformBranch.Branch(fTree, "waveform", fWaveform, "wfLength",
+                         fEventDecoder->GetBitResolution());
   return kSuccess;
 }
 
@@ -81,6 +83,7 @@ ORDataProcessor::EReturnCode ORKatrinFLTWaveformTreeWriter::ProcessMyDataRecord(
   }
   
   fEventDecoder->CopyWaveformData( fWaveform, kMaxWFLength );
+  fWaveformBranch.Encode(fWaveform, fWaveformLength);
 
   return kSuccess;
 }
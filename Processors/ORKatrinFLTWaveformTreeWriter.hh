@@ -4,6 +4,7 @@
 #define _ORKatrinFLTWaveformTreeWriter_hh_
 
 #include "ORVTreeWriter.hh"
+#include "ORWaveformBranch.hh"
 #include "ORKatrinFLTWaveformDecoder.hh"
 
 class ORKatrinFLTWaveformTreeWriter : public ORVTreeWriter
@@ -22,6 +23,9 @@ class ORKatrinFLTWaveformTreeWriter : public ORVTreeWriter
       //kMaxWFLength = ORKatrinFLTWaveformDecoder::kWaveformLength -tb- this was too small
       kMaxWFLength = ORKatrinFLTWaveformDecoder::kWaveformLength * 64
       };
+    //! Selects plain or encoded (ORWaveformCodec) storage of the waveforms.
+    virtual ORWaveformBranch& GetWaveformBranch() { return fWaveformBranch; }
+
   protected:
     virtual EReturnCode InitializeBranches();
 
@@ -31,6 +35,7 @@ class ORKatrinFLTWaveformTreeWriter : public ORVTreeWriter
     UShort_t fEventID, fChannelMap;
     UShort_t fCrate, fCard, fChannel, fPageNumber;
     UShort_t fWaveform[kMaxWFLength];
+    ORWaveformBranch fWaveformBranch;
     UInt_t fWaveformLength;
     UInt_t fEnergy;
     //Bool_t saveOnlyNonemptyTrees; //!< flag to skip writing empty trees -tb- 2008-02-19 - MOVED TO BASE CLASS -tb-
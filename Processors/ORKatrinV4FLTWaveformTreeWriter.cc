@@ -7,7 +7,8 @@
 using namespace std;
 
 ORKatrinV4FLTWaveformTreeWriter::ORKatrinV4FLTWaveformTreeWriter(string treeName) :
-ORVTreeWriter(new ORKatrinV4FLTWaveformDecoder, treeName)
+ORVTreeWriter(new ORKatrinV4FLTWaveformDecoder, treeName),
+fWaveformBranch(kMaxWFLength)
 {
   fEventDecoder = dynamic_cast<ORKatrinV4FLTWaveformDecoder*>(fDataDecoder);
   Clear();
@@ -35,7 +36,8 @@ ORDataProcessor::EReturnCode ORKatrinV4FLTWaveformTreeWriter::InitializeBranches
   fTree->Branch("energy_adc", &fEnergy, "energy_adc/i");
   fTree->Branch("eventFlags", &fEventFlags, "eventFlags/i");
   fTree->Branch("eventInfo", &fEventInfo, "eventInfo/i");
-  fTree->Branch("waveform", fWaveform, "waveform[wfLength]/s");
+  fWaveformBranch.Branch(fTree, "waveform", fWaveform, "wfLength",
+                         fEventDecoder->GetBitResolution());
   return kSuccess;
 }
 
@@ -80,6 +82,7 @@ ORDataProcessor::EReturnCode ORKatrinV4FLTWaveformTreeWriter::ProcessMyDataRecor
   }
   
   fEventDecoder->CopyWaveformData( fWaveform, kMaxWFLength );
+  fWaveformBranch.Encode(fWaveform, fWaveformLength);
 
   return kSuccess;
 }
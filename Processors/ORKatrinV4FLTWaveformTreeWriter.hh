@@ -4,6 +4,7 @@
 #define _ORKatrinV4FLTWaveformTreeWriter_hh_
 
 #include "ORVTreeWriter.hh"
+#include "ORWaveformBranch.hh"
 #include "ORKatrinV4FLTWaveformDecoder.hh"
 
 class ORKatrinV4FLTWaveformTreeWriter : public ORVTreeWriter
@@ -22,6 +23,9 @@ class ORKatrinV4FLTWaveformTreeWriter : public ORVTreeWriter
       //kMaxWFLength = ORKatrinV4FLTWaveformDecoder::kWaveformLength -tb- this was too small
       kMaxWFLength = ORKatrinV4FLTWaveformDecoder::kWaveformLength * 1 /*64*/ //TODO: test it -tb-
       };
+    //! Selects plain or encoded (ORWaveformCodec) storage of the waveforms.
+    virtual ORWaveformBranch& GetWaveformBranch() { return fWaveformBranch; }
+
   protected:
     virtual EReturnCode InitializeBranches();
 
@@ -31,6 +35,7 @@ class ORKatrinV4FLTWaveformTreeWriter : public ORVTreeWriter
     UInt_t fChannelMap;
     UShort_t fCrate, fCard, fChannel;
     UShort_t fWaveform[kMaxWFLength];
+    ORWaveformBranch fWaveformBranch;
     UInt_t fWaveformLength;
     UInt_t fEnergy;
     UInt_t fEventID, fEventFlags, fEventInfo;
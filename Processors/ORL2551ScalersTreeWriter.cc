@@ -47,7 +47,7 @@ ORDataProcessor::EReturnCode ORL2551ScalersTreeWriter::ProcessMyDataRecord(UInt_
   for(size_t i=0; i<fScalersDecoder->NScalersOf(record); i++) {
     fChannel = fScalersDecoder->IthChannelOf(record, i);
     fScaler = fScalersDecoder->IthScalerOf(record, i);
-    fTree->Fill();
+    FillTree();
   }
 
   return kSuccess;
@@ -42,7 +42,7 @@ ORDataProcessor::EReturnCode ORLakeshore210TreeWriter::ProcessMyDataRecord(UInt_
         << ((fIsCelsius) ? 'C' : 'K') 
         << ":" << fTime << endl;
     }
-    fTree->Fill();
+    FillTree();
   }
 
   return kSuccess;
@@ -68,7 +68,7 @@ ORDataProcessor::EReturnCode ORMCA927TreeWriter::ProcessMyDataRecord(UInt_t* rec
 		return kFailure;
 	}
 	fEventDecoder->CopySpectrumData(fSpectrum, fSpectrumLength);
-	fTree->Fill();
+	FillTree();
 	return kSuccess;
 }
 
@@ -0,0 +1,218 @@
+// ORMemoryMonitor.cc
+
+#include "ORMemoryMonitor.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <unistd.h>
+#include <sys/resource.h>
+#ifdef __APPLE__
+#include <mach/mach.h>
+#endif
+#include "TArrayC.h"
+#include "TArrayD.h"
+#include "TArrayF.h"
+#include "TArrayI.h"
+#include "TArrayS.h"
+#include "TBasket.h"
+#include "TBranch.h"
+#include "TH1.h"
+#include "TObjArray.h"
+#include "TString.h"
+#include "TTree.h"
+#include "ORLogger.hh"
+
+using namespace std;
+
+ORMemoryMonitor::ORMemoryMonitor() :
+fResident("process resident size"), fBudget(0), fWarnAbove(0)
+{
+}
+
+int ORMemoryMonitor::Register(const string& name)
+{
+  map<string, int>::iterator iter = fIds.find(name);
+  if (iter != fIds.end()) return iter->second;
+  fEntries.push_back(ORMemoryEntry(name));
+  fIds[name] = fEntries.size() - 1;
+  return fEntries.size() - 1;
+}
+
+string ORMemoryMonitor::GetName(int id) const
+{
+  if (id < 0 || (size_t) id >= fEntries.size()) return "";
+  return fEntries[id].fName;
+}
+
+void ORMemoryMonitor::Set(int id, size_t nBytes)
+{
+  if (id < 0 || (size_t) id >= fEntries.size()) return;
+  fEntries[id].Set(nBytes);
+}
+
+size_t ORMemoryMonitor::Get(int id) const
+{
+  if (id < 0 || (size_t) id >= fEntries.size()) return 0;
+  return fEntries[id].fBytes;
+}
+
+void ORMemoryMonitor::SampleResident()
+{
+  fResident.Set(ResidentBytes());
+}
+
+bool ORMemoryMonitor::CheckBudget()
+{
+  if (fBudget == 0) return false;
+  SampleResident();
+  if (fResident.fBytes <= fBudget) {
+    fWarnAbove = fBudget;
+    return false;
+  }
+  if (fResident.fBytes <= fWarnAbove) return false;
+  fWarnAbove = fResident.fBytes + fResident.fBytes/10;
+  return true;
+}
+
+void ORMemoryMonitor::StartRun()
+{
+  SampleResident();
+  fResident.fAtStartRun = fResident.fBytes;
+  fResident.fRunPeak = fResident.fBytes;
+  for (size_t i=0; i<fEntries.size(); i++) {
+    fEntries[i].fAtStartRun = fEntries[i].fBytes;
+    fEntries[i].fRunPeak = fEntries[i].fBytes;
+  }
+}
+
+static bool ORMemoryEntryHoldsMore(const pair<size_t, size_t>& a, const pair<size_t, size_t>& b)
+{
+  return a.first > b.first;
+}
+
+void ORMemoryMonitor::Print(size_t maxRows) const
+{
+  // (bytes, index), largest first
+  vector< pair<size_t, size_t> > order;
+  size_t accounted = 0;
+  for (size_t i=0; i<fEntries.size(); i++) {
+    order.push_back(pair<size_t, size_t>(fEntries[i].fBytes, i));
+    // nested components are included in their compound processor
+    if (fEntries[i].fName.find('/') == string::npos) accounted += fEntries[i].fBytes;
+  }
+  stable_sort(order.begin(), order.end(), ORMemoryEntryHoldsMore);
+  if (maxRows == 0 || maxRows > order.size()) maxRows = order.size();
+
+  ORLog(kRoutine) << "Print(): memory held per component:" << endl;
+  ORLog(kRoutine) << ::Form("  %-40s %10s %10s %11s %10s %10s", "", "run start", "now",
+                            "change", "run peak", "peak") << endl;
+  for (size_t i=0; i<maxRows; i++) PrintEntry(fEntries[order[i].second]);
+  ORMemoryEntry resident = fResident;
+  size_t peak = PeakResidentBytes();
+  if (peak > resident.fPeak) resident.fPeak = peak;
+  PrintEntry(resident);
+  if (resident.fBytes > 0) {
+    ORLog(kRoutine) << ::Form("  %-40s %10s (%.0f%% of resident)", "accounted for",
+                              FormatBytes(accounted).c_str(),
+                              100.*accounted/resident.fBytes) << endl;
+  }
+  if (fBudget > 0) {
+    ORLog(kRoutine) << ::Form("  %-40s %10s", "budget", FormatBytes(fBudget).c_str()) << endl;
+  }
+}
+
+void ORMemoryMonitor::PrintEntry(const ORMemoryEntry& entry) const
+{
+  ORLog(kRoutine) << ::Form("  %-40s %10s %10s %11s %10s %10s", entry.fName.c_str(),
+                            FormatBytes(entry.fAtStartRun).c_str(),
+                            FormatBytes(entry.fBytes).c_str(),
+                            FormatBytes((Double_t) entry.fBytes - entry.fAtStartRun, true).c_str(),
+                            FormatBytes(entry.fRunPeak).c_str(),
+                            FormatBytes(entry.fPeak).c_str()) << endl;
+}
+
+size_t ORMemoryMonitor::ResidentBytes()
+{
+#ifdef __APPLE__
+  mach_task_basic_info info;
+  mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+  if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, (task_info_t) &info, &count) != KERN_SUCCESS) {
+    return 0;
+  }
+  return info.resident_size;
+#else
+  FILE* statm = fopen("/proc/self/statm", "r");
+  if (statm == NULL) return 0;
+  unsigned long nPages = 0, nResidentPages = 0;
+  int nRead = fscanf(statm, "%lu %lu", &nPages, &nResidentPages);
+  fclose(statm);
+  if (nRead != 2) return 0;
+  return nResidentPages*sysconf(_SC_PAGESIZE);
+#endif
+}
+
+size_t ORMemoryMonitor::PeakResidentBytes()
+{
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+#ifdef __APPLE__
+  return usage.ru_maxrss;      // bytes
+#else
+  return usage.ru_maxrss*1024; // kB
+#endif
+}
+
+size_t ORMemoryMonitor::SizeOf(const TH1* hist)
+{
+  if (hist == NULL) return 0;
+  size_t nBytes = 0;
+  const TArray* contents = dynamic_cast<const TArray*>(hist);
+  if (contents != NULL) {
+    size_t elementSize = sizeof(Double_t);
+    if (dynamic_cast<const TArrayF*>(hist) != NULL) elementSize = sizeof(Float_t);
+    else if (dynamic_cast<const TArrayI*>(hist) != NULL) elementSize = sizeof(Int_t);
+    else if (dynamic_cast<const TArrayS*>(hist) != NULL) elementSize = sizeof(Short_t);
+    else if (dynamic_cast<const TArrayC*>(hist) != NULL) elementSize = sizeof(Char_t);
+    nBytes += contents->GetSize()*elementSize;
+  }
+  nBytes += hist->GetSumw2N()*sizeof(Double_t);
+  return nBytes;
+}
+
+size_t ORMemoryMonitor::BasketBytesOf(TTree* tree)
+{
+  if (tree == NULL) return 0;
+  return BasketBytesOf(tree->GetListOfBranches());
+}
+
+size_t ORMemoryMonitor::BasketBytesOf(TObjArray* branches)
+{
+  if (branches == NULL) return 0;
+  size_t nBytes = 0;
+  for (Int_t i=0; i<branches->GetEntriesFast(); i++) {
+    TBranch* branch = (TBranch*) branches->UncheckedAt(i);
+    if (branch == NULL) continue;
+    TObjArray* baskets = branch->GetListOfBaskets();
+    for (Int_t j=0; baskets != NULL && j<baskets->GetEntriesFast(); j++) {
+      TBasket* basket = (TBasket*) baskets->UncheckedAt(j);
+      if (basket != NULL) nBytes += basket->GetBufferSize();
+    }
+    nBytes += BasketBytesOf(branch->GetListOfBranches());
+  }
+  return nBytes;
+}
+
+string ORMemoryMonitor::FormatBytes(Double_t nBytes, bool sign)
+{
+  static const char* units[] = { "B", "kB", "MB", "GB", "TB" };
+  Double_t size = fabs(nBytes);
+  size_t unit = 0;
+  while (size >= 1024 && unit < 4) {
+    size /= 1024;
+    unit++;
+  }
+  const char* prefix = (nBytes < 0) ? "-" : (sign ? "+" : "");
+  if (unit == 0) return ::Form("%s%.0f %s", prefix, size, units[unit]);
+  return ::Form("%s%.1f %s", prefix, size, units[unit]);
+}
@@ -0,0 +1,113 @@
+// ORMemoryMonitor.hh
+
+#ifndef _ORMemoryMonitor_hh_
+#define _ORMemoryMonitor_hh_
+
+#include <cstddef>
+#include <map>
+#include <string>
+#include <vector>
+#ifndef ROOT_Rtypes
+#include "Rtypes.h"
+#endif
+
+class TH1;
+class TTree;
+class TObjArray;
+
+//! Memory held by the processors of an analysis, per run.
+/*!
+    Enabled with ORDataProcManager::EnableMemoryAccounting().  At the start
+    and at the end of each run, the manager asks every processor how many
+    bytes it holds (ORDataProcessor::GetMemoryUsage(): tree baskets,
+    histogram contents, buffered hits, decoder caches such as the waveform
+    reassembly buffers) and records them here, together with the record
+    pool (records in flight and retained by processors), the queue of the
+    ORTreeFillThread and the header dictionary.  Components of nested
+    compound processors are listed as compound/component; the compound's
+    own entry includes them.  After EndRun() the manager logs, per
+    component, the bytes held at the start and the end of the run, the peak
+    during the run and over the job, and the same for the resident size of
+    the process, the difference being memory that no component accounts
+    for (ROOT, the dictionaries of the classes, fragmentation).
+
+    With a budget (SetBudget()), the manager samples the resident size every
+    few thousand records.  When it goes over the budget, the processors are
+    asked to give back what they can (ORDataProcessor::ReduceMemory(), e.g.
+    tree writers write out their baskets), the record pool is trimmed, and
+    the largest components are logged with a warning, so that it can be
+    seen which one grew before the process gets killed.  The warning is
+    repeated only after the resident size has grown by another 10%, or after
+    it went back under the budget.
+
+    Peaks of the components are over the times they were accounted (start
+    and end of run, budget warnings); the resident peak is over the samples.
+ */
+class ORMemoryMonitor
+{
+  public:
+    ORMemoryMonitor();
+    virtual ~ORMemoryMonitor() {}
+
+    //! Returns the id of a component name, adding it on first use.
+    virtual int Register(const std::string& name);
+    virtual std::string GetName(int id) const;
+    //! Records that component id holds nBytes now.
+    virtual void Set(int id, size_t nBytes);
+    virtual size_t Get(int id) const;
+
+    //! Records the current resident size of the process.
+    virtual void SampleResident();
+    //! Samples the resident size; returns true if a budget warning is due.
+    virtual bool CheckBudget();
+    virtual size_t GetResidentBytes() const { return fResident.fBytes; }
+
+    //! Resident size in bytes above which to warn and reduce memory; 0 for none.
+    virtual void SetBudget(size_t nBytes) { fBudget = nBytes; fWarnAbove = nBytes; }
+    virtual size_t GetBudget() const { return fBudget; }
+
+    //! Starts the per-run values from the current ones.
+    virtual void StartRun();
+
+    //! Logs the maxRows components that hold the most (0 for all).
+    virtual void Print(size_t maxRows = 0) const;
+
+    //! Resident size of the process, 0 if unknown.
+    static size_t ResidentBytes();
+    //! Largest resident size the process has had, 0 if unknown.
+    static size_t PeakResidentBytes();
+    //! Bytes of the contents (bins, errors) of a histogram.
+    static size_t SizeOf(const TH1* hist);
+    //! Bytes of the baskets of a tree that are in memory.
+    static size_t BasketBytesOf(TTree* tree);
+    static std::string FormatBytes(Double_t nBytes, bool sign = false);
+
+  protected:
+    struct ORMemoryEntry {
+      std::string fName;
+      size_t fBytes;
+      size_t fAtStartRun;
+      size_t fRunPeak;
+      size_t fPeak;
+      ORMemoryEntry(const std::string& name = "") :
+        fName(name), fBytes(0), fAtStartRun(0), fRunPeak(0), fPeak(0) {}
+      void Set(size_t nBytes)
+      {
+        fBytes = nBytes;
+        if (nBytes > fRunPeak) fRunPeak = nBytes;
+        if (nBytes > fPeak) fPeak = nBytes;
+      }
+    };
+
+    static size_t BasketBytesOf(TObjArray* branches);
+    virtual void PrintEntry(const ORMemoryEntry& entry) const;
+
+  protected:
+    std::vector<ORMemoryEntry> fEntries;
+    std::map<std::string, int> fIds;
+    ORMemoryEntry fResident;
+    size_t fBudget;
+    size_t fWarnAbove;
+};
+
+#endif
@@ -58,7 +58,7 @@ ORDataProcessor::EReturnCode ORMotionNodeTreeWriter::ProcessMyDataRecord(UInt_t*
 		return kFailure;
 	}
 	fEventDecoder->CopyWaveformData(fWaveform, fWaveformLength);
-	fTree->Fill();
+	FillTree();
 	return kSuccess;
 }
 
@@ -0,0 +1,287 @@
+// ORMultiCardEventTreeWriter.cc
+
+#include "ORMultiCardEventTreeWriter.hh"
+
+#include <algorithm>
+#include "ORLogger.hh"
+#include "ORRunContext.hh"
+#include "ORVBasicADCDecoder.hh"
+
+using namespace std;
+
+ORMultiCardEventTreeWriter::ORMultiCardEventTreeWriter(string treeName) :
+ORVTreeWriter(NULL, treeName), fSlots(kNSlots)
+{
+  fCardsAreSet = false;
+  fCardsAreKnown = false;
+  fNCompleteEvents = 0;
+  fNIncompleteEvents = 0;
+  Clear();
+  SetDoNotAutoFillTree();
+}
+
+ORMultiCardEventTreeWriter::~ORMultiCardEventTreeWriter()
+{
+  for (size_t i = 0; i < fModules.size(); i++) delete fModules[i].fDecoder;
+}
+
+void ORMultiCardEventTreeWriter::AddModule(ORVBasicTreeDecoder* decoder, ECounter counter)
+{
+  // one record per hit channel: neither counter can tell the events apart
+  if (dynamic_cast<ORVBasicADCDecoder*>(decoder) != NULL) {
+    ORLog(kError) << "AddModule(): " << decoder->GetDataObjectPath()
+                  << " writes one record per channel and has no event counter" << endl;
+    delete decoder;
+    return;
+  }
+  ORModule module;
+  module.fDecoder = decoder;
+  module.fDataId = ORVDataDecoder::GetIllegalDataId();
+  module.fCounter = counter;
+  module.fNPars = decoder->GetNPars();
+  module.fChannelPar = module.fValuePar = module.fOverflowPar = module.fNPars;
+  module.fUnderThresholdPar = module.fValidPar = module.fNPars;
+  for (size_t iPar = 0; iPar < module.fNPars; iPar++) {
+    string name = decoder->GetParName(iPar);
+    if (name == "channel") {
+      module.fChannelPar = iPar;
+      // the value follows the channel in all of these decoders
+      if (iPar+1 < module.fNPars) module.fValuePar = iPar+1;
+    }
+    else if (name == "overflow") module.fOverflowPar = iPar;
+    else if (name == "underthresh") module.fUnderThresholdPar = iPar;
+    else if (name == "isValid") module.fValidPar = iPar;
+  }
+  if (module.fValuePar == module.fNPars) {
+    ORLog(kError) << "AddModule(): " << decoder->GetDataObjectPath()
+                  << " has no channel and value" << endl;
+    delete decoder;
+    return;
+  }
+  fModules.push_back(module);
+}
+
+void ORMultiCardEventTreeWriter::AddCard(UInt_t crate, UInt_t card)
+{
+  UInt_t key = CardKey(crate, card);
+  if (find(fExpectedCards.begin(), fExpectedCards.end(), key) == fExpectedCards.end()) {
+    fExpectedCards.push_back(key);
+  }
+  fCardsAreSet = true;
+  fCardsAreKnown = true;
+}
+
+void ORMultiCardEventTreeWriter::SetDataId()
+{
+  if (fRunContext == NULL || fRunContext->GetHeader() == NULL) {
+    ORLog(kError) << "SetDataId(): no header" << endl;
+    return;
+  }
+  for (size_t i = 0; i < fModules.size(); i++) {
+    string path = fModules[i].fDecoder->GetDataObjectPath();
+    fModules[i].fDataId = fRunContext->GetHeader()->GetDataId(path);
+    if (fModules[i].fDataId == ORVDataDecoder::GetIllegalDataId()) {
+      ORLog(kDebug) << "SetDataId(): no data id for " << path << endl;
+    }
+  }
+}
+
+void ORMultiCardEventTreeWriter::SetDecoderDictionary()
+{
+  if (fRunContext == NULL || fRunContext->GetHardwareDict() == NULL) return;
+  for (size_t i = 0; i < fModules.size(); i++) {
+    ORVDataDecoder* decoder = fModules[i].fDecoder;
+    decoder->SetDecoderDictionary(
+      fRunContext->GetHardwareDict()->GetDecoderDictionary(decoder->GetDictionaryObjectPath()));
+  }
+}
+
+ORDataProcessor::EReturnCode ORMultiCardEventTreeWriter::InitializeBranches()
+{
+  fTree->Branch("eventCount", &fEventCount, "eventCount/i");
+  fTree->Branch("nCards", &fNCards, "nCards/i");
+  fTree->Branch("complete", &fComplete, "complete/O");
+  fTree->Branch("nValues", &fNValues, "nValues/i");
+  fTree->Branch("crate", fCrate, "crate[nValues]/s");
+  fTree->Branch("card", fCard, "card[nValues]/s");
+  fTree->Branch("channel", fChannel, "channel[nValues]/s");
+  fTree->Branch("value", fValue, "value[nValues]/i");
+  fTree->Branch("overflow", fOverflow, "overflow[nValues]/O");
+  fTree->Branch("underThreshold", fUnderThreshold, "underThreshold[nValues]/O");
+  return kSuccess;
+}
+
+ORDataProcessor::EReturnCode ORMultiCardEventTreeWriter::StartRun()
+{
+  for (size_t i = 0; i < fSlots.size(); i++) {
+    fSlots[i].fInUse = false;
+    fSlots[i].fCards.clear();
+    fSlots[i].fNValues = 0;
+  }
+  if (!fCardsAreSet) {
+    fExpectedCards.clear();
+    fCardsAreKnown = false;
+  }
+  fFirstEventOfCard.clear();
+  fRecordCounts.clear();
+  fNCompleteEvents = 0;
+  fNIncompleteEvents = 0;
+  return ORVTreeWriter::StartRun();
+}
+
+ORDataProcessor::EReturnCode ORMultiCardEventTreeWriter::ProcessDataRecord(UInt_t* record)
+{
+  if (!fDoProcess || !fDoProcessRun || !fRunContext) return kFailure;
+  for (size_t i = 0; i < fModules.size(); i++) {
+    ORModule& module = fModules[i];
+    if (module.fDecoder->DataIdOf(record) != module.fDataId) continue;
+    if (fRunContext->MustSwap() && !fRunContext->IsRecordSwapped()) {
+      /* Swapping the record.  This only must be done once! */
+      module.fDecoder->Swap(record);
+      fRunContext->SetRecordSwapped();
+    }
+    if (fDebugRecord) module.fDecoder->DumpHex(record);
+    return ProcessModuleRecord(module, record);
+  }
+  return kSuccess;
+}
+
+ORDataProcessor::EReturnCode ORMultiCardEventTreeWriter::ProcessModuleRecord(ORModule& module,
+                                                                            UInt_t* record)
+{
+  ORVBasicTreeDecoder* decoder = module.fDecoder;
+  UInt_t crate = decoder->CrateOf(record);
+  UInt_t card = decoder->CardOf(record);
+  UInt_t key = CardKey(crate, card);
+
+  UInt_t eventCount;
+  if (module.fCounter == kRecordCounter) eventCount = ++fRecordCounts[key];
+  else {
+    UInt_t endOfBlock = record[decoder->LengthOf(record)-1];
+    if (((endOfBlock & 0x07000000) >> 24) != 4) {
+      ORLog(kWarning) << "ProcessModuleRecord(): record of (crate,card) = (" << crate << ","
+                      << card << ") does not end with an end-of-block word" << endl;
+      return kFailure;
+    }
+    eventCount = endOfBlock & 0xffffff;
+  }
+
+  // the cards seen before any card reports its second event are all the cards
+  if (!fCardsAreKnown) {
+    map<UInt_t, UInt_t>::iterator first = fFirstEventOfCard.find(key);
+    if (first == fFirstEventOfCard.end()) {
+      fFirstEventOfCard[key] = eventCount;
+      fExpectedCards.push_back(key);
+      ORLog(kRoutine) << "adding (crate,card) = (" << crate << "," << card << ")" << endl;
+    }
+    else if (first->second != eventCount) {
+      fCardsAreKnown = true;
+      WriteCompleteSlots();
+    }
+  }
+  else if (!fCardsAreSet &&
+           find(fExpectedCards.begin(), fExpectedCards.end(), key) == fExpectedCards.end()) {
+    ORLog(kWarning) << "(crate,card) = (" << crate << "," << card
+                    << ") first reported at event " << eventCount << "; adding it" << endl;
+    fExpectedCards.push_back(key);
+  }
+
+  OREventSlot& slot = fSlots[eventCount % kNSlots];
+  if (slot.fInUse && slot.fEventCount != eventCount) WriteSlot(slot);
+  if (!slot.fInUse) {
+    slot.fInUse = true;
+    slot.fEventCount = eventCount;
+    slot.fCards.clear();
+    slot.fNValues = 0;
+  }
+  if (find(slot.fCards.begin(), slot.fCards.end(), key) != slot.fCards.end()) {
+    ORLog(kWarning) << "(crate,card) = (" << crate << "," << card
+                    << ") reported event " << eventCount << " twice; skipping it" << endl;
+    return kFailure;
+  }
+  slot.fCards.push_back(key);
+
+  size_t nRows = decoder->GetNRows(record);
+  for (size_t iRow = 0; iRow < nRows; iRow++) {
+    if (module.fValidPar != module.fNPars && !decoder->GetPar(record, module.fValidPar, iRow)) {
+      continue;
+    }
+    if (slot.fNValues >= slot.fValues.size()) {
+      ORLog(kWarning) << "more than " << kMaxValues << " values in event " << eventCount
+                      << "; dropping the rest" << endl;
+      break;
+    }
+    ORValue& value = slot.fValues[slot.fNValues++];
+    value.fCrate = crate;
+    value.fCard = card;
+    value.fChannel = decoder->GetPar(record, module.fChannelPar, iRow);
+    value.fValue = decoder->GetPar(record, module.fValuePar, iRow);
+    value.fOverflow = (module.fOverflowPar != module.fNPars) ?
+      decoder->GetPar(record, module.fOverflowPar, iRow) != 0 : false;
+    value.fUnderThreshold = (module.fUnderThresholdPar != module.fNPars) ?
+      decoder->GetPar(record, module.fUnderThresholdPar, iRow) != 0 : false;
+  }
+
+  if (IsComplete(slot)) WriteSlot(slot);
+  return kSuccess;
+}
+
+bool ORMultiCardEventTreeWriter::IsComplete(const OREventSlot& slot) const
+{
+  return fCardsAreKnown && slot.fCards.size() >= fExpectedCards.size();
+}
+
+void ORMultiCardEventTreeWriter::WriteSlot(OREventSlot& slot)
+{
+  if (!slot.fInUse) return;
+  fEventCount = slot.fEventCount;
+  fNCards = slot.fCards.size();
+  fComplete = IsComplete(slot);
+  fNValues = slot.fNValues;
+  for (size_t i = 0; i < fNValues; i++) {
+    const ORValue& value = slot.fValues[i];
+    fCrate[i] = value.fCrate;
+    fCard[i] = value.fCard;
+    fChannel[i] = value.fChannel;
+    fValue[i] = value.fValue;
+    fOverflow[i] = value.fOverflow;
+    fUnderThreshold[i] = value.fUnderThreshold;
+  }
+  if (fComplete) fNCompleteEvents++;
+  else {
+    ORLog(kDebug) << "WriteSlot(): event " << fEventCount << " has " << fNCards << " of "
+                  << fExpectedCards.size() << " cards" << endl;
+    fNIncompleteEvents++;
+  }
+  FillTree();
+  slot.fInUse = false;
+}
+
+void ORMultiCardEventTreeWriter::WriteCompleteSlots()
+{
+  for (size_t i = 0; i < fSlots.size(); i++) {
+    if (fSlots[i].fInUse && IsComplete(fSlots[i])) WriteSlot(fSlots[i]);
+  }
+}
+
+void ORMultiCardEventTreeWriter::WriteAllSlots()
+{
+  // in order of event count
+  while (true) {
+    OREventSlot* oldest = NULL;
+    for (size_t i = 0; i < fSlots.size(); i++) {
+      if (!fSlots[i].fInUse) continue;
+      if (oldest == NULL || fSlots[i].fEventCount < oldest->fEventCount) oldest = &fSlots[i];
+    }
+    if (oldest == NULL) break;
+    WriteSlot(*oldest);
+  }
+}
+
+ORDataProcessor::EReturnCode ORMultiCardEventTreeWriter::EndRun()
+{
+  WriteAllSlots();
+  ORLog(kRoutine) << "EndRun(): " << fNCompleteEvents << " complete and " << fNIncompleteEvents
+                  << " incomplete events from " << fExpectedCards.size() << " cards" << endl;
+  return ORVTreeWriter::EndRun();
+}
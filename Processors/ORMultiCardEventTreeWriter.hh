@@ -0,0 +1,123 @@
+// ORMultiCardEventTreeWriter.hh
+
+#ifndef _ORMultiCardEventTreeWriter_hh_
+#define _ORMultiCardEventTreeWriter_hh_
+
+#include <map>
+#include <string>
+#include <vector>
+#include "ORVTreeWriter.hh"
+#include "ORVBasicTreeDecoder.hh"
+
+//! Assembles events from the records of several VME cards by event counter.
+/*!
+    Works with the basic tree decoders of the VME ADC/QDC/TDC modules
+    (ORCaen792qdcDecoder, ORCaen775tdcDecoder, ORCaen785adcDecoder,
+    ORCaen1785adcDecoder, ORCaen965qdcDecoder, ...), in any number of
+    crates, and several module types at once:
+    \verbatim
+    ORMultiCardEventTreeWriter writer;
+    writer.AddModule(new ORCaen792qdcDecoder);
+    writer.AddModule(new ORCaen775tdcDecoder);
+    \endverbatim
+    The event of a record is the event counter in the end-of-block word of
+    the CAEN modules (kEndOfBlockCounter), or, for modules without one, the
+    number of records received from the card in this run (kRecordCounter),
+    which assumes that every card writes exactly one record per event.
+    Decoders of modules that write one record per hit channel (the
+    ORVBasicADCDecoder family: AD811, AD413, ...) carry no event number and
+    are rejected by AddModule().
+
+    The records of the last kNSlots events are collected in slots of fixed
+    capacity.  An event is written as soon as all expected cards have
+    reported; if a card is missing, it is written incomplete when its slot
+    is needed for a later event or at the end of the run.  The expected
+    cards are those given with AddCard() or, by default, those that report
+    before any card reports its second event.
+
+    One entry per event, the values of all cards flattened:
+    eventCount - UInt_t; nCards - UInt_t, cards that reported
+    complete - Bool_t, all expected cards reported
+    nValues - UInt_t (at most kMaxValues)
+    crate, card, channel [nValues] - UShort_t
+    value [nValues] - UInt_t
+    overflow, underThreshold [nValues] - Bool_t
+    Values the decoder flags as not valid are left out.
+ */
+class ORMultiCardEventTreeWriter : public ORVTreeWriter
+{
+  public:
+    enum ECounter { kEndOfBlockCounter, kRecordCounter };
+    enum EMultiCardEventTreeWriterConsts { kMaxValues = 4096, kNSlots = 16 };
+
+    ORMultiCardEventTreeWriter(std::string treeName = "multiCardEventTree");
+    virtual ~ORMultiCardEventTreeWriter();
+
+    //! Adds a module type, taking ownership of decoder.
+    virtual void AddModule(ORVBasicTreeDecoder* decoder, ECounter counter = kEndOfBlockCounter);
+    //! Adds a card to the expected cards, turning off their automatic detection.
+    virtual void AddCard(UInt_t crate, UInt_t card);
+
+    virtual void SetDataId();
+    virtual void SetDecoderDictionary();
+    virtual EReturnCode StartRun();
+    virtual EReturnCode ProcessDataRecord(UInt_t* record);
+    virtual EReturnCode EndRun();
+    virtual inline void Clear() { fEventCount = 0; fNCards = 0; fComplete = false; fNValues = 0; }
+
+    virtual ULong64_t GetNComplete() const { return fNCompleteEvents; }
+    virtual ULong64_t GetNIncomplete() const { return fNIncompleteEvents; }
+
+  protected:
+    struct ORModule {
+      ORVBasicTreeDecoder* fDecoder;
+      UInt_t fDataId;
+      ECounter fCounter;
+      size_t fNPars; // index of parameters the decoder does not have
+      size_t fChannelPar, fValuePar, fOverflowPar, fUnderThresholdPar, fValidPar;
+    };
+    struct ORValue {
+      UShort_t fCrate, fCard, fChannel;
+      UInt_t fValue;
+      Bool_t fOverflow, fUnderThreshold;
+    };
+    struct OREventSlot {
+      bool fInUse;
+      UInt_t fEventCount;
+      std::vector<UInt_t> fCards; // card keys that reported
+      std::vector<ORValue> fValues; // fixed size kMaxValues
+      size_t fNValues;
+      OREventSlot() : fInUse(false), fEventCount(0), fValues(kMaxValues), fNValues(0) {}
+    };
+
+    static UInt_t CardKey(UInt_t crate, UInt_t card) { return (crate << 16) + card; }
+    virtual EReturnCode InitializeBranches();
+    virtual EReturnCode ProcessModuleRecord(ORModule& module, UInt_t* record);
+    virtual bool IsComplete(const OREventSlot& slot) const;
+    virtual void WriteSlot(OREventSlot& slot);
+    virtual void WriteCompleteSlots();
+    virtual void WriteAllSlots();
+
+  protected:
+    std::vector<ORModule> fModules;
+    std::vector<OREventSlot> fSlots;
+    std::vector<UInt_t> fExpectedCards;
+    bool fCardsAreSet;       // by AddCard()
+    bool fCardsAreKnown;     // set, or detected
+    std::map<UInt_t, UInt_t> fFirstEventOfCard;
+    std::map<UInt_t, UInt_t> fRecordCounts;
+    ULong64_t fNCompleteEvents, fNIncompleteEvents;
+
+    UInt_t fEventCount;
+    UInt_t fNCards;
+    Bool_t fComplete;
+    UInt_t fNValues;
+    UShort_t fCrate[kMaxValues];
+    UShort_t fCard[kMaxValues];
+    UShort_t fChannel[kMaxValues];
+    UInt_t fValue[kMaxValues];
+    Bool_t fOverflow[kMaxValues];
+    Bool_t fUnderThreshold[kMaxValues];
+};
+
+#endif
@@ -0,0 +1,262 @@
+// ORProcessorStats.cc
+
+#include "ORProcessorStats.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+#include <typeinfo>
+#include <cxxabi.h>
+#include <cstdlib>
+#include "TTree.h"
+#include "TObjString.h"
+#include "TDirectory.h"
+#include "TROOT.h"
+#include "ORDataProcessor.hh"
+#include "ORLogger.hh"
+#include "ORUtils.hh"
+
+using namespace std;
+
+// Statistics of one processor, phase and data id.  Call times are counted
+// in bins of a quarter octave of nanoseconds.
+class ORTimingEntry
+{
+  public:
+    enum ETimingEntryConsts { kNBuckets = 4*48 };
+
+    ORTimingEntry(int id, ORProcessorStats::EPhase phase, UInt_t dataId) :
+      fId(id), fPhase(phase), fDataId(dataId) { Reset(); }
+    void Reset()
+    {
+      fNCalls = 0; fNBytes = 0; fSeconds = 0; fMaxSeconds = 0;
+      for (size_t i=0; i<kNBuckets; i++) fBuckets[i] = 0;
+    }
+    void Add(Double_t seconds, size_t nBytes)
+    {
+      fNCalls++;
+      fNBytes += nBytes;
+      fSeconds += seconds;
+      if (seconds > fMaxSeconds) fMaxSeconds = seconds;
+      fBuckets[BucketOf(seconds)]++;
+    }
+    static size_t BucketOf(Double_t seconds)
+    {
+      Double_t ns = seconds*1e9;
+      if (ns < 1) return 0;
+      int exponent;
+      Double_t mantissa = frexp(ns, &exponent); // ns = mantissa*2^exponent, mantissa in [0.5, 1)
+      size_t bucket = (exponent-1)*4 + (size_t) ((mantissa - 0.5)*8);
+      return (bucket < kNBuckets) ? bucket : kNBuckets-1;
+    }
+    Double_t GetPercentile(Double_t fraction) const
+    {
+      if (fNCalls == 0) return 0;
+      ULong64_t rank = (ULong64_t) ceil(fraction*fNCalls);
+      if (rank == 0) rank = 1;
+      ULong64_t count = 0;
+      size_t bucket = 0;
+      for (; bucket < kNBuckets-1; bucket++) {
+        count += fBuckets[bucket];
+        if (count >= rank) break;
+      }
+      // middle of the bucket
+      Double_t octave = ldexp(1.0, bucket/4 + 1);
+      Double_t seconds = (0.5 + (bucket%4 + 0.5)/8)*octave*1e-9;
+      return (seconds < fMaxSeconds) ? seconds : fMaxSeconds;
+    }
+
+    int fId;
+    ORProcessorStats::EPhase fPhase;
+    UInt_t fDataId;
+    ULong64_t fNCalls;
+    ULong64_t fNBytes;
+    Double_t fSeconds;
+    Double_t fMaxSeconds;
+    ULong64_t fBuckets[kNBuckets];
+};
+
+static bool ORTimingEntryTakesLonger(const ORTimingEntry* a, const ORTimingEntry* b)
+{
+  return a->fSeconds > b->fSeconds;
+}
+
+ORProcessorStats::ORProcessorStats()
+{
+  Reset();
+}
+
+ORProcessorStats::~ORProcessorStats()
+{
+  map<ULong64_t, ORTimingEntry*>::iterator iter;
+  for (iter = fEntries.begin(); iter != fEntries.end(); iter++) delete iter->second;
+}
+
+int ORProcessorStats::Register(const string& name)
+{
+  map<string, int>::iterator iter = fIds.find(name);
+  if (iter != fIds.end()) return iter->second;
+  fNames.push_back(name);
+  fIds[name] = fNames.size() - 1;
+  return fNames.size() - 1;
+}
+
+string ORProcessorStats::GetName(int id) const
+{
+  if (id < 0 || (size_t) id >= fNames.size()) return "";
+  return fNames[id];
+}
+
+string ORProcessorStats::ClassNameOf(const ORDataProcessor* processor)
+{
+  if (processor == NULL) return "";
+  const char* mangled = typeid(*processor).name();
+  int status = 0;
+  char* demangled = abi::__cxa_demangle(mangled, NULL, NULL, &status);
+  string name = (status == 0 && demangled != NULL) ? demangled : mangled;
+  free(demangled);
+  return name;
+}
+
+const char* ORProcessorStats::PhaseName(EPhase phase)
+{
+  switch (phase) {
+    case kProcess: return "process";
+    case kStartRun: return "startRun";
+    case kEndRun: return "endRun";
+    case kRead: return "read";
+    default: return "unknown";
+  }
+}
+
+Double_t ORProcessorStats::Now()
+{
+  return ORUtils::MonotonicSeconds();
+}
+
+void ORProcessorStats::Add(int id, EPhase phase, UInt_t dataId, Double_t seconds, size_t nBytes)
+{
+  ULong64_t key = (((ULong64_t) id) << 40) + (((ULong64_t) phase) << 32) + dataId;
+  map<ULong64_t, ORTimingEntry*>::iterator iter = fEntries.find(key);
+  ORTimingEntry* entry;
+  if (iter != fEntries.end()) entry = iter->second;
+  else {
+    entry = new ORTimingEntry(id, phase, dataId);
+    fEntries[key] = entry;
+  }
+  entry->Add(seconds, nBytes);
+}
+
+void ORProcessorStats::AddBufferOccupancy(Double_t fraction)
+{
+  if (fraction < 0) return;
+  fNOccupancySamples++;
+  fOccupancySum += fraction;
+  if (fraction > fOccupancyMax) fOccupancyMax = fraction;
+}
+
+void ORProcessorStats::Reset()
+{
+  map<ULong64_t, ORTimingEntry*>::iterator iter;
+  for (iter = fEntries.begin(); iter != fEntries.end(); iter++) delete iter->second;
+  fEntries.clear();
+  fNOccupancySamples = 0;
+  fOccupancySum = 0;
+  fOccupancyMax = 0;
+}
+
+void ORProcessorStats::GetSortedEntries(vector<const ORTimingEntry*>& entries) const
+{
+  entries.clear();
+  map<ULong64_t, ORTimingEntry*>::const_iterator iter;
+  for (iter = fEntries.begin(); iter != fEntries.end(); iter++) entries.push_back(iter->second);
+  stable_sort(entries.begin(), entries.end(), ORTimingEntryTakesLonger);
+}
+
+void ORProcessorStats::Print(size_t maxRows) const
+{
+  vector<const ORTimingEntry*> entries;
+  GetSortedEntries(entries);
+  if (maxRows == 0 || maxRows > entries.size()) maxRows = entries.size();
+  ORLog(kRoutine) << "Print(): time spent per processor, phase and data id:" << endl;
+  for (size_t i=0; i<maxRows; i++) {
+    const ORTimingEntry* entry = entries[i];
+    ORLog(kRoutine) << ::Form("  %-40s %-8s 0x%08x %10llu calls %10.3f s  p50 %9.2e s  "
+                              "p99 %9.2e s  max %9.2e s", GetName(entry->fId).c_str(),
+                              PhaseName(entry->fPhase), entry->fDataId, entry->fNCalls,
+                              entry->fSeconds, entry->GetPercentile(0.5),
+                              entry->GetPercentile(0.99), entry->fMaxSeconds) << endl;
+  }
+  if (fNOccupancySamples > 0) {
+    ORLog(kRoutine) << ::Form("  reader buffer occupancy: mean %.1f%%, max %.1f%%",
+                              100*fOccupancySum/fNOccupancySamples, 100*fOccupancyMax) << endl;
+  }
+}
+
+string ORProcessorStats::ToJSON() const
+{
+  vector<const ORTimingEntry*> entries;
+  GetSortedEntries(entries);
+  ostringstream json;
+  json.precision(6);
+  json << "{\"entries\": [";
+  for (size_t i=0; i<entries.size(); i++) {
+    const ORTimingEntry* entry = entries[i];
+    json << ((i == 0) ? "\n" : ",\n")
+         << "  {\"processor\": \"" << ORUtils::JSONEscape(GetName(entry->fId)) << "\", "
+         << "\"phase\": \"" << PhaseName(entry->fPhase) << "\", "
+         << "\"dataId\": " << entry->fDataId << ", "
+         << "\"nCalls\": " << entry->fNCalls << ", "
+         << "\"nBytes\": " << entry->fNBytes << ", "
+         << "\"seconds\": " << entry->fSeconds << ", "
+         << "\"maxSeconds\": " << entry->fMaxSeconds << ", "
+         << "\"p50\": " << entry->GetPercentile(0.5) << ", "
+         << "\"p90\": " << entry->GetPercentile(0.9) << ", "
+         << "\"p99\": " << entry->GetPercentile(0.99) << "}";
+  }
+  json << "],\n \"readerBufferOccupancy\": {\"nSamples\": " << fNOccupancySamples
+       << ", \"mean\": " << ((fNOccupancySamples > 0) ? fOccupancySum/fNOccupancySamples : 0)
+       << ", \"max\": " << fOccupancyMax << "}}\n";
+  return json.str();
+}
+
+void ORProcessorStats::Write() const
+{
+  string processor, phase;
+  UInt_t dataId;
+  ULong64_t nCalls, nBytes;
+  Double_t seconds, maxSeconds, p50, p90, p99;
+
+  TTree tree("processorStats", "time spent per processor, phase and data id");
+  tree.Branch("processor", &processor);
+  tree.Branch("phase", &phase);
+  tree.Branch("dataId", &dataId, "dataId/i");
+  tree.Branch("nCalls", &nCalls, "nCalls/l");
+  tree.Branch("nBytes", &nBytes, "nBytes/l");
+  tree.Branch("seconds", &seconds, "seconds/D");
+  tree.Branch("maxSeconds", &maxSeconds, "maxSeconds/D");
+  tree.Branch("p50", &p50, "p50/D");
+  tree.Branch("p90", &p90, "p90/D");
+  tree.Branch("p99", &p99, "p99/D");
+
+  vector<const ORTimingEntry*> entries;
+  GetSortedEntries(entries);
+  for (size_t i=0; i<entries.size(); i++) {
+    const ORTimingEntry* entry = entries[i];
+    processor = GetName(entry->fId);
+    phase = PhaseName(entry->fPhase);
+    dataId = entry->fDataId;
+    nCalls = entry->fNCalls;
+    nBytes = entry->fNBytes;
+    seconds = entry->fSeconds;
+    maxSeconds = entry->fMaxSeconds;
+    p50 = entry->GetPercentile(0.5);
+    p90 = entry->GetPercentile(0.9);
+    p99 = entry->GetPercentile(0.99);
+    tree.Fill();
+  }
+  tree.Write();
+
+  TObjString json(ToJSON().c_str());
+  json.Write("processorStatsJSON");
+}
@@ -0,0 +1,85 @@
+// ORProcessorStats.hh
+
+#ifndef _ORProcessorStats_hh_
+#define _ORProcessorStats_hh_
+
+#include <map>
+#include <string>
+#include <vector>
+#ifndef ROOT_Rtypes
+#include "Rtypes.h"
+#endif
+
+class ORDataProcessor;
+class ORTimingEntry;
+
+//! Throughput and latency of the processors of an analysis.
+/*!
+    Enabled with ORDataProcManager::EnableInstrumentation().  The compound
+    processors then time every call of their components to StartRun(),
+    ProcessDataRecord() and EndRun(), and the manager times the reader.
+    For each processor, phase and (for ProcessDataRecord()) data id, it
+    keeps the number of calls, the bytes of the records, the total and
+    maximum time and a histogram of the call times with four bins per
+    factor of two, from which percentiles are estimated to within ~10%.
+    Time spent in a nested compound processor includes that of its
+    components.  The manager also samples the fill level of the reader's
+    buffer (ORVReader::GetBufferOccupancy(), e.g. the socket ring).
+
+    At the end of each run the manager logs the table and writes it to the
+    current directory (the output file) as a tree named processorStats with
+    branches
+
+    processor, phase - string
+    dataId - UInt_t (0 for phases other than process)
+    nCalls, nBytes - ULong64_t
+    seconds, maxSeconds, p50, p90, p99 - Double_t (seconds)
+
+    and as a JSON string processorStatsJSON (a TObjString) that also holds
+    the reader's buffer occupancy.  With a more verbose heartbeat (see
+    ORRunDataProcessor), the busiest processors are also logged at every
+    heartbeat.
+ */
+class ORProcessorStats
+{
+  public:
+    enum EPhase { kProcess, kStartRun, kEndRun, kRead, kNPhases };
+
+    ORProcessorStats();
+    virtual ~ORProcessorStats();
+
+    //! Returns the id of a processor name, adding it on first use.
+    virtual int Register(const std::string& name);
+    virtual std::string GetName(int id) const;
+    //! Class name of processor, for Register().
+    static std::string ClassNameOf(const ORDataProcessor* processor);
+    static const char* PhaseName(EPhase phase);
+
+    //! Monotonic wall-clock time in seconds.
+    static Double_t Now();
+    virtual void Add(int id, EPhase phase, UInt_t dataId, Double_t seconds, size_t nBytes = 0);
+    //! Adds a sample of the fill level (0 to 1) of the reader's buffer.
+    virtual void AddBufferOccupancy(Double_t fraction);
+
+    //! Clears the statistics (but keeps the names).
+    virtual void Reset();
+
+    //! Logs the maxRows entries that took the most time (0 for all).
+    virtual void Print(size_t maxRows = 0) const;
+    virtual std::string ToJSON() const;
+    //! Writes the tree and JSON string to the current directory.
+    virtual void Write() const;
+
+  protected:
+    virtual void GetSortedEntries(std::vector<const ORTimingEntry*>& entries) const;
+
+  protected:
+    std::vector<std::string> fNames;
+    std::map<std::string, int> fIds;
+    std::map<ULong64_t, ORTimingEntry*> fEntries; // by id, phase and data id
+    ULong64_t fNOccupancySamples;
+    Double_t fOccupancySum;
+    Double_t fOccupancyMax;
+};
+
+#endif
@@ -25,6 +25,8 @@ ORRunContext::ORRunContext(ORHeader* header, const char* runCtrlPath)
   if (header != NULL) LoadHeader(header, runCtrlPath);
   fHardwareDict = NULL;
   fWritableSocket = NULL;
+  fCurrentRecord = NULL;
+  fRecordPool = NULL;
 }
 
 ORRunContext::~ORRunContext()
@@ -6,6 +6,7 @@
 #include <string>
 #include "ORHeader.hh"
 #include "ORHardwareDictionary.hh"
+#include "ORRecordPool.hh"
 
 
 class ORRunDataProcessor;
@@ -28,6 +29,8 @@ class ORVWriter;
  *  Run Type - ORCA run type
  *  Packet Number - How many packets have been read during run. Useful for
  *    indexing packets.
+ *  Current Record - handle to the record being processed, which processors
+ *    may copy to keep the record alive (see ORDataProcessor::RetainRecord).
 
  *  ORRunContext handles several other 'global' aspects of a run, including
  *  determining if the current record is already swapped, and providing
@@ -82,6 +85,17 @@ class ORRunContext
     virtual inline Bool_t MustSwap() const { return fMustSwap; }
     virtual inline Bool_t IsRecordSwapped() const { return fIsRecordSwapped; }
 
+    //! Handle to the record currently being processed.
+    /*!
+        Copying the handle keeps the record alive after the processing of
+        the record has finished, without copying the data.  The handle is
+        invalid if the record did not come from the manager's record pool.
+     */
+    virtual const ORRecordHandle& GetCurrentRecord() const 
+      { return (fCurrentRecord) ? *fCurrentRecord : fNullRecord; }
+    //! The pool the manager reads records into, NULL if not managed.
+    virtual ORRecordPool* GetRecordPool() const { return fRecordPool; }
+
     //! Pointer access function for Run number
     /*!
         This is useful when needed to, for example, initialize
@@ -102,6 +116,7 @@ class ORRunContext
     virtual std::string* GetPointerToStringOfState() { return &fStringOfState; }
 
     virtual inline EState GetState() const { return fState; }
+    virtual const std::string& GetStringOfState() const { return fStringOfState; }
     virtual void SetState(EState aState) 
       { fState = aState; fStringOfState = GetStateName(fState); }
 
@@ -141,6 +156,8 @@ class ORRunContext
     virtual void SetStopping();
     virtual void SetPreparingForSubRun();
     virtual void SetMustSwap(Bool_t mustSwap) { fMustSwap = mustSwap; } 
+    virtual void SetCurrentRecord(const ORRecordHandle* record) { fCurrentRecord = record; }
+    virtual void SetRecordPool(ORRecordPool* pool) { fRecordPool = pool; }
 
     ORHeader* fHeader;
     ORHardwareDictionary* fHardwareDict;
@@ -157,6 +174,9 @@ class ORRunContext
     Int_t fPacketNumber;
 
     ORVWriter* fWritableSocket;
+    const ORRecordHandle* fCurrentRecord; //!
+    ORRecordHandle fNullRecord; //!
+    ORRecordPool* fRecordPool; //!
 
     EState fState;
 };
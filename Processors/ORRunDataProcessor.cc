@@ -4,6 +4,7 @@
 
 #include <string>
 #include "TROOT.h"
+#include "ORProcessorStats.hh"
 
 using namespace std;
 
@@ -12,6 +13,7 @@ ORRunDataProcessor::ORRunDataProcessor() : ORDataProcessor(new ORRunDecoder)
   fRunDecoder = dynamic_cast<ORRunDecoder*>(fDataDecoder);
   fByteCount = 0;
   fIncreaseHeartbeatVerbosity = false;
+  fProcessorStats = NULL;
 }
 
 ORRunDataProcessor::~ORRunDataProcessor()
@@ -47,6 +49,7 @@ ORDataProcessor::EReturnCode ORRunDataProcessor::ProcessMyDataRecord(UInt_t* rec
                      fRunContext->GetRunNumber(), message.c_str());
     if(fIncreaseHeartbeatVerbosity) ORLog(kRoutine) << message << endl;
     else ORLog(kTrace) << message << endl;
+    if (fIncreaseHeartbeatVerbosity && fProcessorStats != NULL) fProcessorStats->Print(5);
     fByteCount = 0;
     return ProcessRunHeartBeat(record);
 
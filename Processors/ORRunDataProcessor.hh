@@ -10,6 +10,7 @@
 
 
 class ORDataProcManager;
+class ORProcessorStats;
 class ORRunDataProcessor : public ORDataProcessor
 {
   public:
@@ -28,6 +29,8 @@ class ORRunDataProcessor : public ORDataProcessor
 
     virtual inline void IncreaseHeartbeatVerbosity(bool doIncrease = true)
       { fIncreaseHeartbeatVerbosity = doIncrease; }
+    //! Logs the busiest processors at every heartbeat; NULL disables.
+    virtual inline void SetProcessorStats(ORProcessorStats* stats) { fProcessorStats = stats; }
 
     friend class ORDataProcManager;
   protected:
@@ -37,6 +40,7 @@ class ORRunDataProcessor : public ORDataProcessor
     ORRunDecoder* fRunDecoder;
     UInt_t fByteCount;
     bool fIncreaseHeartbeatVerbosity;
+    ORProcessorStats* fProcessorStats; //!
 };
 
 #endif
@@ -0,0 +1,97 @@
+// ORRunInfoTree.cc
+
+#include "ORRunInfoTree.hh"
+
+#include "TTree.h"
+#include "TDirectory.h"
+#include "ORLogger.hh"
+#include "ORRunContext.hh"
+#include "ORTreeFillThread.hh"
+
+using namespace std;
+
+ORRunInfoTree::ORRunInfoTree(TTree* parent)
+{
+  fNParentEntries = 0;
+  fFirstEntry = 0;
+  fLastEntry = -1;
+  fRunNumber = 0;
+  fSubRunNumber = 0;
+  fRunningState = "";
+
+  string name = RunInfoTreeName(parent->GetName());
+  // owned by the parent's directory, like the parent
+  fTree = new TTree(name.c_str(), (string("run info of ") + parent->GetName()).c_str());
+  fTree->Branch("firstEntry", &fFirstEntry, "firstEntry/L");
+  fTree->Branch("lastEntry", &fLastEntry, "lastEntry/L");
+  fTree->Branch("runNumber", &fRunNumber, "runNumber/I");
+  fTree->Branch("subRunNumber", &fSubRunNumber, "subRunNumber/I");
+  fTree->Branch("runningState", &fRunningState);
+  parent->AddFriend(fTree);
+}
+
+void ORRunInfoTree::Record(const ORRunContext* runContext)
+{
+  if (fLastEntry >= fFirstEntry &&
+      (runContext->GetRunNumber() != fRunNumber ||
+       runContext->GetSubRunNumber() != fSubRunNumber ||
+       runContext->GetStringOfState() != fRunningState)) {
+    FillRange();
+    fFirstEntry = fNParentEntries;
+  }
+  fRunNumber = runContext->GetRunNumber();
+  fSubRunNumber = runContext->GetSubRunNumber();
+  fRunningState = runContext->GetStringOfState();
+  fLastEntry = fNParentEntries;
+  fNParentEntries++;
+}
+
+void ORRunInfoTree::FillRange()
+{
+  // goes through the fill thread like the parent, which may be writing
+  // to the same file
+  if (ORTreeFillThread::IsRunning()) ORTreeFillThread::Fill(fTree);
+  else fTree->Fill();
+}
+
+void ORRunInfoTree::Finish()
+{
+  if (fLastEntry >= fFirstEntry) FillRange();
+  fFirstEntry = fNParentEntries;
+  ORTreeFillThread::Release(fTree);
+  if (fTree->GetEntries() > 0) fTree->SetTreeIndex(new ORRunRangeIndex(fTree));
+}
+
+ClassImp(ORRunRangeIndex)
+
+ORRunRangeIndex::ORRunRangeIndex(const TTree* runInfoTree) :
+TTreeIndex(runInfoTree, "firstEntry", "0")
+{
+}
+
+Long64_t ORRunRangeIndex::GetEntryNumberFriend(const TTree* parent)
+{
+  if (parent == NULL) return -3;
+  // The best index is the last range starting at or before the parent's
+  // entry; the ranges are contiguous, so it contains the entry.
+  return GetEntryNumberWithBestIndex(parent->GetReadEntry(), 0);
+}
+
+TTree* ORRunRangeIndex::Attach(TTree* tree)
+{
+  if (tree == NULL || tree->GetDirectory() == NULL) return NULL;
+  string runInfoName = ORRunInfoTree::RunInfoTreeName(tree->GetName());
+  TTree* runInfoTree = (TTree*) tree->GetDirectory()->Get(runInfoName.c_str());
+  if (runInfoTree == NULL) {
+    ORLog(kWarning) << "Attach(): no tree " << runInfoName << " found" << endl;
+    return NULL;
+  }
+  if (dynamic_cast<ORRunRangeIndex*>(runInfoTree->GetTreeIndex()) == NULL) {
+    runInfoTree->SetTreeIndex(new ORRunRangeIndex(runInfoTree));
+  }
+  if (tree->GetListOfFriends() == NULL ||
+      tree->GetListOfFriends()->FindObject(runInfoName.c_str()) == NULL) {
+    tree->AddFriend(runInfoTree);
+  }
+  return runInfoTree;
+}
@@ -0,0 +1,88 @@
+// ORRunInfoTree.hh
+
+#ifndef _ORRunInfoTree_hh_
+#define _ORRunInfoTree_hh_
+
+#include <string>
+#include "TTreeIndex.h"
+
+class TTree;
+class ORRunContext;
+
+//! Run number, sub-run number and running state of a tree, stored per entry range.
+/*!
+    Instead of storing runNumber, subRunNumber and runningState in every
+    entry of a tree, ORVTreeWriter can store them in a run-info tree called
+    <treeName>_runInfo (see ORVTreeWriter::SetRunBranchMode()).  The
+    run-info tree has one entry per range of entries of the parent tree that
+    share the same values, with branches
+
+    firstEntry, lastEntry - Long64_t, the range of parent entries (inclusive)
+    runNumber - Int_t
+    subRunNumber - Int_t
+    runningState - string
+
+    The run-info tree is made a friend of the parent tree and indexed with
+    an ORRunRangeIndex, so with libORProcessors loaded,
+
+    \verbatim
+    tree->Draw("energy", "runNumber == 1234");
+    \endverbatim
+
+    works as it does when the values are stored in every entry.
+ */
+class ORRunInfoTree
+{
+  public:
+    //! Makes the run-info tree for parent in the current directory.
+    ORRunInfoTree(TTree* parent);
+    virtual ~ORRunInfoTree() {}
+
+    //! Call before each fill of the parent tree.
+    virtual void Record(const ORRunContext* runContext);
+    //! Stores the last range and builds the index.  Call after the last fill.
+    virtual void Finish();
+
+    virtual TTree* GetTree() { return fTree; }
+    virtual Long64_t GetNParentEntries() { return fNParentEntries; }
+
+    static std::string RunInfoTreeName(const std::string& treeName)
+      { return treeName + "_runInfo"; }
+
+  protected:
+    virtual void FillRange();
+
+  protected:
+    TTree* fTree;
+    Long64_t fNParentEntries;
+    Long64_t fFirstEntry;
+    Long64_t fLastEntry;
+    Int_t fRunNumber;
+    Int_t fSubRunNumber;
+    std::string fRunningState;
+};
+
+//! Index of a run-info tree by the entry ranges of its parent tree.
+/*!
+    Looks up the run-info entry whose range contains the current entry of
+    the parent tree.  Attach() sets up the friend and index for a parent
+    tree read from a file, e.g. when the friend was lost by copying the tree.
+ */
+class ORRunRangeIndex : public TTreeIndex
+{
+  public:
+    ORRunRangeIndex() {}
+    //! Builds the index from the firstEntry branch of runInfoTree.
+    ORRunRangeIndex(const TTree* runInfoTree);
+    virtual ~ORRunRangeIndex() {}
+
+    //! Returns the run-info entry for the current entry of parent.
+    virtual Long64_t GetEntryNumberFriend(const TTree* parent);
+
+    //! Finds the run-info tree of tree, indexes it and makes it a friend.
+    static TTree* Attach(TTree* tree);
+
+  ClassDef(ORRunRangeIndex, 1)
+};
+
+#endif
@@ -47,7 +47,7 @@ ORDataProcessor::EReturnCode ORSIS3820TreeWriter::ProcessMyDataRecord(UInt_t* re
   for(size_t i=0; i<fScalersDecoder->NScalersOf(record); i++) {
     fChannel = fScalersDecoder->IthChannelOf(record, i);
     fScaler = fScalersDecoder->IthScalerOf(record, i);
-    fTree->Fill();
+    FillTree();
   }
 
   return kSuccess;
@@ -0,0 +1,224 @@
+// ORTimeOrderedEventBuilder.cc
+
+#include "ORTimeOrderedEventBuilder.hh"
+
+#include <algorithm>
+#include <functional>
+#include "OREventBuilderSource.hh"
+#include "ORLogger.hh"
+
+using namespace std;
+
+ORTimeOrderedEventBuilder::ORTimeOrderedEventBuilder(string treeName) :
+fTreeWriter(treeName)
+{
+  fReorderWindow = 1000000;
+  fCoincidenceWindow = 1000;
+  fMinMultiplicity = 1;
+  fMaxBufferedHits = 1000000;
+  AddProcessor(&fTreeWriter);
+  ResetBuffers();
+}
+
+ORTimeOrderedEventBuilder::~ORTimeOrderedEventBuilder()
+{
+  for (size_t i = 0; i < fSources.size(); i++) delete fSources[i];
+}
+
+ORDigitizerEventSource* ORTimeOrderedEventBuilder::AddDigitizer(ORVDigitizerDecoder* decoder,
+                                                                Double_t clockFrequency,
+                                                                UInt_t clockBits)
+{
+  ORDigitizerEventSource* source =
+    new ORDigitizerEventSource(decoder, this, clockFrequency, clockBits);
+  fSources.push_back(source);
+  AddProcessor(source);
+  return source;
+}
+
+ORSecSubSecEventSource* ORTimeOrderedEventBuilder::AddSecSubSecSource(ORVBasicTreeDecoder* decoder,
+                                                                      Double_t subSecondsPerSecond)
+{
+  ORSecSubSecEventSource* source = new ORSecSubSecEventSource(decoder, this, subSecondsPerSecond);
+  fSources.push_back(source);
+  AddProcessor(source);
+  return source;
+}
+
+void ORTimeOrderedEventBuilder::ResetBuffers()
+{
+  fQueueIndex.clear();
+  fQueues.clear();
+  fHeads.clear();
+  fEvent.clear();
+  fNBuffered = 0;
+  fNewestTime = 0;
+  fLastMergedTime = 0;
+  fHaveMerged = false;
+  fNHits = 0;
+  fNLateHits = 0;
+  fNEvents = 0;
+  fNEventsWritten = 0;
+}
+
+size_t ORTimeOrderedEventBuilder::GetMemoryUsage() const
+{
+  size_t nBytes = ORCompoundDataProcessor::GetMemoryUsage();
+  nBytes += fNBuffered*sizeof(ORBuilderHit) + fQueues.capacity()*sizeof(ORHitQueue);
+  nBytes += fHeads.capacity()*sizeof(HeadEntry) + fEvent.capacity()*sizeof(ORBuilderHit);
+  return nBytes;
+}
+
+ORDataProcessor::EReturnCode ORTimeOrderedEventBuilder::StartRun()
+{
+  ResetBuffers();
+  return ORCompoundDataProcessor::StartRun();
+}
+
+ORDataProcessor::EReturnCode ORTimeOrderedEventBuilder::EndRun()
+{
+  Merge(true);
+  WriteEvent();
+  ReportStatistics();
+  return ORCompoundDataProcessor::EndRun();
+}
+
+ORTimeOrderedEventBuilder::ORHitQueue& ORTimeOrderedEventBuilder::GetQueue(UInt_t crate, UInt_t card,
+                                                                          size_t& index)
+{
+  UInt_t key = CardKey(crate, card);
+  map<UInt_t, size_t>::iterator iter = fQueueIndex.find(key);
+  if (iter != fQueueIndex.end()) {
+    index = iter->second;
+    return fQueues[index];
+  }
+  index = fQueues.size();
+  fQueueIndex[key] = index;
+  fQueues.push_back(ORHitQueue());
+  // shift all cards by the most negative offset so that times stay positive
+  Long64_t minOffset = 0;
+  map<UInt_t, Long64_t>::iterator offset;
+  for (offset = fCardOffsets.begin(); offset != fCardOffsets.end(); offset++) {
+    if (offset->second < minOffset) minOffset = offset->second;
+  }
+  offset = fCardOffsets.find(key);
+  Long64_t cardOffset = (offset != fCardOffsets.end()) ? offset->second : 0;
+  fQueues[index].fOffset = (ULong64_t) (cardOffset - minOffset);
+  return fQueues[index];
+}
+
+ULong64_t ORTimeOrderedEventBuilder::TicksToNs(ULong64_t ticks, Double_t clockFrequency)
+{
+  // whole seconds in integers, so that clocks counting from the epoch stay
+  // exact; only the remainder goes through a double
+  ULong64_t ticksPerSecond = (ULong64_t) (clockFrequency + 0.5);
+  if (ticksPerSecond == 0) return (ULong64_t) (ticks*1.0e9/clockFrequency + 0.5);
+  return (ticks/ticksPerSecond)*1000000000LL +
+         (ULong64_t) ((ticks % ticksPerSecond)*1.0e9/clockFrequency + 0.5);
+}
+
+void ORTimeOrderedEventBuilder::AddHit(UInt_t crate, UInt_t card, UShort_t channel,
+                                       ULong64_t rawTime, Double_t clockFrequency, UInt_t clockBits,
+                                       UInt_t energy)
+{
+  fNHits++;
+  size_t index;
+  ORHitQueue& queue = GetQueue(crate, card, index);
+
+  // unwrap: a large step back is the clock rolling over
+  ULong64_t ticks = rawTime;
+  if (clockBits < 64) {
+    ULong64_t range = ((ULong64_t) 1) << clockBits;
+    rawTime &= range - 1;
+    if (queue.fStarted && rawTime < queue.fLastRawTime &&
+        queue.fLastRawTime - rawTime > range/2) queue.fEpoch++;
+    ticks = queue.fEpoch*range + rawTime;
+  }
+  queue.fLastRawTime = rawTime;
+  queue.fStarted = true;
+
+  ORBuilderHit hit;
+  hit.fTime = TicksToNs(ticks, clockFrequency) + queue.fOffset;
+  hit.fCrate = crate;
+  hit.fCard = card;
+  hit.fChannel = channel;
+  hit.fEnergy = energy;
+
+  if (fHaveMerged && hit.fTime < fLastMergedTime) {
+    ORLog(kDebug) << "AddHit(): hit of crate " << crate << ", card " << card
+                  << " arrived after the reorder window" << endl;
+    fNLateHits++;
+    return;
+  }
+
+  // cards mostly read out in order, so this is nearly always a push_back
+  deque<ORBuilderHit>& hits = queue.fHits;
+  if (hits.empty() || hits.back().fTime <= hit.fTime) hits.push_back(hit);
+  else {
+    deque<ORBuilderHit>::iterator pos = hits.end();
+    while (pos != hits.begin() && (pos-1)->fTime > hit.fTime) pos--;
+    hits.insert(pos, hit);
+  }
+  if (hits.front().fTime == hit.fTime) {
+    fHeads.push_back(HeadEntry(hit.fTime, index));
+    push_heap(fHeads.begin(), fHeads.end(), greater<HeadEntry>());
+  }
+  fNBuffered++;
+  if (hit.fTime > fNewestTime) fNewestTime = hit.fTime;
+
+  Merge();
+}
+
+void ORTimeOrderedEventBuilder::Merge(bool all)
+{
+  // Each non-empty queue has an entry for its head in fHeads; entries that
+  // no longer match the head (after an insertion in front) are skipped.
+  while (!fHeads.empty()) {
+    HeadEntry head = fHeads.front();
+    bool overfull = (fMaxBufferedHits > 0 && fNBuffered > fMaxBufferedHits);
+    if (!all && !overfull && head.first + fReorderWindow > fNewestTime) break;
+    pop_heap(fHeads.begin(), fHeads.end(), greater<HeadEntry>());
+    fHeads.pop_back();
+
+    deque<ORBuilderHit>& hits = fQueues[head.second].fHits;
+    if (hits.empty() || hits.front().fTime != head.first) continue;
+    ORBuilderHit hit = hits.front();
+    hits.pop_front();
+    fNBuffered--;
+    if (!hits.empty()) {
+      fHeads.push_back(HeadEntry(hits.front().fTime, head.second));
+      push_heap(fHeads.begin(), fHeads.end(), greater<HeadEntry>());
+    }
+    fLastMergedTime = hit.fTime;
+    fHaveMerged = true;
+    AddToEvent(hit);
+  }
+}
+
+void ORTimeOrderedEventBuilder::AddToEvent(const ORBuilderHit& hit)
+{
+  if (!fEvent.empty() && (Double_t) (hit.fTime - fEvent[0].fTime) > fCoincidenceWindow) WriteEvent();
+  fEvent.push_back(hit);
+}
+
+void ORTimeOrderedEventBuilder::WriteEvent()
+{
+  if (fEvent.empty()) return;
+  fNEvents++;
+  if (fEvent.size() >= fMinMultiplicity) {
+    fTreeWriter.WriteEvent(fEvent);
+    fNEventsWritten++;
+  }
+  fEvent.clear();
+}
+
+void ORTimeOrderedEventBuilder::ReportStatistics() const
+{
+  ORLog(kRoutine) << "ReportStatistics(): " << fNHits << " hits from " << fQueues.size()
+                  << " cards built into " << fNEvents << " events, " << fNEventsWritten
+                  << " written" << endl;
+  if (fNLateHits > 0) {
+    ORLog(kWarning) << "ReportStatistics(): " << fNLateHits << " hits arrived after the "
+                    << fReorderWindow << " ns reorder window and were dropped" << endl;
+  }
+}
@@ -0,0 +1,142 @@
+// ORTimeOrderedEventBuilder.hh
+
+#ifndef _ORTimeOrderedEventBuilder_hh_
+#define _ORTimeOrderedEventBuilder_hh_
+
+#include <deque>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+#include "ORCompoundDataProcessor.hh"
+#include "ORBuiltEventTreeWriter.hh"
+
+class ORVDigitizerDecoder;
+class ORVBasicTreeDecoder;
+class ORDigitizerEventSource;
+class ORSecSubSecEventSource;
+
+//! Builds coincidence events from the hits of several cards and crates.
+/*!
+    Hits come from event sources (see OREventBuilderSource.hh), one per
+    decoder, which are added with AddDigitizer() (any ORVDigitizerDecoder,
+    using GetEventTime()) or AddSecSubSecSource() (the KATRIN/IPE energy
+    records with seconds and subseconds).  Their clocks are unwrapped per
+    card, converted to ns and shifted by the offset of the card
+    (SetCardOffset()), so that all hits are on one time axis.  Times are
+    kept as integer ns, which stay exact for clocks counting from the Unix
+    epoch; if some offsets are negative, all times are shifted by the most
+    negative one so that they stay positive.
+
+    The hits of each card are queued in time order.  The queues are merged
+    (k-way, with a heap on the queue heads) once a hit is older than the
+    newest hit seen by more than SetReorderWindow(), i.e. cards may be read
+    out late by up to the reorder window.  Hits arriving after their time
+    has been merged are counted as late and dropped.  At most
+    SetMaxBufferedHits() are held; beyond that the oldest are merged
+    regardless of the window, so memory stays bounded.
+
+    The merged hits are grouped into events: a hit within
+    SetCoincidenceWindow() of the first hit of the current event joins it,
+    otherwise it starts the next one.  Events with at least
+    SetMinMultiplicity() hits are written by an ORBuiltEventTreeWriter.
+    \verbatim
+    ORTimeOrderedEventBuilder builder;
+    builder.AddDigitizer(new ORGretina4MDecoder, 100.0e6, 48);
+    builder.AddSecSubSecSource(new ORKatrinV4FLTEnergyDecoder);
+    builder.SetCoincidenceWindow(500);
+    builder.SetMinMultiplicity(2);
+    \endverbatim
+ */
+class ORTimeOrderedEventBuilder : public ORCompoundDataProcessor
+{
+  public:
+    ORTimeOrderedEventBuilder(std::string treeName = "builtEventTree");
+    virtual ~ORTimeOrderedEventBuilder();
+
+    //! Adds a digitizer, taking ownership of decoder.
+    /*!
+        clockFrequency is that of the GetEventTime() counter in Hz (0: the
+        decoder's sampling frequency), which wraps after clockBits bits.
+     */
+    virtual ORDigitizerEventSource* AddDigitizer(ORVDigitizerDecoder* decoder,
+                                                 Double_t clockFrequency = 0,
+                                                 UInt_t clockBits = 64);
+    //! Adds records with "seconds" and "subseconds" parameters, taking ownership of decoder.
+    virtual ORSecSubSecEventSource* AddSecSubSecSource(ORVBasicTreeDecoder* decoder,
+                                                       Double_t subSecondsPerSecond = 2.0e7);
+
+    //! Time added to the hits of a card, in ns; set before the run.
+    virtual void SetCardOffset(UInt_t crate, UInt_t card, Long64_t offset)
+      { fCardOffsets[CardKey(crate, card)] = offset; }
+    //! How late (ns) the hits of a card may arrive relative to other cards.
+    virtual void SetReorderWindow(Double_t window)
+      { fReorderWindow = (window > 0) ? (ULong64_t) window : 0; }
+    virtual void SetCoincidenceWindow(Double_t window) { fCoincidenceWindow = window; }
+    virtual void SetMinMultiplicity(size_t nHits) { fMinMultiplicity = nHits; }
+    virtual void SetMaxBufferedHits(size_t nHits) { fMaxBufferedHits = nHits; }
+
+    //! Queues a hit; called by the event sources.
+    /*!
+        rawTime is a count of ticks of clockFrequency (Hz), wrapping after
+        clockBits.
+     */
+    virtual void AddHit(UInt_t crate, UInt_t card, UShort_t channel, ULong64_t rawTime,
+                        Double_t clockFrequency, UInt_t clockBits, UInt_t energy);
+    //! ticks of clockFrequency (Hz) in ns, exact for whole-Hz clocks.
+    static ULong64_t TicksToNs(ULong64_t ticks, Double_t clockFrequency);
+
+    virtual EReturnCode StartRun();
+    virtual EReturnCode EndRun();
+
+    virtual ULong64_t GetNHits() const { return fNHits; }
+    virtual ULong64_t GetNLateHits() const { return fNLateHits; }
+    virtual ULong64_t GetNEvents() const { return fNEvents; }
+    virtual ULong64_t GetNEventsWritten() const { return fNEventsWritten; }
+    virtual void ReportStatistics() const;
+
+    //! The components, and the hits waiting to be merged.
+    virtual size_t GetMemoryUsage() const;
+
+  protected:
+    struct ORHitQueue {
+      std::deque<ORBuilderHit> fHits;
+      ULong64_t fLastRawTime;
+      ULong64_t fEpoch;     // number of clock wraps
+      bool fStarted;
+      ULong64_t fOffset;    // card offset minus the most negative one
+      ORHitQueue() : fLastRawTime(0), fEpoch(0), fStarted(false), fOffset(0) {}
+    };
+    // heap entry for the head of a queue: (time, queue index)
+    typedef std::pair<ULong64_t, size_t> HeadEntry;
+
+    static UInt_t CardKey(UInt_t crate, UInt_t card) { return (crate << 16) + card; }
+    virtual ORHitQueue& GetQueue(UInt_t crate, UInt_t card, size_t& index);
+    //! Merges queued hits older than the newest by the reorder window (or all).
+    virtual void Merge(bool all = false);
+    virtual void AddToEvent(const ORBuilderHit& hit);
+    virtual void WriteEvent();
+    virtual void ResetBuffers();
+
+  protected:
+    ORBuiltEventTreeWriter fTreeWriter;
+    std::vector<ORDataProcessor*> fSources;
+    std::map<UInt_t, size_t> fQueueIndex;
+    std::vector<ORHitQueue> fQueues;
+    std::vector<HeadEntry> fHeads; // min-heap on time
+    std::map<UInt_t, Long64_t> fCardOffsets;
+    std::vector<ORBuilderHit> fEvent;
+
+    ULong64_t fReorderWindow;
+    Double_t fCoincidenceWindow;
+    size_t fMinMultiplicity;
+    size_t fMaxBufferedHits;
+
+    size_t fNBuffered;
+    ULong64_t fNewestTime;
+    ULong64_t fLastMergedTime;
+    bool fHaveMerged;
+    ULong64_t fNHits, fNLateHits, fNEvents, fNEventsWritten;
+};
+
+#endif
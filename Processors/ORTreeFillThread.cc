@@ -0,0 +1,444 @@
+// ORTreeFillThread.cc
+
+#include "ORTreeFillThread.hh"
+
+#include <pthread.h>
+#include <sys/time.h>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <deque>
+#include <map>
+#include "RVersion.h"
+#include "TROOT.h"
+#include "TTree.h"
+#include "TBranch.h"
+#include "TBranchElement.h"
+#include "TLeaf.h"
+#include "TObjArray.h"
+#include "TString.h"
+#if ROOT_VERSION_CODE < ROOT_VERSION(6,5,0)
+#include "TThread.h"
+#endif
+#include "ORLogger.hh"
+#include "ORTraceWriter.hh"
+
+using namespace std;
+
+namespace {
+
+// One double-buffered top-level branch.
+struct ORFillSlot {
+  enum EKind { kFixed, kVarArray, kString };
+  EKind fKind;
+  TBranch* fBranch;
+  char* fOrigAddress;     // the writer's buffer
+  size_t fNBytes;         // kFixed: size of the buffer; kVarArray: size of one element
+  char* fCountAddress;    // kVarArray: the writer's count leaf
+  int fCountSize;         // kVarArray: size of the count leaf in bytes
+  vector<char> fShadow;   // the fill thread's buffer
+  string* fOrigString;
+  string fShadowString;
+};
+
+struct ORAsyncTree {
+  TTree* fTree;
+  bool fSynchronous;
+  vector<ORFillSlot*> fSlots;
+};
+
+struct ORFillJob {
+  ORAsyncTree* fTree;
+  vector<char> fData;
+};
+
+pthread_t gFillThread;
+pthread_mutex_t gMutex = PTHREAD_MUTEX_INITIALIZER;
+pthread_cond_t gWorkCond = PTHREAD_COND_INITIALIZER; // signals queued work or stop
+pthread_cond_t gDoneCond = PTHREAD_COND_INITIALIZER; // signals finished work
+bool gRunning = false;
+bool gStopRequested = false;
+bool gBusy = false;
+size_t gMaxQueuedBytes = 0;
+size_t gQueuedBytes = 0;
+deque<ORFillJob*> gQueue;
+vector<ORFillJob*> gFreeJobs;
+map<TTree*, ORAsyncTree*> gTrees; // only touched by the processing thread
+
+// statistics
+ULong64_t gNAsyncFills = 0;
+ULong64_t gNSyncFills = 0;
+ULong64_t gNBytesQueued = 0;
+double gSecondsBlocked = 0.0;
+double gSecondsFilling = 0.0;
+
+double Now()
+{
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec + 1e-6*tv.tv_usec;
+}
+
+ULong64_t ReadCount(const char* address, int size)
+{
+  switch (size) {
+    case 1: { Char_t c; memcpy(&c, address, 1); return (c < 0) ? 0 : c; }
+    case 2: { Short_t s; memcpy(&s, address, 2); return (s < 0) ? 0 : s; }
+    case 4: { Int_t i; memcpy(&i, address, 4); return (i < 0) ? 0 : i; }
+    case 8: { Long64_t l; memcpy(&l, address, 8); return (l < 0) ? 0 : l; }
+  }
+  return 0;
+}
+
+void Append(vector<char>& data, const void* source, size_t nBytes)
+{
+  size_t size = data.size();
+  data.resize(size + nBytes);
+  if (nBytes > 0) memcpy(&data[size], source, nBytes);
+}
+
+// Works out how to double-buffer aTree and, if possible, redirects its
+// branches to the shadow buffers. Called on the processing thread before
+// the first fill of aTree is queued.
+ORAsyncTree* TakeOver(TTree* aTree)
+{
+  ORAsyncTree* asyncTree = new ORAsyncTree;
+  asyncTree->fTree = aTree;
+  asyncTree->fSynchronous = false;
+  string reason;
+
+  TObjArray* branches = aTree->GetListOfBranches();
+  for (int i=0; i<branches->GetEntriesFast() && reason == ""; i++) {
+    TBranch* branch = (TBranch*) branches->At(i);
+    ORFillSlot* slot = new ORFillSlot;
+    asyncTree->fSlots.push_back(slot);
+    slot->fBranch = branch;
+    slot->fOrigAddress = branch->GetAddress();
+    slot->fNBytes = 0;
+    slot->fCountAddress = NULL;
+    slot->fCountSize = 0;
+    slot->fOrigString = NULL;
+
+    TBranchElement* element = dynamic_cast<TBranchElement*>(branch);
+    if (element != NULL) {
+      if (string(element->GetClassName()) == "string" && element->GetObject() != NULL) {
+        slot->fKind = ORFillSlot::kString;
+        slot->fOrigString = (string*) element->GetObject();
+      }
+      else reason = string("branch ") + branch->GetName() + " is of class " + element->GetClassName();
+      continue;
+    }
+
+    TObjArray* leaves = branch->GetListOfLeaves();
+    if (slot->fOrigAddress == NULL || leaves->GetEntriesFast() == 0 ||
+        branch->GetListOfBranches()->GetEntriesFast() > 0) {
+      reason = string("branch ") + branch->GetName() + " is not a simple leaf-list branch";
+      continue;
+    }
+    slot->fKind = ORFillSlot::kFixed;
+    for (int j=0; j<leaves->GetEntriesFast(); j++) {
+      TLeaf* leaf = (TLeaf*) leaves->At(j);
+      if (string(leaf->ClassName()) == "TLeafC") {
+        reason = string("branch ") + branch->GetName() + " holds a C string";
+        break;
+      }
+      size_t nBytes = leaf->GetLenType()*leaf->GetLenStatic();
+      TLeaf* countLeaf = leaf->GetLeafCount();
+      if (countLeaf != NULL) {
+        if (leaves->GetEntriesFast() > 1 || countLeaf->GetBranch()->GetAddress() == NULL) {
+          reason = string("branch ") + branch->GetName() + " has an unsupported variable-length array";
+          break;
+        }
+        slot->fKind = ORFillSlot::kVarArray;
+        slot->fNBytes = nBytes;
+        slot->fCountAddress = countLeaf->GetBranch()->GetAddress() + countLeaf->GetOffset();
+        slot->fCountSize = countLeaf->GetLenType();
+      }
+      else if (leaf->GetOffset() + nBytes > slot->fNBytes) {
+        slot->fNBytes = leaf->GetOffset() + nBytes;
+      }
+    }
+  }
+
+  if (reason != "") {
+    ORLog(kRoutine) << "TakeOver(): tree " << aTree->GetName()
+                    << " will be filled synchronously: " << reason << endl;
+    for (size_t i=0; i<asyncTree->fSlots.size(); i++) delete asyncTree->fSlots[i];
+    asyncTree->fSlots.clear();
+    asyncTree->fSynchronous = true;
+    return asyncTree;
+  }
+
+  // All addresses are known; now redirect the branches.
+  for (size_t i=0; i<asyncTree->fSlots.size(); i++) {
+    ORFillSlot* slot = asyncTree->fSlots[i];
+    if (slot->fKind == ORFillSlot::kString) {
+      slot->fShadowString = *slot->fOrigString;
+      ((TBranchElement*) slot->fBranch)->SetObject(&slot->fShadowString);
+      continue;
+    }
+    slot->fShadow.resize(slot->fNBytes > 0 ? slot->fNBytes : 1);
+    slot->fBranch->SetAddress(&slot->fShadow[0]);
+  }
+  return asyncTree;
+}
+
+void HandBack(ORAsyncTree* asyncTree)
+{
+  for (size_t i=0; i<asyncTree->fSlots.size(); i++) {
+    ORFillSlot* slot = asyncTree->fSlots[i];
+    if (slot->fKind == ORFillSlot::kString) {
+      ((TBranchElement*) slot->fBranch)->SetObject(slot->fOrigString);
+    }
+    else slot->fBranch->SetAddress(slot->fOrigAddress);
+    delete slot;
+  }
+  delete asyncTree;
+}
+
+// Copies the writer's buffers into job->fData (processing thread).
+void Snapshot(ORAsyncTree* asyncTree, ORFillJob* job)
+{
+  job->fData.clear();
+  for (size_t i=0; i<asyncTree->fSlots.size(); i++) {
+    ORFillSlot* slot = asyncTree->fSlots[i];
+    size_t nBytes = 0;
+    switch (slot->fKind) {
+      case ORFillSlot::kFixed:
+        Append(job->fData, slot->fOrigAddress, slot->fNBytes);
+        break;
+      case ORFillSlot::kVarArray:
+        nBytes = slot->fNBytes*ReadCount(slot->fCountAddress, slot->fCountSize);
+        Append(job->fData, &nBytes, sizeof(nBytes));
+        Append(job->fData, slot->fOrigAddress, nBytes);
+        break;
+      case ORFillSlot::kString:
+        nBytes = slot->fOrigString->size();
+        Append(job->fData, &nBytes, sizeof(nBytes));
+        Append(job->fData, slot->fOrigString->data(), nBytes);
+        break;
+    }
+  }
+}
+
+// Copies job->fData into the shadow buffers and fills the tree (fill thread).
+void Unpack(ORFillJob* job)
+{
+  ORAsyncTree* asyncTree = job->fTree;
+  const char* data = job->fData.empty() ? NULL : &job->fData[0];
+  for (size_t i=0; i<asyncTree->fSlots.size(); i++) {
+    ORFillSlot* slot = asyncTree->fSlots[i];
+    size_t nBytes = slot->fNBytes;
+    if (slot->fKind != ORFillSlot::kFixed) {
+      memcpy(&nBytes, data, sizeof(nBytes));
+      data += sizeof(nBytes);
+    }
+    if (slot->fKind == ORFillSlot::kString) slot->fShadowString.assign(data, nBytes);
+    else {
+      if (nBytes > slot->fShadow.size()) {
+        slot->fShadow.resize(nBytes);
+        slot->fBranch->SetAddress(&slot->fShadow[0]);
+      }
+      if (nBytes > 0) memcpy(&slot->fShadow[0], data, nBytes);
+    }
+    data += nBytes;
+  }
+  asyncTree->fTree->Fill();
+}
+
+void* FillThreadLoop(void*)
+{
+  ORTraceWriter::SetThreadName("tree fill");
+  ULong64_t nTraceFills = 0;
+  pthread_mutex_lock(&gMutex);
+  while (true) {
+    while (gQueue.empty() && !gStopRequested) pthread_cond_wait(&gWorkCond, &gMutex);
+    if (gQueue.empty()) break; // stop requested and nothing left to do
+    ORFillJob* job = gQueue.front();
+    gQueue.pop_front();
+    gBusy = true;
+    pthread_mutex_unlock(&gMutex);
+
+    double start = Now();
+    Double_t traceStart = ORTraceWriter::IsOpen() ? ORTraceWriter::Now() : 0;
+    Unpack(job);
+    double elapsed = Now() - start;
+    // sampled fills, and all that took over a millisecond (basket flushes)
+    if (ORTraceWriter::IsOpen() && (ORTraceWriter::Sample(nTraceFills) || elapsed > 1e-3)) {
+      ORTraceWriter::AddSpan(string("TTree::Fill ") + job->fTree->fTree->GetName(), "io", traceStart);
+    }
+
+    pthread_mutex_lock(&gMutex);
+    gSecondsFilling += elapsed;
+    gQueuedBytes -= job->fData.size();
+    gFreeJobs.push_back(job);
+    gBusy = false;
+    pthread_cond_broadcast(&gDoneCond);
+  }
+  pthread_mutex_unlock(&gMutex);
+  return NULL;
+}
+
+void InitializeROOTThreads()
+{
+  static bool initialized = false;
+  if (initialized) return;
+#if ROOT_VERSION_CODE >= ROOT_VERSION(6,5,0)
+  ROOT::EnableThreadSafety();
+#else
+  TThread::Initialize();
+#endif
+  initialized = true;
+}
+
+}
+
+bool ORTreeFillThread::Start(size_t maxQueuedBytes)
+{
+  if (gRunning) {
+    ORLog(kWarning) << "Start(): the fill thread is already running" << endl;
+    return true;
+  }
+  InitializeROOTThreads();
+  gMaxQueuedBytes = (maxQueuedBytes > 0) ? maxQueuedBytes : 64*1024*1024;
+  gStopRequested = false;
+  if (pthread_create(&gFillThread, NULL, FillThreadLoop, NULL) != 0) {
+    ORLog(kError) << "Start(): could not create the fill thread; "
+                  << "trees will be filled synchronously" << endl;
+    return false;
+  }
+  gRunning = true;
+  ORLog(kRoutine) << "Start(): filling trees on a separate thread, queue limit "
+                  << gMaxQueuedBytes/1024/1024 << " MB" << endl;
+  return true;
+}
+
+void ORTreeFillThread::Stop()
+{
+  if (!gRunning) return;
+  ReleaseAll();
+  pthread_mutex_lock(&gMutex);
+  gStopRequested = true;
+  pthread_cond_signal(&gWorkCond);
+  pthread_mutex_unlock(&gMutex);
+  pthread_join(gFillThread, NULL);
+  gRunning = false;
+  ReportStatistics();
+  for (size_t i=0; i<gFreeJobs.size(); i++) delete gFreeJobs[i];
+  gFreeJobs.clear();
+}
+
+bool ORTreeFillThread::IsRunning()
+{
+  return gRunning;
+}
+
+Int_t ORTreeFillThread::Fill(TTree* aTree)
+{
+  if (!gRunning) return aTree->Fill();
+
+  ORAsyncTree* asyncTree = NULL;
+  map<TTree*, ORAsyncTree*>::iterator iter = gTrees.find(aTree);
+  if (iter != gTrees.end()) asyncTree = iter->second;
+  else {
+    asyncTree = TakeOver(aTree);
+    gTrees[aTree] = asyncTree;
+  }
+
+  if (asyncTree->fSynchronous) {
+    // the fill thread may be writing to the same file
+    Sync();
+    gNSyncFills++;
+    return aTree->Fill();
+  }
+
+  pthread_mutex_lock(&gMutex);
+  ORFillJob* job = NULL;
+  if (!gFreeJobs.empty()) {
+    job = gFreeJobs.back();
+    gFreeJobs.pop_back();
+  }
+  pthread_mutex_unlock(&gMutex);
+  if (job == NULL) job = new ORFillJob;
+  job->fTree = asyncTree;
+  Snapshot(asyncTree, job);
+
+  pthread_mutex_lock(&gMutex);
+  if (gQueuedBytes + job->fData.size() > gMaxQueuedBytes && (!gQueue.empty() || gBusy)) {
+    double start = Now();
+    while (gQueuedBytes + job->fData.size() > gMaxQueuedBytes && (!gQueue.empty() || gBusy)) {
+      pthread_cond_wait(&gDoneCond, &gMutex);
+    }
+    gSecondsBlocked += Now() - start;
+  }
+  gQueue.push_back(job);
+  gQueuedBytes += job->fData.size();
+  gNBytesQueued += job->fData.size();
+  gNAsyncFills++;
+  pthread_cond_signal(&gWorkCond);
+  pthread_mutex_unlock(&gMutex);
+  return 0;
+}
+
+void ORTreeFillThread::Sync()
+{
+  if (!gRunning) return;
+  pthread_mutex_lock(&gMutex);
+  while (!gQueue.empty() || gBusy) pthread_cond_wait(&gDoneCond, &gMutex);
+  pthread_mutex_unlock(&gMutex);
+}
+
+void ORTreeFillThread::Release(TTree* aTree)
+{
+  map<TTree*, ORAsyncTree*>::iterator iter = gTrees.find(aTree);
+  if (iter == gTrees.end()) return;
+  Sync();
+  HandBack(iter->second);
+  gTrees.erase(iter);
+}
+
+void ORTreeFillThread::ReleaseAll()
+{
+  Sync();
+  map<TTree*, ORAsyncTree*>::iterator iter;
+  for (iter = gTrees.begin(); iter != gTrees.end(); iter++) HandBack(iter->second);
+  gTrees.clear();
+}
+
+bool ORTreeFillThread::EnableImplicitMT(UInt_t nThreads)
+{
+#if ROOT_VERSION_CODE >= ROOT_VERSION(6,10,0)
+  InitializeROOTThreads();
+  ROOT::EnableImplicitMT(nThreads);
+  if (!ROOT::IsImplicitMTEnabled()) {
+    ORLog(kWarning) << "EnableImplicitMT(): ROOT was built without implicit "
+                    << "multi-threading support" << endl;
+    return false;
+  }
+  ORLog(kRoutine) << "EnableImplicitMT(): baskets will be compressed in parallel" << endl;
+  return true;
+#else
+  ORLog(kWarning) << "EnableImplicitMT(): parallel basket compression requires "
+                  << "ROOT >= 6.10; ignoring request for " << nThreads << " threads" << endl;
+  return false;
+#endif
+}
+
+size_t ORTreeFillThread::GetQueuedBytes()
+{
+  pthread_mutex_lock(&gMutex);
+  size_t nBytes = gQueuedBytes;
+  pthread_mutex_unlock(&gMutex);
+  return nBytes;
+}
+
+void ORTreeFillThread::ReportStatistics()
+{
+  pthread_mutex_lock(&gMutex);
+  ORLog(kRoutine) << "ReportStatistics(): " << gNAsyncFills << " fills on the fill thread ("
+                  << ::Form("%.1f", double(gNBytesQueued)/1024.0/1024.0) << " MB, "
+                  << ::Form("%.1f", gSecondsFilling) << " s in TTree::Fill), "
+                  << gNSyncFills << " synchronous fills, "
+                  << ::Form("%.1f", gSecondsBlocked) << " s blocked on a full queue" << endl;
+  pthread_mutex_unlock(&gMutex);
+}
@@ -0,0 +1,68 @@
+// ORTreeFillThread.hh
+
+#ifndef _ORTreeFillThread_hh_
+#define _ORTreeFillThread_hh_
+
+#include <cstddef>
+#ifndef ROOT_Rtypes
+#include "Rtypes.h"
+#endif
+
+class TTree;
+
+//! Background thread that fills TTrees and writes their baskets.
+/*!
+    When the thread is running, ORVTreeWriter::FillTree() hands the tree to
+    Fill() instead of calling TTree::Fill() itself.  Fill() copies the
+    current contents of the tree's branch buffers (the writer's member
+    variables) into a snapshot and queues it; the fill thread copies the
+    snapshot into buffers of its own, to which the tree's branches are
+    redirected, and calls TTree::Fill().  Basket compression and the disk
+    writes it triggers therefore happen off the processing thread, while the
+    writer is free to fill its members with the next event right away.
+
+    Leaf-list branches (scalars, fixed and variable-length arrays) and
+    std::string branches are double-buffered.  Trees with any other kind of
+    branch (e.g. std::vector) are filled synchronously on the calling thread
+    after the queue has been drained, so the result is the same either way.
+
+    The queue holds at most the given number of bytes of snapshots; Fill()
+    blocks when it is full.  All functions must be called from the
+    processing thread.  Before anything is written to a file that holds a
+    tree being filled (tree or histogram Write(), file Close()), Sync() must
+    be called; ORDataProcManager does this before EndRun(), ORFileWriter
+    before it writes or closes its file.  Release() restores the branch
+    addresses of a tree and must be called before the tree is deleted.
+
+    Independently of the fill thread, ROOT's implicit multi-threading can be
+    enabled with EnableImplicitMT() (ROOT >= 6.10), in which case TTree::Fill()
+    compresses the baskets of different branches in parallel.
+ */
+class ORTreeFillThread
+{
+  public:
+    //! Starts the thread; maxQueuedBytes == 0 selects the default (64 MB).
+    static bool Start(size_t maxQueuedBytes = 0);
+    //! Drains the queue, releases all trees and joins the thread.
+    static void Stop();
+    static bool IsRunning();
+
+    //! Queues a fill of aTree (or fills it directly if the thread is not running).
+    static Int_t Fill(TTree* aTree);
+    //! Waits until all queued fills have been done.
+    static void Sync();
+    //! Sync()s and hands aTree back to its writer.
+    static void Release(TTree* aTree);
+    static void ReleaseAll();
+
+    //! Enables ROOT implicit multi-threading with nThreads (0: one per core).
+    static bool EnableImplicitMT(UInt_t nThreads = 0);
+
+    //! Bytes of snapshots waiting in the queue.
+    static size_t GetQueuedBytes();
+
+    //! Logs the fill statistics at the routine level.
+    static void ReportStatistics();
+};
+
+#endif
@@ -11,15 +11,10 @@ ORTrig4ChanShaperCompoundProcessor::ORTrig4ChanShaperCompoundProcessor()
   
   fTriggerTreeWriter = new ORTrig4ChanTreeWriter("triggerTree");
   AddProcessor(fTriggerTreeWriter);
-  
-  fLastTriggerRecordPtr = NULL;
 }
 
 ORTrig4ChanShaperCompoundProcessor::~ORTrig4ChanShaperCompoundProcessor()
 {
-  if(fLastTriggerRecordPtr) {
-    delete[] fLastTriggerRecordPtr;
-  }
   delete fShaperTreeWriter;
   delete fTriggerTreeWriter;
 }
@@ -33,11 +28,7 @@ ORDataProcessor::EReturnCode ORTrig4ChanShaperCompoundProcessor::StartRun()
 
 ORDataProcessor::EReturnCode ORTrig4ChanShaperCompoundProcessor::EndRun()
 {
-
-  if(fLastTriggerRecordPtr) {
-    delete[] fLastTriggerRecordPtr;
-    fLastTriggerRecordPtr = NULL;
-  }
+  fRetainedTriggerRecord.Reset();
   return ORCompoundDataProcessor::EndRun();
 }
 
@@ -54,20 +45,15 @@ ORDataProcessor::EReturnCode ORTrig4ChanShaperCompoundProcessor::ProcessDataReco
       //duplicate trigger record
       /* Here the last record was a shaper, so we have to duplicate the record. */
       /* Call the trigger tree writer to do this. */
-      code = fTriggerTreeWriter->ProcessDataRecord(fLastTriggerRecordPtr);
+      code = fTriggerTreeWriter->ProcessDataRecord(fRetainedTriggerRecord.GetData());
     }  else {
       code = kSuccess;
     } 
     fLastRecordDataId = thisDataId;  
   } else if( thisDataId == fTriggerDataId ) {
     //normal processing
-    if (fLastTriggerRecordPtr==NULL) { 
-      /* if not allocated, reallocate a buffer and then copy. */
-      fTriggerRecordLength = fShaperDecoder.LengthOf(record);
-      fLastTriggerRecordPtr = new UInt_t[fTriggerRecordLength];  
-    }
-    /* copy */
-    memcpy(fLastTriggerRecordPtr, record, fTriggerRecordLength*sizeof(UInt_t));
+    /* keep the trigger record; this shares the reader's buffer. */
+    fRetainedTriggerRecord = RetainRecord(record);
     fLastRecordDataId = thisDataId;  
     code = kSuccess;
   } 
@@ -31,8 +31,7 @@ class ORTrig4ChanShaperCompoundProcessor : public ORCompoundDataProcessor
     
     UInt_t fLastTriggerRecord;
     UInt_t fLastRecordDataId;
-    size_t fTriggerRecordLength;
-    UInt_t* fLastTriggerRecordPtr;
+    ORRecordHandle fRetainedTriggerRecord;
 };
 
 #endif
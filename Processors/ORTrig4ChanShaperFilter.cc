@@ -6,11 +6,13 @@
 using namespace std;
 
 
-ORTrig4ChanShaperFilter::ORTrig4ChanShaperFilter()
+ORTrig4ChanShaperFilter::ORTrig4ChanShaperFilter() :
+fLastHitClock(kNumCards*kNumChannels, 0), fHasHit(kNumCards*kNumChannels, false)
 {
   SetComponentBreakReturnsFailure();
   
-  fTimeCutLength = 0.0005;// in units of secs
+  SetTimeCut(0.0005);
+  fLastTriggerClock = 0;
   f64PDHistDrawer = new OR64PDHistDrawer(&fShaperDecoder);
   AddProcessor(f64PDHistDrawer);
 
@@ -21,28 +23,26 @@ ORTrig4ChanShaperFilter::ORTrig4ChanShaperFilter()
   fTriggerTreeWriter = new ORTrig4ChanTreeWriter("triggerFilterTree");
   AddProcessor(fTriggerTreeWriter);
   
-  fLastTriggerRecordPtr = NULL;
-  fTempShaperRecordPtr = NULL;
-   Reset = 0;
+  fNRecordsSinceTrigger = 0;
 }
 
 ORTrig4ChanShaperFilter::~ORTrig4ChanShaperFilter()
 {
-  if(fLastTriggerRecordPtr != NULL) {
-    delete[] fLastTriggerRecordPtr;
-  }
-  if(fTempShaperRecordPtr != NULL) {
-    delete[] fTempShaperRecordPtr;
-  }
-  
   delete f64PDHistDrawer;
   delete fShaperTreeWriter;
   delete fTriggerTreeWriter;
 }
+
+void ORTrig4ChanShaperFilter::ClearLastHits()
+{
+  fHasHit.assign(fHasHit.size(), false);
+}
+
 ORDataProcessor::EReturnCode ORTrig4ChanShaperFilter::StartRun()
 {
   fShaperDataId = fShaperTreeWriter->GetDataId();
   fTriggerDataId = fTriggerTreeWriter->GetDataId();
+  ClearLastHits();
   
   return ORCompoundDataProcessor::StartRun();
 }
@@ -51,63 +51,36 @@ ORDataProcessor::EReturnCode ORTrig4ChanShaperFilter::ProcessDataRecord(UInt_t*
   UInt_t thisDataId = fShaperDecoder.DataIdOf(record);
  
   if( thisDataId == fShaperDataId ) {
-     Reset++;
-    if (fTempShaperRecordPtr==NULL) { 
-       fShaperRecordLength = fShaperDecoder.LengthOf(record);
+    fNRecordsSinceTrigger++;
+    if (!fLastTriggerRecord.IsValid()) {
+      ORLog(kDebug) << "Shaper record before the first trigger record; skipping it" << endl;
+      return kSuccess;
     }
-    UInt_t tagNoise = 0;
-    fThisTriggerTime = (Double_t)fTriggerDecoder.ClockOf(fLastTriggerRecordPtr)/50000000.0;
-    fThisCard = fShaperDecoder.CardOf(record);  
-    fThisChannel = fShaperDecoder.ChannelOf(record);
-    if ( fBothRecords.size() > 0 ) {
-      //iterator to tag records old enough to delete
-      multimap<Double_t, UInt_t*>::iterator del_It= fBothRecords.begin();
+    UInt_t card = fShaperDecoder.CardOf(record);  
+    UInt_t channel = fShaperDecoder.ChannelOf(record);
+    size_t slot = card*kNumChannels + channel; // both in range by their bit masks
+    ULong64_t thisClock = fLastTriggerClock;
 
-      for (multimap<Double_t, UInt_t*>::iterator it = fBothRecords.begin();
-         it != fBothRecords.end();
-         ++it) {
-        fMapTriggerTime = it->first;
-        if ( fThisTriggerTime - fMapTriggerTime > fTimeCutLength ) {
-           //done with old records
-            delete[] it->second;
-            it->second = NULL;
-            //save iterator location of last record to erase 
-            del_It++;
-         } else { //within time cut
-          fLastCard = fShaperDecoder.CardOf(it->second);  
-          fLastChannel = fShaperDecoder.ChannelOf(it->second);
-          if ( fThisTriggerTime >= fMapTriggerTime ) {
-             //normal order events
-             if ( fThisCard == fLastCard ) {
-                if ( fThisChannel == fLastChannel ) {
-                   tagNoise = 1;//don't print current record
-                }
-             }
-          } else { 
-             //correct for out of order events
-             ORLog(kDebug) << "Cut Triggers coming out of order!" << endl;
-             ORLog(kDebug) << "Processing record " << fThisTriggerTime  << endl;
-             ORLog(kDebug) << "Map record Time " << fMapTriggerTime << endl;
-             ORLog(kDebug) << "Difference " << fThisTriggerTime - fMapTriggerTime << endl;
-             ORLog(kDebug) << "Reset " << Reset << endl;
-             if (fMapTriggerTime - fThisTriggerTime > fTimeCutLength ) {
-                if ( fThisCard == fLastCard ) {
-                   if ( fThisChannel == fLastChannel ) {
-                      tagNoise = 1;//don't print current record
-                   }
-                }
-             }
-             
-          }
-        }
+    bool tagNoise = false;
+    if (fHasHit[slot]) {
+      ULong64_t lastClock = fLastHitClock[slot];
+      if (thisClock >= lastClock) {
+        //normal order events: noise if within the time cut
+        tagNoise = (thisClock - lastClock <= fTimeCutTicks);
+      } else {
+        //out of order events
+        ORLog(kDebug) << "Cut Triggers coming out of order!" << endl;
+        ORLog(kDebug) << "Processing record clock " << thisClock << endl;
+        ORLog(kDebug) << "Last hit clock " << lastClock << endl;
+        ORLog(kDebug) << "Records since trigger " << fNRecordsSinceTrigger << endl;
+        tagNoise = (lastClock - thisClock > fTimeCutTicks);
       }
-      //records are automatically sorted by multimap, erase everything up to del_It
-      fBothRecords.erase(fBothRecords.begin(), del_It);
     }
-    if ( tagNoise == 0 ) {
+    if (!tagNoise) {
       if (!fDoProcess || !fDoProcessRun) return kFailure;
       //add time to hist BEFORE adding shaper record
-      EReturnCode retCode = f64PDHistDrawer->ProcessRecordTime(fThisTriggerTime);
+      EReturnCode retCode = 
+        f64PDHistDrawer->ProcessRecordTime((Double_t) thisClock/kClockFrequency);
       if (retCode == kBreak) return fBreakRetCode;
       if (retCode >= kAlarm) return retCode;      
       //add this shaper record to hist
@@ -117,25 +90,19 @@ ORDataProcessor::EReturnCode ORTrig4ChanShaperFilter::ProcessDataRecord(UInt_t*
       retCode = fShaperTreeWriter->ProcessDataRecord(record); 
       if (retCode == kBreak) return fBreakRetCode;
       if (retCode >= kAlarm) return retCode;      
-      retCode = fTriggerTreeWriter->ProcessDataRecord(fLastTriggerRecordPtr); 
+      retCode = fTriggerTreeWriter->ProcessDataRecord(fLastTriggerRecord.GetData()); 
       if (retCode == kBreak) return fBreakRetCode;
       if (retCode >= kAlarm) return retCode;      
     }
-    //now add this record to fBothRecords
-    fTempShaperRecordPtr = new UInt_t[fShaperRecordLength]; 
-    memcpy(fTempShaperRecordPtr, record, fShaperRecordLength*sizeof(UInt_t));
-    fBothRecords.insert(pair<Double_t, UInt_t*>(fThisTriggerTime, fTempShaperRecordPtr) );
+    //noise hits also start a new time cut
+    fLastHitClock[slot] = thisClock;
+    fHasHit[slot] = true;
     fLastRecordDataId = thisDataId;  
   } else if( thisDataId == fTriggerDataId ) {
-     Reset = 0;
-    if (fLastTriggerRecordPtr==NULL) { 
-      /* if not allocated, reallocate a buffer and then copy. */
-      fTriggerRecordLength = fShaperDecoder.LengthOf(record);
-      fLastTriggerRecordPtr = new UInt_t[fTriggerRecordLength];  
-       ORLog(kDebug) << "Trigger Length" << fTriggerRecordLength << endl;
-    }
-    /* copy */
-    memcpy(fLastTriggerRecordPtr, record, fTriggerRecordLength*sizeof(UInt_t));
+    fNRecordsSinceTrigger = 0;
+    /* keep the trigger record around for the following shaper records */
+    fLastTriggerRecord = RetainRecord(record);
+    fLastTriggerClock = fTriggerDecoder.ClockOf(record);
     fLastRecordDataId = thisDataId;  
   } 
   
@@ -144,43 +111,13 @@ ORDataProcessor::EReturnCode ORTrig4ChanShaperFilter::ProcessDataRecord(UInt_t*
 }
 ORDataProcessor::EReturnCode ORTrig4ChanShaperFilter::EndRun()
 {
-  if ( fBothRecords.size() > 0 ) {
-    for (multimap<Double_t, UInt_t*>::iterator it = fBothRecords.begin();
-        it != fBothRecords.end();
-        ++it) {
-      if( it->second != NULL ){
-        delete[] it->second;        
-        it->second = NULL;
-      }
-    }
-    fBothRecords.clear();
-  }
-  
-  
-  if(fLastTriggerRecordPtr != NULL) {
-    delete[] fLastTriggerRecordPtr;
-    fLastTriggerRecordPtr = NULL;
-  }
-  if(fTempShaperRecordPtr != NULL) {
-    //delete[] fTempShaperRecordPtr;//deleted by map
-    fTempShaperRecordPtr = NULL;
-  }
+  ClearLastHits();
+  fLastTriggerRecord.Reset();
   
   return ORCompoundDataProcessor::EndRun();
 }
 ORDataProcessor::EReturnCode ORTrig4ChanShaperFilter::EndProcessing()
 {
-  if ( fBothRecords.size() > 0 ) {
-    for (multimap<Double_t, UInt_t*>::iterator it = fBothRecords.begin();
-      it != fBothRecords.end();
-      ++it) {
-      if( it->second != NULL ){
-        delete[] it->second;        
-        it->second = NULL;
-      }
-    }
-    fBothRecords.clear();
-  }
+  ClearLastHits();
   return ORCompoundDataProcessor::EndProcessing();
 }
-
@@ -10,14 +10,24 @@
 #include "ORBasicTreeWriter.hh"
 #include "ORTrig4ChanTreeWriter.hh"
 #include "ORCompoundDataProcessor.hh"
-#include <utility>
-#include <map>
-
-using std::multimap;
+#include <vector>
 
+//! Drops shaper hits that follow a hit on the same channel too closely.
+/*!
+    Each shaper record is timed by the clock of the last trigger record.
+    A shaper hit on a card and channel that already had a hit within the
+    time cut (SetTimeCut(), 0.5 ms by default) is tagged as noise; the
+    others are passed to the 64-pixel display and, with their trigger
+    record, to the shaper and trigger trees.  The time of the last hit of
+    each card and channel is kept in a table and compared in clock ticks,
+    so each record costs O(1).
+ */
 class ORTrig4ChanShaperFilter : public ORCompoundDataProcessor
 {
   public:
+    enum ETrig4ChanShaperFilterConsts { kNumCards = 32, kNumChannels = 16,
+                                        kClockFrequency = 50000000 };
+
     ORTrig4ChanShaperFilter();
     virtual ~ ORTrig4ChanShaperFilter();
     virtual EReturnCode StartRun();
@@ -25,34 +35,34 @@ class ORTrig4ChanShaperFilter : public ORCompoundDataProcessor
     virtual EReturnCode EndRun();
     virtual EReturnCode EndProcessing();
 
+    //! Minimum time between two hits on a channel, in seconds.
+    virtual void SetTimeCut(Double_t seconds)
+      { fTimeCutTicks = (ULong64_t) (seconds*kClockFrequency + 0.5); }
+
   protected:
-    Double_t fTimeCutLength; 
-    
+    virtual void ClearLastHits();
+
+  protected:
+    ULong64_t fTimeCutTicks;
+
     ORTrig4ChanDecoder fTriggerDecoder;
     ORTrig4ChanTreeWriter* fTriggerTreeWriter;
     UInt_t fTriggerDataId; 
-    size_t fTriggerRecordLength;
-    Double_t fMapTriggerTime;
-    Double_t fThisTriggerTime;
-    UInt_t* fLastTriggerRecordPtr;
-    multimap<Double_t, UInt_t*> fBothRecords;
+    ORRecordHandle fLastTriggerRecord;
+    ULong64_t fLastTriggerClock;
 
-    
+    // clock of the last hit of each card and channel, valid if fHasHit
+    std::vector<ULong64_t> fLastHitClock;
+    std::vector<bool> fHasHit;
     
     ORShaperShaperDecoder fShaperDecoder;
     ORBasicTreeWriter* fShaperTreeWriter;
     UInt_t fShaperDataId; 
-    size_t fShaperRecordLength;
-    UInt_t* fTempShaperRecordPtr;
-    UInt_t fLastChannel;
-    UInt_t fLastCard;
-    UInt_t fThisChannel;
-    UInt_t fThisCard;
  
     OR64PDHistDrawer* f64PDHistDrawer;
     
     UInt_t fLastRecordDataId;
-   UInt_t Reset;
+    UInt_t fNRecordsSinceTrigger;
 };
 
 #endif
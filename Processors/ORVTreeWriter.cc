@@ -4,10 +4,20 @@
 
 #include "TROOT.h"
 #include "ORLogger.hh"
+#include "ORMemoryMonitor.hh"
 #include "ORRunContext.hh"
+#include "ORTreeFillThread.hh"
+#include "ORRunInfoTree.hh"
+#include <map>
 
 using namespace std;
 
+ORVTreeWriter::ERunBranchMode ORVTreeWriter::fgDefaultRunBranchMode = ORVTreeWriter::kRunBranchesInEveryEntry;
+
+// Run-info trees of the trees currently being written, so that all writers
+// of a shared tree find the same one.
+static map<TTree*, ORRunInfoTree*> gRunInfoTrees;
+
 ORVTreeWriter::ORVTreeWriter(ORVDataDecoder* decoder, string treeName) :
 ORDataProcessor(decoder)
 {
@@ -21,6 +31,17 @@ ORDataProcessor(decoder)
   fFillCount = 0;
   fLastProcessedRecordRetCode = kSuccess;
   fSaveOnlyNonemptyTrees = false;  // I would prefer 'true', but this (false) will keep the ancient behaviour -tb- 2008-07-25
+  fRunBranchMode = kDefaultRunBranchMode;
+  fRunInfoTree = NULL;
+}
+
+void ORVTreeWriter::DeleteRunInfoTrees()
+{
+  map<TTree*, ORRunInfoTree*>::iterator runInfo;
+  for (runInfo = gRunInfoTrees.begin(); runInfo != gRunInfoTrees.end(); runInfo++) {
+    delete runInfo->second;
+  }
+  gRunInfoTrees.clear();
 }
 
 ORDataProcessor::EReturnCode ORVTreeWriter::StartRun()
@@ -52,7 +73,7 @@ ORDataProcessor::EReturnCode ORVTreeWriter::ProcessDataRecord(UInt_t* record)
   if (fThisProcessorAutoFillsTree && 
       fFillMethod == kFillBeforeProcessDataRecord &&
       fLastProcessedRecordRetCode == kSuccess) {
-    if (fFillCount > 0 && fFillCount % fFillPeriod == 0) fTree->Fill();
+    if (fFillCount > 0 && fFillCount % fFillPeriod == 0) FillTree();
     fFillCount++;
   }
 
@@ -65,7 +86,7 @@ ORDataProcessor::EReturnCode ORVTreeWriter::ProcessDataRecord(UInt_t* record)
       fFillMethod == kFillAfterProcessDataRecord &&
       fLastProcessedRecordRetCode == kSuccess) {
     fFillCount++;
-    if (fFillCount % fFillPeriod == 0) fTree->Fill();
+    if (fFillCount % fFillPeriod == 0) FillTree();
   }
   return fLastProcessedRecordRetCode;
 }
@@ -85,7 +106,20 @@ ORDataProcessor::EReturnCode ORVTreeWriter::EndRun()
   // be written automatically. A manual write can be performed by
   // overloading this function.
   if (fThisProcessorAutoFillsTree || fUniqueTree) {
-    if (fFillMethod == kFillBeforeProcessDataRecord && fLastProcessedRecordRetCode == kSuccess) fTree->Fill();
+    if (fFillMethod == kFillBeforeProcessDataRecord && fLastProcessedRecordRetCode == kSuccess) FillTree();
+
+    // wait for queued fills and give the branches back before the tree is
+    // looked at or written
+    ORTreeFillThread::Release(fTree);
+    if (fRunInfoTree != NULL) {
+      fRunInfoTree->Finish();
+      TTree* runInfoTree = fRunInfoTree->GetTree();
+      if (!fSaveOnlyNonemptyTrees || fTree->GetEntries() != 0) {
+        runInfoTree->Write(runInfoTree->GetName(), TObject::kOverwrite);
+      }
+      gRunInfoTrees.erase(fTree);
+      delete fRunInfoTree;
+    }
 
     if (fTree->GetEntries() == 0) {
       ORLog(kWarning) << "EndRun(): no entries in fTree " << fTree->GetName() << endl;
@@ -110,6 +144,9 @@ ORDataProcessor::EReturnCode ORVTreeWriter::EndRun()
        fTree->Write(fTree->GetName(), TObject::kOverwrite);
     }
   }
+  // the writer of the tree deletes the shared run info tree above; the
+  // others must not keep a pointer to it
+  fRunInfoTree = NULL;
   return kSuccess;
 }
 
@@ -151,12 +188,61 @@ ORDataProcessor::EReturnCode ORVTreeWriter::InitializeTree()
     }
     // always save the run number, the sub-run number, 
     // and the state of the run
-    fTree->Branch("runNumber", fRunContext->GetPointerToRunNumber(), "runNumber/I");
-    fTree->Branch("subRunNumber", fRunContext->GetPointerToSubRunNumber(), "subRunNumber/I");
-    fTree->Branch("runningState", fRunContext->GetPointerToStringOfState());
+    if (GetRunBranchMode() == kRunBranchesInRunInfoTree) {
+      gRunInfoTrees[fTree] = new ORRunInfoTree(fTree);
+    }
+    else {
+      fTree->Branch("runNumber", fRunContext->GetPointerToRunNumber(), "runNumber/I");
+      fTree->Branch("subRunNumber", fRunContext->GetPointerToSubRunNumber(), "subRunNumber/I");
+      fTree->Branch("runningState", fRunContext->GetPointerToStringOfState());
+    }
   }
+  map<TTree*, ORRunInfoTree*>::iterator runInfo = gRunInfoTrees.find(fTree);
+  fRunInfoTree = (runInfo == gRunInfoTrees.end()) ? NULL : runInfo->second;
+
+  EReturnCode retCode = InitializeBranches();
+  if (retCode >= kAlarm) return retCode;
+
+  // Apply the I/O settings now that all branches of this writer exist. When
+  // several writers share a tree, this is repeated for each one so that the
+  // branches added later get the settings too.
+  ORTreeIOSettings settings = ORIOConfig::GetTreeSettings(fTree->GetName());
+  settings.Merge(fIOSettings);
+  settings.Apply(fTree);
 
-  return InitializeBranches();
+  return retCode;
+}
+
+Int_t ORVTreeWriter::FillTree()
+{
+  if (fRunInfoTree != NULL) fRunInfoTree->Record(fRunContext);
+  if (ORTreeFillThread::IsRunning()) return ORTreeFillThread::Fill(fTree);
+  return fTree->Fill();
+}
+
+size_t ORVTreeWriter::GetMemoryUsage() const
+{
+  size_t nBytes = ORDataProcessor::GetMemoryUsage();
+  if (fTree != NULL && (fThisProcessorAutoFillsTree || fUniqueTree)) {
+    nBytes += ORMemoryMonitor::BasketBytesOf(fTree);
+    if (fRunInfoTree != NULL) nBytes += ORMemoryMonitor::BasketBytesOf(fRunInfoTree->GetTree());
+  }
+  return nBytes;
+}
+
+void ORVTreeWriter::ReduceMemory()
+{
+  if (fTree == NULL || !(fThisProcessorAutoFillsTree || fUniqueTree)) return;
+  // trees that are not in a file (see ORFileWriter) have nowhere to go
+  if (fTree->GetCurrentFile() == NULL) return;
+  fTree->FlushBaskets();
+  if (fRunInfoTree != NULL) fRunInfoTree->GetTree()->FlushBaskets();
+}
+
+ORVTreeWriter::ERunBranchMode ORVTreeWriter::GetRunBranchMode()
+{
+  if (fRunBranchMode == kDefaultRunBranchMode) return fgDefaultRunBranchMode;
+  return fRunBranchMode;
 }
 
 void ORVTreeWriter::SetThisProcessorAutoFillsTree(bool fillTree)
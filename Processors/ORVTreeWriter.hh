@@ -14,12 +14,18 @@ class TTree;
 #ifndef _ORDataProcessor_hh_
 #include "ORDataProcessor.hh"
 #endif
+#ifndef _ORIOConfig_hh_
+#include "ORIOConfig.hh"
+#endif
+
+class ORRunInfoTree;
 
 
 class ORVTreeWriter : public ORDataProcessor
 {
   public:
     enum EFillMethod { kFillAfterProcessDataRecord, kFillBeforeProcessDataRecord };
+    enum ERunBranchMode { kDefaultRunBranchMode, kRunBranchesInEveryEntry, kRunBranchesInRunInfoTree };
 
   public:
     ORVTreeWriter(ORVDataDecoder* decoder, std::string treeName = "");
@@ -77,6 +83,33 @@ class ORVTreeWriter : public ORDataProcessor
     // for compound processors
     virtual void Clear() = 0;
 
+    // I/O settings (compression, basket sizes, AutoFlush, AutoSave) for the
+    // tree of this writer. They are applied on top of the settings that
+    // ORIOConfig has for the tree's name, after the branches have been made.
+    virtual void SetIOSettings(const ORTreeIOSettings& settings) { fIOSettings = settings; }
+    virtual ORTreeIOSettings& GetIOSettings() { return fIOSettings; }
+
+    // By default, the run number, sub-run number and running state are
+    // stored in every entry of the tree (see InitializeTree()). With
+    // kRunBranchesInRunInfoTree, they are instead stored once per range of
+    // entries in a friend tree <treeName>_runInfo; see ORRunInfoTree. The
+    // mode must be set before the tree is made, and applies to all writers
+    // of a shared tree as set by the one that makes it.
+    virtual void SetRunBranchMode(ERunBranchMode mode) { fRunBranchMode = mode; }
+    virtual ERunBranchMode GetRunBranchMode();
+    // Mode used by writers that have kDefaultRunBranchMode.
+    static void SetDefaultRunBranchMode(ERunBranchMode mode) { fgDefaultRunBranchMode = mode; }
+    static ERunBranchMode GetDefaultRunBranchMode() { return fgDefaultRunBranchMode; }
+    // Drops the run-info trees that were not finished by an EndRun(); call
+    // before closing the file that holds their trees.
+    static void DeleteRunInfoTrees();
+
+    // The baskets of the tree in memory are counted by the writer that fills
+    // it. Call only when no fills are queued (see ORTreeFillThread::Sync()).
+    virtual size_t GetMemoryUsage() const;
+    // Writes out the baskets of the tree (TTree::FlushBaskets()).
+    virtual void ReduceMemory();
+
   protected:
     // Turn off auto filling: the derived class will explicitly fill the
     // tree. In this case, the tree must have a unique name. Note that this
@@ -93,10 +126,16 @@ class ORVTreeWriter : public ORDataProcessor
      *  subRunNumber - Integer, number of the current sub run
      *  runningState - string, string representation of the current running
      *  state.  See ORRunContext::EState for a listing of states in the run
+     *
+     *  With kRunBranchesInRunInfoTree, these go to an ORRunInfoTree instead.
      */
     virtual EReturnCode InitializeTree();
     virtual EReturnCode InitializeBranches() = 0;
 
+    // Fills fTree, on the ORTreeFillThread if it is running. Derived classes
+    // that fill their tree manually should call this instead of fTree->Fill().
+    virtual Int_t FillTree();
+
   protected:
     std::string fTreeName;
     TTree* fTree;
@@ -107,6 +146,11 @@ class ORVTreeWriter : public ORDataProcessor
     int fFillCount;
     EReturnCode fLastProcessedRecordRetCode;
     Bool_t fSaveOnlyNonemptyTrees; //!< flag to skip writing empty trees -tb- 2008-07-25
+    ORTreeIOSettings fIOSettings;
+    ERunBranchMode fRunBranchMode;
+    ORRunInfoTree* fRunInfoTree; //! shared by all writers of fTree
+
+    static ERunBranchMode fgDefaultRunBranchMode;
 };
 
 #endif
@@ -40,7 +40,7 @@ ORDataProcessor::EReturnCode ORVXMTreeWriter::ProcessMyDataRecord(UInt_t* record
 	fPositon_in_mm  = fVXMDecoder->GetConvertedPosition(record); // mm
 	fConversion     = fVXMDecoder->GetConversionFactor(record);  //steps/mm
 	
-	fTree->Fill();
+	FillTree();
   
   return kSuccess;
 }
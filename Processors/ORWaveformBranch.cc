@@ -0,0 +1,43 @@
+// ORWaveformBranch.cc
+
+#include "ORWaveformBranch.hh"
+
+#include "TTree.h"
+#include "ORIOConfig.hh"
+#include "ORLogger.hh"
+
+using namespace std;
+
+ORWaveformBranch::ORWaveformBranch(size_t maxSamples) :
+fCodecSetting(-1), fIsEncoding(false), fMaxSamples(maxSamples), fNEncodedBytes(0)
+{
+}
+
+void ORWaveformBranch::Branch(TTree* tree, const string& name, UShort_t* waveform,
+                              const string& lengthLeaf, UShort_t bitResolution)
+{
+  Int_t codec = fCodecSetting;
+  if (codec < 0) codec = ORIOConfig::GetTreeSettings(tree->GetName()).GetWaveformCodec();
+  fIsEncoding = (codec > 0);
+  if (!fIsEncoding) {
+    tree->Branch(name.c_str(), waveform, (name + "[" + lengthLeaf + "]/s").c_str());
+    return;
+  }
+
+  fCodec.SetBitResolution(bitResolution);
+  fCodec.SetPredictor((ORWaveformCodec::EPredictor) codec);
+  fEncoded.resize(ORWaveformCodec::MaxEncodedSize(fMaxSamples));
+  fNEncodedBytes = 0;
+  string lengthName = name + "EncodedLength";
+  tree->Branch(lengthName.c_str(), &fNEncodedBytes, (lengthName + "/i").c_str());
+  tree->Branch((name + "Encoded").c_str(), &fEncoded[0],
+               (name + "Encoded[" + lengthName + "]/b").c_str());
+  ORLog(kDebug) << "Branch(): encoding " << name << " of tree " << tree->GetName() << endl;
+}
+
+void ORWaveformBranch::Encode(const UShort_t* waveform, size_t nSamples)
+{
+  if (!fIsEncoding) return;
+  if (nSamples > fMaxSamples) nSamples = fMaxSamples;
+  fNEncodedBytes = fCodec.Encode(waveform, nSamples, &fEncoded[0]);
+}
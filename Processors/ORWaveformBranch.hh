@@ -0,0 +1,55 @@
+// ORWaveformBranch.hh
+
+#ifndef _ORWaveformBranch_hh_
+#define _ORWaveformBranch_hh_
+
+#include <string>
+#include <vector>
+#include "ORWaveformCodec.hh"
+
+class TTree;
+
+//! Waveform branch of a tree writer, optionally encoded with ORWaveformCodec.
+/*!
+    With the codec off (the default), Branch() makes the usual branch
+    name[lengthLeaf]/s pointing to the writer's waveform array.  With the
+    codec on, it instead makes the branches
+
+    nameEncodedLength - UInt_t, size of the encoded waveform in bytes
+    nameEncoded[nameEncodedLength] - UChar_t, the encoded waveform
+
+    and Encode() must be called after the waveform has been copied and
+    before the tree is filled.  The writer keeps its length branch, so the
+    number of samples is still available without decoding.  Decode with
+    ORWaveformCodec::Decode().
+
+    The codec is selected per writer with SetCodec() or per tree name with
+    ORIOConfig ("tree <pattern> waveformcodec linear").
+ */
+class ORWaveformBranch
+{
+  public:
+    ORWaveformBranch(size_t maxSamples);
+    virtual ~ORWaveformBranch() {}
+
+    //! -1: as configured in ORIOConfig, 0: off, else an ORWaveformCodec::EPredictor.
+    virtual void SetCodec(Int_t codec) { fCodecSetting = codec; }
+
+    //! Makes the waveform branch(es) in tree; call from InitializeBranches().
+    virtual void Branch(TTree* tree, const std::string& name, UShort_t* waveform,
+                        const std::string& lengthLeaf, UShort_t bitResolution);
+    //! Encodes the waveform if the codec is on.
+    virtual void Encode(const UShort_t* waveform, size_t nSamples);
+
+    virtual bool IsEncoding() const { return fIsEncoding; }
+
+  protected:
+    Int_t fCodecSetting;
+    bool fIsEncoding;
+    size_t fMaxSamples;
+    ORWaveformCodec fCodec;
+    std::vector<UChar_t> fEncoded; // fixed size: the tree keeps its address
+    UInt_t fNEncodedBytes;
+};
+
+#endif
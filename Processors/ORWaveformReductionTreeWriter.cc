@@ -0,0 +1,182 @@
+// ORWaveformReductionTreeWriter.cc
+
+#include "ORWaveformReductionTreeWriter.hh"
+
+#include "TTree.h"
+#include "ORDSPFilter.hh"
+#include "ORLogger.hh"
+
+using namespace std;
+
+ORWaveformReductionTreeWriter::ORWaveformReductionTreeWriter(ORVDigitizerDecoder* decoder,
+                                                             string treeName,
+                                                             size_t maxWFLength) :
+ORVTreeWriter(decoder, treeName), fMaxWFLength(maxWFLength), fWaveform(maxWFLength),
+fWaveformBranch(maxWFLength), fRandom(4357)
+{
+  fDigitizerDecoder = decoder;
+  if (treeName == "") fTreeName = "reduced" + decoder->GetDictionaryObjectPath();
+  fPrescale = 0;
+  fUseEnergyWindow = false;
+  fEnergyMin = 0;
+  fEnergyMax = 0;
+  fRandomFraction = 0;
+  fPreTrigger = 0;
+  fPostTrigger = 0;
+  fBaselineSamples = 50;
+  fPileUpWindow = 10;
+  fPolarity = 1;
+  fNEvents = 0;
+  fNSelected = 0;
+  Clear();
+  SetDoNotAutoFillTree();
+}
+
+ORWaveformReductionTreeWriter::~ORWaveformReductionTreeWriter()
+{
+  delete fDigitizerDecoder;
+}
+
+ORDataProcessor::EReturnCode ORWaveformReductionTreeWriter::InitializeBranches()
+{
+  fTree->Branch("crate", &fCrate, "crate/s");
+  fTree->Branch("card", &fCard, "card/s");
+  fTree->Branch("channel", &fChannel, "channel/s");
+  fTree->Branch("eventTime", &fEventTime, "eventTime/l");
+  fTree->Branch("energy", &fEnergy, "energy/i");
+  fTree->Branch("baseline", &fBaseline, "baseline/F");
+  fTree->Branch("baselineRMS", &fBaselineRMS, "baselineRMS/F");
+  fTree->Branch("maximum", &fMaximum, "maximum/F");
+  fTree->Branch("maxSample", &fMaxSample, "maxSample/i");
+  fTree->Branch("riseTime", &fRiseTime, "riseTime/F");
+  fTree->Branch("integral", &fIntegral, "integral/F");
+  fTree->Branch("pileUp", &fPileUp, "pileUp/O");
+  fTree->Branch("selection", &fSelection, "selection/b");
+  fTree->Branch("wfFullLength", &fWFFullLength, "wfFullLength/i");
+  fTree->Branch("wfFirstSample", &fWFFirstSample, "wfFirstSample/i");
+  fTree->Branch("wfLength", &fWFLength, "wfLength/i");
+  fWaveformBranch.Branch(fTree, "waveform", &fWaveform[0], "wfLength", 16);
+  return kSuccess;
+}
+
+ORDataProcessor::EReturnCode ORWaveformReductionTreeWriter::StartRun()
+{
+  fNEvents = 0;
+  fNSelected = 0;
+  return ORVTreeWriter::StartRun();
+}
+
+ORDataProcessor::EReturnCode ORWaveformReductionTreeWriter::ProcessMyDataRecord(UInt_t* record)
+{
+  if (!fDigitizerDecoder->SetDataRecord(record)) return kFailure;
+  fCrate = fDigitizerDecoder->CrateOf();
+  fCard = fDigitizerDecoder->CardOf();
+  for (size_t iEvent = 0; iEvent < fDigitizerDecoder->GetNumberOfEvents(); iEvent++) {
+    fChannel = fDigitizerDecoder->GetEventChannel(iEvent);
+    fEventTime = fDigitizerDecoder->GetEventTime(iEvent);
+    fEnergy = fDigitizerDecoder->GetEventEnergy(iEvent);
+    fNEvents++;
+
+    ORWaveformView view = fDigitizerDecoder->GetWaveformView(iEvent);
+    size_t n = view.GetLength();
+    fWFFullLength = n;
+    fWFFirstSample = 0;
+    fWFLength = 0;
+    fSelection = 0;
+    // no waveform unless selected, also not the last selected one
+    fWaveformBranch.Encode(&fWaveform[0], 0);
+    if (view.IsEmpty()) {
+      fBaseline = 0; fBaselineRMS = 0; fMaximum = 0; fMaxSample = 0;
+      fRiseTime = 0; fIntegral = 0; fPileUp = false;
+      FillTree();
+      continue;
+    }
+    fSamples.resize(n);
+    view.CopyTo(&fSamples[0], n);
+    ComputeFeatures(n);
+
+    fSelection = Select(fEnergy);
+    if (fSelection != 0) {
+      fNSelected++;
+      size_t first = 0;
+      size_t last = n;
+      if (fPreTrigger + fPostTrigger > 0) {
+        Float_t t10 = ORDSPFilter::Crossing(&fSamples[0], fMaxSample+1, 0.1*fMaximum);
+        size_t trigger = (t10 < 0) ? fMaxSample : (size_t) t10;
+        first = (trigger > fPreTrigger) ? trigger - fPreTrigger : 0;
+        last = trigger + fPostTrigger;
+        if (last > n) last = n;
+      }
+      if (last - first > fMaxWFLength) {
+        ORLog(kWarning) << "ProcessMyDataRecord(): keeping " << fMaxWFLength << " of "
+                        << last - first << " samples" << endl;
+        last = first + fMaxWFLength;
+      }
+      fRawSamples.resize(n);
+      view.CopyTo(&fRawSamples[0], n);
+      for (size_t i = first; i < last; i++) fWaveform[i-first] = (UShort_t) fRawSamples[i];
+      fWFFirstSample = first;
+      fWFLength = last - first;
+      fWaveformBranch.Encode(&fWaveform[0], fWFLength);
+    }
+    FillTree();
+  }
+  return kSuccess;
+}
+
+void ORWaveformReductionTreeWriter::ComputeFeatures(size_t n)
+{
+  Float_t* x = &fSamples[0];
+  size_t nBaseline = (fBaselineSamples < n) ? fBaselineSamples : n;
+  fBaseline = ORDSPFilter::Mean(x, nBaseline);
+  fBaselineRMS = ORDSPFilter::RMS(x, nBaseline, fBaseline);
+  // baseline-subtracted, positive pulses from here on
+  Double_t integral = 0;
+  for (size_t i = 0; i < n; i++) {
+    x[i] = fPolarity*(x[i] - fBaseline);
+    integral += x[i];
+  }
+  fIntegral = integral;
+  fMaxSample = ORDSPFilter::ArgMax(x, n);
+  fMaximum = x[fMaxSample];
+  fRiseTime = 0;
+  if (fMaximum > 0) {
+    Float_t t10 = ORDSPFilter::Crossing(x, fMaxSample+1, 0.1*fMaximum);
+    Float_t t90 = ORDSPFilter::Crossing(x, fMaxSample+1, 0.9*fMaximum);
+    if (t10 >= 0 && t90 >= t10) fRiseTime = t90 - t10;
+  }
+  fPileUp = (CountEdges(x, n, fPileUpWindow) > 1);
+}
+
+UInt_t ORWaveformReductionTreeWriter::CountEdges(const Float_t* x, size_t n, UInt_t window)
+{
+  // Rising edges of steps and pulses alike are peaks of x[i] - x[i-window].
+  // An edge counts when the difference rises above half of its maximum,
+  // and the next one only after it has fallen below a quarter.
+  if (window == 0 || n <= window) return 0;
+  Float_t maxDiff = 0;
+  for (size_t i = window; i < n; i++) {
+    Float_t diff = x[i] - x[i-window];
+    if (diff > maxDiff) maxDiff = diff;
+  }
+  if (maxDiff <= 0) return 0;
+  UInt_t nEdges = 0;
+  bool armed = true;
+  for (size_t i = window; i < n; i++) {
+    Float_t diff = x[i] - x[i-window];
+    if (armed && diff > 0.5*maxDiff) { nEdges++; armed = false; }
+    else if (!armed && diff < 0.25*maxDiff) armed = true;
+  }
+  return nEdges;
+}
+
+UChar_t ORWaveformReductionTreeWriter::Select(UInt_t energy)
+{
+  UChar_t selection = 0;
+  if (fPrescale > 0 && fNEvents % fPrescale == 0) selection |= kPrescaled;
+  if (fUseEnergyWindow && energy >= fEnergyMin && energy <= fEnergyMax) {
+    selection |= kInEnergyWindow;
+  }
+  if (fRandomFraction > 0 && fRandom.Rndm() < fRandomFraction) selection |= kRandom;
+  return selection;
+}
@@ -0,0 +1,118 @@
+// ORWaveformReductionTreeWriter.hh
+
+#ifndef _ORWaveformReductionTreeWriter_hh_
+#define _ORWaveformReductionTreeWriter_hh_
+
+#include <string>
+#include <vector>
+#include "TRandom3.h"
+#include "ORVTreeWriter.hh"
+#include "ORVDigitizerDecoder.hh"
+#include "ORWaveformBranch.hh"
+
+//! Writes waveform features for all events and waveforms for selected ones.
+/*!
+    Reduces the data of any ORVDigitizerDecoder: every event gets the cheap
+    features
+
+    crate, card, channel - UShort_t
+    eventTime - ULong64_t; energy - UInt_t, as reported by the decoder
+    baseline, baselineRMS - Float_t, over the first SetBaselineSamples()
+    maximum - Float_t, above the baseline; maxSample - UInt_t
+    riseTime - Float_t, 10-90% of the maximum, in samples
+    integral - Float_t, sum of all samples above the baseline
+    pileUp - Bool_t, more than one rising edge, see SetPileUpWindow()
+    selection - UChar_t, why the waveform was kept: kPrescaled | kInEnergyWindow | kRandom
+
+    but the waveform (wfFullLength/i, wfFirstSample/i, wfLength/i and
+    waveform[wfLength]/s) only when selected, otherwise wfLength is 0.
+    An event is selected if it is one of every SetPrescale() events, if the
+    decoder energy is in SetEnergyWindow(), or at random with
+    SetRandomFraction(); all are off by default.  With
+    SetRegionOfInterest(), only the samples around the 10% crossing are
+    kept.  Samples are stored as raw 16 bits (two's complement for signed
+    digitizers), optionally encoded with GetWaveformBranch().
+
+    The pulses are taken to be positive; SetNegativePulses() inverts them
+    for the features.
+ */
+class ORWaveformReductionTreeWriter : public ORVTreeWriter
+{
+  public:
+    enum ESelection { kPrescaled = 0x1, kInEnergyWindow = 0x2, kRandom = 0x4 };
+
+    ORWaveformReductionTreeWriter(ORVDigitizerDecoder* decoder, std::string treeName = "",
+                                  size_t maxWFLength = 0x10000);
+    virtual ~ORWaveformReductionTreeWriter();
+
+    virtual EReturnCode StartRun();
+    virtual EReturnCode ProcessMyDataRecord(UInt_t* record);
+    virtual inline void Clear()
+      { fCrate = 0; fCard = 0; fChannel = 0; fEventTime = 0; fEnergy = 0;
+        fBaseline = 0; fBaselineRMS = 0; fMaximum = 0; fMaxSample = 0; fRiseTime = 0;
+        fIntegral = 0; fPileUp = false; fSelection = 0;
+        fWFFullLength = 0; fWFFirstSample = 0; fWFLength = 0; }
+
+    //! Keeps the waveform of every nEvents-th event; 0 for none.
+    virtual void SetPrescale(UInt_t nEvents) { fPrescale = nEvents; }
+    //! Keeps waveforms with min <= decoder energy <= max.
+    virtual void SetEnergyWindow(Double_t min, Double_t max)
+      { fEnergyMin = min; fEnergyMax = max; fUseEnergyWindow = true; }
+    virtual void ClearEnergyWindow() { fUseEnergyWindow = false; }
+    //! Keeps a random fraction of the waveforms, e.g. for unbiased samples.
+    virtual void SetRandomFraction(Double_t fraction, UInt_t seed = 4357)
+      { fRandomFraction = fraction; fRandom.SetSeed(seed); }
+    //! Keeps only preTrigger samples before and postTrigger after the trigger; 0, 0 for all.
+    virtual void SetRegionOfInterest(UInt_t preTrigger, UInt_t postTrigger)
+      { fPreTrigger = preTrigger; fPostTrigger = postTrigger; }
+
+    virtual void SetBaselineSamples(UInt_t nSamples) { fBaselineSamples = nSamples; }
+    //! Rising edges are found in the difference over nSamples samples.
+    virtual void SetPileUpWindow(UInt_t nSamples) { fPileUpWindow = nSamples; }
+    virtual void SetNegativePulses(bool negative = true) { fPolarity = negative ? -1 : 1; }
+
+    //! Selects plain or encoded (ORWaveformCodec) storage of the waveforms.
+    virtual ORWaveformBranch& GetWaveformBranch() { return fWaveformBranch; }
+
+    virtual size_t GetNEvents() const { return fNEvents; }
+    virtual size_t GetNSelected() const { return fNSelected; }
+
+  protected:
+    virtual EReturnCode InitializeBranches();
+    //! Fills the feature branches from the baseline-subtracted fSamples.
+    virtual void ComputeFeatures(size_t n);
+    virtual UChar_t Select(UInt_t energy);
+    //! Counts separated rising edges in x.
+    static UInt_t CountEdges(const Float_t* x, size_t n, UInt_t window);
+
+  protected:
+    ORVDigitizerDecoder* fDigitizerDecoder;
+    size_t fMaxWFLength;
+    std::vector<Float_t> fSamples;
+    std::vector<Short_t> fRawSamples;
+    std::vector<UShort_t> fWaveform; // fixed size: the tree keeps its address
+    ORWaveformBranch fWaveformBranch;
+    TRandom3 fRandom;
+
+    UInt_t fPrescale;
+    bool fUseEnergyWindow;
+    Double_t fEnergyMin, fEnergyMax;
+    Double_t fRandomFraction;
+    UInt_t fPreTrigger, fPostTrigger;
+    UInt_t fBaselineSamples;
+    UInt_t fPileUpWindow;
+    Int_t fPolarity;
+    size_t fNEvents, fNSelected;
+
+    UShort_t fCrate, fCard, fChannel;
+    ULong64_t fEventTime;
+    UInt_t fEnergy;
+    Float_t fBaseline, fBaselineRMS, fMaximum;
+    UInt_t fMaxSample;
+    Float_t fRiseTime, fIntegral;
+    Bool_t fPileUp;
+    UChar_t fSelection;
+    UInt_t fWFFullLength, fWFFirstSample, fWFLength;
+};
+
+#endif
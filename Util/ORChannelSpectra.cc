@@ -0,0 +1,82 @@
+// ORChannelSpectra.cc
+
+#include "ORChannelSpectra.hh"
+
+#include <cstring>
+
+using namespace std;
+
+ORChannelSpectra::ORChannelSpectra(size_t nBins, UInt_t shift) :
+fSpectra(GetMaxIndex(), (UInt_t*) NULL), fNBins(nBins), fShift(shift), fAtomic(false),
+fNOutOfRange(0)
+{
+}
+
+ORChannelSpectra::~ORChannelSpectra()
+{
+  FreeSpectra();
+}
+
+void ORChannelSpectra::FreeSpectra()
+{
+  for (size_t i=0; i<fSpectra.size(); i++) {
+    delete [] fSpectra[i];
+    fSpectra[i] = NULL;
+  }
+}
+
+void ORChannelSpectra::SetBinning(size_t nBins, UInt_t shift)
+{
+  FreeSpectra();
+  fNBins = nBins;
+  fShift = shift;
+}
+
+UInt_t* ORChannelSpectra::Allocate(size_t index)
+{
+  UInt_t* spectrum = new UInt_t[fNBins+1];
+  memset(spectrum, 0, (fNBins+1)*sizeof(UInt_t));
+  if (!fAtomic) {
+    fSpectra[index] = spectrum;
+    return spectrum;
+  }
+  // another thread may have allocated the channel in the meantime
+  if (!__sync_bool_compare_and_swap(&fSpectra[index], (UInt_t*) NULL, spectrum)) {
+    delete [] spectrum;
+  }
+  return fSpectra[index];
+}
+
+bool ORChannelSpectra::Add(UInt_t crate, UInt_t card, UInt_t channel, UInt_t value)
+{
+  if (crate >= kMaxCrates || card >= kMaxCards || channel >= kMaxChannels) {
+    if (fAtomic) __sync_add_and_fetch(&fNOutOfRange, 1);
+    else fNOutOfRange++;
+    return false;
+  }
+  size_t index = IndexOf(crate, card, channel);
+  UInt_t* spectrum = fSpectra[index];
+  if (spectrum == NULL) spectrum = Allocate(index);
+  size_t bin = value >> fShift;
+  if (bin > fNBins) bin = fNBins;
+  if (fAtomic) __sync_add_and_fetch(&spectrum[bin], 1);
+  else spectrum[bin]++;
+  return true;
+}
+
+size_t ORChannelSpectra::GetBytesAllocated() const
+{
+  size_t nBytes = fSpectra.capacity()*sizeof(UInt_t*);
+  for (size_t i=0; i<fSpectra.size(); i++) {
+    if (fSpectra[i] != NULL) nBytes += (fNBins+1)*sizeof(UInt_t);
+  }
+  return nBytes;
+}
+
+void ORChannelSpectra::Reset()
+{
+  for (size_t i=0; i<fSpectra.size(); i++) {
+    if (fSpectra[i] != NULL) memset(fSpectra[i], 0, (fNBins+1)*sizeof(UInt_t));
+  }
+  fNOutOfRange = 0;
+}
@@ -0,0 +1,71 @@
+// ORChannelSpectra.hh
+
+#ifndef _ORChannelSpectra_hh_
+#define _ORChannelSpectra_hh_
+
+#include <cstddef>
+#include <vector>
+#ifndef ROOT_Rtypes
+#include "Rtypes.h"
+#endif
+
+//! Integer spectra for every crate/card/channel, e.g. of energies.
+/*!
+    Each channel has a flat array of GetNBins() counters, allocated on its
+    first entry, plus an overflow counter at index GetNBins().  A value v
+    goes to bin v >> GetShift().
+
+    With SetAtomic(), Add() updates the counters (and allocates the arrays)
+    with atomic operations, so that several threads can fill the same
+    spectra without a lock.  Reading the counters while they are being
+    filled gives a consistent count per bin, but not across bins.
+ */
+class ORChannelSpectra
+{
+  public:
+    enum EChannelSpectraConsts { kMaxCrates = 16, kMaxCards = 32, kMaxChannels = 64 };
+
+    ORChannelSpectra(size_t nBins = 0x10000, UInt_t shift = 0);
+    virtual ~ORChannelSpectra();
+
+    //! Counts value in the spectrum of crate, card, channel; false if out of range.
+    virtual bool Add(UInt_t crate, UInt_t card, UInt_t channel, UInt_t value);
+
+    //! Frees the spectra and changes the binning.
+    virtual void SetBinning(size_t nBins, UInt_t shift = 0);
+    virtual size_t GetNBins() const { return fNBins; }
+    virtual UInt_t GetShift() const { return fShift; }
+    virtual void SetAtomic(bool atomic = true) { fAtomic = atomic; }
+    virtual bool IsAtomic() const { return fAtomic; }
+
+    //! Zeroes all counters, keeping the arrays.
+    virtual void Reset();
+
+    //! Channels are numbered by index, from 0 to GetMaxIndex()-1.
+    static size_t GetMaxIndex() { return kMaxCrates*kMaxCards*kMaxChannels; }
+    static size_t IndexOf(UInt_t crate, UInt_t card, UInt_t channel)
+      { return (crate*kMaxCards + card)*kMaxChannels + channel; }
+    static UInt_t CrateOf(size_t index) { return index/(kMaxCards*kMaxChannels); }
+    static UInt_t CardOf(size_t index) { return (index/kMaxChannels) % kMaxCards; }
+    static UInt_t ChannelOf(size_t index) { return index % kMaxChannels; }
+
+    //! The GetNBins()+1 counters of a channel, or NULL if it had no entries.
+    virtual const UInt_t* GetSpectrum(size_t index) const { return fSpectra[index]; }
+    //! Entries of crates, cards or channels above the maxima.
+    virtual UInt_t GetNOutOfRange() const { return fNOutOfRange; }
+    //! Bytes of the counters and the table of channels.
+    virtual size_t GetBytesAllocated() const;
+
+  protected:
+    virtual UInt_t* Allocate(size_t index);
+    virtual void FreeSpectra();
+
+  protected:
+    std::vector<UInt_t*> fSpectra; // by index
+    size_t fNBins;
+    UInt_t fShift;
+    bool fAtomic;
+    UInt_t fNOutOfRange;
+};
+
+#endif
@@ -0,0 +1,235 @@
+// ORDSPFilter.cc
+
+#include "ORDSPFilter.hh"
+
+#include <cmath>
+#include <cstdlib>
+
+using namespace std;
+
+static const char* kParameterNames[ORDSPFilter::kNParameters] = {
+  "rise", "flattop", "window", "decay", "shaping", "order",
+  "baseline", "fraction", "gain", "offset"
+};
+
+ORDSPFilter::ORDSPFilter(EFilterType type)
+{
+  fType = type;
+  fParameters[kRiseTime] = 100;
+  fParameters[kFlatTop] = 50;
+  fParameters[kWindow] = 150;
+  fParameters[kDecayTime] = 0;
+  fParameters[kShapingTime] = 10;
+  fParameters[kOrder] = 4;
+  fParameters[kBaselineSamples] = 100;
+  fParameters[kTriggerFraction] = 0.5;
+  fParameters[kGain] = 1;
+  fParameters[kOffset] = 0;
+}
+
+bool ORDSPFilter::ParseParameterName(const string& name, EParameter& parameter)
+{
+  for (int i=0; i<kNParameters; i++) {
+    if (name == kParameterNames[i]) {
+      parameter = (EParameter) i;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool ORDSPFilter::IsValidParameter(EParameter parameter, Double_t value)
+{
+  switch (parameter) {
+    case kTriggerFraction: case kGain: case kOffset: return true;
+    default: return value >= 0;
+  }
+}
+
+bool ORDSPFilter::SetParameter(const string& name, const string& value)
+{
+  if (name == "type") {
+    if (value == "trapezoidal") fType = kTrapezoidal;
+    else if (value == "mwd") fType = kMWD;
+    else if (value == "crrcn") fType = kCRRCn;
+    else return false;
+    return true;
+  }
+  EParameter parameter;
+  if (!ParseParameterName(name, parameter)) return false;
+  char* end = NULL;
+  Double_t number = strtod(value.c_str(), &end);
+  if (end == value.c_str() || *end != '\0') return false;
+  if (!IsValidParameter(parameter, number)) return false;
+  fParameters[parameter] = number;
+  return true;
+}
+
+bool ORDSPFilter::Process(const Float_t* waveform, size_t n, ORDSPResult& result)
+{
+  result.Clear();
+  if (n == 0) return false;
+  fBuffer.resize(n);
+  fStep.resize(n);
+  fOutput.resize(n);
+
+  size_t nBaseline = (size_t) fParameters[kBaselineSamples];
+  if (nBaseline > n) nBaseline = n;
+  result.fBaseline = Mean(waveform, nBaseline);
+  result.fBaselineRMS = RMS(waveform, nBaseline, result.fBaseline);
+  Subtract(waveform, n, result.fBaseline, &fBuffer[0]);
+  Deconvolve(&fBuffer[0], n, fParameters[kDecayTime], &fStep[0]);
+
+  switch (fType) {
+    case kTrapezoidal:
+      Trapezoid(&fStep[0], n, (UInt_t) fParameters[kRiseTime], (UInt_t) fParameters[kFlatTop],
+                &fOutput[0]);
+      break;
+    case kMWD:
+      MovingWindowDeconvolution(&fStep[0], n, (UInt_t) fParameters[kWindow],
+                                (UInt_t) fParameters[kRiseTime], &fOutput[0]);
+      break;
+    case kCRRCn:
+      CRRCn(&fStep[0], n, fParameters[kShapingTime], (UInt_t) fParameters[kOrder], &fOutput[0]);
+      break;
+  }
+
+  result.fPeakSample = ArgMax(&fOutput[0], n);
+  result.fAmplitude = fOutput[result.fPeakSample];
+  result.fEnergy = fParameters[kGain]*result.fAmplitude + fParameters[kOffset];
+  size_t stepMax = ArgMax(&fStep[0], n);
+  result.fT0 = Crossing(&fStep[0], stepMax+1, fParameters[kTriggerFraction]*fStep[stepMax]);
+  return true;
+}
+
+Double_t ORDSPFilter::Mean(const Float_t* x, size_t n)
+{
+  if (n == 0) return 0;
+  Double_t sum = 0;
+  for (size_t i=0; i<n; i++) sum += x[i];
+  return sum/n;
+}
+
+Double_t ORDSPFilter::RMS(const Float_t* x, size_t n, Double_t mean)
+{
+  if (n == 0) return 0;
+  Double_t sum2 = 0;
+  for (size_t i=0; i<n; i++) sum2 += (x[i] - mean)*(x[i] - mean);
+  return sqrt(sum2/n);
+}
+
+void ORDSPFilter::Subtract(const Float_t* x, size_t n, Float_t offset, Float_t* out)
+{
+  for (size_t i=0; i<n; i++) out[i] = x[i] - offset;
+}
+
+void ORDSPFilter::Deconvolve(const Float_t* x, size_t n, Double_t tau, Float_t* out)
+{
+  if (tau <= 0) {
+    for (size_t i=0; i<n; i++) out[i] = x[i];
+    return;
+  }
+  // For x[i] = A a^i, x[i] + (1-a) sum_{j<i} x[j] = A.
+  const Double_t c = 1. - exp(-1./tau);
+  Double_t sum = 0;
+  for (size_t i=0; i<n; i++) {
+    out[i] = x[i] + c*sum;
+    sum += x[i];
+  }
+}
+
+// out[i] += sign*x[i-delay] for delay <= i < n, i.e. samples before the
+// start count as 0.  No branch in the loop, so that it vectorizes.
+static inline void ORDSPFilterAddDelayed(const Float_t* x, size_t n, size_t delay,
+                                         Float_t sign, Float_t* out)
+{
+  for (size_t i=delay; i<n; i++) out[i] += sign*x[i-delay];
+}
+
+// out[i] = norm*(sum of x[j] for j <= i), in place.
+static inline void ORDSPFilterRunningSum(Float_t* x, size_t n, Double_t norm)
+{
+  Double_t sum = 0;
+  for (size_t i=0; i<n; i++) {
+    sum += x[i];
+    x[i] = norm*sum;
+  }
+}
+
+void ORDSPFilter::Trapezoid(const Float_t* step, size_t n, UInt_t rise, UInt_t flatTop, Float_t* out)
+{
+  if (rise == 0) rise = 1;
+  const size_t k = rise, l = flatTop;
+  // running (mean of the last k samples) - (mean of the k samples before the gap)
+  for (size_t i=0; i<n; i++) out[i] = step[i];
+  ORDSPFilterAddDelayed(step, n, k, -1, out);
+  ORDSPFilterAddDelayed(step, n, k+l, -1, out);
+  ORDSPFilterAddDelayed(step, n, 2*k+l, 1, out);
+  ORDSPFilterRunningSum(out, n, 1./rise);
+}
+
+void ORDSPFilter::MovingWindowDeconvolution(const Float_t* step, size_t n, UInt_t window,
+                                            UInt_t average, Float_t* out)
+{
+  if (average == 0) average = 1;
+  const size_t m = window, l = average;
+  // running mean over l samples of step[i] - step[i-m]
+  for (size_t i=0; i<n; i++) out[i] = step[i];
+  ORDSPFilterAddDelayed(step, n, m, -1, out);
+  ORDSPFilterAddDelayed(step, n, l, -1, out);
+  ORDSPFilterAddDelayed(step, n, l+m, 1, out);
+  ORDSPFilterRunningSum(out, n, 1./average);
+}
+
+void ORDSPFilter::CRRCn(const Float_t* step, size_t n, Double_t tau, UInt_t order, Float_t* out)
+{
+  if (n == 0) return;
+  if (tau <= 0) tau = 1;
+  const Double_t a = exp(-1./tau);
+
+  // peak of the response to a unit step, for the normalization
+  vector<Double_t> rc(order + 1, 0.);
+  Double_t peak = 0, previousIn = 0;
+  size_t nUnit = (size_t) (tau*(order + 10)) + 1;
+  for (size_t i=0; i<nUnit; i++) {
+    rc[0] = a*(rc[0] + 1. - previousIn);
+    previousIn = 1.;
+    for (UInt_t j=1; j<=order; j++) rc[j] = a*rc[j] + (1. - a)*rc[j-1];
+    if (rc[order] > peak) peak = rc[order];
+  }
+  const Double_t norm = (peak > 0) ? 1./peak : 1.;
+
+  // CR, then order passes of RC
+  Double_t cr = 0;
+  previousIn = 0;
+  for (size_t i=0; i<n; i++) {
+    cr = a*(cr + step[i] - previousIn);
+    previousIn = step[i];
+    out[i] = cr;
+  }
+  for (UInt_t j=0; j<order; j++) {
+    Double_t filtered = 0;
+    for (size_t i=0; i<n; i++) {
+      filtered = a*filtered + (1. - a)*out[i];
+      out[i] = filtered;
+    }
+  }
+  for (size_t i=0; i<n; i++) out[i] *= norm;
+}
+
+size_t ORDSPFilter::ArgMax(const Float_t* x, size_t n)
+{
+  size_t iMax = 0;
+  for (size_t i=1; i<n; i++) if (x[i] > x[iMax]) iMax = i;
+  return iMax;
+}
+
+Float_t ORDSPFilter::Crossing(const Float_t* x, size_t n, Float_t threshold)
+{
+  for (size_t i=1; i<n; i++) {
+    if (x[i-1] < threshold && x[i] >= threshold) {
+      return (i-1) + (threshold - x[i-1])/(x[i] - x[i-1]);
+    }
+  }
+  return -1;
+}
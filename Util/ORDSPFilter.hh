@@ -0,0 +1,121 @@
+// ORDSPFilter.hh
+
+#ifndef _ORDSPFilter_hh_
+#define _ORDSPFilter_hh_
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#ifndef ROOT_Rtypes
+#include "Rtypes.h"
+#endif
+
+//! Results of ORDSPFilter::Process() for one waveform.
+class ORDSPResult
+{
+  public:
+    ORDSPResult() { Clear(); }
+    void Clear() { fBaseline = 0; fBaselineRMS = 0; fAmplitude = 0; fEnergy = 0;
+                   fT0 = -1; fPeakSample = 0; }
+
+    Float_t fBaseline;    // mean of the baseline samples
+    Float_t fBaselineRMS; // their RMS
+    Float_t fAmplitude;   // maximum of the filter output
+    Float_t fEnergy;      // gain*fAmplitude + offset
+    Float_t fT0;          // interpolated sample at which the pulse crosses the trigger fraction, -1 if none
+    UInt_t fPeakSample;   // sample of the filter maximum
+};
+
+//! Digital shaping filters for pulse-height (energy) estimation.
+/*!
+    Process() subtracts the baseline (mean of the first SetBaselineSamples()
+    samples), corrects the pole-zero of the preamplifier decay
+    (SetDecayTime(); 0 for no correction), i.e. turns exponential pulses
+    into steps, and applies one of
+
+    kTrapezoidal - trapezoid with SetRiseTime() and SetFlatTop()
+    kMWD - moving window deconvolution: the difference over SetWindow()
+           samples, averaged over SetRiseTime() samples
+    kCRRCn - CR-RC^n with SetShapingTime() and SetOrder()
+
+    The filters are normalized so that the amplitude of a step of height A
+    is A.  Times are in samples.  The energy is gain*amplitude + offset
+    (SetCalibration()).  t0 is where the pulse first crosses
+    SetTriggerFraction() of its maximum, interpolated between samples.
+
+    The filters are O(n) per waveform, using running sums.  The trapezoid
+    and MWD first add up the delayed samples in branch-free loops over
+    contiguous arrays, which the compiler can vectorize; the running sums
+    themselves and the recursive CR-RC^n stages depend on the previous
+    sample and stay scalar.  The static kernels may be used on their own.
+
+    Parameters can be set by name (SetParameter()), as done by the
+    configuration files of ORDSPFilterTreeWriter:
+    type (trapezoidal, mwd, crrcn), rise, flattop, window, decay, shaping,
+    order, baseline, fraction, gain, offset.  The sample counts, times and
+    the order may not be negative.
+ */
+class ORDSPFilter
+{
+  public:
+    enum EFilterType { kTrapezoidal, kMWD, kCRRCn };
+    enum EParameter { kRiseTime, kFlatTop, kWindow, kDecayTime, kShapingTime, kOrder,
+                      kBaselineSamples, kTriggerFraction, kGain, kOffset, kNParameters };
+
+    ORDSPFilter(EFilterType type = kTrapezoidal);
+    virtual ~ORDSPFilter() {}
+
+    virtual void SetType(EFilterType type) { fType = type; }
+    virtual EFilterType GetType() const { return fType; }
+    virtual void SetRiseTime(UInt_t nSamples) { fParameters[kRiseTime] = nSamples; }
+    virtual void SetFlatTop(UInt_t nSamples) { fParameters[kFlatTop] = nSamples; }
+    virtual void SetWindow(UInt_t nSamples) { fParameters[kWindow] = nSamples; }
+    virtual void SetDecayTime(Double_t nSamples) { fParameters[kDecayTime] = nSamples; }
+    virtual void SetShapingTime(Double_t nSamples) { fParameters[kShapingTime] = nSamples; }
+    virtual void SetOrder(UInt_t order) { fParameters[kOrder] = order; }
+    virtual void SetBaselineSamples(UInt_t nSamples) { fParameters[kBaselineSamples] = nSamples; }
+    virtual void SetTriggerFraction(Double_t fraction) { fParameters[kTriggerFraction] = fraction; }
+    virtual void SetCalibration(Double_t gain, Double_t offset)
+      { fParameters[kGain] = gain; fParameters[kOffset] = offset; }
+
+    virtual void SetParameter(EParameter parameter, Double_t value) { fParameters[parameter] = value; }
+    virtual Double_t GetParameter(EParameter parameter) const { return fParameters[parameter]; }
+    //! Sets a parameter by its configuration name; returns false if unknown or invalid.
+    virtual bool SetParameter(const std::string& name, const std::string& value);
+    static bool ParseParameterName(const std::string& name, EParameter& parameter);
+    //! False for negative sample counts, times and orders.
+    static bool IsValidParameter(EParameter parameter, Double_t value);
+
+    //! Filters waveform and fills result.  Returns false if the waveform is empty.
+    virtual bool Process(const Float_t* waveform, size_t n, ORDSPResult& result);
+    //! Filter output of the last Process().
+    virtual const std::vector<Float_t>& GetOutput() const { return fOutput; }
+
+    // kernels
+    static Double_t Mean(const Float_t* x, size_t n);
+    static Double_t RMS(const Float_t* x, size_t n, Double_t mean);
+    //! out = x - offset.  out may be x.
+    static void Subtract(const Float_t* x, size_t n, Float_t offset, Float_t* out);
+    //! Turns exponential pulses of decay time tau into steps.  out may not be x.
+    static void Deconvolve(const Float_t* x, size_t n, Double_t tau, Float_t* out);
+    //! Trapezoid of a step; samples before the start count as 0.  out may not be step.
+    static void Trapezoid(const Float_t* step, size_t n, UInt_t rise, UInt_t flatTop, Float_t* out);
+    //! Difference over window samples, averaged over average samples.  out may not be step.
+    static void MovingWindowDeconvolution(const Float_t* step, size_t n, UInt_t window,
+                                          UInt_t average, Float_t* out);
+    //! CR-RC^order of a step, normalized to its peak.
+    static void CRRCn(const Float_t* step, size_t n, Double_t tau, UInt_t order, Float_t* out);
+    //! Index of the maximum.
+    static size_t ArgMax(const Float_t* x, size_t n);
+    //! First crossing of threshold, interpolated; -1 if none.
+    static Float_t Crossing(const Float_t* x, size_t n, Float_t threshold);
+
+  protected:
+    EFilterType fType;
+    Double_t fParameters[kNParameters];
+    std::vector<Float_t> fBuffer; // baseline-subtracted waveform
+    std::vector<Float_t> fStep;   // after pole-zero correction
+    std::vector<Float_t> fOutput;
+};
+
+#endif
@@ -103,6 +103,26 @@ const ORVDictValue* ORDictionary::LookUp(std::string key, char delimiter) const
   }
 }
 
+size_t ORDictionary::GetMemoryUsage() const
+{
+  // map nodes hold three pointers and a color besides the key and value
+  size_t nBytes = sizeof(ORDictionary) + fName.capacity();
+  DictMap::const_iterator dictIter;
+  for (dictIter = fDictMap.begin(); dictIter != fDictMap.end(); dictIter++) {
+    nBytes += 4*sizeof(void*) + sizeof(DictMap::value_type) + dictIter->first.capacity();
+    nBytes += dictIter->second->GetMemoryUsage();
+  }
+  return nBytes;
+}
+
+size_t ORDictValueA::GetMemoryUsage() const
+{
+  size_t nBytes = sizeof(ORDictValueA) + fName.capacity() +
+                  fDictVals.capacity()*sizeof(ORVDictValue*);
+  for (size_t i=0; i<fDictVals.size(); i++) nBytes += fDictVals[i]->GetMemoryUsage();
+  return nBytes;
+}
+
 std::string ORDictValueA::GetStringOfValue() const
 {
   std::string o("{");
@@ -38,6 +38,9 @@ class ORVDictValue
 
     //! overload this for dict, array
     virtual size_t GetNValues() const { return 1; } 
+
+    //! Approximate bytes of memory held by the value (and its contents).
+    virtual size_t GetMemoryUsage() const { return sizeof(ORVDictValue) + sizeof(double); }
 };
 
 //! True dictionary class
@@ -64,6 +67,7 @@ class ORDictionary : public ORVDictValue
     virtual void SetName(std::string name) { fName = name; }
     virtual std::string GetStringOfValue() const {return "";}
     virtual size_t GetNValues() const {return fDictMap.size();}
+    virtual size_t GetMemoryUsage() const;
     
     // The following functions are useful for iterating over the contents of
     // the dictionary:
@@ -88,6 +92,7 @@ class ORDictValueS : public ORVDictValue
     virtual void SetS(std::string s) { fS = s; };
     virtual const std::string& GetS() const { return fS; }
     virtual std::string GetStringOfValue() const {return fS;}
+    virtual size_t GetMemoryUsage() const { return sizeof(ORDictValueS) + fS.capacity(); }
 
   protected:
     std::string fS;
@@ -162,6 +167,7 @@ class ORDictValueA : public ORVDictValue
     virtual void SetName(std::string name) { fName = name; }
     virtual std::string GetStringOfValue() const;
     virtual size_t GetNValues() const { return fDictVals.size(); }
+    virtual size_t GetMemoryUsage() const;
     virtual const ORVDictValue* At(int i) const { return fDictVals[i]; }
     virtual ORVDictValue* At(int i) { return fDictVals[i]; }
 
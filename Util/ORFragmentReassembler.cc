@@ -0,0 +1,175 @@
+// ORFragmentReassembler.cc
+
+#include "ORFragmentReassembler.hh"
+
+#include <cstring>
+#include "ORLogger.hh"
+
+using namespace std;
+
+ORFragmentReassembler::ORFragmentReassembler(size_t maxChannels, size_t maxLength) :
+fMaxChannels(maxChannels), fMaxLength(maxLength), fTimeout(4096), fFragmentCount(0),
+fSlots(kMaxCrates*kMaxCards*maxChannels, (ORFragmentSlot*) NULL),
+fNCompleted(0), fNTimedOut(0), fNErrors(0)
+{
+}
+
+ORFragmentReassembler::~ORFragmentReassembler()
+{
+  for (size_t i=0; i<fSlots.size(); i++) delete fSlots[i];
+}
+
+ORFragmentReassembler::ORFragmentSlot* ORFragmentReassembler::GetSlot(UInt_t crate, UInt_t card,
+                                                                      UInt_t channel, bool create)
+{
+  if (crate >= kMaxCrates || card >= kMaxCards || channel >= fMaxChannels) return NULL;
+  size_t index = (crate*kMaxCards + card)*fMaxChannels + channel;
+  if (fSlots[index] == NULL && create) fSlots[index] = new ORFragmentSlot;
+  return fSlots[index];
+}
+
+const ORFragmentReassembler::ORFragmentSlot* ORFragmentReassembler::FindSlot(UInt_t crate,
+                                                                             UInt_t card,
+                                                                             UInt_t channel) const
+{
+  if (crate >= kMaxCrates || card >= kMaxCards || channel >= fMaxChannels) return NULL;
+  return fSlots[(crate*kMaxCards + card)*fMaxChannels + channel];
+}
+
+void ORFragmentReassembler::ExpireStaleSlots()
+{
+  size_t nActive = 0;
+  for (size_t i=0; i<fActiveSlots.size(); i++) {
+    ORFragmentSlot* slot = fSlots[fActiveSlots[i]];
+    if (!slot->IsPartial()) continue;
+    if (fTimeout > 0 && fFragmentCount - slot->fLastFragment > fTimeout) {
+      ORLog(kDebug) << "ExpireStaleSlots(): dropping trace with " << slot->fFilledLength
+                    << " of " << slot->fExpectedLength << " words" << endl;
+      slot->fFilledLength = 0;
+      slot->fExpectedLength = 0;
+      fNTimedOut++;
+      continue;
+    }
+    fActiveSlots[nActive++] = fActiveSlots[i];
+  }
+  fActiveSlots.resize(nActive);
+}
+
+ORFragmentReassembler::EStatus ORFragmentReassembler::AddFragment(UInt_t crate, UInt_t card,
+                                                                  UInt_t channel, size_t totalLength,
+                                                                  const UInt_t* fragment,
+                                                                  size_t fragmentLength)
+{
+  fFragmentCount++;
+  if (!fActiveSlots.empty()) ExpireStaleSlots();
+
+  ORFragmentSlot* slot = GetSlot(crate, card, channel, true);
+  if (slot == NULL) {
+    ORLog(kWarning) << "AddFragment(): crate " << crate << ", card " << card
+                    << ", channel " << channel << " out of range" << endl;
+    fNErrors++;
+    return kError;
+  }
+  if (totalLength == 0 || totalLength > fMaxLength) {
+    ORLog(kWarning) << "AddFragment(): total length " << totalLength << " words is not in (0, "
+                    << fMaxLength << "]; dropping the trace" << endl;
+    slot->fFilledLength = 0;
+    slot->fExpectedLength = 0;
+    fNErrors++;
+    return kError;
+  }
+
+  // start a new trace after a complete one or if the length changed
+  if (slot->IsComplete() || slot->fExpectedLength != totalLength) {
+    if (slot->IsPartial()) {
+      ORLog(kDebug) << "AddFragment(): dropping incomplete trace with " << slot->fFilledLength
+                    << " of " << slot->fExpectedLength << " words" << endl;
+      fNErrors++;
+    }
+    slot->fFilledLength = 0;
+    slot->fExpectedLength = totalLength;
+    if (slot->fBuffer.size() < totalLength) slot->fBuffer.resize(totalLength);
+  }
+
+  if (slot->fFilledLength + fragmentLength > slot->fExpectedLength) {
+    ORLog(kWarning) << "AddFragment(): fragment of " << fragmentLength << " words overruns the "
+                    << slot->fExpectedLength << "-word trace of crate " << crate << ", card "
+                    << card << ", channel " << channel << "; dropping the trace" << endl;
+    slot->fFilledLength = 0;
+    slot->fExpectedLength = 0;
+    fNErrors++;
+    return kError;
+  }
+
+  bool wasIdle = (slot->fFilledLength == 0);
+  if (fragmentLength > 0) {
+    memcpy(&slot->fBuffer[slot->fFilledLength], fragment, fragmentLength*sizeof(UInt_t));
+  }
+  slot->fFilledLength += fragmentLength;
+  slot->fLastFragment = fFragmentCount;
+  if (slot->IsComplete()) {
+    fNCompleted++;
+    return kComplete;
+  }
+  if (wasIdle && slot->fFilledLength > 0) {
+    fActiveSlots.push_back((crate*kMaxCards + card)*fMaxChannels + channel);
+  }
+  return kIncomplete;
+}
+
+const UInt_t* ORFragmentReassembler::GetData(UInt_t crate, UInt_t card, UInt_t channel) const
+{
+  const ORFragmentSlot* slot = FindSlot(crate, card, channel);
+  if (slot == NULL || !slot->IsComplete()) return NULL;
+  return &slot->fBuffer[0];
+}
+
+size_t ORFragmentReassembler::GetFilledLength(UInt_t crate, UInt_t card, UInt_t channel) const
+{
+  const ORFragmentSlot* slot = FindSlot(crate, card, channel);
+  return (slot == NULL) ? 0 : slot->fFilledLength;
+}
+
+void ORFragmentReassembler::Clear()
+{
+  for (size_t i=0; i<fSlots.size(); i++) {
+    if (fSlots[i] == NULL) continue;
+    fSlots[i]->fFilledLength = 0;
+    fSlots[i]->fExpectedLength = 0;
+  }
+  fActiveSlots.clear();
+}
+
+void ORFragmentReassembler::ReleaseMemory()
+{
+  for (size_t i=0; i<fSlots.size(); i++) {
+    delete fSlots[i];
+    fSlots[i] = NULL;
+  }
+  fActiveSlots.clear();
+}
+
+void ORFragmentReassembler::ReleaseIdleMemory()
+{
+  for (size_t i=0; i<fSlots.size(); i++) {
+    if (fSlots[i] == NULL || fSlots[i]->IsPartial()) continue;
+    delete fSlots[i];
+    fSlots[i] = NULL;
+  }
+}
+
+size_t ORFragmentReassembler::GetBytesAllocated() const
+{
+  size_t nBytes = 0;
+  for (size_t i=0; i<fSlots.size(); i++) {
+    if (fSlots[i] != NULL) nBytes += fSlots[i]->fBuffer.capacity()*sizeof(UInt_t);
+  }
+  return nBytes;
+}
+
+void ORFragmentReassembler::ReportStatistics() const
+{
+  ORLog(kRoutine) << "ReportStatistics(): " << fNCompleted << " traces reassembled, "
+                  << fNTimedOut << " timed out, " << fNErrors << " dropped on errors, "
+                  << GetBytesAllocated() << " bytes in buffers" << endl;
+}
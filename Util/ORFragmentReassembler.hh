@@ -0,0 +1,103 @@
+// ORFragmentReassembler.hh
+
+#ifndef _ORFragmentReassembler_hh_
+#define _ORFragmentReassembler_hh_
+
+#include <cstddef>
+#include <vector>
+#ifndef ROOT_Rtypes
+#include "Rtypes.h"
+#endif
+
+//! Reassembles data (e.g. long waveforms) split across several records.
+/*!
+    Digitizers that read out traces longer than a record can hold send them
+    in consecutive fragments, each record carrying the total length.  This
+    class collects the fragments of each crate/card/channel in a buffer
+    that is sized from the total length on the first fragment and then
+    reused, so steady running does not allocate.
+
+    - A fragment that would overrun the announced length, or a total length
+      above the maximum set in the constructor, drops the partial data
+      (kError).
+    - A partial trace that has not received a fragment for more than
+      SetTimeout() calls to AddFragment() (on any channel) is considered
+      lost and dropped, so a missing fragment cannot hold up or corrupt the
+      following traces.  The timeout is counted in fragments rather than
+      wall time, so replays of files behave as the online run did.
+    - ReleaseMemory() frees the buffers, e.g. at the end of a run, and
+      ReleaseIdleMemory() those not holding a partial trace, e.g. when
+      the process is over its memory budget.
+
+    Not thread-safe; each decoder owns its own reassembler.
+ */
+class ORFragmentReassembler
+{
+  public:
+    enum EStatus { kIncomplete, kComplete, kError };
+    enum EFragmentReassemblerConsts { kMaxCrates = 16, kMaxCards = 32 };
+
+    //! maxLength is the largest accepted total length in 32-bit words.
+    ORFragmentReassembler(size_t maxChannels = 16, size_t maxLength = 0x400000);
+    virtual ~ORFragmentReassembler();
+
+    //! Adds fragmentLength words of a trace of totalLength words.
+    /*!
+        Returns kComplete when the trace is complete, after which GetData()
+        returns it until the next fragment for the same channel.
+     */
+    virtual EStatus AddFragment(UInt_t crate, UInt_t card, UInt_t channel, size_t totalLength,
+                                const UInt_t* fragment, size_t fragmentLength);
+
+    //! The completed trace of a channel, or NULL if it is not complete.
+    virtual const UInt_t* GetData(UInt_t crate, UInt_t card, UInt_t channel) const;
+
+    //! Number of words collected so far for a channel.
+    virtual size_t GetFilledLength(UInt_t crate, UInt_t card, UInt_t channel) const;
+
+    //! Partial traces older than nFragments fragments are dropped; 0 disables.
+    virtual void SetTimeout(UInt_t nFragments) { fTimeout = nFragments; }
+    virtual UInt_t GetTimeout() const { return fTimeout; }
+
+    //! Drops all partial traces.
+    virtual void Clear();
+    //! Drops all partial traces and frees the buffers.
+    virtual void ReleaseMemory();
+    //! Frees the buffers of the channels without a partial trace.
+    virtual void ReleaseIdleMemory();
+
+    virtual size_t GetNCompleted() const { return fNCompleted; }
+    virtual size_t GetNTimedOut() const { return fNTimedOut; }
+    virtual size_t GetNErrors() const { return fNErrors; }
+    //! Bytes held in reassembly buffers.
+    virtual size_t GetBytesAllocated() const;
+    virtual void ReportStatistics() const;
+
+  protected:
+    struct ORFragmentSlot {
+      std::vector<UInt_t> fBuffer;
+      size_t fExpectedLength;
+      size_t fFilledLength;
+      UInt_t fLastFragment;
+      ORFragmentSlot() : fExpectedLength(0), fFilledLength(0), fLastFragment(0) {}
+      bool IsPartial() const { return fFilledLength > 0 && fFilledLength < fExpectedLength; }
+      bool IsComplete() const { return fExpectedLength > 0 && fFilledLength == fExpectedLength; }
+    };
+
+    virtual ORFragmentSlot* GetSlot(UInt_t crate, UInt_t card, UInt_t channel, bool create);
+    virtual const ORFragmentSlot* FindSlot(UInt_t crate, UInt_t card, UInt_t channel) const;
+    virtual void ExpireStaleSlots();
+
+  protected:
+    size_t fMaxChannels;
+    size_t fMaxLength;
+    UInt_t fTimeout;
+    UInt_t fFragmentCount;
+    std::vector<ORFragmentSlot*> fSlots;
+    std::vector<size_t> fActiveSlots;
+    size_t fNCompleted;
+    size_t fNTimedOut;
+    size_t fNErrors;
+};
+
+#endif
@@ -0,0 +1,187 @@
+// ORRecordPool.cc
+
+#include "ORRecordPool.hh"
+
+#include <cstring>
+#include <string>
+#include "TString.h"
+#include "ORLogger.hh"
+
+static std::string ORRecordPoolFormatBytes(size_t nBytes)
+{
+  if(nBytes < 1024) return ::Form("%d B", (int) nBytes);
+  else if(nBytes < 1024*1024) return ::Form("%.1f kB", double(nBytes)/1024.0);
+  return ::Form("%.1f MB", double(nBytes)/1024.0/1024.0);
+}
+
+ORRecordHandle::ORRecordHandle(const ORRecordHandle& other) : fBlock(other.fBlock)
+{
+  if (fBlock) __sync_add_and_fetch(&fBlock->fRefCount, 1);
+}
+
+ORRecordHandle& ORRecordHandle::operator=(const ORRecordHandle& other)
+{
+  if (fBlock == other.fBlock) return *this;
+  // take the new reference before dropping the old one
+  if (other.fBlock) __sync_add_and_fetch(&other.fBlock->fRefCount, 1);
+  Reset();
+  fBlock = other.fBlock;
+  return *this;
+}
+
+void ORRecordHandle::Reset()
+{
+  if (fBlock == NULL) return;
+  ORRecordBlock* block = fBlock;
+  fBlock = NULL;
+  if (__sync_sub_and_fetch(&block->fRefCount, 1) == 0) block->fPool->Release(block);
+}
+
+int ORRecordHandle::GetRefCount() const
+{
+  if (fBlock == NULL) return 0;
+  return __sync_add_and_fetch(&fBlock->fRefCount, 0);
+}
+
+ORRecordPool::ORRecordPool(size_t maxBytes) :
+fMaxBytes(maxBytes), fBytesAllocated(0), fBytesInUse(0), fPeakBytes(0),
+fNAcquired(0), fNReused(0), fNRefused(0)
+{
+  for (int i=0; i<kNumSizeClasses; i++) fFreeLists[i] = NULL;
+}
+
+ORRecordPool::~ORRecordPool()
+{
+  Trim();
+  if (fBytesInUse > 0) {
+    ORLog(kError) << "~ORRecordPool(): " << ORRecordPoolFormatBytes(fBytesInUse)
+                  << " of records are still referenced; "
+                  << "handles must not outlive their pool!" << std::endl;
+  }
+}
+
+int ORRecordPool::SizeClassOf(size_t nLongs)
+{
+  int sizeClass = 0;
+  while (CapacityOf(sizeClass) < nLongs) {
+    sizeClass++;
+    if (sizeClass >= kNumSizeClasses) return -1;
+  }
+  return sizeClass;
+}
+
+ORRecordHandle ORRecordPool::Acquire(size_t nLongs)
+{
+  if (nLongs == 0) nLongs = 1;
+  int sizeClass = SizeClassOf(nLongs);
+  size_t capacity = (sizeClass < 0) ? nLongs : CapacityOf(sizeClass);
+  size_t nBytes = capacity*sizeof(UInt_t);
+
+  ORRecordBlock* block = NULL;
+  fLock.writeLock();
+  fNAcquired++;
+  if (sizeClass >= 0 && fFreeLists[sizeClass] != NULL) {
+    block = fFreeLists[sizeClass];
+    fFreeLists[sizeClass] = block->fNext;
+    fNReused++;
+  }
+  else {
+    if (fMaxBytes > 0 && fBytesAllocated + nBytes > fMaxBytes) {
+      FreeCachedBlocks(fBytesAllocated + nBytes - fMaxBytes);
+    }
+    if (fMaxBytes > 0 && fBytesAllocated + nBytes > fMaxBytes) {
+      fNRefused++;
+      bool firstRefusal = (fNRefused == 1);
+      fLock.unlock();
+      if (firstRefusal) {
+        ORLog(kWarning) << "Acquire(): request for " << ORRecordPoolFormatBytes(nBytes)
+                        << " would exceed the limit of "
+                        << ORRecordPoolFormatBytes(fMaxBytes) << std::endl;
+      }
+      return ORRecordHandle();
+    }
+    block = new ORRecordBlock;
+    block->fData = new UInt_t[capacity];
+    block->fCapacity = capacity;
+    block->fSizeClass = sizeClass;
+    block->fPool = this;
+    fBytesAllocated += nBytes;
+    if (fBytesAllocated > fPeakBytes) fPeakBytes = fBytesAllocated;
+  }
+  block->fRefCount = 1;
+  block->fNext = NULL;
+  fBytesInUse += nBytes;
+  fLock.unlock();
+  return ORRecordHandle(block);
+}
+
+ORRecordHandle ORRecordPool::Copy(const UInt_t* record, size_t nLongs)
+{
+  ORRecordHandle handle = Acquire(nLongs);
+  if (handle.IsValid()) memcpy(handle.GetData(), record, nLongs*sizeof(UInt_t));
+  return handle;
+}
+
+void ORRecordPool::Release(ORRecordBlock* block)
+{
+  size_t nBytes = block->fCapacity*sizeof(UInt_t);
+  fLock.writeLock();
+  fBytesInUse -= nBytes;
+  if (block->fSizeClass < 0) {
+    fBytesAllocated -= nBytes;
+    delete [] block->fData;
+    delete block;
+  }
+  else {
+    block->fNext = fFreeLists[block->fSizeClass];
+    fFreeLists[block->fSizeClass] = block;
+  }
+  fLock.unlock();
+}
+
+size_t ORRecordPool::FreeCachedBlocks(size_t nBytesNeeded)
+{
+  // Must be called with fLock held.  Frees the largest blocks first.
+  size_t nBytesFreed = 0;
+  for (int i=kNumSizeClasses-1; i>=0 && nBytesFreed < nBytesNeeded; i--) {
+    while (fFreeLists[i] != NULL && nBytesFreed < nBytesNeeded) {
+      ORRecordBlock* block = fFreeLists[i];
+      fFreeLists[i] = block->fNext;
+      nBytesFreed += block->fCapacity*sizeof(UInt_t);
+      delete [] block->fData;
+      delete block;
+    }
+  }
+  fBytesAllocated -= nBytesFreed;
+  return nBytesFreed;
+}
+
+void ORRecordPool::Trim()
+{
+  fLock.writeLock();
+  FreeCachedBlocks(fBytesAllocated);
+  fLock.unlock();
+}
+
+void ORRecordPool::ResetStatistics()
+{
+  fLock.writeLock();
+  fPeakBytes = fBytesAllocated;
+  fNAcquired = 0;
+  fNReused = 0;
+  fNRefused = 0;
+  fLock.unlock();
+}
+
+void ORRecordPool::ReportStatistics(const char* label)
+{
+  fLock.readLock();
+  std::string limit = (fMaxBytes > 0) ? ORRecordPoolFormatBytes(fMaxBytes) : "none";
+  double reuse = (fNAcquired > 0) ? 100.0*double(fNReused)/double(fNAcquired) : 0.0;
+  std::string refused = (fNRefused > 0) ?
+    ::Form(", %llu requests refused", (unsigned long long) fNRefused) : "";
+  ORLog(kRoutine) << label << ": peak " << ORRecordPoolFormatBytes(fPeakBytes)
+                  << " (limit: " << limit << "), " << fNAcquired << " records, "
+                  << ::Form("%.1f", reuse) << "% buffers reused" << refused << std::endl;
+  fLock.unlock();
+}
@@ -0,0 +1,148 @@
+// ORRecordPool.hh
+
+#ifndef _ORRecordPool_hh_
+#define _ORRecordPool_hh_
+
+#include <cstddef>
+#ifndef ROOT_Rtypes
+#include "Rtypes.h"
+#endif
+#ifndef _ORReadWriteLock_hh
+#include "ORReadWriteLock.hh"
+#endif
+
+class ORRecordPool;
+
+//! Storage block handed out by ORRecordPool.
+/*!
+    Users never deal with this directly; it is accessed through an
+    ORRecordHandle which takes care of the reference counting.
+ */
+class ORRecordBlock
+{
+  public:
+    UInt_t* fData;          //!
+    size_t fCapacity;       //! capacity in 32-bit words
+    int fSizeClass;         //! -1 for oversized (uncached) blocks
+    int fRefCount;          //! modified atomically
+    ORRecordPool* fPool;    //!
+    ORRecordBlock* fNext;   //! link in the pool's free list
+};
+
+//! Reference-counted handle to a record held in an ORRecordPool.
+/*!
+    Copying a handle shares the underlying record, it does not copy the
+    data.  The record is returned to its pool when the last handle referring
+    to it is reset or destroyed.  Handles may be copied and released from
+    different threads.
+ */
+class ORRecordHandle
+{
+  public:
+    ORRecordHandle() : fBlock(NULL) {}
+    ORRecordHandle(const ORRecordHandle& other);
+    ~ORRecordHandle() { Reset(); }
+    ORRecordHandle& operator=(const ORRecordHandle& other);
+
+    //! Drops this reference, returning the record to the pool if it was the last one.
+    void Reset();
+
+    bool IsValid() const { return fBlock != NULL; }
+    UInt_t* GetData() const { return (fBlock) ? fBlock->fData : NULL; }
+    //! Capacity of the record buffer in 32-bit words.
+    size_t GetCapacity() const { return (fBlock) ? fBlock->fCapacity : 0; }
+    //! Number of handles currently sharing this record.
+    int GetRefCount() const;
+    UInt_t& operator[](size_t i) const { return fBlock->fData[i]; }
+
+    friend class ORRecordPool;
+
+  protected:
+    explicit ORRecordHandle(ORRecordBlock* block) : fBlock(block) {}
+    ORRecordBlock* fBlock; //!
+};
+
+//! Slab pool for record buffers.
+/*!
+    ORRecordPool hands out record buffers in power-of-two size classes,
+    from 2^kMinClassShift up to 2^kMaxClassShift 32-bit words (the largest
+    long record ORCA can write).  Released buffers are kept on a free list
+    per size class and reused, so long waveform records do not go back to
+    the heap for every record.  Requests larger than the largest size class
+    (i.e. headers) are allocated exactly and freed on release.
+
+    The total memory held by the pool (in use and cached) can be capped with
+    SetMaxBytes().  When an Acquire() would exceed the cap, cached buffers are
+    freed first; if that is not sufficient, an invalid handle is returned.
+    Usage statistics, including the peak memory, are available and can be
+    logged with ReportStatistics().
+
+    All member functions are thread-safe.
+ */
+class ORRecordPool
+{
+  public:
+    enum ERecordPoolConsts { kMinClassShift = 6,
+                             kMaxClassShift = 18,
+                             kNumSizeClasses = kMaxClassShift - kMinClassShift + 1 };
+
+    //! maxBytes == 0 means no limit.
+    ORRecordPool(size_t maxBytes = 0);
+    virtual ~ORRecordPool();
+
+    //! Returns a handle to a buffer of at least nLongs 32-bit words.
+    /*!
+        The contents of the buffer are undefined.  Returns an invalid handle
+        if the memory limit would be exceeded.
+     */
+    virtual ORRecordHandle Acquire(size_t nLongs);
+
+    //! Acquire() a buffer and copy nLongs words of record into it.
+    virtual ORRecordHandle Copy(const UInt_t* record, size_t nLongs);
+
+    virtual void SetMaxBytes(size_t maxBytes) { fMaxBytes = maxBytes; }
+    virtual size_t GetMaxBytes() const { return fMaxBytes; }
+
+    //! Frees all cached (unused) buffers.
+    virtual void Trim();
+
+    size_t GetBytesAllocated() const { return fBytesAllocated; }
+    size_t GetBytesInUse() const { return fBytesInUse; }
+    size_t GetPeakBytes() const { return fPeakBytes; }
+    ULong64_t GetNAcquired() const { return fNAcquired; }
+    ULong64_t GetNReused() const { return fNReused; }
+    ULong64_t GetNRefused() const { return fNRefused; }
+
+    //! Resets the counters; the peak is set to the current allocation.
+    virtual void ResetStatistics();
+    //! Logs the usage statistics at the routine level.
+    virtual void ReportStatistics(const char* label = "ORRecordPool");
+
+    //! Returns the size class for nLongs, or -1 if too large to be cached.
+    static int SizeClassOf(size_t nLongs);
+    static size_t CapacityOf(int sizeClass)
+      { return ((size_t) 1) << (sizeClass + kMinClassShift); }
+
+    friend class ORRecordHandle;
+
+  protected:
+    virtual void Release(ORRecordBlock* block);
+    virtual size_t FreeCachedBlocks(size_t nBytesNeeded);
+
+  private:
+    ORRecordPool(const ORRecordPool&);
+    ORRecordPool& operator=(const ORRecordPool&);
+
+  protected:
+    ORRecordBlock* fFreeLists[kNumSizeClasses]; //!
+    size_t fMaxBytes;
+    size_t fBytesAllocated;
+    size_t fBytesInUse;
+    size_t fPeakBytes;
+    ULong64_t fNAcquired;
+    ULong64_t fNReused;
+    ULong64_t fNRefused;
+    ORReadWriteLock fLock; //!
+};
+
+#endif
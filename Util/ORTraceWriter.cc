@@ -0,0 +1,155 @@
+// ORTraceWriter.cc
+
+#include "ORTraceWriter.hh"
+
+#include <pthread.h>
+#include <cstdio>
+#include <map>
+#include "ORLogger.hh"
+#include "ORUtils.hh"
+
+using namespace std;
+
+namespace {
+
+pthread_mutex_t gTraceMutex = PTHREAD_MUTEX_INITIALIZER;
+FILE* gTraceFile = NULL;        // guarded by gTraceMutex
+bool gFirstEvent = true;
+map<pthread_t, int> gThreadIds;     // of the open file
+map<pthread_t, string> gThreadNames; // kept across files
+ULong64_t gNRecords = 0;        // only touched by the processing thread
+bool gRecordSampled = false;
+
+// Read by every thread without the mutex, so only accessed through Load()
+// and Store(), which are atomic and full barriers.
+UInt_t gTraceIsOpen = 0;
+UInt_t gSampling = 1;
+
+inline UInt_t Load(UInt_t& value)
+{
+  return __sync_add_and_fetch(&value, 0);
+}
+
+inline void Store(UInt_t& value, UInt_t newValue)
+{
+  __sync_synchronize();
+  __sync_lock_test_and_set(&value, newValue);
+  __sync_synchronize();
+}
+
+// Must be called with the mutex held.
+void StartEvent()
+{
+  fprintf(gTraceFile, gFirstEvent ? "\n" : ",\n");
+  gFirstEvent = false;
+}
+
+// Must be called with the mutex held and the file open.
+void WriteThreadName(int id, const string& name)
+{
+  StartEvent();
+  fprintf(gTraceFile, "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": %d, "
+          "\"args\": {\"name\": \"%s\"}}", id, ORUtils::JSONEscape(name).c_str());
+}
+
+// Must be called with the mutex held and the file open.
+int ThreadId()
+{
+  pthread_t self = pthread_self();
+  map<pthread_t, int>::iterator iter = gThreadIds.find(self);
+  if (iter != gThreadIds.end()) return iter->second;
+  int id = gThreadIds.size() + 1;
+  gThreadIds[self] = id;
+  map<pthread_t, string>::iterator name = gThreadNames.find(self);
+  if (name != gThreadNames.end()) WriteThreadName(id, name->second);
+  return id;
+}
+
+}
+
+bool ORTraceWriter::Open(const string& fileName, UInt_t sampling)
+{
+  Close();
+  pthread_mutex_lock(&gTraceMutex);
+  gTraceFile = fopen(fileName.c_str(), "w");
+  if (gTraceFile == NULL) {
+    pthread_mutex_unlock(&gTraceMutex);
+    ORLog(kError) << "Open(): could not open " << fileName << endl;
+    return false;
+  }
+  fprintf(gTraceFile, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [");
+  gFirstEvent = true;
+  gThreadIds.clear();
+  pthread_mutex_unlock(&gTraceMutex);
+  SetSampling(sampling);
+  Store(gTraceIsOpen, 1);
+  return true;
+}
+
+void ORTraceWriter::Close()
+{
+  pthread_mutex_lock(&gTraceMutex);
+  if (gTraceFile != NULL) {
+    fprintf(gTraceFile, "\n]}\n");
+    fclose(gTraceFile);
+    gTraceFile = NULL;
+  }
+  Store(gTraceIsOpen, 0);
+  gRecordSampled = false;
+  pthread_mutex_unlock(&gTraceMutex);
+}
+
+bool ORTraceWriter::IsOpen()
+{
+  return Load(gTraceIsOpen) != 0;
+}
+
+void ORTraceWriter::SetSampling(UInt_t sampling)
+{
+  Store(gSampling, (sampling > 0) ? sampling : 1);
+}
+
+bool ORTraceWriter::NextRecord()
+{
+  gRecordSampled = IsOpen() && (gNRecords++ % Load(gSampling) == 0);
+  return gRecordSampled;
+}
+
+bool ORTraceWriter::Sample(ULong64_t& counter)
+{
+  return counter++ % Load(gSampling) == 0;
+}
+
+bool ORTraceWriter::IsRecordSampled()
+{
+  return gRecordSampled;
+}
+
+Double_t ORTraceWriter::Now()
+{
+  return ORUtils::MonotonicSeconds()*1e6;
+}
+
+void ORTraceWriter::AddSpan(const string& name, const char* category, Double_t start)
+{
+  Double_t end = Now();
+  pthread_mutex_lock(&gTraceMutex);
+  if (gTraceFile != NULL) {
+    int id = ThreadId(); // may write the thread's name first
+    StartEvent();
+    fprintf(gTraceFile, "{\"name\": \"%s\", \"cat\": \"%s\", \"ph\": \"X\", \"ts\": %.3f, "
+            "\"dur\": %.3f, \"pid\": 1, \"tid\": %d}", ORUtils::JSONEscape(name).c_str(), category,
+            start, end - start, id);
+  }
+  pthread_mutex_unlock(&gTraceMutex);
+}
+
+void ORTraceWriter::SetThreadName(const string& name)
+{
+  pthread_mutex_lock(&gTraceMutex);
+  pthread_t self = pthread_self();
+  gThreadNames[self] = name;
+  map<pthread_t, int>::iterator iter = gThreadIds.find(self);
+  if (gTraceFile != NULL && iter != gThreadIds.end()) WriteThreadName(iter->second, name);
+  pthread_mutex_unlock(&gTraceMutex);
+}
@@ -0,0 +1,80 @@
+// ORTraceWriter.hh
+
+#ifndef _ORTraceWriter_hh_
+#define _ORTraceWriter_hh_
+
+#include <string>
+#ifndef ROOT_Rtypes
+#include "Rtypes.h"
+#endif
+
+//! Writes a timeline of the processing in the Chrome trace-event format.
+/*!
+    When a trace file is open, the stages of the processing are recorded as
+    spans ("complete" events) with the thread that ran them:
+
+    reader - ReadRecord() and the socket reader's waits for data
+    header - loading the header and setting up the data ids
+    processor - StartRun(), ProcessDataRecord() and EndRun() of every
+                component of a compound processor, named by class and index
+    io - TTree fills on the fill thread, tree writes, file closes and
+         header writes at sub-run transitions
+
+    Per-record spans (reading, processing, tree fills) are only recorded for
+    one record in SetSampling() records, chosen by ORDataProcManager via
+    NextRecord(), so that the file stays small and the overhead low; all
+    other spans are always recorded.  The file can be loaded in
+    chrome://tracing or https://ui.perfetto.dev:
+    \verbatim
+    ORTraceWriter::Open("run.trace.json", 1000);
+    ...
+    ORTraceWriter::Close();
+    \endverbatim
+    All functions are thread-safe.
+ */
+class ORTraceWriter
+{
+  public:
+    //! Opens fileName; records per-record spans for one in sampling records.
+    static bool Open(const std::string& fileName, UInt_t sampling = 1);
+    static void Close();
+    static bool IsOpen();
+    static void SetSampling(UInt_t sampling);
+
+    //! Decides whether the next record is traced; called by the manager for each record.
+    static bool NextRecord();
+    static bool IsRecordSampled();
+    //! For other threads' per-record spans: true once every sampling calls with counter.
+    static bool Sample(ULong64_t& counter);
+
+    //! Microseconds on a monotonic clock.
+    static Double_t Now();
+    //! Records a span that started at start (from Now()) and ends now.
+    static void AddSpan(const std::string& name, const char* category, Double_t start);
+    //! Names the calling thread in the timeline; may be called before Open().
+    static void SetThreadName(const std::string& name);
+};
+
+//! Records a span from construction to destruction if tracing is on.
+/*!
+    \verbatim
+    { ORTraceSpan span("TFile::Close", "io"); file->Close(); }
+    \endverbatim
+    With sampled = true, the span is only recorded for sampled records.
+ */
+class ORTraceSpan
+{
+  public:
+    ORTraceSpan(const char* name, const char* category, bool sampled = false) :
+      fName(name), fCategory(category), fStart(-1)
+      { if (sampled ? ORTraceWriter::IsRecordSampled() : ORTraceWriter::IsOpen())
+          fStart = ORTraceWriter::Now(); }
+    ~ORTraceSpan() { if (fStart >= 0) ORTraceWriter::AddSpan(fName, fCategory, fStart); }
+
+  protected:
+    const char* fName;
+    const char* fCategory;
+    Double_t fStart;
+};
+
+#endif
@@ -0,0 +1,24 @@
+// ORUtils.cc
+
+#include "ORUtils.hh"
+
+#include <ctime>
+
+using namespace std;
+
+Double_t ORUtils::MonotonicSeconds()
+{
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec + 1e-9*now.tv_nsec;
+}
+
+string ORUtils::JSONEscape(const string& text)
+{
+  string escaped;
+  for (size_t i=0; i<text.size(); i++) {
+    if (text[i] == '"' || text[i] == '\\') escaped += '\\';
+    escaped += text[i];
+  }
+  return escaped;
+}
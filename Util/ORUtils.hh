@@ -3,6 +3,7 @@
 #ifndef _ORUtils_hh_
 #define _ORUtils_hh_
 
+#include <string>
 #ifndef ROOT_TROOT
 #include "TROOT.h"
 #endif
@@ -52,6 +53,11 @@ namespace ORUtils
                (((ULong64_t)(hi)) << 32));  
     }
 
+    //! Wall-clock time in seconds on a monotonic clock, for intervals.
+    Double_t MonotonicSeconds();
+
+    //! Escapes quotes and backslashes for a JSON string.
+    std::string JSONEscape(const std::string& text);
 
 };
 
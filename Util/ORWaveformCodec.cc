@@ -0,0 +1,199 @@
+// ORWaveformCodec.cc
+
+#include "ORWaveformCodec.hh"
+
+#include "ORLogger.hh"
+
+// Block header: bit width of the packed values, with kRawBlock set if the
+// block holds the samples themselves rather than prediction residuals.
+static const UChar_t kRawBlock = 0x80;
+static const UChar_t kWidthMask = 0x3f;
+
+static inline int ORWaveformCodecBitsNeeded(UInt_t value)
+{
+  int nBits = 0;
+  while (value != 0) { nBits++; value >>= 1; }
+  return nBits;
+}
+
+// Packs n values of width bits each, LSB first.  Written as a plain loop
+// over a 64-bit accumulator so that the compiler can unroll/vectorize it.
+static inline size_t ORWaveformCodecPack(const UInt_t* values, size_t n, int width, UChar_t* out)
+{
+  if (width == 0) return 0;
+  UChar_t* start = out;
+  ULong64_t accumulator = 0;
+  int nBits = 0;
+  for (size_t i=0; i<n; i++) {
+    accumulator |= ((ULong64_t) values[i]) << nBits;
+    nBits += width;
+    while (nBits >= 8) {
+      *out++ = (UChar_t) accumulator;
+      accumulator >>= 8;
+      nBits -= 8;
+    }
+  }
+  if (nBits > 0) *out++ = (UChar_t) accumulator;
+  return out - start;
+}
+
+static inline void ORWaveformCodecUnpack(const UChar_t* in, size_t n, int width, UInt_t* values)
+{
+  if (width == 0) {
+    for (size_t i=0; i<n; i++) values[i] = 0;
+    return;
+  }
+  const ULong64_t mask = (((ULong64_t) 1) << width) - 1;
+  ULong64_t accumulator = 0;
+  int nBits = 0;
+  for (size_t i=0; i<n; i++) {
+    while (nBits < width) {
+      accumulator |= ((ULong64_t) *in++) << nBits;
+      nBits += 8;
+    }
+    values[i] = (UInt_t) (accumulator & mask);
+    accumulator >>= width;
+    nBits -= width;
+  }
+}
+
+ORWaveformCodec::ORWaveformCodec(UShort_t bitResolution, EPredictor predictor)
+{
+  SetBitResolution(bitResolution);
+  fPredictor = predictor;
+}
+
+void ORWaveformCodec::SetBitResolution(UShort_t bitResolution)
+{
+  if (bitResolution == 0 || bitResolution > 16) {
+    ORLog(kWarning) << "SetBitResolution(): " << bitResolution
+                    << "-bit samples not supported, using 16" << std::endl;
+    bitResolution = 16;
+  }
+  fBitResolution = bitResolution;
+}
+
+size_t ORWaveformCodec::Encode(const UShort_t* samples, size_t nSamples, UChar_t* out) const
+{
+  UChar_t* start = out;
+  *out++ = (UChar_t) ((kFormatVersion << 4) | fPredictor);
+  *out++ = (UChar_t) fBitResolution;
+  size_t n = nSamples;
+  do {
+    UChar_t byte = n & 0x7f;
+    n >>= 7;
+    if (n != 0) byte |= 0x80;
+    *out++ = byte;
+  } while (n != 0);
+
+  UInt_t residuals[kBlockSize];
+  UInt_t raw[kBlockSize];
+  Int_t previous = 0, beforePrevious = 0;
+  for (size_t first=0; first<nSamples; first+=kBlockSize) {
+    size_t blockLength = (nSamples - first < (size_t) kBlockSize) ? nSamples - first : (size_t) kBlockSize;
+    const UShort_t* block = samples + first;
+    UInt_t residualBits = 0, rawBits = 0;
+    for (size_t i=0; i<blockLength; i++) {
+      Int_t sample = block[i];
+      Int_t prediction = 0;
+      switch (fPredictor) {
+        case kDelta: prediction = previous; break;
+        case kLinear: prediction = 2*previous - beforePrevious; break;
+        case kNoPrediction: prediction = 0; break;
+      }
+      Int_t residual = sample - prediction;
+      residuals[i] = (((UInt_t) residual) << 1) ^ ((UInt_t) (residual >> 31)); // zig-zag
+      raw[i] = sample;
+      residualBits |= residuals[i];
+      rawBits |= raw[i];
+      beforePrevious = previous;
+      previous = sample;
+    }
+    int residualWidth = ORWaveformCodecBitsNeeded(residualBits);
+    int rawWidth = ORWaveformCodecBitsNeeded(rawBits);
+    if (rawWidth < fBitResolution) rawWidth = fBitResolution;
+    if (residualWidth < rawWidth) {
+      *out++ = (UChar_t) residualWidth;
+      out += ORWaveformCodecPack(residuals, blockLength, residualWidth, out);
+    }
+    else {
+      *out++ = (UChar_t) (kRawBlock | rawWidth);
+      out += ORWaveformCodecPack(raw, blockLength, rawWidth, out);
+    }
+  }
+  return out - start;
+}
+
+size_t ORWaveformCodec::Encode(const UShort_t* samples, size_t nSamples,
+                               std::vector<UChar_t>& out) const
+{
+  out.resize(MaxEncodedSize(nSamples));
+  size_t nBytes = Encode(samples, nSamples, &out[0]);
+  out.resize(nBytes);
+  return nBytes;
+}
+
+size_t ORWaveformCodec::GetNSamples(const UChar_t* in, size_t nBytes)
+{
+  if (nBytes < 3 || (in[0] >> 4) != kFormatVersion) return 0;
+  size_t nSamples = 0;
+  for (size_t i=2, shift=0; i<nBytes && shift<35; i++, shift+=7) {
+    nSamples |= ((size_t) (in[i] & 0x7f)) << shift;
+    if ((in[i] & 0x80) == 0) return nSamples;
+  }
+  return 0;
+}
+
+size_t ORWaveformCodec::Decode(const UChar_t* in, size_t nBytes, UShort_t* samples, size_t maxSamples)
+{
+  size_t nSamples = GetNSamples(in, nBytes);
+  if (nSamples == 0) return 0;
+  EPredictor predictor = (EPredictor) (in[0] & 0x0f);
+  if (predictor != kDelta && predictor != kLinear && predictor != kNoPrediction) return 0;
+  const UChar_t* end = in + nBytes;
+  in += 2;
+  while (*in & 0x80) in++;
+  in++;
+
+  if (nSamples > maxSamples) nSamples = maxSamples;
+  UInt_t values[kBlockSize];
+  Int_t previous = 0, beforePrevious = 0;
+  for (size_t first=0; first<nSamples; first+=kBlockSize) {
+    size_t blockLength = (nSamples - first < (size_t) kBlockSize) ? nSamples - first : (size_t) kBlockSize;
+    if (in >= end) return 0;
+    UChar_t header = *in++;
+    int width = header & kWidthMask;
+    size_t blockBytes = (width*blockLength + 7)/8;
+    if (width > 32 || blockBytes > (size_t) (end - in)) return 0;
+    ORWaveformCodecUnpack(in, blockLength, width, values);
+    in += blockBytes;
+
+    UShort_t* block = samples + first;
+    if (header & kRawBlock) {
+      for (size_t i=0; i<blockLength; i++) block[i] = (UShort_t) values[i];
+      if (blockLength >= 2) beforePrevious = block[blockLength-2];
+      else beforePrevious = previous;
+      previous = block[blockLength-1];
+      continue;
+    }
+    for (size_t i=0; i<blockLength; i++) {
+      Int_t residual = (Int_t) (values[i] >> 1) ^ -((Int_t) (values[i] & 1));
+      Int_t sample = residual;
+      if (predictor == kDelta) sample += previous;
+      else if (predictor == kLinear) sample += 2*previous - beforePrevious;
+      block[i] = (UShort_t) sample;
+      beforePrevious = previous;
+      previous = sample;
+    }
+  }
+  return nSamples;
+}
+
+size_t ORWaveformCodec::Decode(const UChar_t* in, size_t nBytes, std::vector<UShort_t>& samples)
+{
+  samples.resize(GetNSamples(in, nBytes));
+  if (samples.empty()) return 0;
+  size_t nSamples = Decode(in, nBytes, &samples[0], samples.size());
+  samples.resize(nSamples);
+  return nSamples;
+}
@@ -0,0 +1,77 @@
+// ORWaveformCodec.hh
+
+#ifndef _ORWaveformCodec_hh_
+#define _ORWaveformCodec_hh_
+
+#include <cstddef>
+#include <vector>
+#ifndef ROOT_Rtypes
+#include "Rtypes.h"
+#endif
+
+//! Lossless codec for digitizer waveforms of up to 16 bits per sample.
+/*!
+    Each sample is predicted from the previous ones (kDelta: the previous
+    sample, kLinear: linear extrapolation of the previous two), and the
+    prediction residuals are zig-zag mapped to unsigned integers and
+    bit-packed in blocks of kBlockSize samples, each block with the bit
+    width of its largest residual.  Blocks in which the residuals would need
+    at least as many bits as the samples themselves (e.g. at a fast edge)
+    store the samples packed to the digitizer's bit resolution instead, so a
+    waveform never takes more than bitResolution bits per sample plus one
+    byte per block and a few bytes of header.
+
+    The encoded stream is self-describing (predictor, bit resolution and
+    number of samples are in the header), so Decode() needs no parameters.
+    Baseline-dominated traces from 12- and 14-bit digitizers typically
+    shrink to 3-6 bits per sample, and both directions are much faster than
+    deflate.
+
+    Usage in analysis, for a tree written with waveform encoding on:
+    \verbatim
+    std::vector<UShort_t> wf;
+    ORWaveformCodec::Decode(waveformEncoded, waveformEncodedLength, wf);
+    \endverbatim
+ */
+class ORWaveformCodec
+{
+  public:
+    enum EPredictor { kDelta = 1, kLinear = 2, kNoPrediction = 3 };
+    enum EWaveformCodecConsts { kBlockSize = 128, kFormatVersion = 1, kMaxHeaderBytes = 8 };
+
+    ORWaveformCodec(UShort_t bitResolution = 16, EPredictor predictor = kDelta);
+    virtual ~ORWaveformCodec() {}
+
+    virtual void SetBitResolution(UShort_t bitResolution);
+    virtual UShort_t GetBitResolution() const { return fBitResolution; }
+    virtual void SetPredictor(EPredictor predictor) { fPredictor = predictor; }
+    virtual EPredictor GetPredictor() const { return fPredictor; }
+
+    //! Encodes nSamples samples into out, returning the number of bytes written.
+    /*!
+        out must have room for MaxEncodedSize(nSamples) bytes.
+     */
+    virtual size_t Encode(const UShort_t* samples, size_t nSamples, UChar_t* out) const;
+    virtual size_t Encode(const UShort_t* samples, size_t nSamples,
+                          std::vector<UChar_t>& out) const;
+
+    //! Upper bound of the encoded size of nSamples samples.
+    static size_t MaxEncodedSize(size_t nSamples)
+      { return kMaxHeaderBytes + (nSamples + kBlockSize - 1)/kBlockSize + 2*nSamples; }
+
+    //! Number of samples in an encoded waveform, 0 if the header is bad.
+    static size_t GetNSamples(const UChar_t* in, size_t nBytes);
+
+    //! Decodes at most maxSamples samples, returning the number decoded.
+    /*!
+        Returns 0 if the input is corrupt or truncated.
+     */
+    static size_t Decode(const UChar_t* in, size_t nBytes, UShort_t* samples, size_t maxSamples);
+    static size_t Decode(const UChar_t* in, size_t nBytes, std::vector<UShort_t>& samples);
+
+  protected:
+    UShort_t fBitResolution;
+    EPredictor fPredictor;
+};
+
+#endif
@@ -114,6 +114,13 @@ const ORVDictValue* ORXmlPlist::LookUp(std::string key, char delimiter) const
   return fDictionary->LookUp(key, delimiter); 
 }
 
+size_t ORXmlPlist::GetMemoryUsage() const
+{
+  size_t nBytes = fRawXML.Capacity();
+  if (fDictionary != NULL) nBytes += fDictionary->GetMemoryUsage();
+  return nBytes;
+}
+
 bool ORXmlPlist::LoadDictionary(TXMLNode* dictNode, ORDictionary* dictionary)
 {
   ORLog(kDebug) << "LoadDictionary(): Loading dictionary " 
@@ -36,6 +36,8 @@ class ORXmlPlist
     virtual const ORVDictValue* LookUp(std::string key, char delimiter = ':') const;
     virtual TString& GetRawXML() { return fRawXML; }
     virtual const TString& GetRawXML() const { return fRawXML; }
+    //! Approximate bytes held by the raw XML and the dictionary.
+    virtual size_t GetMemoryUsage() const;
 
     // Options
     virtual inline void ValidateXML(bool flag = true) { fDoValidate = flag; }
@@ -0,0 +1,12 @@
+// ORRunInfoTreeLinkDef.h
+// Dictionary of the classes with a ClassDef for the CMake build; the
+// autotools build runs rootcint over every header instead.
+
+#ifdef __CINT__
+#pragma link off all globals;
+#pragma link off all classes;
+#pragma link off all functions;
+
+#pragma link C++ class ORRunRangeIndex+;
+
+#endif